@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "memory/slab_allocator.h"
+
+namespace redis_simple {
+namespace {
+// Request sizes of the hot nodes: dict entries, objects and list nodes.
+constexpr std::array<size_t, 4> kChurnSizes = {32, 48, 80, 112};
+
+template <bool slab>
+void* Allocate(size_t size) {
+  if (slab) {
+    return in_memory::SlabAllocate(size, in_memory::SlabTag::kDictEntry);
+  }
+  return ::operator new(size);
+}
+
+template <bool slab>
+void Deallocate(void* pointer, size_t size) {
+  if (slab) {
+    in_memory::SlabDeallocate(pointer, size, in_memory::SlabTag::kDictEntry);
+  } else {
+    ::operator delete(pointer);
+  }
+}
+
+// Keep state.range(0) objects of mixed sizes live, and each iteration replace
+// a random one, as inserts and deletes do in a steady-state keyspace.
+template <bool slab>
+void AllocatorChurn(benchmark::State& state) {
+  const auto live = static_cast<size_t>(state.range(0));
+  std::mt19937 rng(42);
+  std::vector<void*> objects(live);
+  std::vector<size_t> sizes(live);
+  for (size_t index = 0; index < live; ++index) {
+    sizes[index] = kChurnSizes[index % kChurnSizes.size()];
+    objects[index] = Allocate<slab>(sizes[index]);
+  }
+  std::uniform_int_distribution<size_t> pick(0, live - 1);
+  for (auto _ : state) {
+    (void)_;
+    const size_t index = pick(rng);
+    Deallocate<slab>(objects[index], sizes[index]);
+    sizes[index] = kChurnSizes[rng() % kChurnSizes.size()];
+    objects[index] = Allocate<slab>(sizes[index]);
+    benchmark::DoNotOptimize(objects[index]);
+  }
+  for (size_t index = 0; index < live; ++index) {
+    Deallocate<slab>(objects[index], sizes[index]);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Allocate state.range(0) objects and free them all, as filling and flushing
+// a table does.
+template <bool slab>
+void AllocatorBulk(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  std::vector<void*> objects(count);
+  for (auto _ : state) {
+    (void)_;
+    for (size_t index = 0; index < count; ++index) {
+      objects[index] = Allocate<slab>(kChurnSizes[index % kChurnSizes.size()]);
+    }
+    for (size_t index = 0; index < count; ++index) {
+      Deallocate<slab>(objects[index], kChurnSizes[index % kChurnSizes.size()]);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+}  // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables,bugprone-throwing-static-initialization)
+BENCHMARK_TEMPLATE(AllocatorChurn, false)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(AllocatorChurn, true)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(AllocatorBulk, false)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(AllocatorBulk, true)->Range(1 << 10, 1 << 16);
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables,bugprone-throwing-static-initialization)
+}  // namespace redis_simple
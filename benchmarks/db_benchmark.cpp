@@ -0,0 +1,164 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "memory/slab_allocator.h"
+#include "server/db/db.h"
+#include "server/db/redis_obj.h"
+#include "utils/string_utils.h"
+#include "utils/time_utils.h"
+
+namespace redis_simple {
+// Look up state.range(0) volatile keys, reading the clock on every lookup or,
+// with cached set, once per batch as an event loop iteration does.
+template <bool cached>
+static void VolatileKeyLookup(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  auto redis_db = db::RedisDb::Create();
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  const int64_t expire = utils::NowInMilliseconds() + 3'600'000;
+  for (size_t index = 0; index < count; ++index) {
+    keys.push_back("key:" + std::to_string(index));
+    redis_db->SetKey(keys.back(), db::RedisObject::CreateWithString("v"),
+                     expire);
+  }
+
+  for (auto _ : state) {
+    (void)_;
+    std::optional<utils::CachedClockScope> cached_clock;
+    if (cached) {
+      cached_clock.emplace();
+    }
+    for (const auto& key : keys) {
+      benchmark::DoNotOptimize(redis_db->LookupKey(key));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+
+// Run SCAN MATCH user:42:* to completion over state.range(0) keys, filtering
+// the whole keyspace or, with indexed set, walking the prefix index.
+template <bool indexed>
+static void PrefixScan(benchmark::State& state) {
+  constexpr size_t kScanCount = 100;
+  constexpr std::string_view kPattern = "user:42:*";
+  const auto count = static_cast<size_t>(state.range(0));
+  auto redis_db = db::RedisDb::Create(db::RedisDb::kDefaultKeyspaceShards,
+                                      indexed);
+  for (size_t index = 0; index < count; ++index) {
+    redis_db->SetKey("user:" + std::to_string(index % 1000) + ":" +
+                         std::to_string(index / 1000),
+                     db::RedisObject::CreateWithString("v"), 0);
+  }
+  const std::string prefix = utils::GlobLiteralPrefix(kPattern);
+
+  size_t matched = 0;
+  const auto collect = [&matched, kPattern](std::string_view key) {
+    matched += utils::MatchesGlob(key, kPattern) ? 1 : 0;
+  };
+  for (auto _ : state) {
+    (void)_;
+    size_t cursor = 0;
+    do {
+      if (indexed) {
+        cursor = redis_db->ScanKeysWithPrefix(cursor, prefix, kScanCount,
+                                              collect)
+                     .value_or(0);
+      } else {
+        cursor = redis_db->ScanKeys(cursor, kScanCount, collect);
+      }
+    } while (cursor != 0);
+  }
+  benchmark::DoNotOptimize(matched);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+  state.counters["index_bytes_per_key"] =
+      static_cast<double>(redis_db->PrefixStats().memory_bytes) /
+      static_cast<double>(count);
+}
+
+// Set 4096 keys to string values of state.range(0) bytes and read them back,
+// reporting the bytes each value's object takes from the slab allocator.
+static void StringValueSetGet(benchmark::State& state) {
+  constexpr size_t kKeys = 4096;
+  const std::string value(static_cast<size_t>(state.range(0)), 'v');
+  std::vector<std::string> keys;
+  keys.reserve(kKeys);
+  for (size_t index = 0; index < kKeys; ++index) {
+    keys.push_back("key:" + std::to_string(index));
+  }
+  auto redis_db = db::RedisDb::Create();
+  const auto object_bytes = [] {
+    return in_memory::SlabMemoryStats().tag_bytes[static_cast<size_t>(
+        in_memory::SlabTag::kRedisObject)];
+  };
+  const size_t before = object_bytes();
+  for (const auto& key : keys) {
+    redis_db->SetKey(key, db::RedisObject::CreateWithString(value), 0);
+  }
+  state.counters["object_bytes_per_key"] =
+      static_cast<double>(object_bytes() - before) / kKeys;
+
+  for (auto _ : state) {
+    (void)_;
+    for (const auto& key : keys) {
+      redis_db->SetKey(key, db::RedisObject::CreateWithString(value), 0);
+      benchmark::DoNotOptimize(redis_db->LookupKey(key)->String().data());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * kKeys);
+}
+
+// Set 4096 keys to the decimal integers from state.range(0) upwards and read
+// them back, reporting the bytes each value's object takes from the slab
+// allocator. Values below 10000 come from the shared integer pool.
+static void IntegerValueSetGet(benchmark::State& state) {
+  constexpr size_t kKeys = 4096;
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  keys.reserve(kKeys);
+  values.reserve(kKeys);
+  for (size_t index = 0; index < kKeys; ++index) {
+    keys.push_back("key:" + std::to_string(index));
+    values.push_back(std::to_string(state.range(0) + index));
+  }
+  auto redis_db = db::RedisDb::Create();
+  const auto object_bytes = [] {
+    return in_memory::SlabMemoryStats().tag_bytes[static_cast<size_t>(
+        in_memory::SlabTag::kRedisObject)];
+  };
+  const size_t before = object_bytes();
+  for (size_t index = 0; index < kKeys; ++index) {
+    redis_db->SetKey(keys[index],
+                     db::RedisObject::CreateWithString(values[index]), 0);
+  }
+  state.counters["object_bytes_per_key"] =
+      static_cast<double>(object_bytes() - before) / kKeys;
+
+  for (auto _ : state) {
+    (void)_;
+    for (size_t index = 0; index < kKeys; ++index) {
+      redis_db->SetKey(keys[index],
+                       db::RedisObject::CreateWithString(values[index]), 0);
+      benchmark::DoNotOptimize(redis_db->LookupKey(keys[index]));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * kKeys);
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables,bugprone-throwing-static-initialization)
+BENCHMARK_TEMPLATE(VolatileKeyLookup, false)->Range(1 << 6, 1 << 16);
+BENCHMARK_TEMPLATE(VolatileKeyLookup, true)->Range(1 << 6, 1 << 16);
+BENCHMARK_TEMPLATE(PrefixScan, false)->Range(1 << 12, 1 << 18);
+BENCHMARK_TEMPLATE(PrefixScan, true)->Range(1 << 12, 1 << 18);
+BENCHMARK(StringValueSetGet)->Arg(8)->Arg(24)->Arg(47)->Arg(64);
+BENCHMARK(IntegerValueSetGet)->Arg(0)->Arg(1'000'000'000'000);
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables,bugprone-throwing-static-initialization)
+}  // namespace redis_simple
@@ -6,13 +6,28 @@
 #include <vector>
 
 #include "memory/dict.h"
+#include "memory/flat_dict.h"
 
 namespace redis_simple {
-in_memory::Dict<std::string, std::string>& BenchmarkDict() {
-  static auto dict = in_memory::Dict<std::string, std::string>::Create();
+// Chained dict with runtime std::function hooks.
+using ChainedDict = in_memory::Dict<std::string, std::string>;
+// Chained dict with hooks inlined through a compile-time policy.
+using PolicyDict =
+    in_memory::Dict<std::string, std::string,
+                    in_memory::DefaultDictPolicy<std::string, std::string>>;
+// Inlined hooks with key bytes embedded in each entry.
+using EmbeddedKeyDict =
+    in_memory::Dict<std::string, std::string,
+                    in_memory::EmbeddedKeyDictPolicy<std::string>>;
+using FlatDict = in_memory::FlatDict<std::string, std::string>;
+
+template <typename DictType>
+DictType& BenchmarkDict() {
+  static auto dict = DictType::Create();
   return *dict;
 }
 
+template <typename DictType>
 std::vector<std::string>& BenchmarkKeys() {
   static std::vector<std::string> keys;
   return keys;
@@ -44,56 +59,140 @@ static std::string RandomString(int len) {
   return str;
 }
 
+template <typename DictType>
 static void DictAdd(benchmark::State& state) {
   for (auto _ : state) {
     (void)_;
     const auto key = RandomString(10);
-    BenchmarkKeys().push_back(key);
-    BenchmarkDict().Insert(key, RandomString(10));
+    BenchmarkKeys<DictType>().push_back(key);
+    BenchmarkDict<DictType>().Insert(key, RandomString(10));
   }
 }
 
+template <typename DictType>
 static void DictFind(benchmark::State& state) {
+  auto& keys = BenchmarkKeys<DictType>();
   for (auto _ : state) {
     (void)_;
-    if (!BenchmarkKeys().empty()) {
-      benchmark::DoNotOptimize(BenchmarkDict().Get(
-          BenchmarkKeys()[RandomIndex(BenchmarkKeys().size())]));
+    if (!keys.empty()) {
+      benchmark::DoNotOptimize(BenchmarkDict<DictType>().FindValue(
+          std::string_view(keys[RandomIndex(keys.size())])));
     }
   }
 }
 
+template <typename DictType>
 static void DictUpdate(benchmark::State& state) {
+  auto& keys = BenchmarkKeys<DictType>();
   std::bernoulli_distribution use_existing(0.5);
   for (auto _ : state) {
     (void)_;
-    if (use_existing(Rng()) && !BenchmarkKeys().empty()) {
-      BenchmarkDict().Set(BenchmarkKeys()[RandomIndex(BenchmarkKeys().size())],
-                          RandomString(10));
+    if (use_existing(Rng()) && !keys.empty()) {
+      BenchmarkDict<DictType>().Set(keys[RandomIndex(keys.size())],
+                                    RandomString(10));
     } else {
-      BenchmarkDict().Set("non-existing key", "val");
+      BenchmarkDict<DictType>().Set("non-existing key", "val");
     }
   }
 }
 
+template <typename DictType>
 static void DictDelete(benchmark::State& state) {
+  auto& keys = BenchmarkKeys<DictType>();
   std::bernoulli_distribution use_existing(0.5);
   for (auto _ : state) {
     (void)_;
-    if (use_existing(Rng()) && !BenchmarkKeys().empty()) {
-      BenchmarkDict().Delete(
-          BenchmarkKeys()[RandomIndex(BenchmarkKeys().size())]);
+    if (use_existing(Rng()) && !keys.empty()) {
+      BenchmarkDict<DictType>().Delete(keys[RandomIndex(keys.size())]);
+    } else {
+      BenchmarkDict<DictType>().Delete("non-existing key");
+    }
+  }
+}
+
+// Look up hits and misses in a prefilled table of state.range(0) keys.
+template <typename DictType>
+static void DictFindPrefilled(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  auto dict = DictType::Create();
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (size_t index = 0; index < count; ++index) {
+    keys.push_back("key:" + std::to_string(index));
+    dict->Insert(keys.back(), "value");
+  }
+  std::vector<std::string> missing;
+  missing.reserve(count);
+  for (size_t index = 0; index < count; ++index) {
+    missing.push_back("missing:" + std::to_string(index));
+  }
+  size_t index = 0;
+  for (auto _ : state) {
+    (void)_;
+    benchmark::DoNotOptimize(
+        dict->FindValue(std::string_view(keys[index % count])));
+    benchmark::DoNotOptimize(
+        dict->FindValue(std::string_view(missing[index % count])));
+    index += 7919;
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 2);
+}
+
+// Load state.range(0) distinct keys into an empty dict, either growing on
+// demand or presized with Reserve() and filled through BulkInsert().
+template <typename DictType, bool kPresize>
+static void DictLoad(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  for (size_t index = 0; index < count; ++index) {
+    keys.push_back("key:" + std::to_string(index));
+  }
+  for (auto _ : state) {
+    (void)_;
+    auto dict = DictType::Create();
+    if constexpr (kPresize) {
+      dict->Reserve(count);
+      for (const auto& key : keys) {
+        dict->BulkInsert(std::string(key), "value");
+      }
     } else {
-      BenchmarkDict().Delete("non-existing key");
+      for (const auto& key : keys) {
+        dict->Insert(key, "value");
+      }
     }
+    benchmark::DoNotOptimize(dict->Size());
   }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
 }
 
 // NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables,bugprone-throwing-static-initialization)
-BENCHMARK(DictAdd);
-BENCHMARK(DictFind);
-BENCHMARK(DictUpdate);
-BENCHMARK(DictDelete);
+BENCHMARK_TEMPLATE(DictAdd, ChainedDict);
+BENCHMARK_TEMPLATE(DictFind, ChainedDict);
+BENCHMARK_TEMPLATE(DictUpdate, ChainedDict);
+BENCHMARK_TEMPLATE(DictDelete, ChainedDict);
+BENCHMARK_TEMPLATE(DictFindPrefilled, ChainedDict)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(DictAdd, PolicyDict);
+BENCHMARK_TEMPLATE(DictFind, PolicyDict);
+BENCHMARK_TEMPLATE(DictUpdate, PolicyDict);
+BENCHMARK_TEMPLATE(DictDelete, PolicyDict);
+BENCHMARK_TEMPLATE(DictFindPrefilled, PolicyDict)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(DictAdd, EmbeddedKeyDict);
+BENCHMARK_TEMPLATE(DictFind, EmbeddedKeyDict);
+BENCHMARK_TEMPLATE(DictUpdate, EmbeddedKeyDict);
+BENCHMARK_TEMPLATE(DictDelete, EmbeddedKeyDict);
+BENCHMARK_TEMPLATE(DictFindPrefilled, EmbeddedKeyDict)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(DictAdd, FlatDict);
+BENCHMARK_TEMPLATE(DictFind, FlatDict);
+BENCHMARK_TEMPLATE(DictUpdate, FlatDict);
+BENCHMARK_TEMPLATE(DictDelete, FlatDict);
+BENCHMARK_TEMPLATE(DictFindPrefilled, FlatDict)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(DictLoad, EmbeddedKeyDict, false)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(DictLoad, EmbeddedKeyDict, true)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(DictLoad, FlatDict, false)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(DictLoad, FlatDict, true)->Range(1 << 10, 1 << 20);
 // NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables,bugprone-throwing-static-initialization)
 }  // namespace redis_simple
 
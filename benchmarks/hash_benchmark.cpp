@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "memory/hash_function.h"
+
+namespace redis_simple {
+// Hash a key of state.range(0) bytes with the standard library hash.
+static void StdHash(benchmark::State& state) {
+  const std::string key(static_cast<size_t>(state.range(0)), 'k');
+  std::hash<std::string_view> hash;
+  for (auto _ : state) {
+    (void)_;
+    benchmark::DoNotOptimize(hash(std::string_view(key)));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+
+// Hash a key of state.range(0) bytes with the seeded dict hash.
+static void SeededHash(benchmark::State& state) {
+  const std::string key(static_cast<size_t>(state.range(0)), 'k');
+  for (auto _ : state) {
+    (void)_;
+    benchmark::DoNotOptimize(in_memory::HashString(key));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables,bugprone-throwing-static-initialization)
+BENCHMARK(StdHash)->RangeMultiplier(2)->Range(8, 1024);
+BENCHMARK(SeededHash)->RangeMultiplier(2)->Range(8, 1024);
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables,bugprone-throwing-static-initialization)
+}  // namespace redis_simple
@@ -0,0 +1,64 @@
+#include "cli/bigkeys.h"
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace redis_simple::cli {
+namespace {
+// The value of field in an INFO-style report, or an empty view.
+std::string_view FieldValue(std::string_view report, std::string_view field) {
+  size_t start = 0;
+  while (start < report.size()) {
+    size_t end = report.find('\n', start);
+    if (end == std::string_view::npos) {
+      end = report.size();
+    }
+    std::string_view line = report.substr(start, end - start);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    if (line.size() > field.size() && line.substr(0, field.size()) == field &&
+        line[field.size()] == ':') {
+      return line.substr(field.size() + 1);
+    }
+    start = end + 1;
+  }
+  return {};
+}
+
+void WriteReport(std::string_view report, std::ostream& out) {
+  for (const char character : report) {
+    if (character != '\r') {
+      out << character;
+    }
+  }
+}
+}  // namespace
+
+bool RunBigKeys(RedisCli* const cli, std::chrono::milliseconds poll_interval,
+                std::ostream& out, std::ostream& progress) {
+  cli->AddCommand(std::vector<std::string_view>{"BIGKEYS", "START"});
+  const std::string started = cli->ReadReply();
+  if (started != "OK\n") {
+    progress << "bigkeys: " << started;
+    return false;
+  }
+  while (true) {
+    std::this_thread::sleep_for(poll_interval);
+    cli->AddCommand(std::vector<std::string_view>{"BIGKEYS", "STATUS"});
+    const std::string report = cli->ReadReply();
+    const std::string_view status = FieldValue(report, "status");
+    if (status == "running") {
+      progress << "scanned " << FieldValue(report, "scanned_keys")
+               << " keys\n";
+      continue;
+    }
+    WriteReport(report, out);
+    return status == "done";
+  }
+}
+}  // namespace redis_simple::cli
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+
+#include "cli/cli.h"
+
+namespace redis_simple::cli {
+/*
+ * The --bigkeys mode: start the server's BIGKEYS analysis, poll its status
+ * every poll_interval while the server scans in the background, and write the
+ * final report to out. Progress goes to progress. Returns false if the
+ * analysis could not start or was stopped before it finished.
+ */
+bool RunBigKeys(RedisCli* cli, std::chrono::milliseconds poll_interval,
+                std::ostream& out, std::ostream& progress);
+}  // namespace redis_simple::cli
@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cli/bigkeys.h"
+#include "cli/cli.h"
+#include "utils/string_utils.h"
+
+namespace {
+constexpr std::string_view kUsage =
+    "Usage: redis_simple_client [--host <address>] [--port <port>] "
+    "[--bigkeys | command [arg ...]]\n";
+constexpr std::chrono::milliseconds kBigKeysPollInterval{100};
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string host = "127.0.0.1";
+  int64_t port = 8080;
+  bool bigkeys = false;
+  std::vector<std::string_view> command;
+  for (int index = 1; index < argc; ++index) {
+    const std::string_view arg = argv[index];
+    if (!command.empty()) {
+      command.push_back(arg);
+    } else if (arg == "--help") {
+      std::cout << kUsage;
+      return EXIT_SUCCESS;
+    } else if (arg == "--bigkeys") {
+      bigkeys = true;
+    } else if ((arg == "--host" || arg == "--port") && index + 1 < argc) {
+      const std::string_view value = argv[++index];
+      if (arg == "--host") {
+        host = value;
+      } else if (!redis_simple::utils::ToInt64(value, &port) || port < 1 ||
+                 port > 65535) {
+        std::cerr << "redis_simple_client: port must be between 1 and 65535\n";
+        return EXIT_FAILURE;
+      }
+    } else if (arg.substr(0, 2) == "--") {
+      std::cerr << "redis_simple_client: unknown option " << arg << '\n'
+                << kUsage;
+      return EXIT_FAILURE;
+    } else {
+      command.push_back(arg);
+    }
+  }
+  if (bigkeys == !command.empty()) {
+    std::cerr << kUsage;
+    return EXIT_FAILURE;
+  }
+
+  redis_simple::cli::RedisCli cli;
+  if (cli.Connect(host, static_cast<int>(port)) !=
+      redis_simple::cli::CliStatus::kOk) {
+    std::cerr << "redis_simple_client: cannot connect to " << host << ':'
+              << port << '\n';
+    return EXIT_FAILURE;
+  }
+  if (bigkeys) {
+    return redis_simple::cli::RunBigKeys(&cli, kBigKeysPollInterval,
+                                         std::cout, std::cerr)
+               ? EXIT_SUCCESS
+               : EXIT_FAILURE;
+  }
+  cli.AddCommand(command);
+  std::cout << cli.ReadReply();
+  return EXIT_SUCCESS;
+}
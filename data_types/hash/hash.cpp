@@ -10,6 +10,8 @@
 #include <utility>
 #include <vector>
 
+#include "memory/used_memory.h"
+
 namespace redis_simple::hash {
 namespace {
 constexpr size_t kListPackMaxEntries = 128;
@@ -80,6 +82,43 @@ size_t Hash::Size() const {
   throw std::invalid_argument("unknown hash encoding type");
 }
 
+size_t Hash::Bytes(size_t samples) const {
+  if (encoding_ == Encoding::kListPack) {
+    return listpack_ == nullptr ? 0
+                                : in_memory::AllocationBytes(listpack_.get()) +
+                                      listpack_->Bytes();
+  }
+  if (encoding_ == Encoding::kDict) {
+    return dict_ == nullptr ? 0
+                            : in_memory::AllocationBytes(dict_.get()) +
+                                  dict_->Bytes(samples);
+  }
+  throw std::invalid_argument("unknown hash encoding type");
+}
+
+bool Hash::Defrag(in_memory::DefragStats* const stats) {
+  if (encoding_ == Encoding::kListPack) {
+    return listpack_ != nullptr && listpack_->Defrag(stats);
+  }
+  if (encoding_ == Encoding::kDict) {
+    bool moved = false;
+    std::optional<size_t> cursor = 0;
+    while (dict_ != nullptr && cursor.has_value()) {
+      cursor = dict_->Scan(*cursor, [stats, &moved](
+                                        std::string_view /*field*/,
+                                        const std::string& value) {
+        // Moving the value's buffer leaves the entry, its field and its hash
+        // untouched, so the dict is not mutated in the sense Scan forbids.
+        moved = in_memory::DefragString(const_cast<std::string*>(&value),
+                                        stats) ||
+                moved;
+      });
+    }
+    return moved;
+  }
+  throw std::invalid_argument("unknown hash encoding type");
+}
+
 std::vector<Hash::Entry> Hash::Entries() const {
   std::vector<Entry> entries;
   entries.reserve(Size());
@@ -131,7 +170,7 @@ bool Hash::SetListPack(std::string_view field, std::string_view value) {
 bool Hash::SetDict(std::string_view field, std::string_view value) {
   assert(encoding_ == Encoding::kDict);
   if (dict_ == nullptr) {
-    dict_ = in_memory::Dict<std::string, std::string>::Create();
+    dict_ = in_memory::HashTable<std::string, std::string>::Create();
   }
   auto* existing = dict_->FindValue(field);
   if (existing != nullptr) {
@@ -144,11 +183,11 @@ bool Hash::SetDict(std::string_view field, std::string_view value) {
 
 void Hash::ConvertListPackToDict(size_t capacity) {
   assert(encoding_ == Encoding::kListPack);
-  dict_ = in_memory::Dict<std::string, std::string>::Create(capacity);
+  dict_ = in_memory::HashTable<std::string, std::string>::Create(capacity);
   if (listpack_ != nullptr) {
     listpack_->ForEachPair(
         [this](std::string_view field, std::string_view value) {
-          dict_->Set(std::string(field), std::string(value));
+          dict_->BulkInsert(std::string(field), std::string(value));
           return true;
         });
   }
@@ -8,7 +8,8 @@
 #include <string_view>
 #include <vector>
 
-#include "memory/dict.h"
+#include "memory/defrag.h"
+#include "memory/hash_table.h"
 #include "memory/listpack.h"
 
 namespace redis_simple::hash {
@@ -33,6 +34,12 @@ class Hash {
   bool Delete(std::string_view field);
   bool Exists(std::string_view field) const;
   size_t Size() const;
+  // Heap bytes of the active encoding. With samples, the table measures
+  // only that many elements and extrapolates the rest.
+  size_t Bytes(size_t samples = 0) const;
+  // Move the listpack, or the value strings of a table, to fresh memory where
+  // that packs the heap better. Returns true if anything moved.
+  bool Defrag(in_memory::DefragStats* stats);
   std::vector<Entry> Entries() const;
   // The value view is valid only during the callback invocation.
   template <typename Visitor>
@@ -56,7 +63,7 @@ class Hash {
 
   enum Encoding encoding_;
   std::unique_ptr<in_memory::ListPack> listpack_;
-  std::unique_ptr<in_memory::Dict<std::string, std::string>> dict_;
+  std::unique_ptr<in_memory::HashTable<std::string, std::string>> dict_;
 };
 
 template <typename Visitor>
@@ -98,7 +105,8 @@ bool Hash::ForEachEntry(Visitor&& visitor) const {
     return listpack_->ForEachPair(visitor);
   }
   if (encoding_ == Encoding::kDict) {
-    auto it = in_memory::Dict<std::string, std::string>::Iterator(dict_.get());
+    auto it =
+        in_memory::HashTable<std::string, std::string>::Iterator(dict_.get());
     it.SeekToFirst();
     while (it.Valid()) {
       if (!visitor(it.Key(), it.Value())) {
@@ -9,6 +9,8 @@
 #include <utility>
 #include <vector>
 
+#include "memory/used_memory.h"
+
 namespace redis_simple::list {
 namespace {
 in_memory::QuickList::RemoveDirection ToQuickListRemoveDirection(
@@ -123,6 +125,17 @@ size_t List::NodeCount() const {
   return quicklist_ ? quicklist_->NodeCount() : 0;
 }
 
+size_t List::Bytes(size_t samples) const {
+  return listpack_ ? in_memory::AllocationBytes(listpack_.get()) +
+                         listpack_->Bytes()
+                   : in_memory::AllocationBytes(quicklist_.get()) +
+                         quicklist_->Bytes(samples);
+}
+
+bool List::Defrag(in_memory::DefragStats* const stats) {
+  return listpack_ ? listpack_->Defrag(stats) : quicklist_->Defrag(stats);
+}
+
 std::vector<std::string> List::Range(size_t start, size_t stop) const {
   std::vector<std::string> values;
   const size_t size = Size();
@@ -7,6 +7,7 @@
 #include <string_view>
 #include <vector>
 
+#include "memory/defrag.h"
 #include "memory/listpack.h"
 #include "memory/quicklist.h"
 
@@ -41,6 +42,12 @@ class List {
   bool Trim(size_t start, size_t stop);
   size_t Size() const;
   size_t NodeCount() const;
+  // Heap bytes of the active encoding. With samples, a quicklist measures
+  // only that many nodes and extrapolates the rest.
+  size_t Bytes(size_t samples = 0) const;
+  // Move the listpacks to fresh memory where that packs the heap better.
+  // Returns true if any moved.
+  bool Defrag(in_memory::DefragStats* stats);
   std::vector<std::string> Range(size_t start, size_t stop) const;
   template <typename Visitor>
   bool ForEach(size_t start, size_t stop, Visitor&& visitor) const;
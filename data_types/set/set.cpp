@@ -12,6 +12,8 @@
 #include <utility>
 #include <vector>
 
+#include "memory/random.h"
+#include "memory/used_memory.h"
 #include "utils/int_utils.h"
 #include "utils/string_utils.h"
 
@@ -90,6 +92,77 @@ bool Set::Remove(std::string_view value) {
   throw std::invalid_argument("unknown encoding type");
 }
 
+std::optional<std::string> Set::RandomMember() const {
+  const size_t size = Size();
+  if (size == 0) {
+    return std::nullopt;
+  }
+  if (encoding_ == Encoding::kIntSet) {
+    return std::to_string(
+        intset_->Get(static_cast<unsigned int>(in_memory::RandomIndex(size))));
+  }
+  if (encoding_ == Encoding::kListPack) {
+    const auto idx = listpack_->IndexAt(in_memory::RandomIndex(size));
+    return idx.has_value() ? listpack_->Get(*idx) : std::nullopt;
+  }
+  if (encoding_ == Encoding::kDict) {
+    std::optional<std::string> member;
+    dict_->RandomEntry([&member](std::string_view key, std::nullptr_t) {
+      member.emplace(key);
+    });
+    return member;
+  }
+  throw std::invalid_argument("unknown encoding type");
+}
+
+std::vector<std::string> Set::RandomMembers(size_t count) const {
+  std::vector<std::string> members;
+  const size_t size = Size();
+  if (size == 0 || count == 0) {
+    return members;
+  }
+  if (encoding_ == Encoding::kIntSet) {
+    for (const size_t index : in_memory::SampleIndexes(size, count)) {
+      members.push_back(
+          std::to_string(intset_->Get(static_cast<unsigned int>(index))));
+    }
+    return members;
+  }
+  if (encoding_ == Encoding::kListPack) {
+    // Listpack entries are reached by walking, so collect them in one pass.
+    auto indexes = in_memory::SampleIndexes(size, count);
+    std::sort(indexes.begin(), indexes.end());
+    members.reserve(indexes.size());
+    size_t index = 0;
+    auto next = indexes.begin();
+    listpack_->ForEach(0, size - 1, [&](std::string_view member) {
+      if (index++ == *next) {
+        members.emplace_back(member);
+        ++next;
+      }
+      return next != indexes.end();
+    });
+    return members;
+  }
+  if (encoding_ == Encoding::kDict) {
+    members.reserve(std::min(count, size));
+    dict_->SampleEntries(count, [&members](std::string_view key,
+                                           std::nullptr_t) {
+      members.emplace_back(key);
+    });
+    return members;
+  }
+  throw std::invalid_argument("unknown encoding type");
+}
+
+std::vector<std::string> Set::PopRandomMembers(size_t count) {
+  std::vector<std::string> members = RandomMembers(count);
+  for (const auto& member : members) {
+    Remove(member);
+  }
+  return members;
+}
+
 size_t Set::Size() const {
   switch (encoding_) {
     case Encoding::kIntSet:
@@ -103,6 +176,38 @@ size_t Set::Size() const {
   }
 }
 
+size_t Set::Bytes(size_t samples) const {
+  switch (encoding_) {
+    case Encoding::kIntSet:
+      return intset_ ? in_memory::AllocationBytes(intset_.get()) +
+                           intset_->Bytes()
+                     : 0;
+    case Encoding::kListPack:
+      return listpack_ ? in_memory::AllocationBytes(listpack_.get()) +
+                             listpack_->Bytes()
+                       : 0;
+    case Encoding::kDict:
+      return dict_ ? in_memory::AllocationBytes(dict_.get()) +
+                         dict_->Bytes(samples)
+                   : 0;
+    default:
+      throw std::invalid_argument("unknown encoding type");
+  }
+}
+
+bool Set::Defrag(in_memory::DefragStats* const stats) {
+  switch (encoding_) {
+    case Encoding::kIntSet:
+      return intset_ != nullptr && intset_->Defrag(stats);
+    case Encoding::kListPack:
+      return listpack_ != nullptr && listpack_->Defrag(stats);
+    case Encoding::kDict:
+      return false;
+    default:
+      throw std::invalid_argument("unknown encoding type");
+  }
+}
+
 enum Set::Encoding Set::Encoding() const {
   switch (encoding_) {
     case Encoding::kIntSet:
@@ -156,7 +261,7 @@ bool Set::ListPackAddAndMaybeConvert(std::string_view value) {
 
 bool Set::DictAdd(std::string_view value) {
   if (!dict_) {
-    dict_ = in_memory::Dict<std::string, std::nullptr_t>::Create();
+    dict_ = in_memory::HashTable<std::string, std::nullptr_t>::Create();
   }
   if (dict_->FindValue(value) != nullptr) {
     return false;
@@ -175,13 +280,13 @@ void Set::MaybeConvertIntsetToDict() {
 void Set::ConvertIntSetToDict(size_t capacity) {
   assert(encoding_ == Encoding::kIntSet);
   encoding_ = Encoding::kDict;
-  dict_ = in_memory::Dict<std::string, std::nullptr_t>::Create(capacity);
+  dict_ = in_memory::HashTable<std::string, std::nullptr_t>::Create(capacity);
   if (!intset_) {
     return;
   }
   for (unsigned int i = 0; i < intset_->Size(); ++i) {
     int64_t value = intset_->Get(i);
-    dict_->Set(std::to_string(value), nullptr);
+    dict_->BulkInsert(std::to_string(value), nullptr);
   }
   intset_.reset();
 }
@@ -234,7 +339,7 @@ void Set::ConvertIntSetToListPack(std::string_view val) {
 void Set::ConvertListPackToDict(size_t capacity) {
   assert(encoding_ == Encoding::kListPack);
   encoding_ = Encoding::kDict;
-  dict_ = in_memory::Dict<std::string, std::nullptr_t>::Create(capacity);
+  dict_ = in_memory::HashTable<std::string, std::nullptr_t>::Create(capacity);
   if (!listpack_) {
     return;
   }
@@ -242,7 +347,7 @@ void Set::ConvertListPackToDict(size_t capacity) {
   while (idx.has_value()) {
     auto string_result = listpack_->Get(*idx);
     if (string_result.has_value()) {
-      dict_->Set(std::move(*string_result), nullptr);
+      dict_->BulkInsert(std::move(*string_result), nullptr);
     }
     idx = listpack_->Next(*idx);
   }
@@ -6,13 +6,15 @@
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <system_error>
 #include <vector>
 
-#include "memory/dict.h"
+#include "memory/defrag.h"
+#include "memory/hash_table.h"
 #include "memory/intset.h"
 #include "memory/listpack.h"
 
@@ -34,7 +36,20 @@ class Set {
   template <typename Visitor>
   bool ForEachMember(Visitor&& visitor) const;
   bool Remove(std::string_view value);
+  // A member chosen uniformly at random, or std::nullopt if the set is empty.
+  std::optional<std::string> RandomMember() const;
+  // Up to count distinct members chosen uniformly at random.
+  std::vector<std::string> RandomMembers(size_t count) const;
+  // Remove and return up to count distinct members chosen uniformly at random.
+  std::vector<std::string> PopRandomMembers(size_t count);
   size_t Size() const;
+  // Heap bytes of the active encoding. With samples, a table or skiplist
+  // measures only that many elements and extrapolates the rest.
+  size_t Bytes(size_t samples = 0) const;
+  // Move a compact encoding to fresh memory if that packs the heap better.
+  // Table members live in slab entries and stay put. Returns true if anything
+  // moved.
+  bool Defrag(in_memory::DefragStats* stats);
   Encoding Encoding() const;
 
  private:
@@ -53,7 +68,7 @@ class Set {
   enum Encoding encoding_;
   std::unique_ptr<in_memory::IntSet> intset_;
   std::unique_ptr<in_memory::ListPack> listpack_;
-  std::unique_ptr<in_memory::Dict<std::string, std::nullptr_t>> dict_;
+  std::unique_ptr<in_memory::HashTable<std::string, std::nullptr_t>> dict_;
 };
 
 template <typename Visitor>
@@ -83,8 +98,8 @@ bool Set::ForEachMember(Visitor&& visitor) const {
     return listpack_->ForEach(0, size - 1, visitor);
   }
   if (encoding_ == Encoding::kDict) {
-    auto it =
-        in_memory::Dict<std::string, std::nullptr_t>::Iterator(dict_.get());
+    auto it = in_memory::HashTable<std::string, std::nullptr_t>::Iterator(
+        dict_.get());
     it.SeekToFirst();
     while (it.Valid()) {
       if (!visitor(it.Key())) {
@@ -2,8 +2,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace redis_simple::set {
@@ -128,4 +131,57 @@ TEST(SetTest, RemoveMembersFromEachEncoding) {
   ASSERT_FALSE(dict->HasMember("member"));
   ASSERT_FALSE(dict->Remove("member"));
 }
+
+namespace {
+// Members "0".."count-1", plus extra when it is not empty.
+std::unique_ptr<Set> MakeSet(int count, std::string_view extra = {}) {
+  auto set = Set::Create();
+  for (int i = 0; i < count; ++i) {
+    set->Add(std::to_string(i));
+  }
+  if (!extra.empty()) {
+    set->Add(extra);
+  }
+  return set;
+}
+}  // namespace
+
+TEST(SetTest, RandomMembersFromEachEncoding) {
+  std::vector<std::unique_ptr<Set>> sets;
+  sets.push_back(MakeSet(50));
+  sets.push_back(MakeSet(50, "member"));
+  sets.push_back(MakeSet(50, std::string(65, 'x')));
+  const std::vector<enum Set::Encoding> encodings = {
+      Set::Encoding::kIntSet, Set::Encoding::kListPack, Set::Encoding::kDict};
+  for (size_t i = 0; i < sets.size(); ++i) {
+    const auto& set = sets[i];
+    ASSERT_EQ(set->Encoding(), encodings[i]);
+    const auto member = set->RandomMember();
+    ASSERT_TRUE(member.has_value());
+    EXPECT_TRUE(set->HasMember(*member));
+    for (const size_t count : {size_t{3}, size_t{30}, size_t{100}}) {
+      const auto members = set->RandomMembers(count);
+      EXPECT_EQ(members.size(), std::min(count, set->Size()));
+      const std::set<std::string> distinct(members.begin(), members.end());
+      EXPECT_EQ(distinct.size(), members.size());
+      for (const auto& sampled : members) {
+        EXPECT_TRUE(set->HasMember(sampled)) << sampled;
+      }
+    }
+  }
+  EXPECT_FALSE(Set::Create()->RandomMember().has_value());
+  EXPECT_TRUE(Set::Create()->RandomMembers(3).empty());
+}
+
+TEST(SetTest, PopRandomMembersRemovesThem) {
+  auto set = MakeSet(50, "member");
+  const auto popped = set->PopRandomMembers(20);
+  ASSERT_EQ(popped.size(), 20);
+  EXPECT_EQ(set->Size(), 31);
+  for (const auto& member : popped) {
+    EXPECT_FALSE(set->HasMember(member)) << member;
+  }
+  EXPECT_EQ(set->PopRandomMembers(100).size(), 31);
+  EXPECT_EQ(set->Size(), 0);
+}
 }  // namespace redis_simple::set
@@ -1,5 +1,6 @@
 #include "zset.h"
 
+#include <cassert>
 #include <cmath>
 #include <memory>
 #include <optional>
@@ -8,6 +9,7 @@
 
 #include "data_types/zset/zset_listpack.h"
 #include "data_types/zset/zset_skiplist.h"
+#include "memory/used_memory.h"
 
 namespace redis_simple::zset {
 ZSet::ZSet()
@@ -62,6 +64,10 @@ bool ZSet::ForEachEntry(const ZSetEntryVisitor& visitor) const {
   return storage_->ForEachEntry(visitor);
 }
 
+size_t ZSet::Bytes(size_t samples) const {
+  return in_memory::AllocationBytes(storage_.get()) + storage_->Bytes(samples);
+}
+
 enum ZSet::Encoding ZSet::Encoding() const { return encoding_; }
 
 bool ZSet::ShouldConvertToSkiplist(std::string_view key, bool inserted) const {
@@ -30,6 +30,12 @@ class ZSet {
   size_t Count(const RangeByScoreSpec* spec) const;
   bool ForEachEntry(const ZSetEntryVisitor& visitor) const;
   size_t Size() const { return storage_->Size(); }
+  // Heap bytes of the storage. With samples, a skiplist measures only that
+  // many keys and extrapolates the rest.
+  size_t Bytes(size_t samples = 0) const;
+  // Move a listpack encoding to fresh memory if that packs the heap better.
+  // Returns true if it moved.
+  bool Defrag(in_memory::DefragStats* stats) { return storage_->Defrag(stats); }
   Encoding Encoding() const;
 
  private:
@@ -3,9 +3,12 @@
 #include <string>
 #include <string_view>
 
+#include "memory/slab_allocator.h"
+
 namespace redis_simple::zset {
 // Entry storing key and score
-struct ZSetEntry {
+struct ZSetEntry
+    : in_memory::SlabAllocated<in_memory::SlabTag::kZSetEntry> {
   ZSetEntry(const std::string& key, double score) : key(key), score(score) {}
   ZSetEntry(std::string_view key, double score)
       : key(key.data(), key.size()), score(score) {}
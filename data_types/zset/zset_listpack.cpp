@@ -10,6 +10,7 @@
 #include <string_view>
 
 #include "memory/listpack.h"
+#include "memory/used_memory.h"
 #include "utils/float_utils.h"
 
 namespace redis_simple::zset {
@@ -124,6 +125,16 @@ ZSetEntryList ZSetListPack::RangeByScore(const RangeByScoreSpec* spec) const {
   return spec->reverse ? RevRangeByScoreUtil(spec) : RangeByScoreUtil(spec);
 }
 
+size_t ZSetListPack::Bytes(size_t /*samples*/) const {
+  size_t bytes = in_memory::AllocationBytes(listpack_.get()) +
+                 listpack_->Bytes() +
+                 in_memory::AllocationBytes(range_cache_.data());
+  for (const auto& entry : range_cache_) {
+    bytes += in_memory::StringBytes(entry.key);
+  }
+  return bytes;
+}
+
 size_t ZSetListPack::Count(const RangeByScoreSpec* spec) const {
   if (!ValidateRangeScoreSpec(spec)) {
     return 0;
@@ -26,6 +26,10 @@ class ZSetListPack : public ZSetStorage {
     // divided by 2.
     return listpack_->Size() / 2;
   };
+  size_t Bytes(size_t samples) const override;
+  bool Defrag(in_memory::DefragStats* stats) override {
+    return listpack_->Defrag(stats);
+  }
 
  private:
   struct EntryView {
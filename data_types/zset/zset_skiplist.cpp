@@ -8,9 +8,11 @@
 #include <string>
 #include <string_view>
 
+#include "memory/used_memory.h"
+
 namespace redis_simple::zset {
 ZSetSkiplist::ZSetSkiplist()
-    : dict_(in_memory::Dict<std::string, double>::Create()),
+    : dict_(ScoreDict::Create()),
       skiplist_(std::make_unique<SkiplistType>(in_memory::kInitSkiplistLevel,
                                                Comparator(), Destructor())) {}
 
@@ -120,6 +122,20 @@ bool ZSetSkiplist::ForEachEntry(const ZSetEntryVisitor& visitor) const {
   return true;
 }
 
+size_t ZSetSkiplist::Bytes(size_t samples) const {
+  const auto entry_bytes = [](const ZSetEntry* entry) {
+    return entry == nullptr
+               ? 0
+               : in_memory::SlabAllocationBytes(entry, sizeof(ZSetEntry)) +
+                     in_memory::StringBytes(entry->key);
+  };
+  return in_memory::AllocationBytes(dict_.get()) + dict_->Bytes(samples) +
+         in_memory::AllocationBytes(skiplist_.get()) +
+         skiplist_->Bytes(samples, entry_bytes) +
+         (min_key_ ? in_memory::StringBytes(*min_key_) : 0) +
+         (max_key_ ? in_memory::StringBytes(*max_key_) : 0);
+}
+
 ZSetSkiplist::RankSpecPtr ZSetSkiplist::ToSkiplistRangeByRankSpec(
     const RangeByRankSpec* spec) const {
   if (spec == nullptr) {
@@ -172,7 +188,7 @@ ZSetSkiplist::KeySpecPtr ZSetSkiplist::ToSkiplistRangeByKeySpec(
 void ZSetSkiplist::RecomputeMinMaxKeys() {
   min_key_.reset();
   max_key_.reset();
-  auto it = in_memory::Dict<std::string, double>::Iterator(dict_.get());
+  auto it = ScoreDict::Iterator(dict_.get());
   it.SeekToFirst();
   while (it.Valid()) {
     const std::string& key = it.Key();
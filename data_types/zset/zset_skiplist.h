@@ -27,6 +27,10 @@ class ZSetSkiplist : public ZSetStorage {
   size_t Count(const RangeByScoreSpec* spec) const override;
   bool ForEachEntry(const ZSetEntryVisitor& visitor) const override;
   size_t Size() const override { return skiplist_->Size(); }
+  size_t Bytes(size_t samples) const override;
+  // Entries and nodes live in slab memory, which is never handed back, and
+  // member names are left with them.
+  bool Defrag(in_memory::DefragStats* /*stats*/) override { return false; }
 
  private:
   struct Comparator {
@@ -51,6 +55,9 @@ class ZSetSkiplist : public ZSetStorage {
     }
   };
 
+  using ScoreDict =
+      in_memory::Dict<std::string, double,
+                      in_memory::DefaultDictPolicy<std::string, double>>;
   using SkiplistType =
       in_memory::Skiplist<const ZSetEntry*, Comparator, Destructor>;
   using SkiplistLimitSpec = SkiplistType::SkiplistLimitSpec;
@@ -69,7 +76,7 @@ class ZSetSkiplist : public ZSetStorage {
   KeySpecPtr ToSkiplistRangeByKeySpec(const RangeByScoreSpec* spec) const;
   void RecomputeMinMaxKeys();
   // Dict mapping key to score, used with the skiplist
-  std::unique_ptr<in_memory::Dict<std::string, double>> dict_;
+  std::unique_ptr<ScoreDict> dict_;
   // Skiplist storing key score pairs ordered by score
   std::unique_ptr<SkiplistType> skiplist_;
   // Min and max key value, used for RangeByScore
@@ -10,6 +10,7 @@
 
 #include "data_types/zset/zset_entry.h"
 #include "data_types/zset/zset_range_spec.h"
+#include "memory/defrag.h"
 
 namespace redis_simple::zset {
 using ZSetEntryList = std::vector<const ZSetEntry*>;
@@ -37,6 +38,12 @@ class ZSetStorage {
   virtual bool ForEachEntry(const ZSetEntryVisitor& visitor) const = 0;
   // Return the total number of keys.
   virtual size_t Size() const = 0;
+  // Return the heap bytes held by the storage. With samples, only that many
+  // keys are measured and the rest are extrapolated.
+  virtual size_t Bytes(size_t samples) const = 0;
+  // Move heap blocks to fresh memory where that packs the heap better. Return
+  // true if any moved.
+  virtual bool Defrag(in_memory::DefragStats* stats) = 0;
   virtual ~ZSetStorage() = default;
 };
 }  // namespace redis_simple::zset
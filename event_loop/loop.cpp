@@ -205,14 +205,19 @@ void Loop::Defer(std::function<void()> callback) {
 }
 
 void Loop::ProcessEvents() {
-  ProcessFileEvents();
+  if (before_sleep_) {
+    before_sleep_();
+  }
+  timespec timeout_spec = PollTimeout();
+  const auto& ready_events = event_poller_->Poll(&timeout_spec);
+  // Callbacks of this iteration share the time the poll returned.
+  const utils::CachedClockScope cached_clock;
+  ProcessFileEvents(ready_events);
   ProcessDeferredCallbacks();
   ProcessTimeEvents();
 }
 
-void Loop::ProcessFileEvents() {
-  timespec timeout_spec = PollTimeout();
-  const auto& ready_events = event_poller_->Poll(&timeout_spec);
+void Loop::ProcessFileEvents(const std::vector<ReadyEvent>& ready_events) {
   processing_file_events_ = true;
   for (const auto& ready_event : ready_events) {
     const int fd = ready_event.fd;
@@ -277,7 +282,7 @@ timespec Loop::PollTimeout() const {
   if (!deferred_callbacks_.empty()) {
     timeout_ms = 0;
   } else {
-    const int64_t now = utils::NowInMilliseconds();
+    const int64_t now = utils::MonotonicNowInMilliseconds();
     for (const auto& event : time_events_) {
       if (event->Id() == ToInt(EventFlag::kDeleteEventId) ||
           event->When() <= now) {
@@ -305,15 +310,14 @@ void Loop::ProcessTimeEvents() {
       }
       it = time_events_.erase(it);
     } else {
-      int64_t now = utils::NowInMilliseconds();
+      int64_t now = utils::MonotonicNowInMilliseconds();
       if (time_event->When() <= now) {
         int ret = time_event->CallTimeCallback();
         if (ret < 0) {
           // Defer deletion so unlinking and finalization happen in one path.
           time_event->SetId(ToInt(EventFlag::kDeleteEventId));
         } else {
-          time_event->SetWhen(
-              now + (static_cast<int64_t>(ret) * kMillisecondsPerSecond));
+          time_event->SetWhen(now + static_cast<int64_t>(ret));
         }
       }
       ++it;
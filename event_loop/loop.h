@@ -6,6 +6,7 @@
 #include <functional>
 #include <list>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "event_loop/event_poller.h"
@@ -70,13 +71,17 @@ class Loop {
   }
   void CreateTimeEvent(std::unique_ptr<TimeEvent> time_event);
   void Defer(std::function<void()> callback);
+  // Run callback at the start of every iteration, before polling for events.
+  void SetBeforeSleep(std::function<void()> callback) {
+    before_sleep_ = std::move(callback);
+  }
   void ProcessEvents();
   ~Loop() = default;
 
  private:
   static constexpr int kMaxReadyEvents = 1024;
   explicit Loop(std::unique_ptr<EventPoller> event_poller);
-  void ProcessFileEvents();
+  void ProcessFileEvents(const std::vector<ReadyEvent>& ready_events);
   void ProcessTimeEvents();
   void ProcessDeferredCallbacks();
   timespec PollTimeout() const;
@@ -85,6 +90,7 @@ class Loop {
   std::list<std::unique_ptr<TimeEvent>> time_events_;
   std::vector<std::function<void()>> deferred_callbacks_;
   std::vector<std::function<void()>> running_deferred_callbacks_;
+  std::function<void()> before_sleep_;
   std::unique_ptr<EventPoller> event_poller_;
   bool processing_file_events_{false};
   bool stop_requested_{false};
@@ -11,6 +11,8 @@
 #include <utility>
 #include <vector>
 
+#include "utils/time_utils.h"
+
 namespace redis_simple::event_loop {
 namespace {
 class ScopedFd {
@@ -154,6 +156,33 @@ TEST(LoopTest, TimeEventRunsAndFinalizes) {
   EXPECT_EQ(finalize_count, 1);
 }
 
+TEST(LoopTest, TimeEventReschedulesInMillisecondsAfterBeforeSleep) {
+  auto loop = Loop::Create();
+  ASSERT_NE(loop, nullptr);
+
+  std::vector<int> order;
+  loop->SetBeforeSleep([&order] { order.push_back(0); });
+  auto time_event = TimeEvent::Create(
+      [&order](int64_t) {
+        order.push_back(1);
+        return 20;
+      },
+      nullptr);
+  const TimeEvent* const event = time_event.get();
+  loop->CreateTimeEvent(std::move(time_event));
+
+  const int64_t before = utils::MonotonicNowInMilliseconds();
+  loop->ProcessEvents();
+  EXPECT_EQ(order, std::vector<int>({0, 1}));
+  EXPECT_GE(event->When(), before + 20);
+  EXPECT_LT(event->When(), before + 1000);
+
+  // The poll waits for the timer instead of its default timeout.
+  loop->ProcessEvents();
+  EXPECT_EQ(order, std::vector<int>({0, 1, 0, 1}));
+  EXPECT_GE(utils::MonotonicNowInMilliseconds(), before + 20);
+}
+
 TEST(LoopTest, TimeEventRequiresCallback) {
   EXPECT_EQ(TimeEvent::Create(nullptr, nullptr), nullptr);
 }
@@ -6,6 +6,9 @@
 #include <utility>
 
 namespace redis_simple::event_loop {
+// The time callback returns the milliseconds until it runs again, or a
+// negative value such as EventFlag::kNoMore to delete the event. When() is on
+// the monotonic clock of utils::MonotonicNowInMilliseconds().
 class TimeEvent {
  public:
   using TimeCallback = std::function<int(int64_t)>;
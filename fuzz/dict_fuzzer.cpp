@@ -7,15 +7,16 @@
 
 #include "fuzz/fuzz_input.h"
 #include "memory/dict.h"
+#include "memory/flat_dict.h"
 
 namespace redis_simple::fuzz {
 namespace {
-using StringDict = in_memory::Dict<std::string, std::string>;
 using DictModel = std::unordered_map<std::string, std::string>;
 
+template <typename StringDict>
 DictModel ReadWithIterator(const StringDict& dict) {
   DictModel values;
-  auto it = StringDict::Iterator(&dict);
+  auto it = typename StringDict::Iterator(&dict);
   it.SeekToFirst();
   while (it.Valid()) {
     Require(values.emplace(it.Key(), it.Value()).second);
@@ -24,6 +25,7 @@ DictModel ReadWithIterator(const StringDict& dict) {
   return values;
 }
 
+template <typename StringDict>
 DictModel ReadWithScan(StringDict* dict) {
   DictModel values;
   std::optional<size_t> cursor = 0;
@@ -36,6 +38,7 @@ DictModel ReadWithScan(StringDict* dict) {
   return values;
 }
 
+template <typename StringDict>
 void Verify(StringDict* dict, const DictModel& model) {
   Require(dict->Size() == model.size());
   for (const auto& [key, value] : model) {
@@ -45,6 +48,7 @@ void Verify(StringDict* dict, const DictModel& model) {
   Require(ReadWithIterator(*dict) == model);
 }
 
+template <typename StringDict>
 void RunOperations(FuzzInput* input) {
   auto dict = StringDict::Create(input->ReadIndex(8) + 1);
   Require(dict != nullptr);
@@ -102,7 +106,17 @@ void RunOperations(FuzzInput* input) {
 }  // namespace redis_simple::fuzz
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-  redis_simple::fuzz::FuzzInput input(data, size);
-  redis_simple::fuzz::RunOperations(&input);
+  redis_simple::fuzz::FuzzInput chained_input(data, size);
+  redis_simple::fuzz::RunOperations<
+      redis_simple::in_memory::Dict<std::string, std::string>>(&chained_input);
+  redis_simple::fuzz::FuzzInput policy_input(data, size);
+  redis_simple::fuzz::RunOperations<redis_simple::in_memory::Dict<
+      std::string, std::string,
+      redis_simple::in_memory::DefaultDictPolicy<std::string, std::string>>>(
+      &policy_input);
+  redis_simple::fuzz::FuzzInput flat_input(data, size);
+  redis_simple::fuzz::RunOperations<
+      redis_simple::in_memory::FlatDict<std::string, std::string>>(
+      &flat_input);
   return 0;
 }
@@ -69,6 +69,22 @@ int Run() {
     RS_LOG_DEBUG("unexpected persistence info: %s\n", persistence_info.c_str());
     return EXIT_FAILURE;
   }
+  cli.AddCommand(std::vector<std::string_view>{"INFO", "stats"});
+  const std::string stats_info = cli.ReadReply();
+  if (stats_info.find("active_rehash_max_stall_us:") == std::string::npos ||
+      stats_info.find("keyspace_rehashing:") == std::string::npos ||
+      stats_info.find("aof_enabled") != std::string::npos) {
+    RS_LOG_DEBUG("unexpected stats info: %s\n", stats_info.c_str());
+    return EXIT_FAILURE;
+  }
+  cli.AddCommand(std::vector<std::string_view>{"INFO", "memory"});
+  const std::string memory_info = cli.ReadReply();
+  if (memory_info.find("slab_fragmentation_perc:") == std::string::npos ||
+      memory_info.find("redis_object_bytes:") == std::string::npos ||
+      memory_info.find("active_rehash") != std::string::npos) {
+    RS_LOG_DEBUG("unexpected memory info: %s\n", memory_info.c_str());
+    return EXIT_FAILURE;
+  }
   if (!ExpectReply(&cli, {"QUIT"}, "OK\n")) {
     return EXIT_FAILURE;
   }
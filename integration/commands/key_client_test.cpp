@@ -193,6 +193,17 @@ int Run() {
   if (!ExpectReply(&cli, {"DBSIZE\r\n", "0\n"})) {
     return EXIT_FAILURE;
   }
+  const std::vector<Case> random_key_cases = {
+      {"RANDOMKEY\r\n", "(nil)\n"},
+      {"SET random_key value\r\n", "OK\n"},
+      {"RANDOMKEY\r\n", "random_key\n"},
+      {"DEL random_key\r\n", "1\n"},
+  };
+  for (const Case& test_case : random_key_cases) {
+    if (!ExpectReply(&cli, test_case)) {
+      return EXIT_FAILURE;
+    }
+  }
   return EXIT_SUCCESS;
 }
 }  // namespace redis_simple
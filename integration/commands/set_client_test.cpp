@@ -170,6 +170,35 @@ int Run() {
     return EXIT_FAILURE;
   }
 
+  const std::vector<Case> random_cases = {
+      {"SADD integration_random_set only\r\n", "1\n"},
+      {"SRANDMEMBER integration_random_set\r\n", "only\n"},
+      {"SRANDMEMBER integration_random_set -3\r\n",
+       "only\nonly\nonly\n\n\n"},
+      {"SRANDMEMBER missing_set\r\n", "(nil)\n"},
+      {"SRANDMEMBER integration_random_set nope\r\n",
+       "ERR value is not an integer or out of range\n"},
+      {"SPOP integration_random_set\r\n", "only\n"},
+      {"SCARD integration_random_set\r\n", "0\n"},
+      {"SPOP missing_set\r\n", "(nil)\n"},
+      {"SPOP integration_set -1\r\n",
+       "ERR value is out of range, must be positive\n"},
+  };
+  for (const Case& test_case : random_cases) {
+    if (!ExpectReply(&cli, test_case)) {
+      return EXIT_FAILURE;
+    }
+  }
+  if (!ExpectMembers(&cli, "SRANDMEMBER integration_set 10\r\n",
+                     {"ele2", "ele3", "ele4"})) {
+    return EXIT_FAILURE;
+  }
+  if (!ExpectMembers(&cli, "SPOP integration_set_c 5\r\n",
+                     {"ele3", "ele4"}) ||
+      !ExpectReply(&cli, {"SCARD integration_set_c\r\n", "0\n"})) {
+    return EXIT_FAILURE;
+  }
+
   cli.AddCommand(std::vector<std::string_view>{"HELLO", "3"});
   if (cli.ReadReply().find("proto\n3\n") == std::string::npos) {
     RS_LOG_DEBUG("failed to negotiate RESP3\n");
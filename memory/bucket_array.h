@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "memory/used_memory.h"
+
+namespace redis_simple::in_memory {
+/*
+ * Fixed-size array of zero-initialized buckets allocated with calloc. Large
+ * requests are served from fresh anonymous mappings that the kernel zeroes
+ * lazily on first touch, so creating a multi-gigabyte hash table does not
+ * memset it on the event loop the way std::vector::resize would. The arrays
+ * bypass operator new, so they add themselves to UsedMemory().
+ */
+template <typename T>
+class BucketArray {
+ public:
+  static_assert(std::is_trivial<T>::value,
+                "buckets must be valid when all bytes are zero");
+  BucketArray() = default;
+  BucketArray(BucketArray&& other) noexcept
+      : data_(std::move(other.data_)), size_(std::exchange(other.size_, 0)) {}
+  BucketArray& operator=(BucketArray&& other) noexcept {
+    data_ = std::move(other.data_);
+    size_ = std::exchange(other.size_, 0);
+    return *this;
+  }
+  size_t Size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+  // Heap bytes of the array.
+  size_t Bytes() const { return AllocationBytes(data_.get()); }
+  T& operator[](size_t index) { return data_[index]; }
+  const T& operator[](size_t index) const { return data_[index]; }
+  // Replace the contents with size zeroed buckets. Throws std::bad_alloc if
+  // the allocation fails.
+  void Reset(size_t size) {
+    if (size == 0) {
+      Clear();
+      return;
+    }
+    T* const data = static_cast<T*>(std::calloc(size, sizeof(T)));
+    if (data == nullptr) {
+      throw std::bad_alloc();
+    }
+    AddUsedMemory(static_cast<int64_t>(AllocationBytes(data)));
+    data_.reset(data);
+    size_ = size;
+  }
+  void Clear() {
+    data_.reset();
+    size_ = 0;
+  }
+
+ private:
+  struct FreeDeleter {
+    void operator()(T* data) const {
+      AddUsedMemory(-static_cast<int64_t>(AllocationBytes(data)));
+      std::free(data);
+    }
+  };
+  std::unique_ptr<T[], FreeDeleter> data_;
+  size_t size_{};
+};
+}  // namespace redis_simple::in_memory
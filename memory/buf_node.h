@@ -6,8 +6,10 @@
 #include <string>
 #include <utility>
 
+#include "memory/slab_allocator.h"
+
 namespace redis_simple::in_memory {
-class BufNode {
+class BufNode : public SlabAllocated<SlabTag::kBufNode> {
  public:
   static std::unique_ptr<BufNode> Create(size_t len) {
     return std::unique_ptr<BufNode>(
@@ -0,0 +1,53 @@
+#include "memory/defrag.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace redis_simple::in_memory {
+HeapStats HeapMemoryStats() {
+  HeapStats stats;
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+  const struct mallinfo2 info = mallinfo2();
+  stats.heap_bytes = info.arena;
+  stats.free_bytes = info.fordblks;
+#endif
+  return stats;
+}
+
+bool ReleaseFreeHeap() {
+#if defined(__GLIBC__)
+  return malloc_trim(0) != 0;
+#else
+  return false;
+#endif
+}
+
+bool IsBetterPlaced(const void* const fresh, const void* const current,
+                    DefragStats* const stats) {
+  if (std::less<const void*>()(fresh, current)) {
+    ++stats->hits;
+    return true;
+  }
+  ++stats->misses;
+  return false;
+}
+
+bool DefragString(std::string* const value, DefragStats* const stats) {
+  if (StringBytes(*value) == 0 || value->size() >= kMaxDefragBytes) {
+    return false;
+  }
+  std::string fresh(*value);
+  if (!IsBetterPlaced(fresh.data(), value->data(), stats)) {
+    return false;
+  }
+  *value = std::move(fresh);
+  stats->bytes_moved += StringBytes(*value);
+  return true;
+}
+}  // namespace redis_simple::in_memory
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "memory/used_memory.h"
+
+namespace redis_simple::in_memory {
+struct HeapStats {
+  // Bytes malloc holds from the system outside of mmapped blocks.
+  size_t heap_bytes{};
+  // Bytes of that held in free chunks, which only moving the blocks around
+  // them can give back.
+  size_t free_bytes{};
+};
+
+// malloc arena totals, or zeros where the allocator does not report them.
+HeapStats HeapMemoryStats();
+// Return free heap pages to the system. Returns true if any were released.
+bool ReleaseFreeHeap();
+
+struct DefragStats {
+  // Blocks moved to fresh memory, and blocks examined but left in place.
+  uint64_t hits{};
+  uint64_t misses{};
+  uint64_t bytes_moved{};
+};
+
+/*
+ * glibc malloc cannot tell whether a block sits in a sparsely used region, so
+ * a block is moved when a fresh allocation of its size lands at a lower
+ * address: the copy fills a hole, and the space it leaves merges toward the
+ * top of the heap where ReleaseFreeHeap() can return it. Blocks of
+ * kMaxDefragBytes or more are left in place: they cost more to copy, and the
+ * largest have mappings of their own.
+ */
+inline constexpr size_t kMaxDefragBytes = size_t{64} * 1024;
+
+// Whether fresh, a new block, is better placed than current, counting a hit
+// or a miss in stats.
+bool IsBetterPlaced(const void* fresh, const void* current,
+                    DefragStats* stats);
+
+// Move the count elements of buffer to fresh memory if that packs the heap
+// better. Returns true if the buffer moved.
+template <typename T>
+bool DefragBuffer(std::unique_ptr<T[]>* const buffer, size_t count,
+                  DefragStats* const stats) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "only plain byte buffers can be moved");
+  const size_t bytes = count * sizeof(T);
+  if (*buffer == nullptr || bytes == 0 || bytes >= kMaxDefragBytes) {
+    return false;
+  }
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays): mirrors the buffer type
+  std::unique_ptr<T[]> fresh(new T[count]);
+  if (!IsBetterPlaced(fresh.get(), buffer->get(), stats)) {
+    return false;
+  }
+  std::memcpy(fresh.get(), buffer->get(), bytes);
+  *buffer = std::move(fresh);
+  stats->bytes_moved += AllocationBytes(buffer->get());
+  return true;
+}
+
+// Move the heap buffer of value, if it has one, as DefragBuffer() does. Spare
+// capacity is dropped either way it moves.
+bool DefragString(std::string* value, DefragStats* stats);
+}  // namespace redis_simple::in_memory
@@ -0,0 +1,74 @@
+#include "memory/defrag.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "memory/listpack.h"
+
+namespace redis_simple::in_memory {
+TEST(DefragTest, BufferKeepsContent) {
+  constexpr size_t kCount = 256;
+  auto buffer = std::make_unique<uint8_t[]>(kCount);
+  for (size_t index = 0; index < kCount; ++index) {
+    buffer[index] = static_cast<uint8_t>(index);
+  }
+  DefragStats stats;
+  const bool moved = DefragBuffer(&buffer, kCount, &stats);
+  EXPECT_EQ(stats.hits + stats.misses, 1);
+  EXPECT_EQ(stats.hits, moved ? 1 : 0);
+  EXPECT_EQ(stats.bytes_moved > 0, moved);
+  for (size_t index = 0; index < kCount; ++index) {
+    ASSERT_EQ(buffer[index], static_cast<uint8_t>(index));
+  }
+}
+
+TEST(DefragTest, SkipsLargeBuffers) {
+  auto buffer = std::make_unique<uint8_t[]>(kMaxDefragBytes);
+  const uint8_t* const before = buffer.get();
+  DefragStats stats;
+  EXPECT_FALSE(DefragBuffer(&buffer, kMaxDefragBytes, &stats));
+  EXPECT_EQ(buffer.get(), before);
+  EXPECT_EQ(stats.hits + stats.misses, 0);
+}
+
+TEST(DefragTest, StringKeepsContent) {
+  std::string value(200, 'v');
+  value.reserve(1000);
+  DefragStats stats;
+  const bool moved = DefragString(&value, &stats);
+  EXPECT_EQ(stats.hits + stats.misses, 1);
+  EXPECT_EQ(value, std::string(200, 'v'));
+  if (moved) {
+    EXPECT_LT(value.capacity(), 1000);
+  }
+}
+
+TEST(DefragTest, SkipsInlineStrings) {
+  std::string value = "short";
+  DefragStats stats;
+  EXPECT_FALSE(DefragString(&value, &stats));
+  EXPECT_EQ(value, "short");
+  EXPECT_EQ(stats.hits + stats.misses, 0);
+}
+
+TEST(DefragTest, ListPackKeepsEntries) {
+  auto lp = std::make_unique<ListPack>();
+  for (int index = 0; index < 100; ++index) {
+    lp->Append("entry:" + std::to_string(index));
+  }
+  DefragStats stats;
+  lp->Defrag(&stats);
+  EXPECT_EQ(stats.hits + stats.misses, 1);
+  ASSERT_EQ(lp->Size(), 100);
+  auto position = lp->First();
+  for (int index = 0; index < 100; ++index) {
+    ASSERT_TRUE(position.has_value());
+    EXPECT_EQ(lp->Get(*position), "entry:" + std::to_string(index));
+    position = lp->Next(*position);
+  }
+}
+}  // namespace redis_simple::in_memory
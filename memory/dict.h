@@ -2,38 +2,58 @@
 
 #include <algorithm>
 #include <array>
-#include <cassert>
 #include <cstddef>
-#include <functional>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <new>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <type_traits>
 #include <utility>
-#include <vector>
+
+#include "memory/bucket_array.h"
+#include "memory/dict_policy.h"
+#include "memory/prefetch.h"
+#include "memory/random.h"
+#include "memory/scan_cursor.h"
+#include "memory/slab_allocator.h"
+#include "memory/used_memory.h"
 
 namespace redis_simple::in_memory {
-template <typename K, typename V>
+/*
+ * Chained hash table with incremental rehashing. Hashing, key comparison and
+ * the dup/destructor hooks come from Policy (see memory/dict_policy.h); the
+ * default DictTypePolicy reads them from a runtime DictType, while stateless
+ * policies such as DefaultDictPolicy are inlined into every lookup.
+ */
+template <typename K, typename V, typename Policy = DictTypePolicy<K, V>>
 class Dict {
  public:
   class Iterator;
-  struct DictType;
-  static std::unique_ptr<Dict<K, V>> Create();
-  static std::unique_ptr<Dict<K, V>> Create(size_t capacity);
-  static std::unique_ptr<Dict<K, V>> Create(const DictType& type);
+  using DictType = in_memory::DictType<K, V>;
+  // Keys embedded in the entry are exposed as views of the stored bytes.
+  using KeyView = std::conditional_t<PolicyEmbedsKey<Policy>::value,
+                                     std::string_view, const K&>;
+  static std::unique_ptr<Dict<K, V, Policy>> Create();
+  static std::unique_ptr<Dict<K, V, Policy>> Create(size_t capacity);
+  static std::unique_ptr<Dict<K, V, Policy>> Create(const DictType& type);
   Dict(const Dict&) = delete;
   Dict& operator=(const Dict&) = delete;
   std::optional<V> Get(const K& key);
   V* FindValue(const K& key);
   V* FindValue(std::string_view key);
   V* FindValue(const char* key);
+  void FindMany(const std::string_view* keys, size_t count, V** values);
+  void PrefetchKey(std::string_view key) const;
+  void PrefetchBuckets(size_t hash) const;
   void Set(const K& key, const V& val);
   void Set(const K& key, V&& val);
   void Set(K&& key, V&& val);
   bool Insert(const K& key, const V& val);
   bool Insert(K&& key, V&& val);
+  void BulkInsert(K&& key, V&& val);
   bool Delete(const K& key);
   bool Delete(std::string_view key);
   bool Delete(const char* key) { return Delete(std::string_view(key)); }
@@ -42,21 +62,54 @@ class Dict {
   std::optional<V> Extract(const char* key) {
     return Extract(std::string_view(key));
   }
+  // Variants for callers that already hashed key, e.g. to pick a shard. hash
+  // must be what the policy returns for key.
+  V* FindValue(std::string_view key, size_t hash);
+  // The key as stored in the dict, or std::nullopt if it is absent.
+  std::optional<std::string_view> FindKey(std::string_view key, size_t hash);
+  void Set(K&& key, V&& val, size_t hash);
+  bool Delete(std::string_view key, size_t hash);
+  std::optional<V> Extract(std::string_view key, size_t hash);
   template <typename Visitor>
   std::optional<size_t> Scan(size_t cursor, Visitor&& visitor);
+  template <typename Visitor>
+  bool RandomEntry(Visitor&& visitor);
+  // Visit up to count distinct entries chosen uniformly at random.
+  template <typename Visitor>
+  size_t SampleEntries(size_t count, Visitor&& visitor) {
+    return SampleDistinctEntries(this, count, std::forward<Visitor>(visitor));
+  }
   size_t Size() const { return table_used_[0] + table_used_[1]; }
+  bool IsRehashing() const { return rehash_idx_.has_value(); }
+  // Buckets in table 0 and, while rehashing, the next one to migrate.
+  size_t BucketCount() const { return tables_[0].Size(); }
+  std::optional<size_t> RehashIndex() const { return rehash_idx_; }
+  // Heap bytes of the tables and entries, including what keys and values own.
+  // With samples, only that many entries are measured and the rest are taken
+  // to be of the same average size.
+  size_t Bytes(size_t samples = 0) const;
+  bool Reserve(size_t size);
+  bool ShrinkIfNeeded();
+  bool Rehash(int n);
   void Clear();
   ~Dict();
 
  private:
-  struct DictEntry;
+  struct NodeEntry;
+  struct EmbeddedKeyEntry;
+  static constexpr bool kEmbedKey = PolicyEmbedsKey<Policy>::value;
+  static_assert(!kEmbedKey || std::is_same<K, std::string>::value,
+                "only std::string keys can be embedded in dict entries");
+  using DictEntry =
+      std::conditional_t<kEmbedKey, EmbeddedKeyEntry, NodeEntry>;
   Dict();
-  Dict(const DictType& type);
+  explicit Dict(const Policy& policy);
   void InitializeTables();
   void InitializeTableWithSize(int i, int exp, size_t size);
   void InsertEntry(DictEntry* entry, int i);
   DictEntry* Unlink(const K& key);
   DictEntry* Unlink(std::string_view key);
+  DictEntry* Unlink(std::string_view key, size_t hash);
   void UnlinkEntry(DictEntry* entry, DictEntry* prev, int i);
   void DeleteEntry(DictEntry* entry, DictEntry* prev, int i);
   size_t TableSize(int exp) const {
@@ -64,7 +117,6 @@ class Dict {
                ? 0
                : size_t{1} << exp;
   }
-  bool IsRehashing() const { return rehash_idx_.has_value(); }
   void PauseRehashing() { ++pause_rehash_; }
   void ResumeRehashing() {
     if (pause_rehash_ > 0) {
@@ -76,8 +128,13 @@ class Dict {
   size_t KeyHash(const K& key) const;
   size_t StringViewKeyHash(std::string_view key) const;
   int NextExp(size_t size) const;
-  bool IsEqual(const K& key1, const K& key2) const;
-  bool IsEqual(std::string_view key1, const K& key2) const;
+  static KeyView EntryKey(const DictEntry* entry);
+  bool IsEqual(const K& key, const DictEntry* entry) const;
+  bool IsEqual(std::string_view key, const DictEntry* entry) const;
+  template <typename Key>
+  DictEntry* AllocateEntry(Key&& key, size_t hash);
+  static void DeallocateEntry(DictEntry* entry);
+  static size_t EntryBytes(const DictEntry* entry);
   void SetKey(DictEntry* entry, const K& key);
   void SetKey(DictEntry* entry, K&& key);
   void SetVal(DictEntry* entry, const V& val);
@@ -88,61 +145,71 @@ class Dict {
   std::optional<V> ExtractUnlinkedEntry(DictEntry* entry);
   DictEntry* FindEntry(const K& key);
   DictEntry* FindEntry(std::string_view key);
+  DictEntry* FindEntry(std::string_view key, size_t hash);
+  void PrefetchChainHeads(size_t hash) const;
   std::optional<size_t> KeyIndex(const K& key, size_t hash,
                                  DictEntry** existing);
   DictEntry* InsertRaw(const K& key, DictEntry** existing);
   DictEntry* InsertRaw(K&& key, DictEntry** existing);
+  DictEntry* InsertRaw(K&& key, size_t hash, DictEntry** existing);
   void ExpandIfNeeded();
   bool Expand(size_t size);
+  bool Shrink(size_t size);
   void RehashStepIfNeeded();
+  void FinishRehash();
   void MigrateRehashedTable();
-  bool Rehash(int n);
   void Clear(int i);
   void Reset(int i);
   static constexpr int kTableInitSize = 2;
   static constexpr int kTableInitExp = 1;
   // Rehash when elements/table-size reaches this ratio.
   static constexpr double kDictForceResizeRatio = 2.0;
-  DictType type_;
+  // Shrink when at most 1/kDictMinFill of the table buckets are used.
+  static constexpr size_t kDictMinFill = 8;
+  // Keys looked up together by FindMany().
+  static constexpr size_t kFindManyBatch = 16;
+  // RandomEntry() picks chain positions below this bound, so only entries of
+  // longer chains are sampled less often than the rest.
+  static constexpr size_t kRandomChainBound = 8;
+  // Buckets migrated per Rehash() call while Reserve() drains a rehash.
+  static constexpr int kReserveRehashStep = 1024;
+  Policy policy_;
   // Table 1 is populated incrementally while table 0 is being rehashed.
-  std::array<std::vector<DictEntry*>, 2> tables_;
+  std::array<BucketArray<DictEntry*>, 2> tables_;
   std::array<size_t, 2> table_used_{};
   std::array<int, 2> table_size_exp_{};
   std::optional<size_t> rehash_idx_;
   size_t pause_rehash_;
 };
 
-template <typename K, typename V>
-struct Dict<K, V>::DictEntry {
+template <typename K, typename V, typename Policy>
+struct Dict<K, V, Policy>::NodeEntry
+    : SlabAllocated<SlabTag::kDictEntry> {
   K key;
   V val;
   size_t hash{};
-  DictEntry* next{nullptr};
+  NodeEntry* next{nullptr};
 };
 
-template <typename K, typename V>
-struct Dict<K, V>::DictType {
-  // Used to get the hash index of the key. Use std::hash by default.
-  std::function<size_t(const K& key)> hash_function;
-  // Optional non-owning lookup hooks for std::string-keyed dicts.
-  std::function<size_t(std::string_view key)> string_view_hash_function;
-  std::function<int(std::string_view key1, const K& key2)>
-      string_view_key_compare;
-  // If set, all keys will be copied while being inserted into the dict.
-  std::function<K(const K& key)> key_dup;
-  // If set, all values will be copied while being inserted into the dict.
-  std::function<V(const V& val)> val_dup;
-  // Callback function when the key is freed from the dict.
-  std::function<void(K& key)> key_destructor;
-  // Callback function when the value is freed from the dict.
-  std::function<void(V& val)> val_destructor;
-  // Comparator for keys. Used to check whether two keys are equal. Use operator
-  // by default.
-  std::function<int(const K& key1, const K& key2)> key_compare;
+/*
+ * Entry layout for policies that embed keys. The key bytes follow the entry in
+ * the same allocation, so one allocation holds the whole entry and comparing a
+ * key reads memory next to the cached hash instead of a separate key buffer.
+ */
+template <typename K, typename V, typename Policy>
+struct Dict<K, V, Policy>::EmbeddedKeyEntry {
+  V val;
+  size_t hash{};
+  EmbeddedKeyEntry* next{nullptr};
+  size_t key_size{};
+  const char* KeyData() const {
+    return reinterpret_cast<const char*>(this + 1);
+  }
+  char* KeyData() { return reinterpret_cast<char*>(this + 1); }
 };
 
-template <typename K, typename V>
-class Dict<K, V>::Iterator {
+template <typename K, typename V, typename Policy>
+class Dict<K, V, Policy>::Iterator {
  public:
   explicit Iterator(const Dict* dict);
   Iterator& operator=(const Iterator& it) = default;
@@ -153,7 +220,7 @@ class Dict<K, V>::Iterator {
   void SeekToLast();
   void Next();
   Iterator& operator++();
-  const K& Key() const { return entry_->key; }
+  KeyView Key() const { return EntryKey(entry_); }
   const V& Value() const { return entry_->val; }
 
  private:
@@ -164,40 +231,40 @@ class Dict<K, V>::Iterator {
   const DictEntry* entry_;
 };
 
-template <typename K, typename V>
-Dict<K, V>::Iterator::Iterator(const Dict* dict)
+template <typename K, typename V, typename Policy>
+Dict<K, V, Policy>::Iterator::Iterator(const Dict* dict)
     : dict_(dict), table_(0), idx_(std::nullopt), entry_(nullptr) {}
 
-template <typename K, typename V>
-bool Dict<K, V>::Iterator::operator==(const Iterator& it) const {
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Iterator::operator==(const Iterator& it) const {
   return dict_ == it.dict_ && table_ == it.table_ && idx_ == it.idx_ &&
          entry_ == it.entry_;
 }
 
-template <typename K, typename V>
-bool Dict<K, V>::Iterator::operator!=(const Iterator& it) const {
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Iterator::operator!=(const Iterator& it) const {
   return !((*this) == it);
 }
 
-template <typename K, typename V>
-bool Dict<K, V>::Iterator::Valid() const {
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Iterator::Valid() const {
   return entry_ != nullptr;
 }
 
-template <typename K, typename V>
-void Dict<K, V>::Iterator::SeekToFirst() {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Iterator::SeekToFirst() {
   table_ = 0;
   idx_ = std::nullopt;
   entry_ = nullptr;
   SeekToNextEntry();
 }
 
-template <typename K, typename V>
-void Dict<K, V>::Iterator::SeekToLast() {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Iterator::SeekToLast() {
   entry_ = nullptr;
   const int last_table = dict_->IsRehashing() ? 1 : 0;
   for (table_ = last_table; table_ >= 0; --table_) {
-    for (size_t bucket = dict_->tables_[table_].size(); bucket > 0; --bucket) {
+    for (size_t bucket = dict_->tables_[table_].Size(); bucket > 0; --bucket) {
       const size_t index = bucket - 1;
       if (dict_->tables_[table_][index] == nullptr) {
         continue;
@@ -214,33 +281,34 @@ void Dict<K, V>::Iterator::SeekToLast() {
   idx_ = std::nullopt;
 }
 
-template <typename K, typename V>
-typename Dict<K, V>::Iterator& Dict<K, V>::Iterator::operator++() {
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::Iterator&
+Dict<K, V, Policy>::Iterator::operator++() {
   SeekToNextEntry();
   return *this;
 }
 
-template <typename K, typename V>
-void Dict<K, V>::Iterator::Next() {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Iterator::Next() {
   SeekToNextEntry();
 }
 
 /*
  * Find the next non-null entry in the dict.
  */
-template <typename K, typename V>
-void Dict<K, V>::Iterator::SeekToNextEntry() {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Iterator::SeekToNextEntry() {
   if (entry_ && entry_->next) {
     entry_ = entry_->next;
     return;
   }
   idx_ = idx_.has_value() ? std::optional<size_t>(*idx_ + 1) : size_t{0};
   // Find next non empty table entry list.
-  while (*idx_ < dict_->tables_[table_].size() &&
+  while (*idx_ < dict_->tables_[table_].Size() &&
          dict_->tables_[table_][*idx_] == nullptr) {
     ++*idx_;
   }
-  if (*idx_ < dict_->tables_[table_].size()) {
+  if (*idx_ < dict_->tables_[table_].Size()) {
     entry_ = dict_->tables_[table_][*idx_];
     return;
   }
@@ -257,48 +325,37 @@ void Dict<K, V>::Iterator::SeekToNextEntry() {
 /*
  * Initialize the dict with default functions.
  */
-template <typename K, typename V>
-std::unique_ptr<Dict<K, V>> Dict<K, V>::Create() {
+template <typename K, typename V, typename Policy>
+std::unique_ptr<Dict<K, V, Policy>> Dict<K, V, Policy>::Create() {
   return Create(kTableInitSize);
 }
 
 /*
  * Initialize the dict with default functions and custom capacity.
  */
-template <typename K, typename V>
-std::unique_ptr<Dict<K, V>> Dict<K, V>::Create(size_t capacity) {
-  std::unique_ptr<Dict<K, V>> dict(new Dict<K, V>());
+template <typename K, typename V, typename Policy>
+std::unique_ptr<Dict<K, V, Policy>> Dict<K, V, Policy>::Create(
+    size_t capacity) {
+  std::unique_ptr<Dict<K, V, Policy>> dict(new Dict<K, V, Policy>());
   if (!dict->Expand(capacity)) {
     return nullptr;
   }
-  dict->type_.hash_function = [](const K& key) {
-    if constexpr (std::is_same<K, std::string>::value) {
-      std::hash<std::string_view> h;
-      return h(std::string_view(key));
-    } else {
-      std::hash<K> h;
-      return h(key);
-    }
-  };
-  if constexpr (std::is_same<K, std::string>::value) {
-    dict->type_.string_view_hash_function = [](std::string_view key) {
-      std::hash<std::string_view> h;
-      return h(key);
-    };
-  }
   return dict;
 }
 
 /*
  * Initialize the dict with customized functions.
  */
-template <typename K, typename V>
-std::unique_ptr<Dict<K, V>> Dict<K, V>::Create(
-    const typename Dict<K, V>::DictType& type) {
+template <typename K, typename V, typename Policy>
+std::unique_ptr<Dict<K, V, Policy>> Dict<K, V, Policy>::Create(
+    const typename Dict<K, V, Policy>::DictType& type) {
+  static_assert(std::is_same<Policy, DictTypePolicy<K, V>>::value,
+                "runtime DictType hooks require DictTypePolicy");
   if (!type.hash_function) {
     return nullptr;
   }
-  std::unique_ptr<Dict<K, V>> dict(new Dict<K, V>(type));
+  std::unique_ptr<Dict<K, V, Policy>> dict(
+      new Dict<K, V, Policy>(Policy(type)));
   if (!dict->Expand(kTableInitSize)) {
     return nullptr;
   }
@@ -308,8 +365,8 @@ std::unique_ptr<Dict<K, V>> Dict<K, V>::Create(
 /*
  * Find the entry containing the given key.
  */
-template <typename K, typename V>
-std::optional<V> Dict<K, V>::Get(const K& key) {
+template <typename K, typename V, typename Policy>
+std::optional<V> Dict<K, V, Policy>::Get(const K& key) {
   DictEntry* entry = FindEntry(key);
   if (entry == nullptr) {
     return std::nullopt;
@@ -317,29 +374,51 @@ std::optional<V> Dict<K, V>::Get(const K& key) {
   return entry->val;
 }
 
-template <typename K, typename V>
-V* Dict<K, V>::FindValue(const K& key) {
+template <typename K, typename V, typename Policy>
+V* Dict<K, V, Policy>::FindValue(const K& key) {
   DictEntry* entry = FindEntry(key);
   return entry == nullptr ? nullptr : &entry->val;
 }
 
-template <typename K, typename V>
-V* Dict<K, V>::FindValue(std::string_view key) {
+template <typename K, typename V, typename Policy>
+V* Dict<K, V, Policy>::FindValue(std::string_view key) {
   DictEntry* entry = FindEntry(key);
   return entry == nullptr ? nullptr : &entry->val;
 }
 
-template <typename K, typename V>
-V* Dict<K, V>::FindValue(const char* key) {
+template <typename K, typename V, typename Policy>
+V* Dict<K, V, Policy>::FindValue(const char* key) {
   return FindValue(std::string_view(key));
 }
 
-template <typename K, typename V>
-typename Dict<K, V>::DictEntry* Dict<K, V>::FindEntry(const K& key) {
+template <typename K, typename V, typename Policy>
+V* Dict<K, V, Policy>::FindValue(std::string_view key, size_t hash) {
+  static_assert(std::is_same<K, std::string>::value,
+                "std::string_view lookup only supports std::string keys");
+  RehashStepIfNeeded();
+  DictEntry* entry = FindEntry(key, hash);
+  return entry == nullptr ? nullptr : &entry->val;
+}
+
+template <typename K, typename V, typename Policy>
+std::optional<std::string_view> Dict<K, V, Policy>::FindKey(
+    std::string_view key, size_t hash) {
+  static_assert(std::is_same<K, std::string>::value,
+                "std::string_view lookup only supports std::string keys");
+  const DictEntry* const entry = FindEntry(key, hash);
+  if (entry == nullptr) {
+    return std::nullopt;
+  }
+  return std::string_view(EntryKey(entry));
+}
+
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::DictEntry* Dict<K, V, Policy>::FindEntry(
+    const K& key) {
   RehashStepIfNeeded();
   size_t hash = KeyHash(key);
   for (size_t i = 0; i < tables_.size(); ++i) {
-    if (tables_[i].empty()) {
+    if (tables_[i].Empty()) {
       if (!IsRehashing()) {
         break;
       }
@@ -348,7 +427,7 @@ typename Dict<K, V>::DictEntry* Dict<K, V>::FindEntry(const K& key) {
     size_t idx = HashIndex(hash, i);
     DictEntry* entry = tables_[i][idx];
     while (entry) {
-      if (entry->hash == hash && IsEqual(key, entry->key)) {
+      if (entry->hash == hash && IsEqual(key, entry)) {
         return entry;
       }
       entry = entry->next;
@@ -360,14 +439,20 @@ typename Dict<K, V>::DictEntry* Dict<K, V>::FindEntry(const K& key) {
   return nullptr;
 }
 
-template <typename K, typename V>
-typename Dict<K, V>::DictEntry* Dict<K, V>::FindEntry(std::string_view key) {
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::DictEntry* Dict<K, V, Policy>::FindEntry(
+    std::string_view key) {
   static_assert(std::is_same<K, std::string>::value,
                 "std::string_view lookup only supports std::string keys");
   RehashStepIfNeeded();
-  size_t hash = StringViewKeyHash(key);
+  return FindEntry(key, StringViewKeyHash(key));
+}
+
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::DictEntry* Dict<K, V, Policy>::FindEntry(
+    std::string_view key, size_t hash) {
   for (size_t i = 0; i < tables_.size(); ++i) {
-    if (tables_[i].empty()) {
+    if (tables_[i].Empty()) {
       if (!IsRehashing()) {
         break;
       }
@@ -376,7 +461,7 @@ typename Dict<K, V>::DictEntry* Dict<K, V>::FindEntry(std::string_view key) {
     size_t idx = HashIndex(hash, i);
     DictEntry* entry = tables_[i][idx];
     while (entry) {
-      if (entry->hash == hash && IsEqual(key, entry->key)) {
+      if (entry->hash == hash && IsEqual(key, entry)) {
         return entry;
       }
       entry = entry->next;
@@ -388,49 +473,115 @@ typename Dict<K, V>::DictEntry* Dict<K, V>::FindEntry(std::string_view key) {
   return nullptr;
 }
 
+/*
+ * Look up count keys, storing a pointer to each value (or null if the key is
+ * missing) in values. Keys are processed in groups: every bucket of a group is
+ * prefetched, then every chain head, and only then are keys compared, so the
+ * cache misses of independent lookups overlap.
+ */
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::FindMany(const std::string_view* keys, size_t count,
+                                  V** values) {
+  static_assert(std::is_same<K, std::string>::value,
+                "std::string_view lookup only supports std::string keys");
+  RehashStepIfNeeded();
+  std::array<size_t, kFindManyBatch> hashes{};
+  for (size_t start = 0; start < count; start += kFindManyBatch) {
+    const size_t group = std::min(kFindManyBatch, count - start);
+    for (size_t i = 0; i < group; ++i) {
+      hashes[i] = StringViewKeyHash(keys[start + i]);
+      PrefetchBuckets(hashes[i]);
+    }
+    for (size_t i = 0; i < group; ++i) {
+      PrefetchChainHeads(hashes[i]);
+    }
+    for (size_t i = 0; i < group; ++i) {
+      DictEntry* const entry = FindEntry(keys[start + i], hashes[i]);
+      values[start + i] = entry == nullptr ? nullptr : &entry->val;
+    }
+  }
+}
+
+/*
+ * Prefetch the buckets a lookup of key reads. Issue it for several keys before
+ * looking any of them up so their cache misses overlap.
+ */
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::PrefetchKey(std::string_view key) const {
+  static_assert(std::is_same<K, std::string>::value,
+                "std::string_view lookup only supports std::string keys");
+  PrefetchBuckets(StringViewKeyHash(key));
+}
+
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::PrefetchBuckets(size_t hash) const {
+  for (size_t i = 0; i < tables_.size(); ++i) {
+    if (!tables_[i].Empty()) {
+      Prefetch(&tables_[i][HashIndex(hash, i)]);
+    }
+  }
+}
+
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::PrefetchChainHeads(size_t hash) const {
+  for (size_t i = 0; i < tables_.size(); ++i) {
+    if (tables_[i].Empty()) {
+      continue;
+    }
+    const DictEntry* const head = tables_[i][HashIndex(hash, i)];
+    if (head != nullptr) {
+      Prefetch(head);
+    }
+  }
+}
+
 /*
  * Set the key-value pair.
  * If the key exists, replace the corresponding value with the new value.
  * Otherwise, insert a new key-value pair into the dict.
  */
-template <typename K, typename V>
-void Dict<K, V>::Set(const K& key, const V& val) {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Set(const K& key, const V& val) {
   DictEntry* existing = nullptr;
   DictEntry* entry = InsertRaw(key, &existing);
   if (entry) {
     SetVal(entry, val);
   } else if (existing) {
-    DictEntry auxentry = *existing;
+    V old_val = std::move(existing->val);
     SetVal(existing, val);
-    FreeVal(&auxentry);
+    policy_.DestroyVal(old_val);
   }
 }
 
-template <typename K, typename V>
-void Dict<K, V>::Set(const K& key, V&& val) {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Set(const K& key, V&& val) {
   DictEntry* existing = nullptr;
   DictEntry* entry = InsertRaw(key, &existing);
   if (entry) {
     SetVal(entry, std::move(val));
   } else if (existing) {
-    DictEntry auxentry;
-    auxentry.val = std::move(existing->val);
+    V old_val = std::move(existing->val);
     SetVal(existing, std::move(val));
-    FreeVal(&auxentry);
+    policy_.DestroyVal(old_val);
   }
 }
 
-template <typename K, typename V>
-void Dict<K, V>::Set(K&& key, V&& val) {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Set(K&& key, V&& val) {
+  const size_t hash = KeyHash(key);
+  Set(std::move(key), std::move(val), hash);
+}
+
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Set(K&& key, V&& val, size_t hash) {
   DictEntry* existing = nullptr;
-  DictEntry* entry = InsertRaw(std::move(key), &existing);
+  DictEntry* entry = InsertRaw(std::move(key), hash, &existing);
   if (entry != nullptr) {
     SetVal(entry, std::move(val));
   } else if (existing != nullptr) {
-    DictEntry auxentry;
-    auxentry.val = std::move(existing->val);
+    V old_val = std::move(existing->val);
     SetVal(existing, std::move(val));
-    FreeVal(&auxentry);
+    policy_.DestroyVal(old_val);
   }
 }
 
@@ -438,8 +589,8 @@ void Dict<K, V>::Set(K&& key, V&& val) {
  * Insert a new key-value pair to the dict.
  * Return false if the key already exists in the dict.
  */
-template <typename K, typename V>
-bool Dict<K, V>::Insert(const K& key, const V& val) {
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Insert(const K& key, const V& val) {
   DictEntry* entry = InsertRaw(key, nullptr);
   if (!entry) {
     return false;
@@ -448,8 +599,8 @@ bool Dict<K, V>::Insert(const K& key, const V& val) {
   return true;
 }
 
-template <typename K, typename V>
-bool Dict<K, V>::Insert(K&& key, V&& val) {
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Insert(K&& key, V&& val) {
   DictEntry* entry = InsertRaw(std::move(key), nullptr);
   if (!entry) {
     return false;
@@ -458,12 +609,26 @@ bool Dict<K, V>::Insert(K&& key, V&& val) {
   return true;
 }
 
+/*
+ * Insert a key the caller knows is absent, e.g. while copying entries out of a
+ * listpack or a snapshot. Skips the duplicate lookup and the incremental rehash
+ * step; call Reserve() first so the dict does not have to expand either.
+ */
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::BulkInsert(K&& key, V&& val) {
+  ExpandIfNeeded();
+  const size_t hash = KeyHash(key);
+  DictEntry* const entry = AllocateEntry(std::move(key), hash);
+  InsertEntry(entry, IsRehashing() ? 1 : 0);
+  SetVal(entry, std::move(val));
+}
+
 /*
  * Delete the key from the dict, and free the memory of the entry used to store
  * the key-value pair.
  */
-template <typename K, typename V>
-bool Dict<K, V>::Delete(const K& key) {
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Delete(const K& key) {
   DictEntry* de = Unlink(key);
   if (de) {
     FreeUnlinkedEntry(de);
@@ -472,11 +637,16 @@ bool Dict<K, V>::Delete(const K& key) {
   return false;
 }
 
-template <typename K, typename V>
-bool Dict<K, V>::Delete(std::string_view key) {
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Delete(std::string_view key) {
+  return Delete(key, StringViewKeyHash(key));
+}
+
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Delete(std::string_view key, size_t hash) {
   static_assert(std::is_same<K, std::string>::value,
                 "std::string_view deletion only supports std::string keys");
-  DictEntry* entry = Unlink(key);
+  DictEntry* entry = Unlink(key, hash);
   if (entry == nullptr) {
     return false;
   }
@@ -484,100 +654,165 @@ bool Dict<K, V>::Delete(std::string_view key) {
   return true;
 }
 
-template <typename K, typename V>
-std::optional<V> Dict<K, V>::Extract(const K& key) {
+template <typename K, typename V, typename Policy>
+std::optional<V> Dict<K, V, Policy>::Extract(const K& key) {
   return ExtractUnlinkedEntry(Unlink(key));
 }
 
-template <typename K, typename V>
-std::optional<V> Dict<K, V>::Extract(std::string_view key) {
+template <typename K, typename V, typename Policy>
+std::optional<V> Dict<K, V, Policy>::Extract(std::string_view key) {
+  return Extract(key, StringViewKeyHash(key));
+}
+
+template <typename K, typename V, typename Policy>
+std::optional<V> Dict<K, V, Policy>::Extract(std::string_view key,
+                                             size_t hash) {
   static_assert(std::is_same<K, std::string>::value,
                 "std::string_view extraction only supports std::string keys");
-  return ExtractUnlinkedEntry(Unlink(key));
+  return ExtractUnlinkedEntry(Unlink(key, hash));
 }
 
-template <typename K, typename V>
+/*
+ * Visit every entry in the bucket addressed by the cursor and return the next
+ * cursor, or std::nullopt once the whole dict has been visited. Cursors advance
+ * in reverse-binary order, so entries present for the whole scan are returned
+ * at least once even if the dict is resized between calls.
+ */
+template <typename K, typename V, typename Policy>
 template <typename Visitor>
-std::optional<size_t> Dict<K, V>::Scan(size_t cursor, Visitor&& visitor) {
-  // Scanning visits the same bucket index in both tables; pause incremental
+std::optional<size_t> Dict<K, V, Policy>::Scan(size_t cursor,
+                                               Visitor&& visitor) {
+  if (tables_[0].Empty()) {
+    return std::nullopt;
+  }
+  // Scanning visits related bucket indexes in both tables; pause incremental
   // rehashing so entries do not move while this cursor position is processed.
   PauseRehashing();
-  if (cursor < tables_[0].size()) {
-    const DictEntry* de = tables_[0][cursor];
+  const auto visit_bucket = [this, &visitor](int table, size_t index) {
+    const DictEntry* de = tables_[table][index];
     while (de) {
       const DictEntry* next = de->next;
-      visitor(de->key, de->val);
+      visitor(EntryKey(de), de->val);
       de = next;
     }
-  }
-  // During rehashing, the same cursor position can have entries in both tables.
-  if (IsRehashing() && cursor < tables_[1].size()) {
-    const DictEntry* de = tables_[1][cursor];
-    while (de) {
-      const DictEntry* next = de->next;
-      visitor(de->key, de->val);
-      de = next;
+  };
+  if (!IsRehashing()) {
+    const size_t mask = TableMask(0);
+    visit_bucket(0, cursor & mask);
+    cursor = NextScanCursor(cursor, mask);
+  } else {
+    int small = 0;
+    int large = 1;
+    if (tables_[small].Size() > tables_[large].Size()) {
+      std::swap(small, large);
     }
-  }
-  if (++cursor >= std::max(tables_[0].size(), tables_[1].size())) {
-    ResumeRehashing();
-    return std::nullopt;
+    const size_t small_mask = TableMask(small);
+    const size_t large_mask = TableMask(large);
+    visit_bucket(small, cursor & small_mask);
+    // Visit every bucket of the larger table that the small bucket expands to.
+    do {
+      visit_bucket(large, cursor & large_mask);
+      cursor = (((cursor | small_mask) + 1) & ~small_mask) |
+               (cursor & small_mask);
+    } while ((cursor & (small_mask ^ large_mask)) != 0);
+    cursor = NextScanCursor(cursor, small_mask);
   }
   ResumeRehashing();
-  return cursor;
+  return cursor == 0 ? std::nullopt : std::optional<size_t>(cursor);
 }
 
-template <typename K, typename V>
-void Dict<K, V>::Clear() {
+/*
+ * Pass an entry chosen uniformly at random to visitor and return true, or
+ * return false if the dict is empty. A bucket is drawn across both tables, so
+ * a rehash in progress (whose migrated buckets are simply empty) does not skew
+ * the choice, and then a position in its chain; draws that miss are retried.
+ * Expected draws are kRandomChainBound times buckets per entry.
+ */
+template <typename K, typename V, typename Policy>
+template <typename Visitor>
+bool Dict<K, V, Policy>::RandomEntry(Visitor&& visitor) {
+  if (Size() == 0) {
+    return false;
+  }
+  RehashStepIfNeeded();
+  const size_t first_buckets = tables_[0].Size();
+  const size_t buckets = first_buckets + tables_[1].Size();
+  while (true) {
+    size_t bucket = RandomIndex(buckets);
+    int table = 0;
+    if (bucket >= first_buckets) {
+      bucket -= first_buckets;
+      table = 1;
+    }
+    const DictEntry* de = tables_[table][bucket];
+    size_t length = 0;
+    for (const DictEntry* next = de; next != nullptr; next = next->next) {
+      ++length;
+    }
+    size_t position = RandomIndex(std::max(kRandomChainBound, length));
+    if (position >= length) {
+      continue;
+    }
+    for (; position > 0; --position) {
+      de = de->next;
+    }
+    visitor(EntryKey(de), de->val);
+    return true;
+  }
+}
+
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Clear() {
   Clear(0);
   Clear(1);
   rehash_idx_ = std::nullopt;
   pause_rehash_ = 0;
 }
 
-template <typename K, typename V>
-Dict<K, V>::~Dict() {
+template <typename K, typename V, typename Policy>
+Dict<K, V, Policy>::~Dict() {
   Clear();
 }
 
-template <typename K, typename V>
-Dict<K, V>::Dict() : rehash_idx_(std::nullopt), pause_rehash_(0) {
+template <typename K, typename V, typename Policy>
+Dict<K, V, Policy>::Dict() : rehash_idx_(std::nullopt), pause_rehash_(0) {
   InitializeTables();
 }
 
-template <typename K, typename V>
-Dict<K, V>::Dict(const DictType& type)
-    : type_(type), rehash_idx_(std::nullopt), pause_rehash_(0) {
+template <typename K, typename V, typename Policy>
+Dict<K, V, Policy>::Dict(const Policy& policy)
+    : policy_(policy), rehash_idx_(std::nullopt), pause_rehash_(0) {
   InitializeTables();
 }
 
-template <typename K, typename V>
-void Dict<K, V>::InitializeTables() {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::InitializeTables() {
   Reset(0);
   Reset(1);
 }
 
-template <typename K, typename V>
-void Dict<K, V>::InitializeTableWithSize(int i, int exp, size_t size) {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::InitializeTableWithSize(int i, int exp, size_t size) {
   table_size_exp_[i] = exp;
-  tables_[i].resize(size);
+  tables_[i].Reset(size);
   table_used_[i] = 0;
 }
 
-template <typename K, typename V>
-void Dict<K, V>::InsertEntry(DictEntry* de, int i) {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::InsertEntry(DictEntry* de, int i) {
   size_t key_idx = HashIndex(de->hash, i);
   de->next = tables_[i][key_idx];
   tables_[i][key_idx] = de;
   ++table_used_[i];
 }
 
-template <typename K, typename V>
-typename Dict<K, V>::DictEntry* Dict<K, V>::Unlink(const K& key) {
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::DictEntry* Dict<K, V, Policy>::Unlink(
+    const K& key) {
   RehashStepIfNeeded();
   size_t hash = KeyHash(key);
   for (size_t i = 0; i < tables_.size(); ++i) {
-    if (tables_[i].empty()) {
+    if (tables_[i].Empty()) {
       if (!IsRehashing()) {
         break;
       }
@@ -586,8 +821,9 @@ typename Dict<K, V>::DictEntry* Dict<K, V>::Unlink(const K& key) {
     size_t idx = HashIndex(hash, i);
     DictEntry *entry = tables_[i][idx], *prev = nullptr;
     while (entry) {
-      if (entry->hash == hash && IsEqual(key, entry->key)) {
+      if (entry->hash == hash && IsEqual(key, entry)) {
         UnlinkEntry(entry, prev, i);
+        ShrinkIfNeeded();
         return entry;
       }
       prev = entry, entry = entry->next;
@@ -599,14 +835,20 @@ typename Dict<K, V>::DictEntry* Dict<K, V>::Unlink(const K& key) {
   return nullptr;
 }
 
-template <typename K, typename V>
-typename Dict<K, V>::DictEntry* Dict<K, V>::Unlink(std::string_view key) {
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::DictEntry* Dict<K, V, Policy>::Unlink(
+    std::string_view key) {
+  return Unlink(key, StringViewKeyHash(key));
+}
+
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::DictEntry* Dict<K, V, Policy>::Unlink(
+    std::string_view key, size_t hash) {
   static_assert(std::is_same<K, std::string>::value,
                 "std::string_view unlink only supports std::string keys");
   RehashStepIfNeeded();
-  const size_t hash = StringViewKeyHash(key);
   for (size_t table = 0; table < tables_.size(); ++table) {
-    if (tables_[table].empty()) {
+    if (tables_[table].Empty()) {
       if (!IsRehashing()) {
         break;
       }
@@ -616,8 +858,9 @@ typename Dict<K, V>::DictEntry* Dict<K, V>::Unlink(std::string_view key) {
     DictEntry* entry = tables_[table][index];
     DictEntry* previous = nullptr;
     while (entry != nullptr) {
-      if (entry->hash == hash && IsEqual(key, entry->key)) {
+      if (entry->hash == hash && IsEqual(key, entry)) {
         UnlinkEntry(entry, previous, table);
+        ShrinkIfNeeded();
         return entry;
       }
       previous = entry;
@@ -630,8 +873,8 @@ typename Dict<K, V>::DictEntry* Dict<K, V>::Unlink(std::string_view key) {
   return nullptr;
 }
 
-template <typename K, typename V>
-void Dict<K, V>::UnlinkEntry(DictEntry* de, DictEntry* prev, int i) {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::UnlinkEntry(DictEntry* de, DictEntry* prev, int i) {
   if (prev) {
     prev->next = de->next;
   } else {
@@ -642,41 +885,36 @@ void Dict<K, V>::UnlinkEntry(DictEntry* de, DictEntry* prev, int i) {
   --table_used_[i];
 }
 
-template <typename K, typename V>
-void Dict<K, V>::DeleteEntry(DictEntry* de, DictEntry* prev, int i) {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::DeleteEntry(DictEntry* de, DictEntry* prev, int i) {
   UnlinkEntry(de, prev, i);
   FreeUnlinkedEntry(de);
 }
 
-template <typename K, typename V>
-size_t Dict<K, V>::TableMask(int i) const {
+template <typename K, typename V, typename Policy>
+size_t Dict<K, V, Policy>::TableMask(int i) const {
   return table_size_exp_[i] == -1 ? 0 : (size_t{1} << table_size_exp_[i]) - 1;
 }
 
-template <typename K, typename V>
-size_t Dict<K, V>::HashIndex(size_t hash, int i) const {
+template <typename K, typename V, typename Policy>
+size_t Dict<K, V, Policy>::HashIndex(size_t hash, int i) const {
   return hash & TableMask(i);
 }
 
-template <typename K, typename V>
-size_t Dict<K, V>::KeyHash(const K& key) const {
-  assert(type_.hash_function);
-  return type_.hash_function(key);
+template <typename K, typename V, typename Policy>
+size_t Dict<K, V, Policy>::KeyHash(const K& key) const {
+  return policy_.Hash(key);
 }
 
-template <typename K, typename V>
-size_t Dict<K, V>::StringViewKeyHash(std::string_view key) const {
+template <typename K, typename V, typename Policy>
+size_t Dict<K, V, Policy>::StringViewKeyHash(std::string_view key) const {
   static_assert(std::is_same<K, std::string>::value,
                 "StringViewKeyHash only supports std::string keys");
-  if (type_.string_view_hash_function) {
-    return type_.string_view_hash_function(key);
-  }
-  assert(type_.hash_function);
-  return type_.hash_function(std::string(key));
+  return policy_.Hash(key);
 }
 
-template <typename K, typename V>
-int Dict<K, V>::NextExp(size_t size) const {
+template <typename K, typename V, typename Policy>
+int Dict<K, V, Policy>::NextExp(size_t size) const {
   int exponent = 1;
   size_t table_size = size_t{1} << exponent;
   while (table_size < size) {
@@ -689,91 +927,158 @@ int Dict<K, V>::NextExp(size_t size) const {
   return exponent;
 }
 
-template <typename K, typename V>
-bool Dict<K, V>::IsEqual(const K& key1, const K& key2) const {
-  return key1 == key2 ||
-         (type_.key_compare && !(type_.key_compare(key1, key2)));
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::KeyView Dict<K, V, Policy>::EntryKey(
+    const DictEntry* entry) {
+  if constexpr (kEmbedKey) {
+    return std::string_view(entry->KeyData(), entry->key_size);
+  } else {
+    return entry->key;
+  }
 }
 
-template <typename K, typename V>
-bool Dict<K, V>::IsEqual(std::string_view key1, const K& key2) const {
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::IsEqual(const K& key, const DictEntry* entry) const {
+  if constexpr (kEmbedKey) {
+    return policy_.Equal(std::string_view(key), EntryKey(entry));
+  } else {
+    return policy_.Equal(key, entry->key);
+  }
+}
+
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::IsEqual(std::string_view key,
+                                 const DictEntry* entry) const {
   static_assert(std::is_same<K, std::string>::value,
                 "string_view comparison only supports std::string keys");
-  if (key1 == std::string_view(key2)) {
-    return true;
+  return policy_.Equal(key, EntryKey(entry));
+}
+
+template <typename K, typename V, typename Policy>
+template <typename Key>
+typename Dict<K, V, Policy>::DictEntry* Dict<K, V, Policy>::AllocateEntry(
+    Key&& key, size_t hash) {
+  if constexpr (kEmbedKey) {
+    const std::string_view key_view(key);
+    void* const memory = SlabAllocate(
+        sizeof(EmbeddedKeyEntry) + key_view.size(), SlabTag::kDictEntry);
+    auto* const entry = ::new (memory) EmbeddedKeyEntry();
+    entry->hash = hash;
+    entry->key_size = key_view.size();
+    std::memcpy(entry->KeyData(), key_view.data(), key_view.size());
+    return entry;
+  } else {
+    auto entry = std::make_unique<NodeEntry>();
+    entry->hash = hash;
+    SetKey(entry.get(), std::forward<Key>(key));
+    return entry.release();
   }
-  if (type_.string_view_key_compare) {
-    return !type_.string_view_key_compare(key1, key2);
+}
+
+template <typename K, typename V, typename Policy>
+size_t Dict<K, V, Policy>::EntryBytes(const DictEntry* entry) {
+  if constexpr (kEmbedKey) {
+    return SlabAllocationBytes(entry,
+                               sizeof(EmbeddedKeyEntry) + entry->key_size) +
+           OwnedBytes(entry->val);
+  } else {
+    return SlabAllocationBytes(entry, sizeof(NodeEntry)) +
+           OwnedBytes(entry->key) + OwnedBytes(entry->val);
   }
-  if (type_.key_compare) {
-    return !type_.key_compare(std::string(key1), key2);
+}
+
+template <typename K, typename V, typename Policy>
+size_t Dict<K, V, Policy>::Bytes(size_t samples) const {
+  const size_t table_bytes = tables_[0].Bytes() + tables_[1].Bytes();
+  const size_t limit = samples == 0 ? Size() : std::min(samples, Size());
+  size_t measured = 0;
+  size_t entry_bytes = 0;
+  for (int i = 0; i < 2 && measured < limit; ++i) {
+    for (size_t bucket = 0; bucket < tables_[i].Size() && measured < limit;
+         ++bucket) {
+      for (const DictEntry* entry = tables_[i][bucket];
+           entry != nullptr && measured < limit; entry = entry->next) {
+        entry_bytes += EntryBytes(entry);
+        ++measured;
+      }
+    }
+  }
+  return table_bytes + (measured == 0 ? 0 : entry_bytes * Size() / measured);
+}
+
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::DeallocateEntry(DictEntry* entry) {
+  if constexpr (kEmbedKey) {
+    const size_t size = sizeof(EmbeddedKeyEntry) + entry->key_size;
+    entry->~EmbeddedKeyEntry();
+    SlabDeallocate(entry, size, SlabTag::kDictEntry);
+  } else {
+    delete entry;
   }
-  return false;
 }
 
-template <typename K, typename V>
-void Dict<K, V>::SetKey(DictEntry* entry, const K& key) {
-  entry->key = type_.key_dup ? type_.key_dup(key) : key;
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::SetKey(DictEntry* entry, const K& key) {
+  entry->key = policy_.DupKey(key);
 }
 
-template <typename K, typename V>
-void Dict<K, V>::SetKey(DictEntry* entry, K&& key) {
-  entry->key = type_.key_dup ? type_.key_dup(key) : std::move(key);
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::SetKey(DictEntry* entry, K&& key) {
+  entry->key = policy_.DupKey(std::move(key));
 }
 
-template <typename K, typename V>
-void Dict<K, V>::SetVal(DictEntry* entry, const V& val) {
-  entry->val = type_.val_dup ? type_.val_dup(val) : val;
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::SetVal(DictEntry* entry, const V& val) {
+  entry->val = policy_.DupVal(val);
 }
 
-template <typename K, typename V>
-void Dict<K, V>::SetVal(DictEntry* entry, V&& val) {
-  entry->val = type_.val_dup ? type_.val_dup(val) : std::move(val);
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::SetVal(DictEntry* entry, V&& val) {
+  entry->val = policy_.DupVal(std::move(val));
 }
 
-template <typename K, typename V>
-void Dict<K, V>::FreeKey(DictEntry* entry) {
-  if (type_.key_destructor) {
-    type_.key_destructor(entry->key);
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::FreeKey(DictEntry* entry) {
+  // Embedded key bytes are released together with the entry.
+  if constexpr (!kEmbedKey) {
+    policy_.DestroyKey(entry->key);
   }
 }
 
-template <typename K, typename V>
-void Dict<K, V>::FreeVal(DictEntry* entry) {
-  if (type_.val_destructor) {
-    type_.val_destructor(entry->val);
-  }
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::FreeVal(DictEntry* entry) {
+  policy_.DestroyVal(entry->val);
 }
 
-template <typename K, typename V>
-void Dict<K, V>::FreeUnlinkedEntry(DictEntry* entry) {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::FreeUnlinkedEntry(DictEntry* entry) {
   if (entry) {
     FreeKey(entry);
     FreeVal(entry);
-    delete entry;
+    DeallocateEntry(entry);
   }
 }
 
-template <typename K, typename V>
-std::optional<V> Dict<K, V>::ExtractUnlinkedEntry(DictEntry* entry) {
+template <typename K, typename V, typename Policy>
+std::optional<V> Dict<K, V, Policy>::ExtractUnlinkedEntry(DictEntry* entry) {
   if (entry == nullptr) {
     return std::nullopt;
   }
   std::optional<V> value(std::move(entry->val));
   FreeKey(entry);
-  delete entry;
+  DeallocateEntry(entry);
   return value;
 }
 
-template <typename K, typename V>
-std::optional<size_t> Dict<K, V>::KeyIndex(const K& key, size_t hash,
-                                           Dict<K, V>::DictEntry** existing) {
+template <typename K, typename V, typename Policy>
+std::optional<size_t> Dict<K, V, Policy>::KeyIndex(
+    const K& key, size_t hash, Dict<K, V, Policy>::DictEntry** existing) {
   if (existing != nullptr) {
     *existing = nullptr;
   }
   size_t idx = 0;
   for (size_t i = 0; i < tables_.size(); ++i) {
-    if (tables_[i].empty()) {
+    if (tables_[i].Empty()) {
       if (!IsRehashing()) {
         break;
       }
@@ -782,7 +1087,7 @@ std::optional<size_t> Dict<K, V>::KeyIndex(const K& key, size_t hash,
     idx = HashIndex(hash, i);
     DictEntry* entry = tables_[i][idx];
     while (entry) {
-      if (entry->hash == hash && IsEqual(entry->key, key)) {
+      if (entry->hash == hash && IsEqual(key, entry)) {
         if (existing) {
           *existing = entry;
         }
@@ -797,9 +1102,9 @@ std::optional<size_t> Dict<K, V>::KeyIndex(const K& key, size_t hash,
   return idx;
 }
 
-template <typename K, typename V>
-typename Dict<K, V>::DictEntry* Dict<K, V>::InsertRaw(
-    const K& key, Dict<K, V>::DictEntry** existing) {
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::DictEntry* Dict<K, V, Policy>::InsertRaw(
+    const K& key, Dict<K, V, Policy>::DictEntry** existing) {
   ExpandIfNeeded();
   RehashStepIfNeeded();
   size_t hash = KeyHash(key);
@@ -808,33 +1113,35 @@ typename Dict<K, V>::DictEntry* Dict<K, V>::InsertRaw(
     return nullptr;
   }
   int i = IsRehashing() ? 1 : 0;
-  auto entry = std::make_unique<DictEntry>();
-  entry->hash = hash;
-  SetKey(entry.get(), key);
-  InsertEntry(entry.get(), i);
-  return entry.release();
+  DictEntry* const entry = AllocateEntry(key, hash);
+  InsertEntry(entry, i);
+  return entry;
 }
 
-template <typename K, typename V>
-typename Dict<K, V>::DictEntry* Dict<K, V>::InsertRaw(
-    K&& key, Dict<K, V>::DictEntry** existing) {
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::DictEntry* Dict<K, V, Policy>::InsertRaw(
+    K&& key, Dict<K, V, Policy>::DictEntry** existing) {
+  const size_t hash = KeyHash(key);
+  return InsertRaw(std::move(key), hash, existing);
+}
+
+template <typename K, typename V, typename Policy>
+typename Dict<K, V, Policy>::DictEntry* Dict<K, V, Policy>::InsertRaw(
+    K&& key, size_t hash, Dict<K, V, Policy>::DictEntry** existing) {
   ExpandIfNeeded();
   RehashStepIfNeeded();
-  const size_t hash = KeyHash(key);
   const auto idx = KeyIndex(key, hash, existing);
   if (!idx.has_value()) {
     return nullptr;
   }
   const int table = IsRehashing() ? 1 : 0;
-  auto entry = std::make_unique<DictEntry>();
-  entry->hash = hash;
-  SetKey(entry.get(), std::move(key));
-  InsertEntry(entry.get(), table);
-  return entry.release();
+  DictEntry* const entry = AllocateEntry(std::move(key), hash);
+  InsertEntry(entry, table);
+  return entry;
 }
 
-template <typename K, typename V>
-void Dict<K, V>::ExpandIfNeeded() {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::ExpandIfNeeded() {
   const size_t table_size = TableSize(table_size_exp_[0]);
   if (table_size == 0 || static_cast<double>(table_used_[0]) / table_size >=
                              kDictForceResizeRatio) {
@@ -842,8 +1149,8 @@ void Dict<K, V>::ExpandIfNeeded() {
   }
 }
 
-template <typename K, typename V>
-bool Dict<K, V>::Expand(size_t size) {
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Expand(size_t size) {
   if (IsRehashing() || size < table_used_[0]) {
     return false;
   }
@@ -870,8 +1177,74 @@ bool Dict<K, V>::Expand(size_t size) {
   return true;
 }
 
-template <typename K, typename V>
-void Dict<K, V>::RehashStepIfNeeded() {
+/*
+ * Size the table for at least `size` entries so inserting them never expands
+ * it. Any in-progress rehash is finished first, and existing entries are moved
+ * to the larger table in one pass instead of incrementally. Return false if the
+ * table cannot grow to that size.
+ */
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Reserve(size_t size) {
+  FinishRehash();
+  if (size <= TableSize(table_size_exp_[0])) {
+    return true;
+  }
+  if (table_used_[0] == 0) {
+    // Nothing to migrate: replace table 0 outright.
+    Reset(0);
+  }
+  if (!Expand(size)) {
+    return false;
+  }
+  FinishRehash();
+  return true;
+}
+
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::FinishRehash() {
+  bool pending = IsRehashing();
+  while (pending) {
+    pending = Rehash(kReserveRehashStep);
+  }
+}
+
+/*
+ * Start an incremental rehash into a smaller table once mass deletion has left
+ * table 0 sparse. The new table fits the remaining entries, so the load factor
+ * lands well below the growth threshold and the dict does not oscillate.
+ * Return true if a shrink was started.
+ */
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::ShrinkIfNeeded() {
+  if (IsRehashing()) {
+    return false;
+  }
+  const size_t table_size = TableSize(table_size_exp_[0]);
+  if (table_size <= kTableInitSize ||
+      table_used_[0] * kDictMinFill > table_size) {
+    return false;
+  }
+  return Shrink(table_used_[0]);
+}
+
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Shrink(size_t size) {
+  if (IsRehashing() || size < table_used_[0]) {
+    return false;
+  }
+  const int new_exp = NextExp(std::max<size_t>(size, kTableInitSize));
+  if (new_exp < 0 || new_exp >= table_size_exp_[0]) {
+    return false;
+  }
+  // Entries migrate bucket by bucket as with expansion; table 0 is released
+  // once it has been drained.
+  InitializeTableWithSize(1, new_exp, TableSize(new_exp));
+  rehash_idx_ = size_t{0};
+  return true;
+}
+
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::RehashStepIfNeeded() {
   if (pause_rehash_ == 0) {
     Rehash(1);
   }
@@ -880,8 +1253,8 @@ void Dict<K, V>::RehashStepIfNeeded() {
 // Perform at most n non-empty bucket migrations. Empty buckets are skipped with
 // a bounded visit count so sparse tables cannot stall one operation for too
 // long.
-template <typename K, typename V>
-bool Dict<K, V>::Rehash(int n) {
+template <typename K, typename V, typename Policy>
+bool Dict<K, V, Policy>::Rehash(int n) {
   // Do nothing unless a second table is active.
   if (!IsRehashing()) {
     return false;
@@ -913,8 +1286,8 @@ bool Dict<K, V>::Rehash(int n) {
   return true;
 }
 
-template <typename K, typename V>
-void Dict<K, V>::MigrateRehashedTable() {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::MigrateRehashedTable() {
   tables_[0] = std::move(tables_[1]);
   table_size_exp_[0] = table_size_exp_[1];
   table_used_[0] = table_used_[1];
@@ -926,9 +1299,9 @@ void Dict<K, V>::MigrateRehashedTable() {
  * Helper function for dict clear. Delete all key-value pairs in the given table
  * and reset the table to the initial state.
  */
-template <typename K, typename V>
-void Dict<K, V>::Clear(int i) {
-  for (size_t j = 0; j < tables_[i].size() && table_used_[i] > 0; ++j) {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Clear(int i) {
+  for (size_t j = 0; j < tables_[i].Size() && table_used_[i] > 0; ++j) {
     DictEntry* de = tables_[i][j];
     while (de) {
       DictEntry* next = de->next;
@@ -940,12 +1313,12 @@ void Dict<K, V>::Clear(int i) {
   Reset(i);
 }
 
-template <typename K, typename V>
-void Dict<K, V>::Reset(int i) {
+template <typename K, typename V, typename Policy>
+void Dict<K, V, Policy>::Reset(int i) {
   if (i < 0 || static_cast<size_t>(i) >= tables_.size()) {
     return;
   }
-  tables_[i].clear();
+  tables_[i].Clear();
   table_used_[i] = 0;
   table_size_exp_[i] = -1;
 }
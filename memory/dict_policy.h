@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "memory/hash_function.h"
+
+namespace redis_simple::in_memory {
+template <typename K, typename V>
+struct DictType {
+  // Used to get the hash index of the key. Use the seeded HashString for
+  // std::string keys and std::hash otherwise by default.
+  std::function<size_t(const K& key)> hash_function;
+  // Optional non-owning lookup hooks for std::string-keyed dicts.
+  std::function<size_t(std::string_view key)> string_view_hash_function;
+  std::function<int(std::string_view key1, const K& key2)>
+      string_view_key_compare;
+  // If set, all keys will be copied while being inserted into the dict.
+  std::function<K(const K& key)> key_dup;
+  // If set, all values will be copied while being inserted into the dict.
+  std::function<V(const V& val)> val_dup;
+  // Callback function when the key is freed from the dict.
+  std::function<void(K& key)> key_destructor;
+  // Callback function when the value is freed from the dict.
+  std::function<void(V& val)> val_destructor;
+  // Comparator for keys. Used to check whether two keys are equal. Use operator
+  // by default.
+  std::function<int(const K& key1, const K& key2)> key_compare;
+};
+
+/*
+ * A dict policy supplies the hooks Dict calls for every key it hashes,
+ * compares, stores or frees:
+ *
+ *   size_t Hash(const K& key) const;
+ *   bool Equal(const K& key1, const K& key2) const;
+ *   K DupKey(const K& key) const;   K DupKey(K&& key) const;
+ *   V DupVal(const V& val) const;   V DupVal(V&& val) const;
+ *   void DestroyKey(K& key) const;
+ *   void DestroyVal(V& val) const;
+ *
+ * std::string-keyed policies also provide Hash(std::string_view) and
+ * Equal(std::string_view, const K&) for non-owning lookups. A policy that sets
+ * `static constexpr bool kEmbedKey = true` makes Dict store the key bytes
+ * inside the entry; its Equal must accept two std::string_views, and the key
+ * dup and destructor hooks are not called.
+ */
+template <typename Policy, typename = void>
+struct PolicyEmbedsKey : std::false_type {};
+
+template <typename Policy>
+struct PolicyEmbedsKey<Policy, std::void_t<decltype(Policy::kEmbedKey)>>
+    : std::bool_constant<Policy::kEmbedKey> {};
+
+/*
+ * Hooks configured at runtime through a DictType. Every call goes through a
+ * std::function, so prefer DefaultDictPolicy unless the hooks really vary per
+ * dict instance.
+ */
+template <typename K, typename V>
+class DictTypePolicy {
+ public:
+  DictTypePolicy() {
+    type_.hash_function = [](const K& key) {
+      if constexpr (std::is_same<K, std::string>::value) {
+        return HashString(key);
+      } else {
+        std::hash<K> h;
+        return h(key);
+      }
+    };
+    if constexpr (std::is_same<K, std::string>::value) {
+      type_.string_view_hash_function = [](std::string_view key) {
+        return HashString(key);
+      };
+    }
+  }
+  explicit DictTypePolicy(const DictType<K, V>& type) : type_(type) {}
+  size_t Hash(const K& key) const { return type_.hash_function(key); }
+  size_t Hash(std::string_view key) const {
+    if (type_.string_view_hash_function) {
+      return type_.string_view_hash_function(key);
+    }
+    return type_.hash_function(std::string(key));
+  }
+  bool Equal(const K& key1, const K& key2) const {
+    return key1 == key2 ||
+           (type_.key_compare && !(type_.key_compare(key1, key2)));
+  }
+  bool Equal(std::string_view key1, const K& key2) const {
+    if (key1 == std::string_view(key2)) {
+      return true;
+    }
+    if (type_.string_view_key_compare) {
+      return !type_.string_view_key_compare(key1, key2);
+    }
+    if (type_.key_compare) {
+      return !type_.key_compare(std::string(key1), key2);
+    }
+    return false;
+  }
+  K DupKey(const K& key) const {
+    return type_.key_dup ? type_.key_dup(key) : key;
+  }
+  K DupKey(K&& key) const {
+    return type_.key_dup ? type_.key_dup(key) : std::move(key);
+  }
+  V DupVal(const V& val) const {
+    return type_.val_dup ? type_.val_dup(val) : val;
+  }
+  V DupVal(V&& val) const {
+    return type_.val_dup ? type_.val_dup(val) : std::move(val);
+  }
+  void DestroyKey(K& key) const {
+    if (type_.key_destructor) {
+      type_.key_destructor(key);
+    }
+  }
+  void DestroyVal(V& val) const {
+    if (type_.val_destructor) {
+      type_.val_destructor(val);
+    }
+  }
+
+ private:
+  DictType<K, V> type_;
+};
+
+/*
+ * Stateless hooks resolved at compile time: HashString for std::string keys and
+ * std::hash otherwise, operator==, no copies on insert and no destructor
+ * callbacks. All calls inline into the dict.
+ */
+template <typename K, typename V>
+struct DefaultDictPolicy {
+  static size_t Hash(const K& key) {
+    if constexpr (std::is_same<K, std::string>::value) {
+      return HashString(key);
+    } else {
+      return std::hash<K>()(key);
+    }
+  }
+  static size_t Hash(std::string_view key) { return HashString(key); }
+  static bool Equal(const K& key1, const K& key2) { return key1 == key2; }
+  static bool Equal(std::string_view key1, const K& key2) {
+    return key1 == std::string_view(key2);
+  }
+  static const K& DupKey(const K& key) { return key; }
+  static K&& DupKey(K&& key) { return std::move(key); }
+  static const V& DupVal(const V& val) { return val; }
+  static V&& DupVal(V&& val) { return std::move(val); }
+  static void DestroyKey(K&) {}
+  static void DestroyVal(V&) {}
+};
+
+/*
+ * DefaultDictPolicy for std::string keys whose bytes are embedded in the dict
+ * entry: one allocation per entry, and no separate key buffer to chase during
+ * lookups.
+ */
+template <typename V>
+struct EmbeddedKeyDictPolicy : DefaultDictPolicy<std::string, V> {
+  static constexpr bool kEmbedKey = true;
+  static bool Equal(std::string_view key1, std::string_view key2) {
+    return key1 == key2;
+  }
+};
+}  // namespace redis_simple::in_memory
@@ -2,11 +2,16 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <optional>
+#include <set>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 namespace redis_simple::in_memory {
 TEST(DictStrTest, Init) {
@@ -20,6 +25,75 @@ TEST(DictStrTest, CustomDictionaryRequiresHashFunction) {
   EXPECT_EQ((Dict<std::string, std::string>::Create(type)), nullptr);
 }
 
+namespace {
+// Hashes and compares ASCII keys case-insensitively.
+struct CaseInsensitivePolicy : DefaultDictPolicy<std::string, std::string> {
+  static char Lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+  }
+  static size_t Hash(std::string_view key) {
+    std::string lower(key);
+    for (char& c : lower) {
+      c = Lower(c);
+    }
+    return std::hash<std::string>()(lower);
+  }
+  static bool Equal(std::string_view key1, std::string_view key2) {
+    return key1.size() == key2.size() &&
+           std::equal(key1.begin(), key1.end(), key2.begin(),
+                      [](char a, char b) { return Lower(a) == Lower(b); });
+  }
+};
+}  // namespace
+
+TEST(DictStrTest, CompileTimePolicyHooks) {
+  auto dict = Dict<std::string, std::string, CaseInsensitivePolicy>::Create();
+  ASSERT_TRUE(dict->Insert("Key", "val"));
+  ASSERT_FALSE(dict->Insert("KEY", "other"));
+  ASSERT_EQ(dict->Size(), 1);
+  ASSERT_EQ(dict->Get("kEy"), "val");
+
+  auto* value = dict->FindValue(std::string_view("key"));
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, "val");
+  EXPECT_TRUE(dict->Delete("KEY"));
+  EXPECT_EQ(dict->Size(), 0);
+}
+
+TEST(DictStrTest, EmbeddedKeysSupportLookupAndIteration) {
+  using EmbeddedDict = Dict<std::string, std::unique_ptr<int>,
+                            EmbeddedKeyDictPolicy<std::unique_ptr<int>>>;
+  auto dict = EmbeddedDict::Create();
+  const std::string long_key(40, 'k');
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(dict->Insert(long_key + std::to_string(i),
+                             std::make_unique<int>(i)));
+  }
+  ASSERT_FALSE(dict->Insert(long_key + "7", std::make_unique<int>(0)));
+  dict->Set(long_key + "7", std::make_unique<int>(700));
+
+  const std::string lookup = "xx" + long_key + "7yy";
+  auto* value = dict->FindValue(std::string_view(lookup).substr(2, 41));
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(**value, 700);
+  EXPECT_EQ(dict->FindValue(std::string_view(long_key)), nullptr);
+
+  auto extracted = dict->Extract(long_key + "8");
+  ASSERT_TRUE(extracted.has_value());
+  EXPECT_EQ(**extracted, 8);
+  EXPECT_TRUE(dict->Delete(long_key + "9"));
+
+  std::set<std::string> keys;
+  auto it = EmbeddedDict::Iterator(dict.get());
+  for (it.SeekToFirst(); it.Valid(); it.Next()) {
+    const std::string_view key = it.Key();
+    ASSERT_EQ(key.substr(0, long_key.size()), long_key);
+    ASSERT_TRUE(keys.emplace(key).second);
+  }
+  EXPECT_EQ(keys.size(), 98);
+  EXPECT_EQ(keys.count(long_key + "8"), 0);
+}
+
 TEST(DictStrTest, Insert) {
   auto dict_str = Dict<std::string, std::string>::Create();
   auto status = dict_str->Insert("key", "val");
@@ -65,6 +139,29 @@ TEST(DictStrTest, FindValueSupportsNonOwningLookup) {
   ASSERT_EQ(dict_str->FindValue(std::string_view("missing")), nullptr);
 }
 
+TEST(DictStrTest, FindManyResolvesEveryKeyAcrossRehash) {
+  auto dict = Dict<std::string, int>::Create();
+  std::vector<std::string> keys;
+  // Stop inserting while a rehash is in progress so both tables are searched.
+  for (int i = 0; i < 100 || !dict->IsRehashing(); ++i) {
+    keys.push_back("key:" + std::to_string(i));
+    ASSERT_TRUE(dict->Insert(keys.back(), i));
+  }
+  const size_t inserted = keys.size();
+  keys.emplace_back("missing");
+  keys.push_back(keys.front());
+
+  const std::vector<std::string_view> lookups(keys.begin(), keys.end());
+  std::vector<int*> values(lookups.size());
+  dict->FindMany(lookups.data(), lookups.size(), values.data());
+  for (size_t i = 0; i < inserted; ++i) {
+    ASSERT_NE(values[i], nullptr) << i;
+    EXPECT_EQ(*values[i], static_cast<int>(i));
+  }
+  EXPECT_EQ(values[inserted], nullptr);
+  EXPECT_EQ(values[inserted + 1], values[0]);
+}
+
 TEST(DictStrTest, Delete) {
   auto dict_str = Dict<std::string, std::string>::Create();
   ASSERT_TRUE(dict_str->Insert("key", "val"));
@@ -148,6 +245,133 @@ TEST(DictIntTest, Iterator) {
   ASSERT_FALSE(it.Valid());
 }
 
+TEST(DictIntTest, ScanReturnsStableEntriesAcrossRehash) {
+  auto dict_int = MakeIntDictWithEntries();
+  std::set<int> keys;
+  std::optional<size_t> cursor = 0;
+  int next_key = 129;
+  while (cursor.has_value()) {
+    cursor = dict_int->Scan(*cursor, [&keys](const int& key, const int&) {
+      keys.insert(key);
+    });
+    // Keep the dict growing and rehashing while the scan is in progress.
+    for (int added = 0; added < 16; ++added, ++next_key) {
+      dict_int->Insert(next_key, next_key);
+    }
+  }
+  for (int key = 0; key < 129; ++key) {
+    EXPECT_EQ(keys.count(key), 1) << key;
+  }
+}
+
+TEST(DictIntTest, ShrinksIncrementallyAfterMassDelete) {
+  auto dict_int = Dict<int, int>::Create();
+  for (int i = 0; i < 4096; ++i) {
+    dict_int->Insert(i, i);
+  }
+  while (dict_int->Rehash(100)) {
+  }
+  ASSERT_FALSE(dict_int->IsRehashing());
+
+  bool shrink_started = false;
+  for (int i = 16; i < 4096; ++i) {
+    ASSERT_TRUE(dict_int->Delete(i));
+    shrink_started = shrink_started || dict_int->IsRehashing();
+  }
+  EXPECT_TRUE(shrink_started);
+  while (dict_int->Rehash(100)) {
+  }
+  EXPECT_FALSE(dict_int->ShrinkIfNeeded());
+  ASSERT_EQ(dict_int->Size(), 16);
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(dict_int->Get(i), i);
+  }
+}
+
+TEST(DictIntTest, ScanReturnsStableEntriesAcrossShrink) {
+  auto dict_int = Dict<int, int>::Create();
+  for (int i = 0; i < 1024; ++i) {
+    dict_int->Insert(i, i);
+  }
+  std::set<int> keys;
+  std::optional<size_t> cursor = 0;
+  int next_delete = 64;
+  while (cursor.has_value()) {
+    cursor = dict_int->Scan(*cursor, [&keys](const int& key, const int&) {
+      keys.insert(key);
+    });
+    // Delete keys outside the retained range so the table shrinks mid-scan.
+    for (int deleted = 0; deleted < 32 && next_delete < 1024;
+         ++deleted, ++next_delete) {
+      dict_int->Delete(next_delete);
+    }
+  }
+  for (int key = 0; key < 64; ++key) {
+    EXPECT_EQ(keys.count(key), 1) << key;
+  }
+}
+
+TEST(DictIntTest, ReserveAndBulkInsertSkipRehashing) {
+  auto dict_int = Dict<int, int>::Create();
+  for (int i = 0; i < 64; ++i) {
+    dict_int->Insert(i, i);
+  }
+  ASSERT_TRUE(dict_int->Reserve(4096));
+  ASSERT_FALSE(dict_int->IsRehashing());
+  const size_t buckets = dict_int->BucketCount();
+  EXPECT_GE(buckets, 4096);
+
+  for (int i = 64; i < 4096; ++i) {
+    dict_int->BulkInsert(int{i}, int{i});
+    ASSERT_FALSE(dict_int->IsRehashing());
+  }
+  EXPECT_EQ(dict_int->BucketCount(), buckets);
+  ASSERT_EQ(dict_int->Size(), 4096);
+  for (int i = 0; i < 4096; ++i) {
+    EXPECT_EQ(dict_int->Get(i), i);
+  }
+  EXPECT_TRUE(dict_int->Reserve(16));
+  EXPECT_EQ(dict_int->BucketCount(), buckets);
+}
+
+TEST(DictIntTest, RandomEntryIsUniformAcrossRehash) {
+  auto dict = Dict<int, int>::Create();
+  int size = 0;
+  for (; size < 100 || !dict->IsRehashing(); ++size) {
+    ASSERT_TRUE(dict->Insert(size, size));
+  }
+  // Each draw may advance the rehash; draws must stay uniform throughout.
+  const int draws = size * 200;
+  std::vector<int> hits(size);
+  for (int draw = 0; draw < draws; ++draw) {
+    ASSERT_TRUE(dict->RandomEntry([&hits](const int& key, const int& val) {
+      ASSERT_EQ(key, val);
+      ++hits[key];
+    }));
+  }
+  for (int key = 0; key < size; ++key) {
+    EXPECT_GT(hits[key], 100) << key;
+    EXPECT_LT(hits[key], 300) << key;
+  }
+  auto empty = Dict<int, int>::Create();
+  EXPECT_FALSE(empty->RandomEntry([](const int&, const int&) { FAIL(); }));
+}
+
+TEST(DictIntTest, SampleEntriesVisitsDistinctEntries) {
+  auto dict = MakeIntDictWithEntries();
+  // Cover rejection sampling, the selection pass and oversized requests.
+  for (const size_t count : {0, 5, 42, 43, 100, 129, 500}) {
+    std::set<int> keys;
+    const size_t sampled =
+        dict->SampleEntries(count, [&keys](const int& key, const int& val) {
+          ASSERT_EQ(key, val);
+          ASSERT_TRUE(keys.insert(key).second);
+        });
+    EXPECT_EQ(sampled, std::min<size_t>(count, 129));
+    EXPECT_EQ(keys.size(), sampled);
+  }
+}
+
 TEST(DictIntTest, Clear) {
   auto dict_int = MakeIntDictWithEntries();
   dict_int->Clear();
@@ -161,4 +385,20 @@ TEST(DictIntTest, Clear) {
   ASSERT_EQ(dict_int->Size(), 1);
   ASSERT_EQ(dict_int->Get(1), 10);
 }
+
+TEST(DictStrTest, BytesMatchUsedMemoryAndSamplesExtrapolate) {
+  const size_t before = UsedMemory();
+  auto dict = Dict<std::string, std::string>::Create();
+  for (int i = 0; i < 2000; ++i) {
+    dict->Insert("key:" + std::to_string(i),
+                 "a value long enough to need the heap " + std::to_string(i));
+  }
+  const size_t used = UsedMemory() - before;
+  const size_t bytes = AllocationBytes(dict.get()) + dict->Bytes();
+  EXPECT_NEAR(static_cast<double>(bytes), static_cast<double>(used),
+              static_cast<double>(used) * 0.05);
+  EXPECT_NEAR(static_cast<double>(dict->Bytes(100)),
+              static_cast<double>(dict->Bytes()),
+              static_cast<double>(dict->Bytes()) * 0.1);
+}
 }  // namespace redis_simple::in_memory
@@ -10,6 +10,8 @@
 #include <string_view>
 #include <utility>
 
+#include "memory/used_memory.h"
+
 namespace redis_simple::in_memory {
 DynamicBuffer::DynamicBuffer()
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays): contiguous byte buffer
@@ -18,6 +20,8 @@ DynamicBuffer::DynamicBuffer()
       size_(0),
       processed_(0) {}
 
+size_t DynamicBuffer::Bytes() const { return AllocationBytes(buf_.get()); }
+
 void DynamicBuffer::Append(const char* buffer, size_t n) {
   if (n == 0) {
     return;
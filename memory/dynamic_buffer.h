@@ -13,6 +13,8 @@ class DynamicBuffer {
  public:
   DynamicBuffer();
   size_t Capacity() const { return capacity_; }
+  // Heap bytes of the buffer.
+  size_t Bytes() const;
   size_t Size() const { return size_; }
   size_t Consumed() const { return processed_; }
   void Consume(size_t processed) {
@@ -0,0 +1,798 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "memory/hash_function.h"
+#include "memory/prefetch.h"
+#include "memory/random.h"
+#include "memory/scan_cursor.h"
+#include "memory/used_memory.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace redis_simple::in_memory {
+/*
+ * Open-addressing hash table with Swiss-table control bytes. Every slot has one
+ * control byte that marks it empty, deleted, or full; full slots store the low
+ * seven hash bits, so a probe compares 16 control bytes at once (with SSE2 when
+ * available) and only touches slots whose hash fragment matches.
+ *
+ * The public API mirrors Dict so owners can switch backends with a type alias.
+ * Growth and shrinking rebuild the table in one step instead of rehashing
+ * incrementally. Deletes never shrink the table on their own, so slot
+ * addresses stay stable until ShrinkIfNeeded() or an insert runs.
+ * Scan visitors must not mutate the dict.
+ */
+template <typename K, typename V>
+class FlatDict {
+ public:
+  class Iterator;
+  static std::unique_ptr<FlatDict<K, V>> Create();
+  static std::unique_ptr<FlatDict<K, V>> Create(size_t capacity);
+  FlatDict(const FlatDict&) = delete;
+  FlatDict& operator=(const FlatDict&) = delete;
+  std::optional<V> Get(const K& key);
+  V* FindValue(const K& key);
+  V* FindValue(std::string_view key);
+  V* FindValue(const char* key);
+  void FindMany(const std::string_view* keys, size_t count, V** values);
+  void PrefetchKey(std::string_view key) const;
+  void PrefetchBuckets(size_t hash) const { PrefetchGroup(hash); }
+  void Set(const K& key, const V& val);
+  void Set(const K& key, V&& val);
+  void Set(K&& key, V&& val);
+  bool Insert(const K& key, const V& val);
+  bool Insert(K&& key, V&& val);
+  void BulkInsert(K&& key, V&& val);
+  bool Delete(const K& key);
+  bool Delete(std::string_view key);
+  bool Delete(const char* key) { return Delete(std::string_view(key)); }
+  std::optional<V> Extract(const K& key);
+  std::optional<V> Extract(std::string_view key);
+  std::optional<V> Extract(const char* key) {
+    return Extract(std::string_view(key));
+  }
+  // Variants for callers that already hashed key, e.g. to pick a shard. hash
+  // must be what the dict itself computes for key.
+  V* FindValue(std::string_view key, size_t hash);
+  // The key as stored in the dict, or std::nullopt if it is absent. The view
+  // is invalidated by anything that can resize the dict.
+  std::optional<std::string_view> FindKey(std::string_view key, size_t hash);
+  void Set(K&& key, V&& val, size_t hash);
+  bool Delete(std::string_view key, size_t hash);
+  std::optional<V> Extract(std::string_view key, size_t hash);
+  template <typename Visitor>
+  std::optional<size_t> Scan(size_t cursor, Visitor&& visitor);
+  template <typename Visitor>
+  bool RandomEntry(Visitor&& visitor);
+  // Visit up to count distinct entries chosen uniformly at random.
+  template <typename Visitor>
+  size_t SampleEntries(size_t count, Visitor&& visitor) {
+    return SampleDistinctEntries(this, count, std::forward<Visitor>(visitor));
+  }
+  size_t Size() const { return size_; }
+  bool IsRehashing() const { return false; }
+  size_t BucketCount() const { return capacity_; }
+  std::optional<size_t> RehashIndex() const { return std::nullopt; }
+  // Heap bytes of the control bytes and slots, including what keys and values
+  // own. With samples, only that many entries are measured and the rest are
+  // taken to be of the same average size.
+  size_t Bytes(size_t samples = 0) const;
+  bool Reserve(size_t size);
+  bool ShrinkIfNeeded();
+  // There is never a pending migration; kept for API parity with Dict.
+  bool Rehash(int) { return false; }
+  void Clear();
+  ~FlatDict();
+
+ private:
+  struct Slot {
+    K key;
+    V val;
+  };
+  class Group;
+  using Ctrl = int8_t;
+  static constexpr Ctrl kEmpty = -128;
+  static constexpr Ctrl kDeleted = -2;
+  static constexpr size_t kGroupWidth = 16;
+  static constexpr size_t kNotFound = std::numeric_limits<size_t>::max();
+  // Grow once full and deleted slots reach 7/8 of the capacity.
+  static constexpr size_t kMaxLoadNumerator = 7;
+  static constexpr size_t kMaxLoadDenominator = 8;
+  // Shrink when at most 1/kMinFill of the slots are full.
+  static constexpr size_t kMinFill = 16;
+  // Keys looked up together by FindMany().
+  static constexpr size_t kFindManyBatch = 16;
+  FlatDict() = default;
+  static size_t Mix(size_t hash);
+  static size_t CapacityFor(size_t size);
+  size_t KeyHash(const K& key) const;
+  size_t StringViewKeyHash(std::string_view key) const;
+  void PrefetchGroup(size_t hash) const;
+  static size_t LowestBit(uint32_t mask) {
+    return static_cast<size_t>(__builtin_ctz(mask));
+  }
+  static Ctrl H2(size_t hash) { return static_cast<Ctrl>(hash & 0x7F); }
+  size_t HomeGroup(size_t hash) const { return (hash >> 7) & GroupMask(); }
+  size_t GroupMask() const {
+    return capacity_ == 0 ? 0 : (capacity_ / kGroupWidth) - 1;
+  }
+  size_t GrowthLimit() const {
+    return capacity_ / kMaxLoadDenominator * kMaxLoadNumerator;
+  }
+  template <typename Key>
+  size_t FindSlot(const Key& key, size_t hash) const;
+  size_t FindInsertSlot(size_t hash) const;
+  template <typename Key>
+  size_t InsertSlot(Key&& key, size_t hash, bool* inserted);
+  template <typename Key>
+  size_t InsertNewSlot(Key&& key, size_t hash);
+  void EraseSlot(size_t slot);
+  void Resize(size_t capacity);
+  void ReserveForInsert();
+  void DestroySlots();
+
+  std::unique_ptr<Ctrl[]> ctrl_;
+  Slot* slots_{nullptr};
+  size_t capacity_{};
+  size_t size_{};
+  // Number of empty slots that can still be filled before the table grows.
+  size_t growth_left_{};
+};
+
+template <typename K, typename V>
+class FlatDict<K, V>::Group {
+ public:
+  explicit Group(const Ctrl* ctrl) {
+#if defined(__SSE2__)
+    ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+    for (size_t index = 0; index < kGroupWidth; ++index) {
+      ctrl_[index] = ctrl[index];
+    }
+#endif
+  }
+  uint32_t Match(Ctrl h2) const {
+#if defined(__SSE2__)
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+#else
+    return MatchIf([h2](Ctrl ctrl) { return ctrl == h2; });
+#endif
+  }
+  uint32_t MatchEmpty() const {
+#if defined(__SSE2__)
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(kEmpty), ctrl_)));
+#else
+    return MatchIf([](Ctrl ctrl) { return ctrl == kEmpty; });
+#endif
+  }
+  // Empty and deleted control bytes are the only negative values.
+  uint32_t MatchEmptyOrDeleted() const {
+#if defined(__SSE2__)
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+#else
+    return MatchIf([](Ctrl ctrl) { return ctrl < 0; });
+#endif
+  }
+  uint32_t MatchFull() const {
+    return ~MatchEmptyOrDeleted() & ((uint32_t{1} << kGroupWidth) - 1);
+  }
+
+ private:
+#if defined(__SSE2__)
+  __m128i ctrl_;
+#else
+  template <typename Predicate>
+  uint32_t MatchIf(Predicate predicate) const {
+    uint32_t mask = 0;
+    for (size_t index = 0; index < kGroupWidth; ++index) {
+      if (predicate(ctrl_[index])) {
+        mask |= uint32_t{1} << index;
+      }
+    }
+    return mask;
+  }
+  Ctrl ctrl_[kGroupWidth];
+#endif
+};
+
+template <typename K, typename V>
+class FlatDict<K, V>::Iterator {
+ public:
+  explicit Iterator(const FlatDict* dict) : dict_(dict), slot_(kNotFound) {}
+  Iterator& operator=(const Iterator& it) = default;
+  bool operator==(const Iterator& it) const {
+    return dict_ == it.dict_ && slot_ == it.slot_;
+  }
+  bool operator!=(const Iterator& it) const { return !((*this) == it); }
+  bool Valid() const { return slot_ != kNotFound; }
+  void SeekToFirst() {
+    slot_ = kNotFound;
+    SeekFrom(0);
+  }
+  void SeekToLast() {
+    slot_ = kNotFound;
+    for (size_t slot = dict_->capacity_; slot > 0; --slot) {
+      if (dict_->ctrl_[slot - 1] >= 0) {
+        slot_ = slot - 1;
+        return;
+      }
+    }
+  }
+  void Next() { SeekFrom(slot_ + 1); }
+  Iterator& operator++() {
+    Next();
+    return *this;
+  }
+  const K& Key() const { return dict_->slots_[slot_].key; }
+  const V& Value() const { return dict_->slots_[slot_].val; }
+
+ private:
+  void SeekFrom(size_t slot) {
+    for (; slot < dict_->capacity_; ++slot) {
+      if (dict_->ctrl_[slot] >= 0) {
+        slot_ = slot;
+        return;
+      }
+    }
+    slot_ = kNotFound;
+  }
+  const FlatDict* dict_;
+  size_t slot_;
+};
+
+template <typename K, typename V>
+std::unique_ptr<FlatDict<K, V>> FlatDict<K, V>::Create() {
+  return std::unique_ptr<FlatDict<K, V>>(new FlatDict<K, V>());
+}
+
+template <typename K, typename V>
+std::unique_ptr<FlatDict<K, V>> FlatDict<K, V>::Create(size_t capacity) {
+  const size_t table_capacity = CapacityFor(capacity);
+  if (table_capacity == 0) {
+    return nullptr;
+  }
+  std::unique_ptr<FlatDict<K, V>> dict(new FlatDict<K, V>());
+  dict->Resize(table_capacity);
+  return dict;
+}
+
+template <typename K, typename V>
+std::optional<V> FlatDict<K, V>::Get(const K& key) {
+  const size_t slot = FindSlot(key, KeyHash(key));
+  if (slot == kNotFound) {
+    return std::nullopt;
+  }
+  return slots_[slot].val;
+}
+
+template <typename K, typename V>
+V* FlatDict<K, V>::FindValue(const K& key) {
+  const size_t slot = FindSlot(key, KeyHash(key));
+  return slot == kNotFound ? nullptr : &slots_[slot].val;
+}
+
+template <typename K, typename V>
+V* FlatDict<K, V>::FindValue(std::string_view key) {
+  return FindValue(key, StringViewKeyHash(key));
+}
+
+template <typename K, typename V>
+V* FlatDict<K, V>::FindValue(std::string_view key, size_t hash) {
+  static_assert(std::is_same<K, std::string>::value,
+                "std::string_view lookup only supports std::string keys");
+  const size_t slot = FindSlot(key, hash);
+  return slot == kNotFound ? nullptr : &slots_[slot].val;
+}
+
+template <typename K, typename V>
+std::optional<std::string_view> FlatDict<K, V>::FindKey(std::string_view key,
+                                                        size_t hash) {
+  static_assert(std::is_same<K, std::string>::value,
+                "std::string_view lookup only supports std::string keys");
+  const size_t slot = FindSlot(key, hash);
+  if (slot == kNotFound) {
+    return std::nullopt;
+  }
+  return std::string_view(slots_[slot].key);
+}
+
+template <typename K, typename V>
+V* FlatDict<K, V>::FindValue(const char* key) {
+  return FindValue(std::string_view(key));
+}
+
+/*
+ * Look up count keys, storing a pointer to each value (or null if the key is
+ * missing) in values. The home group of every key in a batch is prefetched
+ * before any of them is probed.
+ */
+template <typename K, typename V>
+void FlatDict<K, V>::FindMany(const std::string_view* keys, size_t count,
+                              V** values) {
+  static_assert(std::is_same<K, std::string>::value,
+                "std::string_view lookup only supports std::string keys");
+  std::array<size_t, kFindManyBatch> hashes{};
+  for (size_t start = 0; start < count; start += kFindManyBatch) {
+    const size_t group = std::min(kFindManyBatch, count - start);
+    for (size_t i = 0; i < group; ++i) {
+      hashes[i] = StringViewKeyHash(keys[start + i]);
+      PrefetchGroup(hashes[i]);
+    }
+    for (size_t i = 0; i < group; ++i) {
+      const size_t slot = FindSlot(keys[start + i], hashes[i]);
+      values[start + i] = slot == kNotFound ? nullptr : &slots_[slot].val;
+    }
+  }
+}
+
+template <typename K, typename V>
+void FlatDict<K, V>::PrefetchKey(std::string_view key) const {
+  static_assert(std::is_same<K, std::string>::value,
+                "std::string_view lookup only supports std::string keys");
+  PrefetchGroup(StringViewKeyHash(key));
+}
+
+// Prefetch the control bytes and first slots of the hash's home group.
+template <typename K, typename V>
+void FlatDict<K, V>::PrefetchGroup(size_t hash) const {
+  if (capacity_ == 0) {
+    return;
+  }
+  const size_t offset = HomeGroup(hash) * kGroupWidth;
+  Prefetch(ctrl_.get() + offset);
+  Prefetch(slots_ + offset);
+}
+
+template <typename K, typename V>
+void FlatDict<K, V>::Set(const K& key, const V& val) {
+  bool inserted = false;
+  const size_t slot = InsertSlot(key, KeyHash(key), &inserted);
+  slots_[slot].val = val;
+}
+
+template <typename K, typename V>
+void FlatDict<K, V>::Set(const K& key, V&& val) {
+  bool inserted = false;
+  const size_t slot = InsertSlot(key, KeyHash(key), &inserted);
+  slots_[slot].val = std::move(val);
+}
+
+template <typename K, typename V>
+void FlatDict<K, V>::Set(K&& key, V&& val) {
+  const size_t hash = KeyHash(key);
+  Set(std::move(key), std::move(val), hash);
+}
+
+template <typename K, typename V>
+void FlatDict<K, V>::Set(K&& key, V&& val, size_t hash) {
+  bool inserted = false;
+  const size_t slot = InsertSlot(std::move(key), hash, &inserted);
+  slots_[slot].val = std::move(val);
+}
+
+template <typename K, typename V>
+bool FlatDict<K, V>::Insert(const K& key, const V& val) {
+  bool inserted = false;
+  const size_t slot = InsertSlot(key, KeyHash(key), &inserted);
+  if (inserted) {
+    slots_[slot].val = val;
+  }
+  return inserted;
+}
+
+template <typename K, typename V>
+bool FlatDict<K, V>::Insert(K&& key, V&& val) {
+  bool inserted = false;
+  const size_t hash = KeyHash(key);
+  const size_t slot = InsertSlot(std::move(key), hash, &inserted);
+  if (inserted) {
+    slots_[slot].val = std::move(val);
+  }
+  return inserted;
+}
+
+/*
+ * Insert a key the caller knows is absent without probing for a duplicate.
+ */
+template <typename K, typename V>
+void FlatDict<K, V>::BulkInsert(K&& key, V&& val) {
+  const size_t hash = KeyHash(key);
+  const size_t slot = InsertNewSlot(std::move(key), hash);
+  slots_[slot].val = std::move(val);
+}
+
+template <typename K, typename V>
+bool FlatDict<K, V>::Delete(const K& key) {
+  const size_t slot = FindSlot(key, KeyHash(key));
+  if (slot == kNotFound) {
+    return false;
+  }
+  EraseSlot(slot);
+  return true;
+}
+
+template <typename K, typename V>
+bool FlatDict<K, V>::Delete(std::string_view key) {
+  return Delete(key, StringViewKeyHash(key));
+}
+
+template <typename K, typename V>
+bool FlatDict<K, V>::Delete(std::string_view key, size_t hash) {
+  static_assert(std::is_same<K, std::string>::value,
+                "std::string_view deletion only supports std::string keys");
+  const size_t slot = FindSlot(key, hash);
+  if (slot == kNotFound) {
+    return false;
+  }
+  EraseSlot(slot);
+  return true;
+}
+
+template <typename K, typename V>
+std::optional<V> FlatDict<K, V>::Extract(const K& key) {
+  const size_t slot = FindSlot(key, KeyHash(key));
+  if (slot == kNotFound) {
+    return std::nullopt;
+  }
+  std::optional<V> value(std::move(slots_[slot].val));
+  EraseSlot(slot);
+  return value;
+}
+
+template <typename K, typename V>
+std::optional<V> FlatDict<K, V>::Extract(std::string_view key) {
+  return Extract(key, StringViewKeyHash(key));
+}
+
+template <typename K, typename V>
+std::optional<V> FlatDict<K, V>::Extract(std::string_view key, size_t hash) {
+  static_assert(std::is_same<K, std::string>::value,
+                "std::string_view extraction only supports std::string keys");
+  const size_t slot = FindSlot(key, hash);
+  if (slot == kNotFound) {
+    return std::nullopt;
+  }
+  std::optional<V> value(std::move(slots_[slot].val));
+  EraseSlot(slot);
+  return value;
+}
+
+/*
+ * Visit every entry whose home group is addressed by the cursor and return the
+ * next cursor, or std::nullopt once the whole dict has been visited. Entries
+ * homed at a group can only live along its probe sequence up to the first group
+ * that still has an empty slot, so the walk stops there. Cursors advance in
+ * reverse-binary order over home groups, which keeps Dict's guarantee that
+ * entries present for the whole scan are returned across resizes.
+ */
+template <typename K, typename V>
+template <typename Visitor>
+std::optional<size_t> FlatDict<K, V>::Scan(size_t cursor, Visitor&& visitor) {
+  if (capacity_ == 0) {
+    return std::nullopt;
+  }
+  const size_t mask = GroupMask();
+  const size_t home = cursor & mask;
+  size_t group = home;
+  for (size_t probe = 0; probe <= mask; ++probe) {
+    const Group ctrl(ctrl_.get() + (group * kGroupWidth));
+    for (uint32_t full = ctrl.MatchFull(); full != 0; full &= full - 1) {
+      const Slot& slot = slots_[(group * kGroupWidth) + LowestBit(full)];
+      if (HomeGroup(KeyHash(slot.key)) == home) {
+        visitor(slot.key, slot.val);
+      }
+    }
+    if (ctrl.MatchEmpty() != 0) {
+      break;
+    }
+    group = (group + probe + 1) & mask;
+  }
+  cursor = NextScanCursor(cursor, mask);
+  return cursor == 0 ? std::nullopt : std::optional<size_t>(cursor);
+}
+
+/*
+ * Pass an entry chosen uniformly at random to visitor and return true, or
+ * return false if the dict is empty. Slots are drawn until a full one is hit,
+ * which takes capacity / size draws on average.
+ */
+template <typename K, typename V>
+template <typename Visitor>
+bool FlatDict<K, V>::RandomEntry(Visitor&& visitor) {
+  if (size_ == 0) {
+    return false;
+  }
+  while (true) {
+    const size_t slot = RandomIndex(capacity_);
+    if (ctrl_[slot] >= 0) {
+      const Slot& entry = slots_[slot];
+      visitor(entry.key, entry.val);
+      return true;
+    }
+  }
+}
+
+template <typename K, typename V>
+void FlatDict<K, V>::Clear() {
+  DestroySlots();
+  ctrl_.reset();
+  capacity_ = 0;
+  size_ = 0;
+  growth_left_ = 0;
+}
+
+template <typename K, typename V>
+FlatDict<K, V>::~FlatDict() {
+  Clear();
+}
+
+/*
+ * Spread hash bits so sequential integer hashes still vary in both the home
+ * group and the seven-bit control fragment.
+ */
+template <typename K, typename V>
+size_t FlatDict<K, V>::Mix(size_t hash) {
+  if constexpr (std::numeric_limits<size_t>::digits == 64) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+  } else {
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bU;
+    hash ^= hash >> 16;
+  }
+  return hash;
+}
+
+/*
+ * Return the smallest power-of-two capacity that holds size entries below the
+ * maximum load factor, or 0 on overflow.
+ */
+template <typename K, typename V>
+size_t FlatDict<K, V>::CapacityFor(size_t size) {
+  constexpr size_t kMaxSize =
+      std::numeric_limits<size_t>::max() / 2 / sizeof(Slot);
+  if (size > kMaxSize / kMaxLoadDenominator) {
+    return 0;
+  }
+  const size_t minimum =
+      (size * kMaxLoadDenominator + kMaxLoadNumerator - 1) / kMaxLoadNumerator;
+  size_t capacity = kGroupWidth;
+  while (capacity < minimum) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+template <typename K, typename V>
+size_t FlatDict<K, V>::KeyHash(const K& key) const {
+  // HashString already avalanches, so only std::hash output needs Mix.
+  if constexpr (std::is_same<K, std::string>::value) {
+    return HashString(key);
+  } else {
+    return Mix(std::hash<K>()(key));
+  }
+}
+
+template <typename K, typename V>
+size_t FlatDict<K, V>::StringViewKeyHash(std::string_view key) const {
+  return HashString(key);
+}
+
+template <typename K, typename V>
+template <typename Key>
+size_t FlatDict<K, V>::FindSlot(const Key& key, size_t hash) const {
+  if (capacity_ == 0) {
+    return kNotFound;
+  }
+  const size_t mask = GroupMask();
+  const Ctrl h2 = H2(hash);
+  size_t group = HomeGroup(hash);
+  for (size_t probe = 0; probe <= mask; ++probe) {
+    const Group ctrl(ctrl_.get() + (group * kGroupWidth));
+    for (uint32_t match = ctrl.Match(h2); match != 0; match &= match - 1) {
+      const size_t slot = (group * kGroupWidth) + LowestBit(match);
+      if (key == slots_[slot].key) {
+        return slot;
+      }
+    }
+    if (ctrl.MatchEmpty() != 0) {
+      return kNotFound;
+    }
+    group = (group + probe + 1) & mask;
+  }
+  return kNotFound;
+}
+
+template <typename K, typename V>
+size_t FlatDict<K, V>::FindInsertSlot(size_t hash) const {
+  const size_t mask = GroupMask();
+  size_t group = HomeGroup(hash);
+  for (size_t probe = 0; probe <= mask; ++probe) {
+    const Group ctrl(ctrl_.get() + (group * kGroupWidth));
+    const uint32_t available = ctrl.MatchEmptyOrDeleted();
+    if (available != 0) {
+      return (group * kGroupWidth) + LowestBit(available);
+    }
+    group = (group + probe + 1) & mask;
+  }
+  return kNotFound;
+}
+
+/*
+ * Return the slot holding key, inserting a slot with a default value when the
+ * key is missing.
+ */
+template <typename K, typename V>
+template <typename Key>
+size_t FlatDict<K, V>::InsertSlot(Key&& key, size_t hash, bool* inserted) {
+  const size_t existing = FindSlot(key, hash);
+  if (existing != kNotFound) {
+    *inserted = false;
+    return existing;
+  }
+  *inserted = true;
+  return InsertNewSlot(std::forward<Key>(key), hash);
+}
+
+template <typename K, typename V>
+template <typename Key>
+size_t FlatDict<K, V>::InsertNewSlot(Key&& key, size_t hash) {
+  ReserveForInsert();
+  const size_t slot = FindInsertSlot(hash);
+  // Reusing a tombstone needs no growth budget, but filling an empty slot does.
+  if (ctrl_[slot] == kEmpty) {
+    --growth_left_;
+  }
+  ::new (static_cast<void*>(&slots_[slot])) Slot{std::forward<Key>(key), V()};
+  ctrl_[slot] = H2(hash);
+  ++size_;
+  return slot;
+}
+
+/*
+ * Destroy the entry in slot. A group that still has an empty slot was never
+ * full, so no probe sequence continues past it and the slot can become empty
+ * again instead of a tombstone.
+ */
+template <typename K, typename V>
+void FlatDict<K, V>::EraseSlot(size_t slot) {
+  slots_[slot].~Slot();
+  const size_t group_start = slot - (slot % kGroupWidth);
+  if (Group(ctrl_.get() + group_start).MatchEmpty() != 0) {
+    ctrl_[slot] = kEmpty;
+    ++growth_left_;
+  } else {
+    ctrl_[slot] = kDeleted;
+  }
+  --size_;
+}
+
+template <typename K, typename V>
+size_t FlatDict<K, V>::Bytes(size_t samples) const {
+  const size_t table_bytes =
+      AllocationBytes(ctrl_.get()) + AllocationBytes(slots_);
+  const size_t limit = samples == 0 ? size_ : std::min(samples, size_);
+  size_t measured = 0;
+  size_t owned_bytes = 0;
+  for (size_t slot = 0; slot < capacity_ && measured < limit; ++slot) {
+    if (ctrl_[slot] >= 0) {
+      const Slot& entry = slots_[slot];
+      owned_bytes += OwnedBytes(entry.key) + OwnedBytes(entry.val);
+      ++measured;
+    }
+  }
+  return table_bytes + (measured == 0 ? 0 : owned_bytes * size_ / measured);
+}
+
+/*
+ * Rebuild the table with the given capacity, dropping all tombstones.
+ */
+template <typename K, typename V>
+void FlatDict<K, V>::Resize(size_t capacity) {
+  std::unique_ptr<Ctrl[]> old_ctrl = std::move(ctrl_);
+  Slot* const old_slots = slots_;
+  const size_t old_capacity = capacity_;
+
+  ctrl_ = std::make_unique<Ctrl[]>(capacity);
+  std::fill(ctrl_.get(), ctrl_.get() + capacity, kEmpty);
+  slots_ = std::allocator<Slot>().allocate(capacity);
+  capacity_ = capacity;
+  growth_left_ = GrowthLimit() - size_;
+
+  for (size_t slot = 0; slot < old_capacity; ++slot) {
+    if (old_ctrl[slot] < 0) {
+      continue;
+    }
+    Slot& old_slot = old_slots[slot];
+    const size_t hash = KeyHash(old_slot.key);
+    const size_t new_slot = FindInsertSlot(hash);
+    ::new (static_cast<void*>(&slots_[new_slot])) Slot(std::move(old_slot));
+    ctrl_[new_slot] = H2(hash);
+    old_slot.~Slot();
+  }
+  if (old_slots != nullptr) {
+    std::allocator<Slot>().deallocate(old_slots, old_capacity);
+  }
+}
+
+/*
+ * Make sure one more empty slot can be filled without exceeding the maximum
+ * load factor. Tables dominated by tombstones are rebuilt at the same size.
+ */
+template <typename K, typename V>
+void FlatDict<K, V>::ReserveForInsert() {
+  if (growth_left_ > 0) {
+    return;
+  }
+  if (capacity_ > 0 && size_ < GrowthLimit() / 2) {
+    Resize(capacity_);
+    return;
+  }
+  Resize(capacity_ == 0 ? kGroupWidth : capacity_ * 2);
+}
+
+/*
+ * Grow the table so `size` entries fit under the maximum load factor. Return
+ * false if no such capacity can be allocated.
+ */
+template <typename K, typename V>
+bool FlatDict<K, V>::Reserve(size_t size) {
+  const size_t capacity = CapacityFor(size);
+  if (capacity == 0) {
+    return false;
+  }
+  if (capacity > capacity_) {
+    Resize(capacity);
+  }
+  return true;
+}
+
+/*
+ * Rebuild a sparse table at a capacity that leaves the remaining entries at
+ * most half of the maximum load. Return true if the table was shrunk.
+ */
+template <typename K, typename V>
+bool FlatDict<K, V>::ShrinkIfNeeded() {
+  if (capacity_ <= kGroupWidth || size_ * kMinFill > capacity_) {
+    return false;
+  }
+  const size_t capacity = CapacityFor(size_ * 2);
+  if (capacity == 0 || capacity >= capacity_) {
+    return false;
+  }
+  Resize(capacity);
+  return true;
+}
+
+template <typename K, typename V>
+void FlatDict<K, V>::DestroySlots() {
+  if (slots_ == nullptr) {
+    return;
+  }
+  for (size_t slot = 0; slot < capacity_; ++slot) {
+    if (ctrl_[slot] >= 0) {
+      slots_[slot].~Slot();
+    }
+  }
+  std::allocator<Slot>().deallocate(slots_, capacity_);
+  slots_ = nullptr;
+}
+}  // namespace redis_simple::in_memory
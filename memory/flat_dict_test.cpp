@@ -0,0 +1,229 @@
+#include "memory/flat_dict.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace redis_simple::in_memory {
+TEST(FlatDictStrTest, InsertSetAndGet) {
+  auto dict = FlatDict<std::string, std::string>::Create();
+  ASSERT_TRUE(dict);
+  ASSERT_EQ(dict->Size(), 0);
+
+  ASSERT_TRUE(dict->Insert("key", "val"));
+  ASSERT_FALSE(dict->Insert("key", "other"));
+  ASSERT_EQ(dict->Get("key"), "val");
+
+  dict->Set("key", "val_update");
+  ASSERT_EQ(dict->Size(), 1);
+  ASSERT_EQ(dict->Get("key"), "val_update");
+  ASSERT_FALSE(dict->Get("missing").has_value());
+}
+
+TEST(FlatDictStrTest, FindValueSupportsNonOwningLookup) {
+  auto dict = FlatDict<std::string, std::string>::Create();
+  ASSERT_TRUE(dict->Insert("prefix_key_suffix", "val"));
+
+  const std::string lookup = "xxprefix_key_suffixyy";
+  auto* value = dict->FindValue(std::string_view(lookup).substr(2, 17));
+
+  ASSERT_NE(value, nullptr);
+  ASSERT_EQ(*value, "val");
+  ASSERT_EQ(dict->FindValue(std::string_view("missing")), nullptr);
+}
+
+TEST(FlatDictStrTest, FindManyResolvesEveryKey) {
+  auto dict = FlatDict<std::string, int>::Create();
+  std::vector<std::string> keys;
+  for (int index = 0; index < 100; ++index) {
+    keys.push_back("key:" + std::to_string(index));
+    ASSERT_TRUE(dict->Insert(keys.back(), index));
+  }
+  keys.emplace_back("missing");
+  keys.push_back(keys.front());
+
+  const std::vector<std::string_view> lookups(keys.begin(), keys.end());
+  std::vector<int*> values(lookups.size());
+  dict->FindMany(lookups.data(), lookups.size(), values.data());
+  for (int index = 0; index < 100; ++index) {
+    ASSERT_NE(values[index], nullptr) << index;
+    EXPECT_EQ(*values[index], index);
+  }
+  EXPECT_EQ(values[100], nullptr);
+  EXPECT_EQ(values[101], values[0]);
+}
+
+TEST(FlatDictStrTest, DeleteAndExtract) {
+  auto dict = FlatDict<std::string, std::unique_ptr<int>>::Create();
+  dict->Set(std::string("key"), std::make_unique<int>(42));
+  dict->Set(std::string("other"), std::make_unique<int>(7));
+
+  auto value = dict->Extract(std::string_view("key"));
+  auto extracted = std::move(value).value_or(nullptr);
+  ASSERT_NE(extracted, nullptr);
+  EXPECT_EQ(*extracted, 42);
+  EXPECT_FALSE(dict->Extract(std::string_view("key")).has_value());
+
+  EXPECT_TRUE(dict->Delete("other"));
+  EXPECT_FALSE(dict->Delete("other"));
+  EXPECT_EQ(dict->Size(), 0);
+}
+
+TEST(FlatDictStrTest, ReusesDeletedSlotsUnderChurn) {
+  auto dict = FlatDict<std::string, int>::Create();
+  for (int round = 0; round < 64; ++round) {
+    for (int index = 0; index < 100; ++index) {
+      ASSERT_TRUE(dict->Insert(std::to_string(round * 100 + index), index));
+    }
+    for (int index = 0; index < 100; ++index) {
+      ASSERT_TRUE(dict->Delete(std::to_string(round * 100 + index)));
+    }
+  }
+  EXPECT_EQ(dict->Size(), 0);
+  ASSERT_TRUE(dict->Insert("last", 1));
+  EXPECT_EQ(dict->Get("last"), 1);
+}
+
+namespace {
+std::unique_ptr<FlatDict<int, int>> MakeFlatIntDictWithEntries(int count) {
+  auto dict = FlatDict<int, int>::Create();
+  for (int i = 0; i < count; ++i) {
+    dict->Insert(i, i);
+  }
+  return dict;
+}
+}  // namespace
+
+TEST(FlatDictIntTest, BatchInsertAndIterate) {
+  auto dict = MakeFlatIntDictWithEntries(1000);
+  ASSERT_EQ(dict->Size(), 1000);
+  ASSERT_EQ(dict->Get(96), 96);
+
+  std::set<int> keys;
+  auto it = FlatDict<int, int>::Iterator(dict.get());
+  for (it.SeekToFirst(); it.Valid(); it.Next()) {
+    ASSERT_EQ(it.Key(), it.Value());
+    ASSERT_TRUE(keys.insert(it.Key()).second);
+  }
+  EXPECT_EQ(keys.size(), 1000);
+}
+
+TEST(FlatDictIntTest, ScanVisitsEveryEntryOnce) {
+  auto dict = MakeFlatIntDictWithEntries(1000);
+  std::set<int> keys;
+  std::optional<size_t> cursor = 0;
+  while (cursor.has_value()) {
+    cursor = dict->Scan(*cursor, [&keys](const int& key, const int&) {
+      ASSERT_TRUE(keys.insert(key).second);
+    });
+  }
+  EXPECT_EQ(keys.size(), 1000);
+}
+
+TEST(FlatDictIntTest, ScanReturnsStableEntriesAcrossGrowth) {
+  auto dict = MakeFlatIntDictWithEntries(100);
+  std::set<int> keys;
+  std::optional<size_t> cursor = 0;
+  int next_key = 100;
+  while (cursor.has_value()) {
+    cursor = dict->Scan(*cursor, [&keys](const int& key, const int&) {
+      keys.insert(key);
+    });
+    // Grow the table several times while the scan is in progress.
+    for (int added = 0; added < 50; ++added, ++next_key) {
+      dict->Insert(next_key, next_key);
+    }
+  }
+  for (int key = 0; key < 100; ++key) {
+    EXPECT_EQ(keys.count(key), 1) << key;
+  }
+}
+
+TEST(FlatDictIntTest, ShrinkIfNeededKeepsRemainingEntries) {
+  auto dict = MakeFlatIntDictWithEntries(4096);
+  EXPECT_FALSE(dict->ShrinkIfNeeded());
+  for (int key = 16; key < 4096; ++key) {
+    ASSERT_TRUE(dict->Delete(key));
+  }
+  EXPECT_TRUE(dict->ShrinkIfNeeded());
+  EXPECT_FALSE(dict->ShrinkIfNeeded());
+  ASSERT_EQ(dict->Size(), 16);
+  for (int key = 0; key < 16; ++key) {
+    EXPECT_EQ(dict->Get(key), key);
+  }
+  ASSERT_TRUE(dict->Insert(4096, 4096));
+  EXPECT_EQ(dict->Get(4096), 4096);
+}
+
+TEST(FlatDictIntTest, ReserveAndBulkInsertSkipGrowth) {
+  auto dict = MakeFlatIntDictWithEntries(64);
+  ASSERT_TRUE(dict->Reserve(4096));
+  const size_t capacity = dict->BucketCount();
+  for (int key = 64; key < 4096; ++key) {
+    dict->BulkInsert(int{key}, int{key});
+  }
+  EXPECT_EQ(dict->BucketCount(), capacity);
+  ASSERT_EQ(dict->Size(), 4096);
+  for (int key = 0; key < 4096; ++key) {
+    EXPECT_EQ(dict->Get(key), key);
+  }
+}
+
+TEST(FlatDictIntTest, RandomEntryAndSampleEntriesCoverEveryEntry) {
+  auto dict = MakeFlatIntDictWithEntries(100);
+  std::vector<int> hits(100);
+  for (int draw = 0; draw < 20000; ++draw) {
+    ASSERT_TRUE(dict->RandomEntry(
+        [&hits](const int& key, const int&) { ++hits[key]; }));
+  }
+  for (int key = 0; key < 100; ++key) {
+    EXPECT_GT(hits[key], 100) << key;
+    EXPECT_LT(hits[key], 300) << key;
+  }
+
+  for (const size_t count : {5, 60, 200}) {
+    std::set<int> keys;
+    const size_t sampled =
+        dict->SampleEntries(count, [&keys](const int& key, const int&) {
+          ASSERT_TRUE(keys.insert(key).second);
+        });
+    EXPECT_EQ(sampled, std::min<size_t>(count, 100));
+    EXPECT_EQ(keys.size(), sampled);
+  }
+}
+
+TEST(FlatDictIntTest, Clear) {
+  auto dict = MakeFlatIntDictWithEntries(129);
+  dict->Clear();
+  ASSERT_EQ(dict->Size(), 0);
+  ASSERT_FALSE(dict->Get(96).has_value());
+
+  ASSERT_TRUE(dict->Insert(1, 10));
+  ASSERT_EQ(dict->Size(), 1);
+  ASSERT_EQ(dict->Get(1), 10);
+}
+
+TEST(FlatDictStrTest, BytesMatchUsedMemoryAndSamplesExtrapolate) {
+  const size_t before = UsedMemory();
+  auto dict = FlatDict<std::string, std::string>::Create();
+  for (int i = 0; i < 2000; ++i) {
+    dict->Insert("key:" + std::to_string(i),
+                 "a value long enough to need the heap " + std::to_string(i));
+  }
+  const size_t used = UsedMemory() - before;
+  const size_t bytes = AllocationBytes(dict.get()) + dict->Bytes();
+  EXPECT_NEAR(static_cast<double>(bytes), static_cast<double>(used),
+              static_cast<double>(used) * 0.05);
+  EXPECT_NEAR(static_cast<double>(dict->Bytes(100)),
+              static_cast<double>(dict->Bytes()),
+              static_cast<double>(dict->Bytes()) * 0.1);
+}
+}  // namespace redis_simple::in_memory
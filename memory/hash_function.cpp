@@ -0,0 +1,14 @@
+#include "memory/hash_function.h"
+
+#include <cstdint>
+#include <random>
+
+namespace redis_simple::in_memory {
+uint64_t ProcessHashSeed() {
+  static const uint64_t seed = [] {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device();
+  }();
+  return seed;
+}
+}  // namespace redis_simple::in_memory
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace redis_simple::in_memory {
+/*
+ * Seeded 64-bit hash for dict keys, following the wyhash construction: input
+ * words are folded with 64x64->128 bit multiplies, so short keys hash in a few
+ * cycles and every output bit depends on the seed. Dicts use a random
+ * per-process seed so clients cannot precompute colliding keys.
+ */
+namespace hash_internal {
+constexpr uint64_t kSecret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                                 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+inline void Multiply(uint64_t* low, uint64_t* high) {
+#if defined(__SIZEOF_INT128__)
+  const __uint128_t product = static_cast<__uint128_t>(*low) * *high;
+  *low = static_cast<uint64_t>(product);
+  *high = static_cast<uint64_t>(product >> 64);
+#else
+  const uint64_t a_high = *low >> 32;
+  const uint64_t a_low = static_cast<uint32_t>(*low);
+  const uint64_t b_high = *high >> 32;
+  const uint64_t b_low = static_cast<uint32_t>(*high);
+  const uint64_t high_high = a_high * b_high;
+  const uint64_t high_low = a_high * b_low;
+  const uint64_t low_high = a_low * b_high;
+  const uint64_t low_low = a_low * b_low;
+  const uint64_t cross = (low_low >> 32) + static_cast<uint32_t>(high_low) +
+                         static_cast<uint32_t>(low_high);
+  *low = (cross << 32) | static_cast<uint32_t>(low_low);
+  *high = high_high + (high_low >> 32) + (low_high >> 32) + (cross >> 32);
+#endif
+}
+
+inline uint64_t Mix(uint64_t a, uint64_t b) {
+  Multiply(&a, &b);
+  return a ^ b;
+}
+
+inline uint64_t Read64(const uint8_t* p) {
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline uint64_t Read32(const uint8_t* p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Read one to three bytes so that every byte contributes.
+inline uint64_t ReadSmall(const uint8_t* p, size_t len) {
+  return (static_cast<uint64_t>(p[0]) << 16) |
+         (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+}
+}  // namespace hash_internal
+
+inline uint64_t HashBytes(const void* data, size_t len, uint64_t seed) {
+  using hash_internal::kSecret;
+  using hash_internal::Mix;
+  using hash_internal::Read32;
+  using hash_internal::Read64;
+  const auto* p = static_cast<const uint8_t*>(data);
+  seed ^= Mix(seed ^ kSecret[0], kSecret[1]);
+  uint64_t a = 0;
+  uint64_t b = 0;
+  if (len <= 16) {
+    if (len >= 4) {
+      const size_t offset = (len >> 3) << 2;
+      a = (Read32(p) << 32) | Read32(p + offset);
+      b = (Read32(p + len - 4) << 32) | Read32(p + len - 4 - offset);
+    } else if (len > 0) {
+      a = hash_internal::ReadSmall(p, len);
+    }
+  } else {
+    size_t remaining = len;
+    if (remaining > 48) {
+      uint64_t seed1 = seed;
+      uint64_t seed2 = seed;
+      do {
+        seed = Mix(Read64(p) ^ kSecret[1], Read64(p + 8) ^ seed);
+        seed1 = Mix(Read64(p + 16) ^ kSecret[2], Read64(p + 24) ^ seed1);
+        seed2 = Mix(Read64(p + 32) ^ kSecret[3], Read64(p + 40) ^ seed2);
+        p += 48;
+        remaining -= 48;
+      } while (remaining > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (remaining > 16) {
+      seed = Mix(Read64(p) ^ kSecret[1], Read64(p + 8) ^ seed);
+      p += 16;
+      remaining -= 16;
+    }
+    a = Read64(p + remaining - 16);
+    b = Read64(p + remaining - 8);
+  }
+  a ^= kSecret[1];
+  b ^= seed;
+  hash_internal::Multiply(&a, &b);
+  return Mix(a ^ kSecret[0] ^ len, b ^ kSecret[1]);
+}
+
+// Random seed chosen once per process.
+uint64_t ProcessHashSeed();
+
+inline size_t HashString(std::string_view key) {
+  static const uint64_t seed = ProcessHashSeed();
+  return static_cast<size_t>(HashBytes(key.data(), key.size(), seed));
+}
+}  // namespace redis_simple::in_memory
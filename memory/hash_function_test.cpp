@@ -0,0 +1,72 @@
+#include "memory/hash_function.h"
+
+#include <gtest/gtest.h>
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+
+namespace redis_simple::in_memory {
+TEST(HashFunctionTest, DeterministicForSameSeed) {
+  const std::string key = "user:1000:profile";
+  ASSERT_EQ(HashBytes(key.data(), key.size(), 42),
+            HashBytes(key.data(), key.size(), 42));
+  ASSERT_EQ(HashString(key), HashString(std::string(key)));
+  ASSERT_EQ(ProcessHashSeed(), ProcessHashSeed());
+}
+
+TEST(HashFunctionTest, SeedChangesHash) {
+  const std::string key = "user:1000:profile";
+  ASSERT_NE(HashBytes(key.data(), key.size(), 1),
+            HashBytes(key.data(), key.size(), 2));
+  ASSERT_NE(HashBytes(nullptr, 0, 1), HashBytes(nullptr, 0, 2));
+}
+
+TEST(HashFunctionTest, EveryLengthHashesEveryByte) {
+  // Cover the short, 16-byte and 48-byte stripe paths, flipping each byte.
+  std::string key(200, 'a');
+  for (size_t len = 0; len <= key.size(); ++len) {
+    const uint64_t base = HashBytes(key.data(), len, 7);
+    if (len > 0) {
+      ASSERT_NE(base, HashBytes(key.data(), len - 1, 7)) << len;
+    }
+    for (size_t index = 0; index < len; ++index) {
+      key[index] = 'b';
+      ASSERT_NE(base, HashBytes(key.data(), len, 7)) << len << ":" << index;
+      key[index] = 'a';
+    }
+  }
+}
+
+TEST(HashFunctionTest, SequentialKeysDoNotCollide) {
+  std::set<uint64_t> hashes;
+  std::set<uint64_t> low_bits;
+  for (int index = 0; index < 100000; ++index) {
+    const std::string key = "key:" + std::to_string(index);
+    const uint64_t hash = HashBytes(key.data(), key.size(), 0);
+    hashes.insert(hash);
+    low_bits.insert(hash & 0xffff);
+  }
+  ASSERT_EQ(hashes.size(), 100000);
+  // Buckets are picked by the low bits. A uniform hash fills about 78% of
+  // 65536 buckets with 100000 keys.
+  ASSERT_GT(low_bits.size(), 50000);
+}
+
+TEST(HashFunctionTest, SingleBitFlipAvalanches) {
+  uint64_t word = 0x0123456789abcdefULL;
+  const uint64_t base = HashBytes(&word, sizeof(word), 0);
+  size_t total_flipped = 0;
+  for (int bit = 0; bit < 64; ++bit) {
+    word ^= uint64_t{1} << bit;
+    total_flipped += std::bitset<64>(base ^ HashBytes(&word, sizeof(word), 0))
+                         .count();
+    word ^= uint64_t{1} << bit;
+  }
+  // Each flip should change about half of the 64 output bits.
+  ASSERT_GT(total_flipped, 64 * 24);
+  ASSERT_LT(total_flipped, 64 * 40);
+}
+}  // namespace redis_simple::in_memory
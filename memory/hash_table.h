@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+
+#include "memory/dict.h"
+#include "memory/flat_dict.h"
+
+namespace redis_simple::in_memory {
+// Hash table backend shared by the keyspace, sets, and hashes. Builds
+// configured with REDIS_SIMPLE_FLAT_DICT=ON opt into the open-addressing
+// FlatDict; the chained, incrementally rehashed Dict with inlined default
+// hooks is used otherwise, with std::string keys embedded in the entries.
+//
+// kHashTableKeysAreStable says whether a std::string key keeps its address for
+// as long as it is in the table, so other structures may hold views of it.
+// Dict entries are relinked but never reallocated; FlatDict moves its slots
+// when it grows or shrinks.
+#ifdef REDIS_SIMPLE_USE_FLAT_DICT
+template <typename K, typename V>
+using HashTable = FlatDict<K, V>;
+inline constexpr bool kHashTableKeysAreStable = false;
+#else
+template <typename K, typename V>
+using HashTable =
+    Dict<K, V,
+         std::conditional_t<std::is_same<K, std::string>::value,
+                            EmbeddedKeyDictPolicy<V>, DefaultDictPolicy<K, V>>>;
+inline constexpr bool kHashTableKeysAreStable = true;
+#endif
+}  // namespace redis_simple::in_memory
@@ -9,6 +9,8 @@
 #include <stdexcept>
 #include <utility>
 
+#include "memory/used_memory.h"
+
 namespace redis_simple::in_memory {
 IntSet::IntSet()
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays): compact byte storage
@@ -56,6 +58,13 @@ bool IntSet::Remove(int64_t value) {
   return true;
 }
 
+size_t IntSet::Bytes() const { return AllocationBytes(contents_.get()); }
+
+bool IntSet::Defrag(DefragStats* const stats) {
+  return DefragBuffer(&contents_, static_cast<size_t>(length_) * encoding_,
+                      stats);
+}
+
 int64_t IntSet::Max() const { return Get(length_ - 1); }
 
 int64_t IntSet::Min() const { return Get(0); }
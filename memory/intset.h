@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <memory>
 
+#include "memory/defrag.h"
+
 namespace redis_simple::in_memory {
 // An in memory set storing integers in ascending order.
 class IntSet {
@@ -19,6 +21,11 @@ class IntSet {
   int64_t Max() const;
   int64_t Min() const;
   unsigned int Size() const { return length_; }
+  // Heap bytes of the encoded contents.
+  size_t Bytes() const;
+  // Move the contents to fresh memory if that packs the heap better. Returns
+  // true if they moved.
+  bool Defrag(DefragStats* stats);
   ~IntSet() = default;
 
  private:
@@ -13,6 +13,7 @@
 #include <utility>
 #include <vector>
 
+#include "memory/used_memory.h"
 #include "utils/string_utils.h"
 
 namespace redis_simple::in_memory {
@@ -528,6 +529,12 @@ bool ListPack::BatchInsert(size_t idx, ListPack::Position where,
   return true;
 }
 
+size_t ListPack::Bytes() const { return AllocationBytes(lp_.get()); }
+
+bool ListPack::Defrag(DefragStats* const stats) {
+  return DefragBuffer(&lp_, TotalBytes(), stats);
+}
+
 uint32_t ListPack::TotalBytes() const {
   return (static_cast<uint32_t>(lp_[0]) << 24) |
          (static_cast<uint32_t>(lp_[1]) << 16) |
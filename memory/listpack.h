@@ -10,6 +10,8 @@
 #include <string_view>
 #include <vector>
 
+#include "memory/defrag.h"
+
 namespace redis_simple::in_memory {
 // Compact Redis-style sequential encoding. See:
 // https://github.com/antirez/listpack/blob/master/listpack.md
@@ -59,6 +61,11 @@ class ListPack {
   std::optional<size_t> Next(size_t idx) const;
   std::optional<size_t> Prev(size_t idx) const;
   uint32_t TotalBytes() const;
+  // Heap bytes of the encoded buffer, which may exceed TotalBytes().
+  size_t Bytes() const;
+  // Move the encoded buffer to fresh memory, trimmed to TotalBytes(), if that
+  // packs the heap better. Returns true if it moved.
+  bool Defrag(DefragStats* stats);
   size_t Size() const;
   static size_t EstimateEntryBytes(std::string_view value);
   static size_t EstimateBytes(int64_t lval, size_t repeat);
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace redis_simple::in_memory {
+/*
+ * Hint that the cache line holding address will be read soon. Issuing hints
+ * for several independent lookups before performing any of them lets their
+ * cache misses overlap instead of being paid one after another.
+ */
+inline void Prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address);
+#else
+  (void)address;
+#endif
+}
+}  // namespace redis_simple::in_memory
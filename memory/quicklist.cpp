@@ -9,6 +9,8 @@
 #include <utility>
 #include <vector>
 
+#include "memory/used_memory.h"
+
 namespace redis_simple::in_memory {
 namespace {
 bool HasRemoveLimit(size_t limit) { return limit != 0; }
@@ -250,6 +252,28 @@ std::optional<size_t> QuickList::ListPackBytes() const {
              : std::optional<size_t>(head_->listpack->TotalBytes());
 }
 
+size_t QuickList::Bytes(size_t samples) const {
+  const size_t limit =
+      samples == 0 ? node_count_ : std::min(samples, node_count_);
+  size_t measured = 0;
+  size_t node_bytes = 0;
+  for (const Node* node = head_.get(); node != nullptr && measured < limit;
+       node = node->next.get(), ++measured) {
+    node_bytes += SlabAllocationBytes(node, sizeof(Node)) +
+                  AllocationBytes(node->listpack.get()) +
+                  node->listpack->Bytes();
+  }
+  return measured == 0 ? 0 : node_bytes * node_count_ / measured;
+}
+
+bool QuickList::Defrag(DefragStats* const stats) {
+  bool moved = false;
+  for (Node* node = head_.get(); node != nullptr; node = node->next.get()) {
+    moved = node->listpack->Defrag(stats) || moved;
+  }
+  return moved;
+}
+
 std::unique_ptr<ListPack> QuickList::ReleaseListPack() {
   if (node_count_ > 1) {
     return nullptr;
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "memory/listpack.h"
+#include "memory/slab_allocator.h"
 
 namespace redis_simple::in_memory {
 class QuickList {
@@ -42,10 +43,15 @@ class QuickList {
   size_t Size() const { return size_; }
   size_t NodeCount() const { return node_count_; }
   std::optional<size_t> ListPackBytes() const;
+  // Heap bytes of the nodes and their listpacks. With samples, only that many
+  // nodes are measured and the rest are taken to be of the same average size.
+  size_t Bytes(size_t samples = 0) const;
+  // Defragment the listpack of every node. Returns true if any moved.
+  bool Defrag(DefragStats* stats);
   std::unique_ptr<ListPack> ReleaseListPack();
 
  private:
-  struct Node {
+  struct Node : SlabAllocated<SlabTag::kQuickListNode> {
     Node();
 
     std::unique_ptr<ListPack> listpack;
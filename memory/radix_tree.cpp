@@ -0,0 +1,206 @@
+#include "memory/radix_tree.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace redis_simple::in_memory {
+namespace {
+// Bytes a std::string keeps outside itself, none while it fits inline.
+size_t HeapBytes(const std::string& value) {
+  static const size_t inline_capacity = std::string().capacity();
+  return value.capacity() > inline_capacity ? value.capacity() + 1 : 0;
+}
+
+size_t CommonPrefixLength(std::string_view left, std::string_view right) {
+  const size_t limit = std::min(left.size(), right.size());
+  size_t length = 0;
+  while (length < limit && left[length] == right[length]) {
+    ++length;
+  }
+  return length;
+}
+}  // namespace
+
+RadixTree::RadixTree() { root_ = NewNode("", false); }
+
+RadixTree::~RadixTree() = default;
+
+size_t RadixTree::Footprint(const Node& node) {
+  return sizeof(Node) + HeapBytes(node.label) +
+         node.children.capacity() * sizeof(std::unique_ptr<Node>);
+}
+
+RadixTree::Children::iterator RadixTree::LowerBound(Children& children,
+                                                    char byte) {
+  const auto position =
+      LowerBound(static_cast<const Children&>(children), byte);
+  return children.begin() + (position - children.cbegin());
+}
+
+std::unique_ptr<RadixTree::Node> RadixTree::NewNode(std::string_view label,
+                                                    bool is_key) {
+  auto node = std::make_unique<Node>();
+  node->label.assign(label);
+  node->is_key = is_key;
+  ++nodes_;
+  memory_bytes_ += Footprint(*node);
+  return node;
+}
+
+void RadixTree::DropNode(const Node& node) {
+  --nodes_;
+  memory_bytes_ -= Footprint(node);
+}
+
+bool RadixTree::Insert(std::string_view key) {
+  Node* node = root_.get();
+  size_t offset = 0;
+  while (offset < key.size()) {
+    const std::string_view rest = key.substr(offset);
+    const auto position = LowerBound(node->children, rest[0]);
+    if (position == node->children.end() ||
+        (*position)->label[0] != rest[0]) {
+      auto leaf = NewNode(rest, true);
+      memory_bytes_ -= Footprint(*node);
+      node->children.insert(position, std::move(leaf));
+      memory_bytes_ += Footprint(*node);
+      ++size_;
+      return true;
+    }
+
+    Node* const child = position->get();
+    const size_t common = CommonPrefixLength(child->label, rest);
+    if (common < child->label.size()) {
+      // Split the edge where the key leaves it; the key then ends at or
+      // branches off the new middle node.
+      auto middle = NewNode(std::string_view(child->label).substr(0, common),
+                            false);
+      memory_bytes_ -= Footprint(*middle) + Footprint(*child);
+      child->label.erase(0, common);
+      middle->children.push_back(std::move(*position));
+      memory_bytes_ += Footprint(*middle) + Footprint(*child);
+      *position = std::move(middle);
+    }
+    node = position->get();
+    offset += common;
+  }
+  if (node->is_key) {
+    return false;
+  }
+  node->is_key = true;
+  ++size_;
+  return true;
+}
+
+/*
+ * Fold a node that holds no key and has one child into that child, so every
+ * edge stays as long as possible.
+ */
+void RadixTree::MergeWithOnlyChild(std::unique_ptr<Node>& slot) {
+  std::unique_ptr<Node> child = std::move(slot->children.front());
+  memory_bytes_ -= Footprint(*child);
+  child->label.insert(0, slot->label);
+  memory_bytes_ += Footprint(*child);
+  DropNode(*slot);
+  slot = std::move(child);
+}
+
+bool RadixTree::Remove(std::string_view key) {
+  std::unique_ptr<Node>* parent = nullptr;
+  std::unique_ptr<Node>* slot = &root_;
+  size_t offset = 0;
+  while (offset < key.size()) {
+    auto& children = (*slot)->children;
+    const auto position = LowerBound(children, key[offset]);
+    if (position == children.end()) {
+      return false;
+    }
+    const std::string_view label = (*position)->label;
+    if (key.compare(offset, label.size(), label) != 0) {
+      return false;
+    }
+    parent = slot;
+    slot = &*position;
+    offset += label.size();
+  }
+  Node* const node = slot->get();
+  if (!node->is_key) {
+    return false;
+  }
+  node->is_key = false;
+  --size_;
+  if (slot == &root_) {
+    return true;
+  }
+
+  if (node->children.size() == 1) {
+    MergeWithOnlyChild(*slot);
+  } else if (node->children.empty()) {
+    Node* const owner = parent->get();
+    DropNode(*node);
+    owner->children.erase(owner->children.begin() +
+                          (slot - owner->children.data()));
+    if (parent != &root_ && !owner->is_key && owner->children.size() == 1) {
+      MergeWithOnlyChild(*parent);
+    }
+  }
+  return true;
+}
+
+bool RadixTree::Contains(std::string_view key) const {
+  const Node* node = root_.get();
+  size_t offset = 0;
+  while (offset < key.size()) {
+    const auto position = LowerBound(node->children, key[offset]);
+    if (position == node->children.end()) {
+      return false;
+    }
+    const std::string_view label = (*position)->label;
+    if (key.compare(offset, label.size(), label) != 0) {
+      return false;
+    }
+    node = position->get();
+    offset += label.size();
+  }
+  return node->is_key;
+}
+
+/*
+ * Return the topmost node whose path starts with prefix, storing its path, or
+ * nullptr if no key has the prefix.
+ */
+const RadixTree::Node* RadixTree::FindSubtree(std::string_view prefix,
+                                              std::string* const path) const {
+  const Node* node = root_.get();
+  size_t offset = 0;
+  while (offset < prefix.size()) {
+    const std::string_view rest = prefix.substr(offset);
+    const auto position = LowerBound(node->children, rest[0]);
+    if (position == node->children.end()) {
+      return nullptr;
+    }
+    const std::string_view label = (*position)->label;
+    const size_t common = CommonPrefixLength(label, rest);
+    if (common < std::min(label.size(), rest.size())) {
+      return nullptr;
+    }
+    node = position->get();
+    path->append(label);
+    offset += label.size();
+  }
+  return node;
+}
+
+void RadixTree::Clear() {
+  root_.reset();
+  size_ = 0;
+  nodes_ = 0;
+  memory_bytes_ = 0;
+  root_ = NewNode("", false);
+}
+}  // namespace redis_simple::in_memory
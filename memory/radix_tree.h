@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace redis_simple::in_memory {
+/*
+ * Set of strings stored as a compressed radix tree: every edge is labelled with
+ * the longest run of bytes its keys share, so a chain of single-child nodes is
+ * always merged into one. Keys are visited in byte order, and the keys sharing
+ * a prefix are exactly the keys of one subtree, which lets prefix scans skip
+ * every key outside it.
+ */
+class RadixTree {
+ public:
+  RadixTree();
+  RadixTree(const RadixTree&) = delete;
+  RadixTree& operator=(const RadixTree&) = delete;
+  ~RadixTree();
+  // Return false if the key is already present.
+  bool Insert(std::string_view key);
+  bool Remove(std::string_view key);
+  bool Contains(std::string_view key) const;
+  // Call visitor(key) for up to limit keys that start with prefix and sort
+  // after `after`, in byte order. Return true if more such keys remain. The
+  // key view is valid only during the callback.
+  template <typename Visitor>
+  bool ScanPrefix(std::string_view prefix,
+                  std::optional<std::string_view> after, size_t limit,
+                  Visitor&& visitor) const;
+  size_t Size() const { return size_; }
+  size_t NodeCount() const { return nodes_; }
+  // Bytes held by the nodes, their labels and their child arrays.
+  size_t MemoryUsage() const { return memory_bytes_; }
+  void Clear();
+
+ private:
+  struct Node {
+    std::string label;
+    bool is_key{};
+    // Sorted by the first byte of their labels, which differs between
+    // siblings.
+    std::vector<std::unique_ptr<Node>> children;
+  };
+  using Children = std::vector<std::unique_ptr<Node>>;
+  static size_t Footprint(const Node& node);
+  static Children::const_iterator LowerBound(const Children& children,
+                                             char byte);
+  static Children::iterator LowerBound(Children& children, char byte);
+  std::unique_ptr<Node> NewNode(std::string_view label, bool is_key);
+  void DropNode(const Node& node);
+  void MergeWithOnlyChild(std::unique_ptr<Node>& slot);
+  const Node* FindSubtree(std::string_view prefix, std::string* path) const;
+  std::unique_ptr<Node> root_;
+  size_t size_{};
+  size_t nodes_{};
+  size_t memory_bytes_{};
+};
+
+inline RadixTree::Children::const_iterator RadixTree::LowerBound(
+    const Children& children, char byte) {
+  return std::lower_bound(children.begin(), children.end(), byte,
+                          [](const std::unique_ptr<Node>& child, char value) {
+                            return static_cast<unsigned char>(child->label[0]) <
+                                   static_cast<unsigned char>(value);
+                          });
+}
+
+/*
+ * Depth-first walk of the subtree holding the prefix. A node's own key sorts
+ * before its children's, and children are ordered by their first byte, so the
+ * walk yields keys in byte order. Subtrees whose path sorts before `after`
+ * without being a prefix of it hold only keys before `after` and are skipped.
+ */
+template <typename Visitor>
+bool RadixTree::ScanPrefix(std::string_view prefix,
+                           std::optional<std::string_view> after, size_t limit,
+                           Visitor&& visitor) const {
+  std::string path;
+  const Node* const subtree = FindSubtree(prefix, &path);
+  if (subtree == nullptr) {
+    return false;
+  }
+  struct Frame {
+    const Node* node;
+    size_t next_child;
+    size_t path_length;
+  };
+  const auto first_child = [&after, &path](const Node& node) -> size_t {
+    if (!after.has_value() || after->size() <= path.size() ||
+        after->compare(0, path.size(), path) != 0) {
+      return 0;
+    }
+    return static_cast<size_t>(
+        LowerBound(node.children, (*after)[path.size()]) -
+        node.children.begin());
+  };
+
+  size_t visited = 0;
+  std::vector<Frame> stack;
+  const auto enter = [&](const Node& node) {
+    if (node.is_key && (!after.has_value() || path > *after)) {
+      if (visited == limit) {
+        return false;
+      }
+      visitor(std::string_view(path));
+      ++visited;
+    }
+    stack.push_back(Frame{&node, first_child(node), path.size()});
+    return true;
+  };
+  if (!enter(*subtree)) {
+    return true;
+  }
+  while (!stack.empty()) {
+    Frame& frame = stack.back();
+    if (frame.next_child == frame.node->children.size()) {
+      stack.pop_back();
+      continue;
+    }
+    const Node& child = *frame.node->children[frame.next_child++];
+    path.resize(frame.path_length);
+    path.append(child.label);
+    if (after.has_value() && path < *after &&
+        after->compare(0, path.size(), path) != 0) {
+      continue;
+    }
+    if (!enter(child)) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace redis_simple::in_memory
@@ -0,0 +1,134 @@
+#include "memory/radix_tree.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace redis_simple::in_memory {
+namespace {
+std::vector<std::string> ScanAll(const RadixTree& tree,
+                                 std::string_view prefix, size_t limit) {
+  std::vector<std::string> keys;
+  std::optional<std::string> after;
+  bool more = true;
+  while (more) {
+    std::string last;
+    more = tree.ScanPrefix(prefix, after, limit,
+                           [&keys, &last](std::string_view key) {
+                             keys.emplace_back(key);
+                             last.assign(key);
+                           });
+    after = last;
+  }
+  return keys;
+}
+}  // namespace
+
+TEST(RadixTreeTest, InsertSplitsAndRemoveMergesEdges) {
+  RadixTree tree;
+  const size_t empty_nodes = tree.NodeCount();
+  const size_t empty_bytes = tree.MemoryUsage();
+  EXPECT_TRUE(tree.Insert("romane"));
+  EXPECT_TRUE(tree.Insert("romanus"));
+  EXPECT_TRUE(tree.Insert("romulus"));
+  EXPECT_TRUE(tree.Insert("rom"));
+  EXPECT_TRUE(tree.Insert(""));
+  EXPECT_FALSE(tree.Insert("romane"));
+  EXPECT_EQ(tree.Size(), 5);
+  // root -> "rom" -> {"an" -> {"e", "us"}, "ulus"}
+  EXPECT_EQ(tree.NodeCount(), 6);
+  EXPECT_GT(tree.MemoryUsage(), empty_bytes);
+
+  EXPECT_TRUE(tree.Contains("rom"));
+  EXPECT_TRUE(tree.Contains(""));
+  EXPECT_FALSE(tree.Contains("roman"));
+  EXPECT_FALSE(tree.Contains("romanes"));
+  EXPECT_FALSE(tree.Remove("roman"));
+
+  EXPECT_TRUE(tree.Remove("romanus"));
+  // "an" and "e" fold back into "ane".
+  EXPECT_EQ(tree.NodeCount(), 4);
+  EXPECT_TRUE(tree.Contains("romane"));
+  EXPECT_TRUE(tree.Remove("rom"));
+  EXPECT_FALSE(tree.Remove("rom"));
+  EXPECT_TRUE(tree.Remove("romulus"));
+  EXPECT_EQ(tree.NodeCount(), 2);
+  EXPECT_TRUE(tree.Remove("romane"));
+  EXPECT_TRUE(tree.Remove(""));
+  EXPECT_EQ(tree.Size(), 0);
+  EXPECT_EQ(tree.NodeCount(), empty_nodes);
+
+  tree.Insert("key");
+  tree.Clear();
+  EXPECT_EQ(tree.Size(), 0);
+  EXPECT_FALSE(tree.Contains("key"));
+  EXPECT_EQ(tree.NodeCount(), empty_nodes);
+  EXPECT_EQ(tree.MemoryUsage(), empty_bytes);
+}
+
+TEST(RadixTreeTest, ScanPrefixVisitsMatchingKeysInOrder) {
+  RadixTree tree;
+  std::set<std::string> keys;
+  std::mt19937 random(7);
+  for (int index = 0; index < 2000; ++index) {
+    std::string key = "user:" + std::to_string(random() % 500) + ":" +
+                      std::to_string(random() % 20);
+    tree.Insert(key);
+    keys.insert(std::move(key));
+  }
+  keys.insert("user:");
+  tree.Insert("user:");
+  tree.Insert("other");
+  ASSERT_EQ(tree.Size(), keys.size() + 1);
+
+  for (const std::string_view prefix : {"user:", "user:4", "user:42:", ""}) {
+    std::vector<std::string> expected;
+    for (const auto& key : keys) {
+      if (key.compare(0, prefix.size(), prefix) == 0) {
+        expected.push_back(key);
+      }
+    }
+    if (prefix.empty()) {
+      expected.insert(expected.begin(), "other");
+    }
+    EXPECT_EQ(ScanAll(tree, prefix, 7), expected) << prefix;
+    EXPECT_EQ(ScanAll(tree, prefix, 1'000'000), expected) << prefix;
+  }
+  EXPECT_TRUE(ScanAll(tree, "user:x", 10).empty());
+  EXPECT_TRUE(ScanAll(tree, "users", 10).empty());
+}
+
+TEST(RadixTreeTest, ScanResumesAfterKeysChange) {
+  RadixTree tree;
+  for (int index = 0; index < 100; ++index) {
+    tree.Insert("key:" + std::to_string(index));
+  }
+  std::string last;
+  EXPECT_TRUE(tree.ScanPrefix("key:", std::nullopt, 10,
+                              [&last](std::string_view key) {
+                                last.assign(key);
+                              }));
+  // Removing the resume key does not lose the keys after it.
+  ASSERT_TRUE(tree.Remove(last));
+  std::set<std::string> rest;
+  bool more = true;
+  std::optional<std::string> after = last;
+  while (more) {
+    std::string next;
+    more = tree.ScanPrefix("key:", after, 10,
+                           [&rest, &next](std::string_view key) {
+                             rest.emplace(key);
+                             next.assign(key);
+                           });
+    after = next;
+  }
+  EXPECT_EQ(rest.size(), 90);
+  EXPECT_EQ(rest.count(last), 0);
+}
+}  // namespace redis_simple::in_memory
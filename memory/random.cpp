@@ -0,0 +1,50 @@
+#include "memory/random.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace redis_simple::in_memory {
+namespace {
+std::mt19937_64& Generator() {
+  thread_local std::mt19937_64 generator = [] {
+    std::random_device device;
+    return std::mt19937_64((static_cast<uint64_t>(device()) << 32) ^
+                           device());
+  }();
+  return generator;
+}
+}  // namespace
+
+size_t RandomIndex(size_t bound) {
+  return std::uniform_int_distribution<size_t>(0, bound - 1)(Generator());
+}
+
+std::vector<size_t> SampleIndexes(size_t size, size_t count) {
+  count = std::min(count, size);
+  std::vector<size_t> indexes;
+  indexes.reserve(count);
+  if (count * kSampleScanRatio > size) {
+    size_t needed = count;
+    for (size_t index = 0; needed > 0; ++index) {
+      if (RandomIndex(size - index) < needed) {
+        indexes.push_back(index);
+        --needed;
+      }
+    }
+    return indexes;
+  }
+  std::unordered_set<size_t> seen;
+  seen.reserve(count);
+  while (indexes.size() < count) {
+    const size_t index = RandomIndex(size);
+    if (seen.insert(index).second) {
+      indexes.push_back(index);
+    }
+  }
+  return indexes;
+}
+}  // namespace redis_simple::in_memory
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+namespace redis_simple::in_memory {
+// Uniformly distributed integer in [0, bound). bound must be positive.
+size_t RandomIndex(size_t bound);
+
+/*
+ * Choose min(count, size) distinct indexes of [0, size) uniformly at random.
+ * Small samples are drawn by rejecting repeats; once the sample covers a third
+ * of the range a single selection pass is cheaper, and it returns the indexes
+ * in ascending order.
+ */
+std::vector<size_t> SampleIndexes(size_t size, size_t count);
+
+// Samples at least 1/kSampleScanRatio of the range are taken in one pass.
+inline constexpr size_t kSampleScanRatio = 3;
+
+/*
+ * Visit min(count, table->Size()) distinct entries of a hash table chosen
+ * uniformly at random, using the same strategy as SampleIndexes(). Table must
+ * provide RandomEntry() and an Iterator; entries are told apart by the address
+ * of their value, which neither table moves outside of a resize. The visitor
+ * must not modify the table.
+ */
+template <typename Table, typename Visitor>
+size_t SampleDistinctEntries(Table* table, size_t count, Visitor&& visitor) {
+  const size_t size = table->Size();
+  count = count < size ? count : size;
+  if (count == 0) {
+    return 0;
+  }
+  if (count * kSampleScanRatio > size) {
+    size_t needed = count;
+    size_t remaining = size;
+    auto it = typename Table::Iterator(table);
+    for (it.SeekToFirst(); needed > 0; it.Next(), --remaining) {
+      if (RandomIndex(remaining) < needed) {
+        visitor(it.Key(), it.Value());
+        --needed;
+      }
+    }
+    return count;
+  }
+  std::unordered_set<const void*> seen;
+  seen.reserve(count);
+  while (seen.size() < count) {
+    table->RandomEntry([&seen, &visitor](auto&& key, const auto& val) {
+      if (seen.insert(&val).second) {
+        visitor(key, val);
+      }
+    });
+  }
+  return count;
+}
+}  // namespace redis_simple::in_memory
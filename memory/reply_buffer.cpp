@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "logging/logger.h"
+#include "memory/used_memory.h"
 
 namespace redis_simple::in_memory {
 ReplyBuffer::ReplyBuffer()
@@ -17,6 +18,16 @@ ReplyBuffer::ReplyBuffer()
       buf_usable_size_(kDefaultBufferSize),
       sent_(0) {}
 
+size_t ReplyBuffer::Bytes() const {
+  size_t bytes = AllocationBytes(buf_.get());
+  for (const BufNode* node = reply_head_.get(); node != nullptr;
+       node = node->next_.get()) {
+    bytes += SlabAllocationBytes(node, sizeof(BufNode)) +
+             AllocationBytes(node->buf_.get()) + StringBytes(node->owned_);
+  }
+  return bytes;
+}
+
 size_t ReplyBuffer::Append(const char* s, size_t len) {
   if (len == 0) {
     return 0;
@@ -20,6 +20,8 @@ class ReplyBuffer {
   size_t ReplyBytes() const { return reply_bytes_; }
   size_t PendingBytes() const { return pending_bytes_; }
   size_t BufferSize() const { return size_; }
+  // Heap bytes of the static buffer and the reply list.
+  size_t Bytes() const;
   BufNode* ReplyTail() const { return reply_tail_; }
   size_t Append(const char* s, size_t len);
   size_t Append(std::string&& reply);
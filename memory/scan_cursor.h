@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+namespace redis_simple::in_memory {
+inline size_t ReverseBits(size_t value) {
+  size_t shift = std::numeric_limits<size_t>::digits;
+  size_t mask = ~size_t{0};
+  while ((shift >>= 1) > 0) {
+    mask ^= (mask << shift);
+    value = ((value >> shift) & mask) | ((value << shift) & ~mask);
+  }
+  return value;
+}
+
+/*
+ * Advance a scan cursor by incrementing its reversed bits. Buckets that split
+ * or merge when a power-of-two table is resized share their low bits, so a
+ * cursor advanced this way never skips an element that was present for the
+ * whole scan, even if the table grows or shrinks between calls.
+ */
+inline size_t NextScanCursor(size_t cursor, size_t mask) {
+  cursor |= ~mask;
+  cursor = ReverseBits(cursor);
+  ++cursor;
+  return ReverseBits(cursor);
+}
+}  // namespace redis_simple::in_memory
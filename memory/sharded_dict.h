@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "memory/hash_function.h"
+#include "memory/hash_table.h"
+#include "memory/random.h"
+#include "memory/used_memory.h"
+
+namespace redis_simple::in_memory {
+/*
+ * String-keyed table split by key hash into a power-of-two number of
+ * independent HashTable shards. Each shard grows, shrinks and rehashes on its
+ * own, so a resize only ever copies the buckets of one shard. Shards are
+ * picked by the high bits of the key hash, which the shards themselves do not
+ * use to pick buckets.
+ *
+ * Scan cursors keep the shard index in their low bits and the shard's own
+ * cursor above them, so a scan finishes one shard before starting the next
+ * and keeps the guarantees of the shard's scan across resizes.
+ */
+template <typename V>
+class ShardedDict {
+ public:
+  using Shard = HashTable<std::string, V>;
+  static constexpr size_t kMaxShards = 1024;
+  // shards is rounded up to a power of two and capped at kMaxShards.
+  static std::unique_ptr<ShardedDict<V>> Create(size_t shards);
+  ShardedDict(const ShardedDict&) = delete;
+  ShardedDict& operator=(const ShardedDict&) = delete;
+  // The hash that routes key. Callers that touch the same key more than once
+  // can compute it once and pass it to the hash-taking overloads.
+  static size_t KeyHash(std::string_view key) { return HashString(key); }
+  V* FindValue(std::string_view key) { return FindValue(key, KeyHash(key)); }
+  V* FindValue(std::string_view key, size_t hash) {
+    return ShardFor(hash)->FindValue(key, hash);
+  }
+  const V* FindValue(std::string_view key) const {
+    const size_t hash = KeyHash(key);
+    return ShardFor(hash)->FindValue(key, hash);
+  }
+  // The key as stored in its shard, which stays valid while the key is in the
+  // dict if in_memory::kHashTableKeysAreStable.
+  std::optional<std::string_view> FindKey(std::string_view key, size_t hash) {
+    return ShardFor(hash)->FindKey(key, hash);
+  }
+  void FindMany(const std::string_view* keys, size_t count, V** values);
+  template <typename Value>
+  void Set(std::string&& key, Value&& val) {
+    const size_t hash = KeyHash(key);
+    Set(std::move(key), std::forward<Value>(val), hash);
+  }
+  template <typename Value>
+  void Set(std::string&& key, Value&& val, size_t hash);
+  bool Delete(std::string_view key);
+  std::optional<V> Extract(std::string_view key) {
+    return Extract(key, KeyHash(key));
+  }
+  std::optional<V> Extract(std::string_view key, size_t hash);
+  template <typename Visitor>
+  std::optional<size_t> Scan(size_t cursor, Visitor&& visitor);
+  template <typename Visitor>
+  bool RandomEntry(Visitor&& visitor);
+  size_t Size() const { return size_; }
+  size_t ShardCount() const { return shards_.size(); }
+  const Shard& ShardAt(size_t index) const { return *shards_[index]; }
+  // Heap bytes of the shards and their entries. Values count only what
+  // OwnedBytes() reports for them. With samples, each shard measures only that
+  // many entries and extrapolates the rest.
+  size_t Bytes(size_t samples = 0) const;
+  bool IsRehashing() const;
+  bool Reserve(size_t size);
+  void ShrinkIfNeeded();
+  bool Rehash(int n);
+  void Clear();
+
+ private:
+  // Keys whose shards are resolved together by FindMany().
+  static constexpr size_t kFindManyBatch = 16;
+  explicit ShardedDict(size_t shard_bits);
+  size_t ShardIndex(size_t hash) const;
+  Shard* ShardFor(size_t hash) const { return shards_[ShardIndex(hash)].get(); }
+  std::optional<size_t> NextNonEmptyShard(size_t shard) const;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  size_t shard_bits_;
+  // Sum of the shard sizes, kept so Size() stays a load on lookup paths.
+  size_t size_{};
+};
+
+template <typename V>
+std::unique_ptr<ShardedDict<V>> ShardedDict<V>::Create(size_t shards) {
+  shards = std::min(std::max<size_t>(shards, 1), kMaxShards);
+  size_t shard_bits = 0;
+  while ((size_t{1} << shard_bits) < shards) {
+    ++shard_bits;
+  }
+  return std::unique_ptr<ShardedDict<V>>(new ShardedDict<V>(shard_bits));
+}
+
+template <typename V>
+ShardedDict<V>::ShardedDict(size_t shard_bits) : shard_bits_(shard_bits) {
+  shards_.reserve(size_t{1} << shard_bits);
+  for (size_t index = 0; index < (size_t{1} << shard_bits); ++index) {
+    shards_.push_back(Shard::Create());
+  }
+}
+
+template <typename V>
+size_t ShardedDict<V>::ShardIndex(size_t hash) const {
+  if (shard_bits_ == 0) {
+    return 0;
+  }
+  return hash >> (std::numeric_limits<size_t>::digits - shard_bits_);
+}
+
+/*
+ * Hash each key in a group once, resolve its shard from the hash, and prefetch
+ * the buckets of every key before any of them is looked up.
+ */
+template <typename V>
+void ShardedDict<V>::FindMany(const std::string_view* keys, size_t count,
+                              V** values) {
+  if (shard_bits_ == 0) {
+    shards_[0]->FindMany(keys, count, values);
+    return;
+  }
+  std::array<size_t, kFindManyBatch> hashes{};
+  std::array<Shard*, kFindManyBatch> shards{};
+  for (size_t start = 0; start < count; start += kFindManyBatch) {
+    const size_t group = std::min(kFindManyBatch, count - start);
+    for (size_t index = 0; index < group; ++index) {
+      hashes[index] = KeyHash(keys[start + index]);
+      shards[index] = ShardFor(hashes[index]);
+      shards[index]->PrefetchBuckets(hashes[index]);
+    }
+    for (size_t index = 0; index < group; ++index) {
+      values[start + index] =
+          shards[index]->FindValue(keys[start + index], hashes[index]);
+    }
+  }
+}
+
+template <typename V>
+template <typename Value>
+void ShardedDict<V>::Set(std::string&& key, Value&& val, size_t hash) {
+  Shard* const shard = ShardFor(hash);
+  const size_t before = shard->Size();
+  shard->Set(std::move(key), V(std::forward<Value>(val)), hash);
+  size_ += shard->Size() - before;
+}
+
+template <typename V>
+bool ShardedDict<V>::Delete(std::string_view key) {
+  const size_t hash = KeyHash(key);
+  if (!ShardFor(hash)->Delete(key, hash)) {
+    return false;
+  }
+  --size_;
+  return true;
+}
+
+template <typename V>
+std::optional<V> ShardedDict<V>::Extract(std::string_view key, size_t hash) {
+  auto val = ShardFor(hash)->Extract(key, hash);
+  if (val.has_value()) {
+    --size_;
+  }
+  return val;
+}
+
+/*
+ * Scan one bucket of the shard named by the cursor's low bits. Empty shards
+ * are skipped, and std::nullopt is returned once the last non-empty shard has
+ * been scanned.
+ */
+template <typename V>
+template <typename Visitor>
+std::optional<size_t> ShardedDict<V>::Scan(size_t cursor, Visitor&& visitor) {
+  const size_t requested = cursor & (shards_.size() - 1);
+  const auto shard = NextNonEmptyShard(requested);
+  if (!shard.has_value()) {
+    return std::nullopt;
+  }
+  const size_t inner = *shard == requested ? cursor >> shard_bits_ : 0;
+  const auto next = shards_[*shard]->Scan(inner, visitor);
+  if (next.has_value()) {
+    return (*next << shard_bits_) | *shard;
+  }
+  return NextNonEmptyShard(*shard + 1);
+}
+
+template <typename V>
+std::optional<size_t> ShardedDict<V>::NextNonEmptyShard(size_t shard) const {
+  for (; shard < shards_.size(); ++shard) {
+    if (shards_[shard]->Size() > 0) {
+      return shard;
+    }
+  }
+  return std::nullopt;
+}
+
+/*
+ * Pass an entry chosen uniformly at random to visitor and return true, or
+ * return false if every shard is empty. The shard is drawn in proportion to
+ * its size so that shards of different sizes do not skew the choice.
+ */
+template <typename V>
+template <typename Visitor>
+bool ShardedDict<V>::RandomEntry(Visitor&& visitor) {
+  if (size_ == 0) {
+    return false;
+  }
+  size_t position = RandomIndex(size_);
+  for (const auto& shard : shards_) {
+    if (position < shard->Size()) {
+      return shard->RandomEntry(std::forward<Visitor>(visitor));
+    }
+    position -= shard->Size();
+  }
+  return false;
+}
+
+template <typename V>
+size_t ShardedDict<V>::Bytes(size_t samples) const {
+  size_t bytes = AllocationBytes(shards_.data());
+  for (const auto& shard : shards_) {
+    bytes += AllocationBytes(shard.get()) + shard->Bytes(samples);
+  }
+  return bytes;
+}
+
+template <typename V>
+bool ShardedDict<V>::IsRehashing() const {
+  return std::any_of(shards_.begin(), shards_.end(),
+                     [](const auto& shard) { return shard->IsRehashing(); });
+}
+
+/*
+ * Presize every shard for its share of size keys, with some slack because
+ * hashing does not split keys exactly evenly.
+ */
+template <typename V>
+bool ShardedDict<V>::Reserve(size_t size) {
+  if (size == 0) {
+    return true;
+  }
+  const size_t share = size >> shard_bits_;
+  bool reserved = true;
+  for (auto& shard : shards_) {
+    reserved = shard->Reserve(share + share / 8 + 1) && reserved;
+  }
+  return reserved;
+}
+
+template <typename V>
+void ShardedDict<V>::ShrinkIfNeeded() {
+  for (auto& shard : shards_) {
+    shard->ShrinkIfNeeded();
+  }
+}
+
+// Migrate up to n buckets in every shard. Return true if work remains.
+template <typename V>
+bool ShardedDict<V>::Rehash(int n) {
+  bool pending = false;
+  for (auto& shard : shards_) {
+    pending = shard->Rehash(n) || pending;
+  }
+  return pending;
+}
+
+template <typename V>
+void ShardedDict<V>::Clear() {
+  for (auto& shard : shards_) {
+    shard->Clear();
+  }
+  size_ = 0;
+}
+}  // namespace redis_simple::in_memory
@@ -0,0 +1,130 @@
+#include "memory/sharded_dict.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace redis_simple::in_memory {
+TEST(ShardedDictTest, RoutesKeysToShardsAndTracksSize) {
+  auto dict = ShardedDict<int>::Create(12);
+  ASSERT_EQ(dict->ShardCount(), 16);
+  ASSERT_EQ(ShardedDict<int>::Create(0)->ShardCount(), 1);
+  for (int index = 0; index < 1000; ++index) {
+    dict->Set("key:" + std::to_string(index), index);
+  }
+  dict->Set("key:0", 100);
+  ASSERT_EQ(dict->Size(), 1000);
+  size_t total = 0;
+  for (size_t shard = 0; shard < dict->ShardCount(); ++shard) {
+    EXPECT_GT(dict->ShardAt(shard).Size(), 0) << shard;
+    total += dict->ShardAt(shard).Size();
+  }
+  EXPECT_EQ(total, 1000);
+  ASSERT_NE(dict->FindValue("key:0"), nullptr);
+  EXPECT_EQ(*dict->FindValue("key:0"), 100);
+
+  EXPECT_TRUE(dict->Delete("key:1"));
+  EXPECT_FALSE(dict->Delete("key:1"));
+  EXPECT_EQ(dict->Extract("key:2"), std::optional<int>(2));
+  EXPECT_EQ(dict->Extract("key:2"), std::nullopt);
+  EXPECT_EQ(dict->Size(), 998);
+  EXPECT_EQ(dict->FindValue("key:1"), nullptr);
+
+  std::array<std::string_view, 3> keys = {"key:3", "missing", "key:999"};
+  std::array<int*, 3> values{};
+  dict->FindMany(keys.data(), keys.size(), values.data());
+  ASSERT_NE(values[0], nullptr);
+  EXPECT_EQ(*values[0], 3);
+  EXPECT_EQ(values[1], nullptr);
+  ASSERT_NE(values[2], nullptr);
+  EXPECT_EQ(*values[2], 999);
+
+  dict->Clear();
+  EXPECT_EQ(dict->Size(), 0);
+  EXPECT_EQ(dict->FindValue("key:3"), nullptr);
+}
+
+TEST(ShardedDictTest, ShardsAcceptTheHashPickedForRouting) {
+  auto shard = ShardedDict<int>::Shard::Create();
+  for (int index = 0; index < 100; ++index) {
+    std::string key = "key:" + std::to_string(index);
+    const size_t hash = HashString(key);
+    shard->Set(std::move(key), int{index}, hash);
+  }
+  shard->Set(std::string("key:0"), 100, HashString("key:0"));
+  ASSERT_EQ(shard->Size(), 100);
+  ASSERT_NE(shard->FindValue("key:0", HashString("key:0")), nullptr);
+  EXPECT_EQ(*shard->FindValue("key:0"), 100);
+  ASSERT_NE(shard->FindValue("key:5", HashString("key:5")), nullptr);
+  EXPECT_EQ(*shard->FindValue("key:5", HashString("key:5")), 5);
+  EXPECT_EQ(shard->FindValue("missing", HashString("missing")), nullptr);
+  EXPECT_TRUE(shard->Delete("key:1", HashString("key:1")));
+  EXPECT_EQ(shard->FindValue("key:1"), nullptr);
+  EXPECT_EQ(shard->Extract("key:2", HashString("key:2")),
+            std::optional<int>(2));
+  EXPECT_EQ(shard->Extract("key:2", HashString("key:2")), std::nullopt);
+  EXPECT_EQ(shard->Size(), 98);
+}
+
+TEST(ShardedDictTest, ScanVisitsEveryShardAcrossGrowth) {
+  auto dict = ShardedDict<int>::Create(8);
+  std::optional<size_t> cursor = 0;
+  EXPECT_EQ(dict->Scan(0, [](std::string_view, const int&) {}), std::nullopt);
+  for (int index = 0; index < 100; ++index) {
+    dict->Set("key:" + std::to_string(index), index);
+  }
+
+  std::set<std::string> seen;
+  int steps = 0;
+  while (cursor.has_value()) {
+    cursor = dict->Scan(*cursor, [&seen](std::string_view key, const int&) {
+      seen.emplace(key);
+    });
+    // Grow every shard part way through the scan.
+    if (++steps == 5) {
+      for (int index = 100; index < 5000; ++index) {
+        dict->Set("key:" + std::to_string(index), index);
+      }
+    }
+  }
+  for (int index = 0; index < 100; ++index) {
+    EXPECT_EQ(seen.count("key:" + std::to_string(index)), 1) << index;
+  }
+}
+
+TEST(ShardedDictTest, ReserveRehashAndRandomEntry) {
+  auto dict = ShardedDict<int>::Create(4);
+  EXPECT_FALSE(dict->RandomEntry([](std::string_view, const int&) {}));
+  ASSERT_TRUE(dict->Reserve(4000));
+  for (int index = 0; index < 4000; ++index) {
+    dict->Set("key:" + std::to_string(index), index);
+  }
+  EXPECT_FALSE(dict->IsRehashing());
+
+  std::map<std::string, int> counts;
+  for (int draw = 0; draw < 8000; ++draw) {
+    ASSERT_TRUE(dict->RandomEntry([&counts](std::string_view key, const int&) {
+      ++counts[std::string(key)];
+    }));
+  }
+  // 8000 draws over 4000 keys reach about 86% of them.
+  EXPECT_GT(counts.size(), 3000);
+
+  for (int index = 16; index < 4000; ++index) {
+    ASSERT_TRUE(dict->Delete("key:" + std::to_string(index)));
+  }
+  dict->ShrinkIfNeeded();
+  while (dict->Rehash(100)) {
+  }
+  EXPECT_FALSE(dict->IsRehashing());
+  EXPECT_EQ(dict->Size(), 16);
+}
+}  // namespace redis_simple::in_memory
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
@@ -13,6 +14,8 @@
 #include <vector>
 
 #include "logging/logger.h"
+#include "memory/slab_allocator.h"
+#include "memory/used_memory.h"
 
 namespace redis_simple::in_memory {
 // Redis skiplists begin with one level and promote at a probability of 0.25.
@@ -97,6 +100,11 @@ class Skiplist {
   size_t Count(const SkiplistRangeByKeySpec* spec) const;
   const Key& operator[](size_t i);
   size_t Size() const { return size_; }
+  // Heap bytes of the nodes, including what key_bytes(key) reports each key
+  // owns. With samples, only that many nodes are measured and the rest are
+  // taken to be of the same average size.
+  template <typename KeyBytes>
+  size_t Bytes(size_t samples, const KeyBytes& key_bytes) const;
   void Clear();
   void Print() const;
   ~Skiplist();
@@ -165,7 +173,8 @@ struct Skiplist<Key, Comparator, Destructor>::SkiplistLevel {
 
 // SkiplistNode
 template <typename Key, typename Comparator, typename Destructor>
-class Skiplist<Key, Comparator, Destructor>::SkiplistNode {
+class Skiplist<Key, Comparator, Destructor>::SkiplistNode
+    : public SlabAllocated<SlabTag::kSkiplistNode> {
  public:
   static SkiplistNode* Create(const Key& key, size_t level,
                               const Destructor& dtr);
@@ -180,6 +189,10 @@ class Skiplist<Key, Comparator, Destructor>::SkiplistNode {
   const SkiplistNode* Prev() const { return prev_; }
   SkiplistNode* Prev() { return prev_; }
   void SetPrev(SkiplistNode* prev) { prev_ = prev; }
+  size_t Bytes() const {
+    return SlabAllocationBytes(this, sizeof(SkiplistNode)) +
+           AllocationBytes(levels_.data());
+  }
   void InitLevel(size_t level) {
     if (level >= levels_.size()) {
       levels_.resize(level + 1);
@@ -710,6 +723,21 @@ void Skiplist<Key, Comparator, Destructor>::Clear() {
   level_ = kInitSkiplistLevel;
 }
 
+template <typename Key, typename Comparator, typename Destructor>
+template <typename KeyBytes>
+size_t Skiplist<Key, Comparator, Destructor>::Bytes(
+    size_t samples, const KeyBytes& key_bytes) const {
+  const size_t limit = samples == 0 ? size_ : std::min(samples, size_);
+  size_t measured = 0;
+  size_t node_bytes = 0;
+  for (const SkiplistNode* node = head_->Next(0);
+       node != nullptr && measured < limit; node = node->Next(0), ++measured) {
+    node_bytes += node->Bytes() + key_bytes(node->key);
+  }
+  return head_->Bytes() +
+         (measured == 0 ? 0 : node_bytes * size_ / measured);
+}
+
 template <typename Key, typename Comparator, typename Destructor>
 void Skiplist<Key, Comparator, Destructor>::Print() const {
   const SkiplistNode* node = head_;
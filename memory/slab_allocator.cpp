@@ -0,0 +1,534 @@
+#include "memory/slab_allocator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <vector>
+
+#include "memory/used_memory.h"
+
+namespace redis_simple::in_memory {
+namespace {
+#if defined(__SANITIZE_ADDRESS__)
+constexpr bool kPassThrough = true;
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+constexpr bool kPassThrough = true;
+#else
+constexpr bool kPassThrough = false;
+#endif
+#else
+constexpr bool kPassThrough = false;
+#endif
+
+constexpr size_t kSlabBytes = size_t{64} * 1024;
+constexpr std::array<size_t, 16> kClassSizes = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512};
+constexpr size_t kClassCount = kClassSizes.size();
+constexpr size_t kGranule = 16;
+constexpr size_t kGranules = kMaxSlabObjectSize / kGranule + 1;
+// Objects a thread cache takes from or gives back to the central list at once.
+constexpr size_t kBatchObjects = 32;
+// A thread cache holding more free objects of a class gives a batch back.
+constexpr size_t kMaxCachedObjects = 2 * kBatchObjects;
+// Empty slabs a size class keeps rather than freeing.
+constexpr size_t kSpareSlabs = 1;
+
+static_assert(kClassSizes.back() == kMaxSlabObjectSize);
+
+// Size class of each request size, indexed by the size in granules rounded
+// up.
+constexpr std::array<uint8_t, kGranules> BuildClassTable() {
+  std::array<uint8_t, kGranules> table{};
+  size_t size_class = 0;
+  for (size_t granules = 0; granules < kGranules; ++granules) {
+    while (kClassSizes[size_class] < granules * kGranule) {
+      ++size_class;
+    }
+    table[granules] = static_cast<uint8_t>(size_class);
+  }
+  return table;
+}
+constexpr std::array<uint8_t, kGranules> kClassOfGranules = BuildClassTable();
+
+size_t ClassOf(size_t size) {
+  return kClassOfGranules[(size + kGranule - 1) / kGranule];
+}
+
+size_t TagIndex(SlabTag tag) { return static_cast<size_t>(tag); }
+
+struct FreeObject {
+  FreeObject* next;
+};
+
+struct FreeList {
+  FreeObject* head;
+  size_t length;
+};
+
+void Push(FreeList* const list, void* const pointer) {
+  auto* const object = static_cast<FreeObject*>(pointer);
+  object->next = list->head;
+  list->head = object;
+  ++list->length;
+}
+
+void* Pop(FreeList* const list) {
+  FreeObject* const object = list->head;
+  list->head = object->next;
+  --list->length;
+  return object;
+}
+
+// Detach the first count objects of a list holding more than count.
+FreeList SplitFront(FreeList* const list, size_t count) {
+  FreeObject* last = list->head;
+  for (size_t index = 1; index < count; ++index) {
+    last = last->next;
+  }
+  const FreeList front{list->head, count};
+  list->head = last->next;
+  list->length -= count;
+  last->next = nullptr;
+  return front;
+}
+
+enum class CacheState : uint8_t {
+  kUnregistered,
+  kActive,
+  // The thread is exiting; its allocations go straight to the central lists.
+  kRetired,
+};
+
+/*
+ * Per-thread free lists and counters. It is zero-initialized, so reaching it
+ * never runs a constructor. The counters are written only by the owning
+ * thread and read by SlabMemoryStats(); they go negative when the thread frees
+ * objects another thread allocated.
+ */
+struct ThreadCache {
+  std::array<FreeList, kClassCount> lists;
+  std::array<std::atomic<int64_t>, kClassCount> used_objects;
+  std::array<std::atomic<int64_t>, kSlabTagCount> tag_bytes;
+  std::atomic<int64_t> large_bytes;
+  CacheState state;
+};
+
+/*
+ * Header at the start of every slab. Slabs are aligned to their size, so an
+ * object's slab is found by masking its address. Objects come back to the
+ * free list of the slab they were carved from, and live counts the ones
+ * handed to threads, whether in use or cached, so a slab whose objects have
+ * all come back can be freed.
+ */
+struct Slab {
+  FreeObject* free;
+  // Uncarved tail. Objects are carved a batch at a time, as they are needed.
+  char* carve_next;
+  char* carve_end;
+  size_t carved;
+  size_t live;
+  // Neighbours in the class's list of slabs with objects to hand out.
+  Slab* previous;
+  Slab* next;
+  bool listed;
+};
+constexpr size_t kSlabHeaderBytes = 64;
+static_assert(sizeof(Slab) <= kSlabHeaderBytes);
+
+Slab* SlabOf(void* const pointer) {
+  return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(pointer) &
+                                 ~(uintptr_t{kSlabBytes} - 1));
+}
+
+/*
+ * Slabs with objects to hand out. New slabs and ones that ran dry and got an
+ * object back go to the front, and empty ones to the back, so allocations
+ * favour slabs already in use and let the others drain. Up to kSpareSlabs
+ * empty slabs are kept to absorb churn; the rest are freed.
+ */
+struct CentralClass {
+  Slab* head{};
+  Slab* tail{};
+  size_t empty_slabs{};
+};
+
+struct Central {
+  std::mutex mutex;
+  std::array<CentralClass, kClassCount> classes{};
+  std::array<size_t, kClassCount> slab_count{};
+  std::array<size_t, kClassCount> carved_objects{};
+  std::vector<ThreadCache*> caches;
+  // Counters of exited threads and of allocations made while exiting.
+  std::array<int64_t, kClassCount> retired_used_objects{};
+  std::array<int64_t, kSlabTagCount> retired_tag_bytes{};
+  int64_t retired_large_bytes{};
+};
+
+// Never destroyed, so objects freed during static destruction still have
+// somewhere to go.
+Central& GetCentral() {
+  static auto* const central = new Central();
+  return *central;
+}
+
+thread_local ThreadCache thread_cache;
+
+void AddRelaxed(std::atomic<int64_t>& counter, int64_t delta) {
+  counter.store(counter.load(std::memory_order_relaxed) + delta,
+                std::memory_order_relaxed);
+}
+
+void LinkFront(CentralClass& central_class, Slab* const slab) {
+  slab->previous = nullptr;
+  slab->next = central_class.head;
+  if (central_class.head != nullptr) {
+    central_class.head->previous = slab;
+  } else {
+    central_class.tail = slab;
+  }
+  central_class.head = slab;
+  slab->listed = true;
+}
+
+void LinkBack(CentralClass& central_class, Slab* const slab) {
+  slab->next = nullptr;
+  slab->previous = central_class.tail;
+  if (central_class.tail != nullptr) {
+    central_class.tail->next = slab;
+  } else {
+    central_class.head = slab;
+  }
+  central_class.tail = slab;
+  slab->listed = true;
+}
+
+void Unlink(CentralClass& central_class, Slab* const slab) {
+  if (slab->previous != nullptr) {
+    slab->previous->next = slab->next;
+  } else {
+    central_class.head = slab->next;
+  }
+  if (slab->next != nullptr) {
+    slab->next->previous = slab->previous;
+  } else {
+    central_class.tail = slab->previous;
+  }
+  slab->listed = false;
+}
+
+// Requires the central mutex.
+Slab* NewSlab(Central& central, size_t size_class) {
+  // Slabs bypass operator new so used memory counts only the objects handed
+  // out of them.
+  void* memory = nullptr;
+  if (posix_memalign(&memory, kSlabBytes, kSlabBytes) != 0) {
+    throw std::bad_alloc();
+  }
+  auto* const slab = static_cast<Slab*>(memory);
+  *slab = Slab{};
+  slab->carve_next = static_cast<char*>(memory) + kSlabHeaderBytes;
+  slab->carve_end = static_cast<char*>(memory) + kSlabBytes;
+  ++central.slab_count[size_class];
+  LinkFront(central.classes[size_class], slab);
+  return slab;
+}
+
+// Move up to count objects of the front slabs to a batch, starting a new slab
+// only if the listed ones yield none. Requires the central mutex.
+FreeList TakeObjects(Central& central, size_t size_class, size_t count) {
+  CentralClass& central_class = central.classes[size_class];
+  const size_t object_size = kClassSizes[size_class];
+  FreeList batch{nullptr, 0};
+  while (batch.length < count) {
+    if (central_class.head == nullptr && batch.length > 0) {
+      break;
+    }
+    Slab* const slab = central_class.head != nullptr
+                           ? central_class.head
+                           : NewSlab(central, size_class);
+    if (slab->live == 0 && slab->carved > 0) {
+      --central_class.empty_slabs;
+    }
+    const size_t before = batch.length;
+    while (batch.length < count && slab->free != nullptr) {
+      FreeObject* const object = slab->free;
+      slab->free = object->next;
+      Push(&batch, object);
+    }
+    const auto uncarved =
+        static_cast<size_t>(slab->carve_end - slab->carve_next) / object_size;
+    const size_t carve = std::min(count - batch.length, uncarved);
+    // Push in reverse so carved objects are handed out in address order.
+    for (size_t index = carve; index-- > 0;) {
+      Push(&batch, slab->carve_next + index * object_size);
+    }
+    slab->carve_next += carve * object_size;
+    slab->carved += carve;
+    central.carved_objects[size_class] += carve;
+    slab->live += batch.length - before;
+    if (slab->free == nullptr && carve == uncarved) {
+      Unlink(central_class, slab);
+    }
+  }
+  return batch;
+}
+
+// Return one object to its slab, freeing the slab once all of its objects are
+// back and enough empty ones are spare. Requires the central mutex.
+void ReturnObject(Central& central, size_t size_class, void* const pointer) {
+  CentralClass& central_class = central.classes[size_class];
+  Slab* const slab = SlabOf(pointer);
+  auto* const object = static_cast<FreeObject*>(pointer);
+  object->next = slab->free;
+  slab->free = object;
+  if (--slab->live > 0) {
+    if (!slab->listed) {
+      LinkFront(central_class, slab);
+    }
+    return;
+  }
+  if (slab->listed) {
+    Unlink(central_class, slab);
+  }
+  if (central_class.empty_slabs < kSpareSlabs) {
+    ++central_class.empty_slabs;
+    LinkBack(central_class, slab);
+    return;
+  }
+  central.carved_objects[size_class] -= slab->carved;
+  --central.slab_count[size_class];
+  std::free(slab);
+}
+
+// Requires the central mutex.
+void ReturnObjects(Central& central, size_t size_class, FreeList list) {
+  while (list.head != nullptr) {
+    ReturnObject(central, size_class, Pop(&list));
+  }
+}
+
+// Requires the central mutex.
+void ReturnCachedObjects(Central& central, ThreadCache& cache) {
+  for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+    ReturnObjects(central, size_class, cache.lists[size_class]);
+    cache.lists[size_class] = FreeList{nullptr, 0};
+  }
+}
+
+void Refill(FreeList* const list, size_t size_class) {
+  Central& central = GetCentral();
+  const std::lock_guard<std::mutex> lock(central.mutex);
+  *list = TakeObjects(central, size_class, kBatchObjects);
+}
+
+void Flush(FreeList* const list, size_t size_class) {
+  const FreeList batch = SplitFront(list, kBatchObjects);
+  Central& central = GetCentral();
+  const std::lock_guard<std::mutex> lock(central.mutex);
+  ReturnObjects(central, size_class, batch);
+}
+
+class CacheReleaser {
+ public:
+  CacheReleaser() = default;
+  CacheReleaser(const CacheReleaser&) = delete;
+  CacheReleaser& operator=(const CacheReleaser&) = delete;
+  ~CacheReleaser() {
+    ThreadCache& cache = thread_cache;
+    Central& central = GetCentral();
+    const std::lock_guard<std::mutex> lock(central.mutex);
+    ReturnCachedObjects(central, cache);
+    for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+      central.retired_used_objects[size_class] +=
+          cache.used_objects[size_class].load(std::memory_order_relaxed);
+    }
+    for (size_t tag = 0; tag < kSlabTagCount; ++tag) {
+      central.retired_tag_bytes[tag] +=
+          cache.tag_bytes[tag].load(std::memory_order_relaxed);
+    }
+    central.retired_large_bytes +=
+        cache.large_bytes.load(std::memory_order_relaxed);
+    central.caches.erase(
+        std::remove(central.caches.begin(), central.caches.end(), &cache),
+        central.caches.end());
+    cache.state = CacheState::kRetired;
+  }
+};
+
+// Publish the calling thread's cache and arrange for it to be handed back
+// when the thread exits.
+void RegisterCache(ThreadCache& cache) {
+  static thread_local CacheReleaser releaser;
+  (void)releaser;
+  Central& central = GetCentral();
+  const std::lock_guard<std::mutex> lock(central.mutex);
+  central.caches.push_back(&cache);
+  cache.state = CacheState::kActive;
+}
+
+void* AllocateUncached(size_t size, SlabTag tag) {
+  Central& central = GetCentral();
+  const std::lock_guard<std::mutex> lock(central.mutex);
+  central.retired_tag_bytes[TagIndex(tag)] += static_cast<int64_t>(size);
+  if (kPassThrough || size > kMaxSlabObjectSize) {
+    central.retired_large_bytes += static_cast<int64_t>(size);
+    return ::operator new(size);
+  }
+  const size_t size_class = ClassOf(size);
+  FreeList batch = TakeObjects(central, size_class, 1);
+  void* const object = Pop(&batch);
+  ++central.retired_used_objects[size_class];
+  AddUsedMemory(static_cast<int64_t>(kClassSizes[size_class]));
+  return object;
+}
+
+void DeallocateUncached(void* const pointer, size_t size, SlabTag tag) {
+  Central& central = GetCentral();
+  const std::lock_guard<std::mutex> lock(central.mutex);
+  central.retired_tag_bytes[TagIndex(tag)] -= static_cast<int64_t>(size);
+  if (kPassThrough || size > kMaxSlabObjectSize) {
+    central.retired_large_bytes -= static_cast<int64_t>(size);
+    ::operator delete(pointer);
+    return;
+  }
+  const size_t size_class = ClassOf(size);
+  --central.retired_used_objects[size_class];
+  AddUsedMemory(-static_cast<int64_t>(kClassSizes[size_class]));
+  ReturnObject(central, size_class, pointer);
+}
+
+size_t NonNegative(int64_t value) {
+  return value > 0 ? static_cast<size_t>(value) : 0;
+}
+}  // namespace
+
+std::string_view SlabTagName(SlabTag tag) {
+  switch (tag) {
+    case SlabTag::kDictEntry:
+      return "dict_entry";
+    case SlabTag::kRedisObject:
+      return "redis_object";
+    case SlabTag::kZSetEntry:
+      return "zset_entry";
+    case SlabTag::kSkiplistNode:
+      return "skiplist_node";
+    case SlabTag::kQuickListNode:
+      return "quicklist_node";
+    case SlabTag::kBufNode:
+      return "buf_node";
+  }
+  return "unknown";
+}
+
+void* SlabAllocate(size_t size, SlabTag tag) {
+  ThreadCache& cache = thread_cache;
+  if (cache.state != CacheState::kActive) {
+    if (cache.state == CacheState::kRetired) {
+      return AllocateUncached(size, tag);
+    }
+    RegisterCache(cache);
+  }
+  AddRelaxed(cache.tag_bytes[TagIndex(tag)], static_cast<int64_t>(size));
+  if (kPassThrough || size > kMaxSlabObjectSize) {
+    AddRelaxed(cache.large_bytes, static_cast<int64_t>(size));
+    return ::operator new(size);
+  }
+  const size_t size_class = ClassOf(size);
+  FreeList& list = cache.lists[size_class];
+  if (list.head == nullptr) {
+    Refill(&list, size_class);
+  }
+  AddRelaxed(cache.used_objects[size_class], 1);
+  AddUsedMemory(static_cast<int64_t>(kClassSizes[size_class]));
+  return Pop(&list);
+}
+
+void SlabDeallocate(void* const pointer, size_t size, SlabTag tag) {
+  if (pointer == nullptr) {
+    return;
+  }
+  ThreadCache& cache = thread_cache;
+  if (cache.state != CacheState::kActive) {
+    if (cache.state == CacheState::kRetired) {
+      DeallocateUncached(pointer, size, tag);
+      return;
+    }
+    RegisterCache(cache);
+  }
+  AddRelaxed(cache.tag_bytes[TagIndex(tag)], -static_cast<int64_t>(size));
+  if (kPassThrough || size > kMaxSlabObjectSize) {
+    AddRelaxed(cache.large_bytes, -static_cast<int64_t>(size));
+    ::operator delete(pointer);
+    return;
+  }
+  const size_t size_class = ClassOf(size);
+  FreeList& list = cache.lists[size_class];
+  Push(&list, pointer);
+  AddRelaxed(cache.used_objects[size_class], -1);
+  AddUsedMemory(-static_cast<int64_t>(kClassSizes[size_class]));
+  if (list.length > kMaxCachedObjects) {
+    Flush(&list, size_class);
+  }
+}
+
+size_t SlabAllocationBytes(const void* const pointer, size_t size) {
+  if (kPassThrough || size > kMaxSlabObjectSize) {
+    return AllocationBytes(pointer);
+  }
+  return kClassSizes[ClassOf(size)];
+}
+
+void SlabReleaseThreadCache() {
+  ThreadCache& cache = thread_cache;
+  if (cache.state != CacheState::kActive) {
+    return;
+  }
+  Central& central = GetCentral();
+  const std::lock_guard<std::mutex> lock(central.mutex);
+  ReturnCachedObjects(central, cache);
+}
+
+SlabStats SlabMemoryStats() {
+  Central& central = GetCentral();
+  const std::lock_guard<std::mutex> lock(central.mutex);
+  std::array<int64_t, kClassCount> used = central.retired_used_objects;
+  std::array<int64_t, kSlabTagCount> tag_bytes = central.retired_tag_bytes;
+  int64_t large_bytes = central.retired_large_bytes;
+  for (const ThreadCache* const cache : central.caches) {
+    for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+      used[size_class] +=
+          cache->used_objects[size_class].load(std::memory_order_relaxed);
+    }
+    for (size_t tag = 0; tag < kSlabTagCount; ++tag) {
+      tag_bytes[tag] += cache->tag_bytes[tag].load(std::memory_order_relaxed);
+    }
+    large_bytes += cache->large_bytes.load(std::memory_order_relaxed);
+  }
+
+  SlabStats stats;
+  stats.classes.reserve(kClassCount);
+  for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+    SlabClassStats class_stats;
+    class_stats.object_size = kClassSizes[size_class];
+    class_stats.slab_bytes = central.slab_count[size_class] * kSlabBytes;
+    const size_t carved_bytes =
+        central.carved_objects[size_class] * class_stats.object_size;
+    class_stats.used_bytes = std::min(
+        NonNegative(used[size_class]) * class_stats.object_size, carved_bytes);
+    class_stats.free_bytes = carved_bytes - class_stats.used_bytes;
+    stats.classes.push_back(class_stats);
+  }
+  for (size_t tag = 0; tag < kSlabTagCount; ++tag) {
+    stats.tag_bytes[tag] = NonNegative(tag_bytes[tag]);
+  }
+  stats.large_bytes = NonNegative(large_bytes);
+  return stats;
+}
+}  // namespace redis_simple::in_memory
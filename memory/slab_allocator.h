@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace redis_simple::in_memory {
+// Subsystems whose slab allocations are counted separately.
+enum class SlabTag : uint8_t {
+  kDictEntry,
+  kRedisObject,
+  kZSetEntry,
+  kSkiplistNode,
+  kQuickListNode,
+  kBufNode,
+};
+inline constexpr size_t kSlabTagCount = 6;
+std::string_view SlabTagName(SlabTag tag);
+
+// Requests up to this many bytes are served from slabs.
+inline constexpr size_t kMaxSlabObjectSize = 512;
+
+struct SlabClassStats {
+  size_t object_size{};
+  // Bytes of slabs carved into objects of this size.
+  size_t slab_bytes{};
+  size_t used_bytes{};
+  // Carved objects not in use, whether cached by a thread or held centrally.
+  size_t free_bytes{};
+};
+
+struct SlabStats {
+  // One entry per size class, smallest first.
+  std::vector<SlabClassStats> classes;
+  // Bytes requested by each subsystem, including requests too large for a
+  // slab, indexed by SlabTag.
+  std::array<size_t, kSlabTagCount> tag_bytes{};
+  // Requests larger than kMaxSlabObjectSize, passed to operator new.
+  size_t large_bytes{};
+};
+
+/*
+ * Allocate small objects from 64 KiB slabs carved into fixed size classes.
+ * Each thread keeps a free list per class and trades batches of objects with
+ * the central slabs, so most calls take no lock, and memory freed on another
+ * thread, such as by the async reclaimer, flows back to the allocating
+ * thread. Every object returns to the slab it was carved from, and a slab
+ * whose objects have all come back is freed once its class already holds a
+ * spare empty slab.
+ *
+ * Builds with AddressSanitizer pass every request to operator new so
+ * use-after-free is still caught.
+ */
+void* SlabAllocate(size_t size, SlabTag tag);
+// size and tag must be the ones the pointer was allocated with.
+void SlabDeallocate(void* pointer, size_t size, SlabTag tag);
+// Bytes UsedMemory() counts for an object SlabAllocate(size) returned.
+size_t SlabAllocationBytes(const void* pointer, size_t size);
+// Hand the calling thread's cached objects back to their slabs, so slabs
+// emptied by a bulk free can be released rather than pinned by the cache.
+void SlabReleaseThreadCache();
+SlabStats SlabMemoryStats();
+
+// Base class routing `new` and `delete` of a type through the slab allocator.
+template <SlabTag tag>
+class SlabAllocated {
+ public:
+  static void* operator new(size_t size) { return SlabAllocate(size, tag); }
+  static void operator delete(void* pointer, size_t size) {
+    SlabDeallocate(pointer, size, tag);
+  }
+};
+}  // namespace redis_simple::in_memory
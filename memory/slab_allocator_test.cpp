@@ -0,0 +1,156 @@
+#include "memory/slab_allocator.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace redis_simple::in_memory {
+namespace {
+size_t TagBytes(SlabTag tag) {
+  return SlabMemoryStats().tag_bytes[static_cast<size_t>(tag)];
+}
+
+const SlabClassStats& ClassStats(const SlabStats& stats, size_t object_size) {
+  for (const auto& size_class : stats.classes) {
+    if (size_class.object_size == object_size) {
+      return size_class;
+    }
+  }
+  static const SlabClassStats kMissing;
+  return kMissing;
+}
+
+struct Node : SlabAllocated<SlabTag::kQuickListNode> {
+  std::array<char, 40> payload{};
+};
+}  // namespace
+
+TEST(SlabAllocatorTest, ServesSizeClassesAndReusesFreedObjects) {
+  const auto before = SlabMemoryStats();
+  std::vector<void*> objects;
+  std::set<void*> distinct;
+  for (int index = 0; index < 1000; ++index) {
+    void* const object = SlabAllocate(40, SlabTag::kDictEntry);
+    ASSERT_NE(object, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(object) % 16, 0);
+    std::memset(object, 0xab, 40);
+    objects.push_back(object);
+    distinct.insert(object);
+  }
+  EXPECT_EQ(distinct.size(), objects.size());
+  const auto during = SlabMemoryStats();
+  // 40-byte requests use the 48-byte class.
+  EXPECT_EQ(ClassStats(during, 48).used_bytes -
+                ClassStats(before, 48).used_bytes,
+            1000 * 48);
+  EXPECT_GE(ClassStats(during, 48).slab_bytes,
+            ClassStats(during, 48).used_bytes +
+                ClassStats(during, 48).free_bytes);
+  EXPECT_EQ(during.tag_bytes[static_cast<size_t>(SlabTag::kDictEntry)] -
+                before.tag_bytes[static_cast<size_t>(SlabTag::kDictEntry)],
+            1000 * 40);
+
+  void* const last = objects.back();
+  SlabDeallocate(last, 40, SlabTag::kDictEntry);
+  objects.pop_back();
+  void* const reused = SlabAllocate(33, SlabTag::kDictEntry);
+  EXPECT_EQ(reused, last);
+  SlabDeallocate(reused, 33, SlabTag::kDictEntry);
+  for (void* const object : objects) {
+    SlabDeallocate(object, 40, SlabTag::kDictEntry);
+  }
+  const auto after = SlabMemoryStats();
+  EXPECT_EQ(ClassStats(after, 48).used_bytes,
+            ClassStats(before, 48).used_bytes);
+  EXPECT_LE(ClassStats(after, 48).slab_bytes,
+            ClassStats(during, 48).slab_bytes);
+}
+
+TEST(SlabAllocatorTest, FreesSlabsOnceTheirObjectsComeBack) {
+  constexpr size_t kSlabBytes = size_t{64} * 1024;
+  const auto before = SlabMemoryStats();
+  std::vector<void*> objects;
+  for (int index = 0; index < 20000; ++index) {
+    objects.push_back(SlabAllocate(200, SlabTag::kBufNode));
+  }
+  const auto during = SlabMemoryStats();
+  // 200-byte requests use the 224-byte class.
+  ASSERT_GE(ClassStats(during, 224).slab_bytes,
+            ClassStats(before, 224).slab_bytes + 20000 * 224);
+  for (void* const object : objects) {
+    SlabDeallocate(object, 200, SlabTag::kBufNode);
+  }
+  // Only the slabs of objects this thread still caches, one spare and any
+  // slab that was partly in use before stay allocated.
+  const auto after = SlabMemoryStats();
+  EXPECT_LE(ClassStats(after, 224).slab_bytes,
+            ClassStats(before, 224).slab_bytes + 4 * kSlabBytes);
+  EXPECT_EQ(ClassStats(after, 224).used_bytes,
+            ClassStats(before, 224).used_bytes);
+}
+
+TEST(SlabAllocatorTest, LargeRequestsBypassSlabs) {
+  const size_t before = SlabMemoryStats().large_bytes;
+  void* const object =
+      SlabAllocate(kMaxSlabObjectSize + 1, SlabTag::kDictEntry);
+  ASSERT_NE(object, nullptr);
+  EXPECT_EQ(SlabMemoryStats().large_bytes - before, kMaxSlabObjectSize + 1);
+  SlabDeallocate(object, kMaxSlabObjectSize + 1, SlabTag::kDictEntry);
+  EXPECT_EQ(SlabMemoryStats().large_bytes, before);
+  SlabDeallocate(nullptr, 16, SlabTag::kDictEntry);
+}
+
+TEST(SlabAllocatorTest, RoutesNewAndDeleteOfTaggedTypes) {
+  const size_t before = TagBytes(SlabTag::kQuickListNode);
+  auto node = std::make_unique<Node>();
+  EXPECT_EQ(TagBytes(SlabTag::kQuickListNode) - before, sizeof(Node));
+  node.reset();
+  EXPECT_EQ(TagBytes(SlabTag::kQuickListNode), before);
+}
+
+TEST(SlabAllocatorTest, ObjectsFreedOnAnotherThreadAreAccounted) {
+  const auto before = SlabMemoryStats();
+  std::vector<void*> objects;
+  for (int index = 0; index < 5000; ++index) {
+    objects.push_back(SlabAllocate(100, SlabTag::kRedisObject));
+  }
+  const auto during = SlabMemoryStats();
+  std::thread reclaimer([&objects] {
+    for (void* const object : objects) {
+      SlabDeallocate(object, 100, SlabTag::kRedisObject);
+    }
+  });
+  reclaimer.join();
+  const auto after = SlabMemoryStats();
+  EXPECT_EQ(ClassStats(after, 112).used_bytes,
+            ClassStats(before, 112).used_bytes);
+  EXPECT_EQ(after.tag_bytes[static_cast<size_t>(SlabTag::kRedisObject)],
+            before.tag_bytes[static_cast<size_t>(SlabTag::kRedisObject)]);
+
+  // The exited thread handed its cached objects back to their slabs, so the
+  // slabs emptied and were freed.
+  EXPECT_LT(ClassStats(after, 112).slab_bytes,
+            ClassStats(during, 112).slab_bytes);
+  for (int index = 0; index < 5000; ++index) {
+    objects[index] = SlabAllocate(100, SlabTag::kRedisObject);
+  }
+  EXPECT_LE(ClassStats(SlabMemoryStats(), 112).slab_bytes,
+            ClassStats(during, 112).slab_bytes);
+  for (void* const object : objects) {
+    SlabDeallocate(object, 100, SlabTag::kRedisObject);
+  }
+}
+
+TEST(SlabAllocatorTest, NamesEveryTag) {
+  for (size_t tag = 0; tag < kSlabTagCount; ++tag) {
+    EXPECT_NE(SlabTagName(static_cast<SlabTag>(tag)), "unknown") << tag;
+  }
+}
+}  // namespace redis_simple::in_memory
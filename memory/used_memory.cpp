@@ -0,0 +1,185 @@
+#include "memory/used_memory.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+// The replacements must stay visible to the C++ runtime library so memory it
+// allocates is counted and freed through the same functions.
+#define REDIS_SIMPLE_EXPORT __attribute__((visibility("default")))
+
+namespace redis_simple::in_memory {
+namespace {
+// Constant-initialized, so it is ready before any static constructor allocates.
+std::atomic<int64_t> used_memory{0};
+
+size_t UsableSize(const void* const pointer) {
+#if defined(__APPLE__)
+  return malloc_size(pointer);
+#else
+  return malloc_usable_size(const_cast<void*>(pointer));
+#endif
+}
+
+void* TryAllocate(size_t size, size_t alignment) {
+  void* pointer = nullptr;
+  if (alignment <= alignof(std::max_align_t)) {
+    pointer = std::malloc(size == 0 ? 1 : size);
+  } else if (posix_memalign(&pointer, alignment, size == 0 ? 1 : size) != 0) {
+    pointer = nullptr;
+  }
+  if (pointer != nullptr) {
+    used_memory.fetch_add(static_cast<int64_t>(UsableSize(pointer)),
+                          std::memory_order_relaxed);
+  }
+  return pointer;
+}
+
+// Retry through the new-handler as the standard operator new does.
+void* Allocate(size_t size, size_t alignment) {
+  while (true) {
+    if (void* const pointer = TryAllocate(size, alignment)) {
+      return pointer;
+    }
+    const std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+void* AllocateNoThrow(size_t size, size_t alignment) noexcept {
+  try {
+    return Allocate(size, alignment);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void Free(void* const pointer) noexcept {
+  if (pointer == nullptr) {
+    return;
+  }
+  used_memory.fetch_sub(static_cast<int64_t>(UsableSize(pointer)),
+                        std::memory_order_relaxed);
+  std::free(pointer);
+}
+}  // namespace
+
+size_t UsedMemory() {
+  const int64_t bytes = used_memory.load(std::memory_order_relaxed);
+  return bytes > 0 ? static_cast<size_t>(bytes) : 0;
+}
+
+void AddUsedMemory(int64_t bytes) {
+  used_memory.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+size_t AllocationBytes(const void* const pointer) {
+  return pointer == nullptr ? 0 : UsableSize(pointer);
+}
+
+size_t StringBytes(const std::string& value) {
+  // An empty string's capacity is its inline buffer.
+  static const size_t inline_capacity = std::string().capacity();
+  return value.capacity() > inline_capacity ? UsableSize(value.data()) : 0;
+}
+}  // namespace redis_simple::in_memory
+
+namespace {
+using redis_simple::in_memory::Allocate;
+using redis_simple::in_memory::AllocateNoThrow;
+using redis_simple::in_memory::Free;
+constexpr size_t kDefaultAlignment = alignof(std::max_align_t);
+
+size_t Alignment(std::align_val_t alignment) {
+  return static_cast<size_t>(alignment);
+}
+}  // namespace
+
+REDIS_SIMPLE_EXPORT void* operator new(size_t size) {
+  return Allocate(size, kDefaultAlignment);
+}
+REDIS_SIMPLE_EXPORT void* operator new[](size_t size) {
+  return Allocate(size, kDefaultAlignment);
+}
+REDIS_SIMPLE_EXPORT void* operator new(size_t size,
+                                       const std::nothrow_t&) noexcept {
+  return AllocateNoThrow(size, kDefaultAlignment);
+}
+REDIS_SIMPLE_EXPORT void* operator new[](size_t size,
+                                         const std::nothrow_t&) noexcept {
+  return AllocateNoThrow(size, kDefaultAlignment);
+}
+REDIS_SIMPLE_EXPORT void* operator new(size_t size,
+                                       std::align_val_t alignment) {
+  return Allocate(size, Alignment(alignment));
+}
+REDIS_SIMPLE_EXPORT void* operator new[](size_t size,
+                                         std::align_val_t alignment) {
+  return Allocate(size, Alignment(alignment));
+}
+REDIS_SIMPLE_EXPORT void* operator new(size_t size, std::align_val_t alignment,
+                                       const std::nothrow_t&) noexcept {
+  return AllocateNoThrow(size, Alignment(alignment));
+}
+REDIS_SIMPLE_EXPORT void* operator new[](size_t size,
+                                         std::align_val_t alignment,
+                                         const std::nothrow_t&) noexcept {
+  return AllocateNoThrow(size, Alignment(alignment));
+}
+
+REDIS_SIMPLE_EXPORT void operator delete(void* pointer) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete[](void* pointer) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete(void* pointer, size_t) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete[](void* pointer, size_t) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete(void* pointer,
+                                         const std::nothrow_t&) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete[](void* pointer,
+                                           const std::nothrow_t&) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete(void* pointer,
+                                         std::align_val_t) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete[](void* pointer,
+                                           std::align_val_t) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete(void* pointer, size_t,
+                                         std::align_val_t) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete[](void* pointer, size_t,
+                                           std::align_val_t) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete(void* pointer, std::align_val_t,
+                                         const std::nothrow_t&) noexcept {
+  Free(pointer);
+}
+REDIS_SIMPLE_EXPORT void operator delete[](void* pointer, std::align_val_t,
+                                           const std::nothrow_t&) noexcept {
+  Free(pointer);
+}
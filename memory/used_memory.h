@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace redis_simple::in_memory {
+/*
+ * Bytes the process holds for data: every block obtained through the global
+ * operator new, which this module replaces, counted at its usable size, plus
+ * the slab objects in use. Slabs themselves are not counted, so freeing small
+ * objects lowers the total even though their slabs are kept.
+ */
+size_t UsedMemory();
+// Record bytes handed out or taken back by an allocator that carves objects
+// from memory obtained outside operator new.
+void AddUsedMemory(int64_t bytes);
+// Bytes UsedMemory() counts for a block from malloc, calloc or the global
+// operator new, or 0 for nullptr.
+size_t AllocationBytes(const void* pointer);
+// Bytes of the heap buffer a string owns, or 0 if it is stored inline.
+size_t StringBytes(const std::string& value);
+// Heap bytes an element stored by value owns beyond itself: a string's buffer,
+// and nothing for scalars and pointers.
+inline size_t OwnedBytes(const std::string& value) {
+  return StringBytes(value);
+}
+template <typename T>
+size_t OwnedBytes(const T& /*value*/) {
+  return 0;
+}
+}  // namespace redis_simple::in_memory
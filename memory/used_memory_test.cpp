@@ -0,0 +1,36 @@
+#include "memory/used_memory.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "memory/slab_allocator.h"
+
+namespace redis_simple::in_memory {
+TEST(UsedMemoryTest, CountsHeapBlocksUntilFreed) {
+  constexpr size_t kBytes = 1 << 20;
+  const size_t before = UsedMemory();
+  auto block = std::make_unique<char[]>(kBytes);
+  EXPECT_GE(UsedMemory(), before + kBytes);
+  block.reset();
+  EXPECT_LT(UsedMemory(), before + kBytes);
+}
+
+TEST(UsedMemoryTest, CountsSlabObjectsInUse) {
+  constexpr size_t kObjects = 1000;
+  constexpr size_t kObjectBytes = 64;
+  std::vector<void*> objects;
+  objects.reserve(kObjects);
+  const size_t before = UsedMemory();
+  for (size_t index = 0; index < kObjects; ++index) {
+    objects.push_back(SlabAllocate(kObjectBytes, SlabTag::kRedisObject));
+  }
+  EXPECT_GE(UsedMemory(), before + kObjects * kObjectBytes);
+  for (void* const object : objects) {
+    SlabDeallocate(object, kObjectBytes, SlabTag::kRedisObject);
+  }
+  EXPECT_LT(UsedMemory(), before + kObjects * kObjectBytes);
+}
+}  // namespace redis_simple::in_memory
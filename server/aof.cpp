@@ -42,6 +42,9 @@ constexpr size_t kRespElementOverhead = 32;
 constexpr std::string_view kLongestInt64 = "-9223372036854775808";
 constexpr auto kSyncInterval = std::chrono::seconds(1);
 constexpr auto kRewriteRetryDelay = std::chrono::seconds(5);
+// First record of a rewritten file: the key and expiration counts, so replay
+// can presize the tables before loading. Replay-only, not a client command.
+constexpr std::string_view kResizeDbCommand = "RESIZEDB";
 
 class SystemFileOps final : public FileOps {
  public:
@@ -102,6 +105,15 @@ bool SyncFile(FileOps* const file_ops, int fd) {
   return true;
 }
 
+bool ParseSize(std::string_view value, size_t* const result) {
+  if (value.empty()) {
+    return false;
+  }
+  const auto parsed =
+      std::from_chars(value.data(), value.data() + value.size(), *result);
+  return parsed.ec == std::errc() && parsed.ptr == value.data() + value.size();
+}
+
 size_t RespBulkSize(std::string_view value) {
   constexpr size_t kFramingBytes = 5;
   size_t digits = 1;
@@ -380,9 +392,11 @@ bool AppendSnapshotRecord(std::string_view key, const db::RedisObject& object,
                           Sink* sink) {
   bool encoded = false;
   switch (object.Type()) {
-    case db::RedisObject::ObjectType::kString:
-      encoded = EmitString(key, object.String(), limits, sink);
+    case db::RedisObject::ObjectType::kString: {
+      db::RedisObject::IntegerBuffer buffer;
+      encoded = EmitString(key, object.StringView(&buffer), limits, sink);
       break;
+    }
     case db::RedisObject::ObjectType::kSet: {
       const auto* set = object.Set();
       SnapshotBatch batch("SADD", key, 1, limits, sink);
@@ -438,15 +452,53 @@ bool AppendSnapshotRecord(std::string_view key, const db::RedisObject& object,
   return true;
 }
 
+bool AppendResizeDbRecord(const db::RedisDb& db, std::string* const output) {
+  const std::string keys = std::to_string(db.KeyCount());
+  const std::string expiring_keys = std::to_string(db.ExpiringKeyCount());
+  return AppendFixedCommand({kResizeDbCommand, keys, expiring_keys}, output);
+}
+
+// Presize the tables from a RESIZEDB record. The counts are only a hint: every
+// key takes more than one byte of the file, so counts above file_size are not
+// trusted, and a table that cannot grow is left to expand on demand.
+bool ReplayResizeDb(const command::CommandArgs& args, size_t file_size,
+                    db::RedisDb* const db) {
+  size_t keys = 0;
+  size_t expiring_keys = 0;
+  if (args.size() != 2 || !ParseSize(args[0], &keys) ||
+      !ParseSize(args[1], &expiring_keys)) {
+    return false;
+  }
+  if (keys <= file_size && expiring_keys <= keys) {
+    db->ReserveTables(keys);
+  }
+  return true;
+}
+
 template <typename Sink>
 bool BuildSnapshotRecords(db::RedisDb* const db, const Limits& limits,
                           Sink* sink) {
-  return db != nullptr && sink != nullptr &&
-         db->ForEachObject([db, &limits, sink](std::string_view key,
-                                               const db::RedisObject& object) {
-           return AppendSnapshotRecord(key, object, db->Expiration(key), limits,
-                                       sink);
-         });
+  std::string header;
+  if (db == nullptr || sink == nullptr ||
+      !AppendResizeDbRecord(*db, &header)) {
+    return false;
+  }
+  // The header travels with the first record instead of as a block of its own.
+  auto with_header = [&header, sink](std::string block) {
+    if (!header.empty()) {
+      header.append(block);
+      block = std::exchange(header, std::string());
+    }
+    return (*sink)(std::move(block));
+  };
+  return db->ForEachObject([&limits, &with_header](
+                               std::string_view key,
+                               const db::RedisObject& object) {
+    const std::optional<int64_t> expire =
+        object.Expire() == 0 ? std::nullopt
+                             : std::optional<int64_t>(object.Expire());
+    return AppendSnapshotRecord(key, object, expire, limits, &with_header);
+  }) && (header.empty() || (*sink)(std::move(header)));
 }
 }  // namespace
 
@@ -816,12 +868,18 @@ bool Aof::Replay(db::RedisDb* const db) {
         if (parsed.consumed > limits_.max_replay_command_bytes) {
           return false;
         }
-        const auto* metadata = command::Find(name);
-        if (metadata == nullptr ||
-            metadata->access != command::CommandAccess::kWrite ||
-            !metadata->arity.Accepts(args.size()) ||
-            !client.ExecuteForReplay(metadata, &args)) {
-          return false;
+        if (name == kResizeDbCommand) {
+          if (!ReplayResizeDb(args, current_size_, db)) {
+            return false;
+          }
+        } else {
+          const auto* metadata = command::Find(name);
+          if (metadata == nullptr ||
+              metadata->access != command::CommandAccess::kWrite ||
+              !metadata->arity.Accepts(args.size()) ||
+              !client.ExecuteForReplay(metadata, &args)) {
+            return false;
+          }
         }
         if (!AddSize(parsed.consumed, &complete_bytes)) {
           return false;
@@ -864,14 +922,15 @@ bool Aof::Encode(std::string_view command,
       return false;
     }
     const auto expire = db->Expiration(args[0]);
-    if (!ReserveSetRecord(args[0], object->String(), expire.has_value(),
-                          output)) {
+    db::RedisObject::IntegerBuffer buffer;
+    const std::string_view value = object->StringView(&buffer);
+    if (!ReserveSetRecord(args[0], value, expire.has_value(), output)) {
       return false;
     }
     reply::AppendArrayHeader(3, output);
     reply::AppendBulkString("SET", output);
     reply::AppendBulkString(args[0], output);
-    reply::AppendBulkString(object->String(), output);
+    reply::AppendBulkString(value, output);
     return !expire.has_value() || AppendExpireAt(args[0], *expire, output);
   }
   if (command == "EXPIRE" || command == "PEXPIRE" || command == "PEXPIREAT") {
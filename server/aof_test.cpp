@@ -335,6 +335,45 @@ TEST(AofTest, RewriteCompactsCommandHistory) {
   EXPECT_EQ(restored->LookupKey("key")->String(), "127");
 }
 
+TEST(AofTest, RewriteHeaderPresizesReplayTables) {
+  TempFile file;
+  auto source = db::RedisDb::Create();
+  const int64_t expire = utils::NowInMilliseconds() + 60'000;
+  for (int index = 0; index < 1000; ++index) {
+    const std::string key = "key" + std::to_string(index);
+    ASSERT_EQ(source->SetKey(key, db::RedisObject::CreateWithString("value"),
+                             index < 100 ? expire : 0),
+              db::DbStatus::kOk);
+  }
+  auto writer = Aof::Open(Always(file), source.get());
+  ASSERT_NE(writer, nullptr);
+  ASSERT_EQ(writer->StartRewrite(source.get()), RewriteResult::kStarted);
+  writer->WaitUntilRewriteIdle();
+  ASSERT_EQ(writer->State().rewrite_status, RewriteStatus::kSucceeded);
+  writer.reset();
+
+  auto restored = db::RedisDb::Create();
+  auto reader = Aof::Open(Always(file), restored.get());
+  ASSERT_NE(reader, nullptr);
+  EXPECT_EQ(restored->KeyCount(), 1000);
+  EXPECT_EQ(restored->ExpiringKeyCount(), 100);
+  const auto keyspace = restored->KeyspaceTableStats();
+  EXPECT_GE(keyspace.buckets, 1000);
+  EXPECT_FALSE(keyspace.rehashing);
+}
+
+TEST(AofTest, IgnoresImplausibleResizeHeader) {
+  TempFile file;
+  ASSERT_TRUE(file.Append(
+      "*3\r\n$8\r\nRESIZEDB\r\n$13\r\n1000000000000\r\n$1\r\n0\r\n"
+      "*3\r\n$3\r\nSET\r\n$3\r\nkey\r\n$5\r\nvalue\r\n"));
+  auto restored = db::RedisDb::Create();
+  auto reader = Aof::Open(Always(file), restored.get());
+  ASSERT_NE(reader, nullptr);
+  ASSERT_NE(restored->LookupKey("key"), nullptr);
+  EXPECT_LT(restored->KeyspaceTableStats().buckets, 1024);
+}
+
 TEST(AofTest, RewritesLargeValuesAsReplayableChunks) {
   TempFile file;
   auto source = db::RedisDb::Create();
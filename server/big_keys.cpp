@@ -0,0 +1,110 @@
+#include "server/big_keys.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "logging/logger.h"
+#include "utils/time_utils.h"
+
+namespace redis_simple {
+namespace {
+constexpr std::array<std::string_view, BigKeysAnalysis::kTypes> kTypeNames = {
+    "string", "set", "list", "zset", "hash"};
+
+void Track(std::string_view key, uint64_t size, BigKey* const largest) {
+  if (largest->key.empty() || size > largest->size) {
+    largest->key.assign(key);
+    largest->size = size;
+  }
+}
+}  // namespace
+
+void BigKeysAnalysis::Start() {
+  state_ = State::kRunning;
+  cursor_ = 0;
+  scanned_keys_ = 0;
+  started_ms_ = utils::NowInMilliseconds();
+  finished_ms_ = 0;
+  types_ = TypeStats{};
+}
+
+void BigKeysAnalysis::Stop() {
+  if (state_ == State::kRunning) {
+    state_ = State::kStopped;
+    finished_ms_ = utils::NowInMilliseconds();
+  }
+}
+
+void BigKeysAnalysis::RunCycle(db::RedisDb* const db, int hz) {
+  if (state_ != State::kRunning || db == nullptr) {
+    return;
+  }
+  Step(db, utils::CronSliceMicroseconds(kCyclePercent, hz));
+}
+
+bool BigKeysAnalysis::Step(db::RedisDb* const db,
+                           int64_t budget_microseconds) {
+  if (state_ != State::kRunning) {
+    return state_ == State::kDone;
+  }
+  const int64_t start = utils::NowInMicroseconds();
+  do {
+    cursor_ = db->ScanObjects(
+        cursor_, utils::kStepsPerClockRead,
+        [this](std::string_view key, const db::RedisObject& object) {
+          Add(key, object);
+        });
+  } while (cursor_ != 0 &&
+           utils::NowInMicroseconds() - start < budget_microseconds);
+  if (cursor_ != 0) {
+    return false;
+  }
+  state_ = State::kDone;
+  finished_ms_ = utils::NowInMilliseconds();
+  RS_LOG_DEBUG("big keys analysis complete\n");
+  return true;
+}
+
+int64_t BigKeysAnalysis::ElapsedMilliseconds() const {
+  if (state_ == State::kIdle) {
+    return 0;
+  }
+  return (state_ == State::kRunning ? utils::NowInMilliseconds()
+                                    : finished_ms_) -
+         started_ms_;
+}
+
+std::string_view BigKeysAnalysis::TypeName(size_t index) {
+  return index < kTypeNames.size() ? kTypeNames[index] : "none";
+}
+
+size_t BigKeysAnalysis::HistogramBucket(uint64_t size) {
+  size_t bucket = 0;
+  for (; size != 0; size >>= 1) {
+    ++bucket;
+  }
+  return bucket;
+}
+
+void BigKeysAnalysis::Add(std::string_view key,
+                          const db::RedisObject& object) {
+  const auto index = static_cast<size_t>(object.Type()) - 1;
+  if (index >= kTypes) {
+    return;
+  }
+  ++scanned_keys_;
+  const uint64_t elements = object.Length();
+  const uint64_t bytes = object.Bytes(kBytesSamples) + key.size();
+  auto& stats = types_[index];
+  ++stats.keys;
+  stats.elements += elements;
+  stats.bytes += bytes;
+  Track(key, elements, &stats.largest_by_elements);
+  Track(key, bytes, &stats.largest_by_bytes);
+  ++stats.elements_histogram[HistogramBucket(elements)];
+  ++stats.bytes_histogram[HistogramBucket(bytes)];
+}
+}  // namespace redis_simple
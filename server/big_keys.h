@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "server/db/db.h"
+
+namespace redis_simple {
+struct BigKey {
+  std::string key;
+  uint64_t size{};
+};
+
+struct TypeSizeStats {
+  // Bucket 0 counts sizes of zero and bucket i >= 1 sizes in
+  // [2^(i-1), 2^i).
+  static constexpr size_t kHistogramBuckets = 65;
+  using Histogram = std::array<uint64_t, kHistogramBuckets>;
+  uint64_t keys{};
+  // Elements of collections, or bytes of strings.
+  uint64_t elements{};
+  // Heap bytes of the values, estimated from kBytesSamples elements each, and
+  // of the key names.
+  uint64_t bytes{};
+  BigKey largest_by_elements;
+  BigKey largest_by_bytes;
+  Histogram elements_histogram{};
+  Histogram bytes_histogram{};
+};
+
+/*
+ * Finds the largest keys of each type, by element count and by estimated
+ * bytes, and histograms their sizes on a log2 scale. Once started, the
+ * analysis scans the keyspace from the cron for kCyclePercent of each cron
+ * period, resuming from its SCAN cursor, so it never holds up clients for
+ * long. Keys changed during the analysis are counted as they were when
+ * scanned.
+ */
+class BigKeysAnalysis {
+ public:
+  enum class State : uint8_t {
+    kIdle,
+    kRunning,
+    kDone,
+    kStopped,
+  };
+  static constexpr int kCyclePercent = 10;
+  // Collection elements measured per key for the byte estimate.
+  static constexpr size_t kBytesSamples = 64;
+  // Indexed by RedisObject::ObjectType - 1.
+  static constexpr size_t kTypes = 5;
+  using TypeStats = std::array<TypeSizeStats, kTypes>;
+
+  // Discard any previous results and start from the beginning.
+  void Start();
+  void Stop();
+  void RunCycle(db::RedisDb* db, int hz);
+  // Scan for up to budget_microseconds. Returns true once the keyspace has
+  // been covered.
+  bool Step(db::RedisDb* db, int64_t budget_microseconds);
+  State GetState() const { return state_; }
+  uint64_t ScannedKeys() const { return scanned_keys_; }
+  // Milliseconds from Start() to completion, or until now while running.
+  int64_t ElapsedMilliseconds() const;
+  const TypeStats& Types() const { return types_; }
+  static std::string_view TypeName(size_t index);
+  static size_t HistogramBucket(uint64_t size);
+
+ private:
+  void Add(std::string_view key, const db::RedisObject& object);
+  State state_{State::kIdle};
+  size_t cursor_{};
+  uint64_t scanned_keys_{};
+  int64_t started_ms_{};
+  int64_t finished_ms_{};
+  TypeStats types_{};
+};
+}  // namespace redis_simple
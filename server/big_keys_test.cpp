@@ -0,0 +1,91 @@
+#include "server/big_keys.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "data_types/hash/hash.h"
+#include "server/db/db.h"
+#include "server/db/redis_obj.h"
+
+namespace redis_simple {
+TEST(BigKeysAnalysisTest, BucketsSizesByPowerOfTwo) {
+  EXPECT_EQ(BigKeysAnalysis::HistogramBucket(0), 0);
+  EXPECT_EQ(BigKeysAnalysis::HistogramBucket(1), 1);
+  EXPECT_EQ(BigKeysAnalysis::HistogramBucket(2), 2);
+  EXPECT_EQ(BigKeysAnalysis::HistogramBucket(3), 2);
+  EXPECT_EQ(BigKeysAnalysis::HistogramBucket(1024), 11);
+  EXPECT_EQ(BigKeysAnalysis::HistogramBucket(UINT64_MAX),
+            TypeSizeStats::kHistogramBuckets - 1);
+}
+
+TEST(BigKeysAnalysisTest, FindsLargestKeysPerType) {
+  auto db = db::RedisDb::Create();
+  for (int index = 0; index < 100; ++index) {
+    ASSERT_EQ(db->SetKey("string:" + std::to_string(index),
+                         db::RedisObject::CreateWithString(
+                             std::string(static_cast<size_t>(index), 'x')),
+                         0),
+              db::DbStatus::kOk);
+  }
+  auto hash = hash::Hash::Create();
+  for (int index = 0; index < 1000; ++index) {
+    hash->Set("field:" + std::to_string(index), "value");
+  }
+  ASSERT_EQ(db->SetKey("big-hash",
+                       db::RedisObject::CreateWithHash(std::move(hash)), 0),
+            db::DbStatus::kOk);
+  auto small = hash::Hash::Create();
+  small->Set("field", "value");
+  ASSERT_EQ(db->SetKey("small-hash",
+                       db::RedisObject::CreateWithHash(std::move(small)), 0),
+            db::DbStatus::kOk);
+
+  BigKeysAnalysis analysis;
+  EXPECT_EQ(analysis.GetState(), BigKeysAnalysis::State::kIdle);
+  analysis.Start();
+  ASSERT_TRUE(analysis.Step(db.get(), 1'000'000));
+  EXPECT_EQ(analysis.GetState(), BigKeysAnalysis::State::kDone);
+  EXPECT_EQ(analysis.ScannedKeys(), 102);
+
+  const auto& strings = analysis.Types()[0];
+  EXPECT_EQ(strings.keys, 100);
+  EXPECT_EQ(strings.elements, 99 * 100 / 2);
+  EXPECT_EQ(strings.largest_by_elements.key, "string:99");
+  EXPECT_EQ(strings.largest_by_elements.size, 99);
+  EXPECT_EQ(strings.elements_histogram[0], 1);
+  EXPECT_EQ(strings.elements_histogram[7], 36);
+
+  const auto& hashes = analysis.Types()[4];
+  EXPECT_EQ(BigKeysAnalysis::TypeName(4), "hash");
+  EXPECT_EQ(hashes.keys, 2);
+  EXPECT_EQ(hashes.largest_by_elements.key, "big-hash");
+  EXPECT_EQ(hashes.largest_by_elements.size, 1000);
+  EXPECT_EQ(hashes.largest_by_bytes.key, "big-hash");
+  EXPECT_GT(hashes.largest_by_bytes.size, 1000 * 10);
+  EXPECT_EQ(hashes.elements_histogram[1], 1);
+  EXPECT_EQ(hashes.elements_histogram[10], 1);
+}
+
+TEST(BigKeysAnalysisTest, StopKeepsPartialResults) {
+  auto db = db::RedisDb::Create();
+  for (int index = 0; index < 1000; ++index) {
+    ASSERT_EQ(db->SetKey("key:" + std::to_string(index),
+                         db::RedisObject::CreateWithString("value"), 0),
+              db::DbStatus::kOk);
+  }
+  BigKeysAnalysis analysis;
+  analysis.Start();
+  EXPECT_FALSE(analysis.Step(db.get(), 0));
+  analysis.Stop();
+  EXPECT_EQ(analysis.GetState(), BigKeysAnalysis::State::kStopped);
+  const uint64_t scanned = analysis.ScannedKeys();
+  EXPECT_GT(scanned, 0);
+  EXPECT_LT(scanned, 1000);
+  analysis.RunCycle(db.get(), 10);
+  EXPECT_EQ(analysis.ScannedKeys(), scanned);
+}
+}  // namespace redis_simple
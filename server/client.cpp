@@ -18,6 +18,7 @@ namespace redis_simple {
 namespace {
 constexpr auto kReadBufferSize = size_t{16} * 1024;
 constexpr auto kMaxQueryBufferSize = size_t{64} * 1024 * 1024;
+constexpr size_t kMaxBatchedRequests = 64;
 }  // namespace
 
 Client::Client(std::unique_ptr<connection::Connection> connection,
@@ -81,6 +82,13 @@ bool Client::ShouldResumeReads() const {
          PendingReplyBytes() <= output_limits_.resume_bytes;
 }
 
+size_t Client::ReplyBytesAvailable() const {
+  const size_t pending = PendingReplyBytes();
+  return pending < output_limits_.hard_bytes
+             ? output_limits_.hard_bytes - pending
+             : 0;
+}
+
 bool Client::CanQueueReply(size_t size) {
   const size_t pending = PendingReplyBytes();
   if (size <= output_limits_.hard_bytes &&
@@ -155,39 +163,76 @@ ClientStatus Client::ProcessInputBuffer() {
   while (!close_after_reply_ && query_buf_.Consumed() < query_buf_.Size()) {
     RS_LOG_DEBUG("process loop %zu %zu\n", query_buf_.Consumed(),
                  query_buf_.Size());
-    const RequestStatus status = ParseRequest();
+    const RequestStatus status = ParseBatch();
+    PrefetchBatchKeys();
+    for (size_t index = 0; index < batch_size_ && !close_after_reply_;
+         ++index) {
+      auto& request = batch_[index];
+      if (request.command == nullptr) {
+        AddReply(std::move(request.rejection));
+        continue;
+      }
+      command_ = request.command;
+      args_.swap(request.args);
+      const ClientStatus result = ProcessCommand();
+      args_.swap(request.args);
+      if (result == ClientStatus::kError) {
+        return ClientStatus::kError;
+      }
+    }
+    if (status == RequestStatus::kProtocolError && !close_after_reply_) {
+      AddReply(reply::FromError("ERR Protocol error: invalid request"));
+      close_after_reply_ = true;
+      query_buf_.Clear();
+    }
     if (status == RequestStatus::kIncomplete ||
         status == RequestStatus::kProtocolError) {
       break;
     }
-    if (status == RequestStatus::kRejected) {
-      continue;
-    }
-    if (ProcessCommand() == ClientStatus::kError) {
-      return ClientStatus::kError;
-    }
   }
   query_buf_.Compact();
   return ClientStatus::kOk;
 }
 
-Client::RequestStatus Client::ParseRequest() {
-  command_ = nullptr;
-  args_.clear();
+/*
+ * Parse up to kMaxBatchedRequests pipelined requests from the query buffer.
+ * Their arguments point into the buffer, so it must not be compacted until the
+ * batch has run. Returns the status of the request that ended the batch.
+ */
+Client::RequestStatus Client::ParseBatch() {
+  batch_size_ = 0;
+  RequestStatus status = RequestStatus::kReady;
+  while (batch_size_ < kMaxBatchedRequests &&
+         query_buf_.Consumed() < query_buf_.Size()) {
+    if (batch_size_ == batch_.size()) {
+      batch_.emplace_back();
+    }
+    status = ParseRequest(&batch_[batch_size_]);
+    if (status == RequestStatus::kIncomplete ||
+        status == RequestStatus::kProtocolError) {
+      break;
+    }
+    ++batch_size_;
+  }
+  return status;
+}
+
+Client::RequestStatus Client::ParseRequest(PendingRequest* const request) {
+  request->command = nullptr;
+  request->args.clear();
+  request->rejection.clear();
   std::string_view name;
-  const auto parsed = request_parser::Parse(query_buf_.View(), &name, &args_);
+  const auto parsed =
+      request_parser::Parse(query_buf_.View(), &name, &request->args);
   if (parsed.status == request_parser::ParseStatus::kIncomplete) {
     return RequestStatus::kIncomplete;
   }
   if (parsed.status == request_parser::ParseStatus::kInvalid) {
-    AddReply(reply::FromError("ERR Protocol error: invalid request"));
-    close_after_reply_ = true;
-    query_buf_.Clear();
     return RequestStatus::kProtocolError;
   }
   query_buf_.Consume(parsed.consumed);
   if (name.empty()) {
-    AddReply(reply::FromError("ERR empty command"));
+    request->rejection = reply::FromError("ERR empty command");
     return RequestStatus::kRejected;
   }
   RS_LOG_DEBUG("command name %.*s\n", static_cast<int>(name.size()),
@@ -195,27 +240,53 @@ Client::RequestStatus Client::ParseRequest() {
   const auto* command = command::Find(name);
   if (command == nullptr) {
     RS_LOG_DEBUG("command not found\n");
-    AddReply(reply::UnknownCommand(name));
+    request->rejection = reply::UnknownCommand(name);
     return RequestStatus::kRejected;
   }
-  if (!command->arity.Accepts(args_.size())) {
-    AddReply(reply::WrongNumberOfArguments());
+  if (!command->arity.Accepts(request->args.size())) {
+    request->rejection = reply::WrongNumberOfArguments();
     return RequestStatus::kRejected;
   }
-  command_ = command;
+  request->command = command;
   return RequestStatus::kReady;
 }
 
+/*
+ * Prefetch the keyspace entries of every key in the batch so their cache misses
+ * overlap instead of stalling each command in turn. A lone request gains
+ * nothing from this and would only hash its keys twice.
+ */
+void Client::PrefetchBatchKeys() {
+  if (db_ == nullptr || batch_size_ < 2) {
+    return;
+  }
+  prefetch_keys_.clear();
+  for (size_t index = 0; index < batch_size_; ++index) {
+    const auto& request = batch_[index];
+    if (request.command != nullptr) {
+      command::ForEachKey(
+          request.command->keys, request.args,
+          [this](std::string_view key) { prefetch_keys_.push_back(key); });
+    }
+  }
+  db_->PrefetchKeys(prefetch_keys_.data(), prefetch_keys_.size());
+}
+
 ClientStatus Client::ProcessCommand() {
   if (command_ == nullptr) {
     return ClientStatus::kError;
   }
   RS_LOG_DEBUG("process command: %.*s\n",
                static_cast<int>(command_->name.size()), command_->name.data());
+  if (Server::Get()->PerformEvictions() == EvictionResult::kFail &&
+      command_->deny_oom) {
+    AddReply(reply::OutOfMemoryError());
+    return ClientStatus::kOk;
+  }
   modified_ = false;
+  propagate_command_ = {};
   command_->callback(this);
-  if (modified_ && aof_ != nullptr &&
-      !aof_->Append(command_->name, args_, db_)) {
+  if (modified_ && aof_ != nullptr && !AppendToAof()) {
     RS_LOG_DEBUG("failed to append command to AOF\n");
     close_after_reply_ = true;
     Server::Get()->Stop();
@@ -224,6 +295,21 @@ ClientStatus Client::ProcessCommand() {
   return ClientStatus::kOk;
 }
 
+void Client::PropagateAs(std::string_view command,
+                         std::vector<std::string> args) {
+  propagate_command_ = command;
+  propagate_args_ = std::move(args);
+}
+
+bool Client::AppendToAof() {
+  if (propagate_command_.empty()) {
+    return aof_->Append(command_->name, args_, db_);
+  }
+  const command::CommandArgs args(propagate_args_.begin(),
+                                  propagate_args_.end());
+  return aof_->Append(propagate_command_, args, db_);
+}
+
 bool Client::ExecuteForReplay(const command::Command* const command,
                               command::CommandArgs* const args) {
   if (command == nullptr || args == nullptr) {
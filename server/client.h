@@ -51,6 +51,11 @@ class Client {
   size_t AddReply(std::string&& header, std::string&& body);
   bool HasPendingReplies() const { return !reply_buf_.Empty(); }
   size_t PendingReplyBytes() const { return reply_buf_.PendingBytes(); }
+  // Reply bytes that can still be queued before the hard output limit.
+  size_t ReplyBytesAvailable() const;
+  // Heap bytes held by the query and reply buffers, used or not.
+  size_t QueryBufferBytes() const { return query_buf_.Bytes(); }
+  size_t OutputBufferBytes() const { return reply_buf_.Bytes(); }
   bool ShouldPauseReads() const;
   bool ShouldResumeReads() const;
   bool ReadsPaused() const { return reads_paused_; }
@@ -63,6 +68,10 @@ class Client {
   void Free() { connection_->Close(); }
   const command::CommandArgs& Args() const { return args_; }
   void MarkModified() { modified_ = true; }
+  // Log the current command to the AOF as command with args instead of as it
+  // was received, for commands whose effect depends on random choices. command
+  // must be a string literal.
+  void PropagateAs(std::string_view command, std::vector<std::string> args);
 
  private:
   friend class aof::Aof;
@@ -72,14 +81,24 @@ class Client {
     kRejected,
     kProtocolError,
   };
+  // A parsed request waiting in the current pipeline batch. command is null
+  // when the request was rejected, in which case rejection holds its reply.
+  struct PendingRequest {
+    const command::Command* command{nullptr};
+    command::CommandArgs args;
+    std::string rejection;
+  };
 
   Client(std::unique_ptr<connection::Connection> connection,
          OutputBufferLimits output_limits);
   explicit Client(db::RedisDb* db);
   bool ExecuteForReplay(const command::Command* command,
                         command::CommandArgs* args);
-  RequestStatus ParseRequest();
+  RequestStatus ParseBatch();
+  RequestStatus ParseRequest(PendingRequest* request);
+  void PrefetchBatchKeys();
   ClientStatus ProcessCommand();
+  bool AppendToAof();
   bool CanQueueReply(size_t size);
   ssize_t SendBufferReply();
   ssize_t SendListReply();
@@ -88,6 +107,9 @@ class Client {
   aof::Aof* aof_{nullptr};
   const command::Command* command_{nullptr};
   command::CommandArgs args_;
+  std::vector<PendingRequest> batch_;
+  size_t batch_size_{};
+  std::vector<std::string_view> prefetch_keys_;
   in_memory::DynamicBuffer query_buf_;
   in_memory::ReplyBuffer reply_buf_;
   std::vector<iovec> reply_blocks_;
@@ -96,6 +118,8 @@ class Client {
   bool reads_paused_{};
   bool close_after_reply_{};
   bool modified_{};
+  std::string_view propagate_command_;
+  std::vector<std::string> propagate_args_;
   bool discard_replies_{};
   bool reply_error_{};
 };
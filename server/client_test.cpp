@@ -197,6 +197,52 @@ TEST(ClientTest, RejectsInvalidArityBeforeDispatch) {
             "-ERR wrong number of arguments\r\n+PONG\r\n");
 }
 
+TEST(ClientTest, PipelinedRequestsRunInOrderAcrossBatches) {
+  auto [client, peer] = CreateClient();
+  constexpr int kKeys = 40;
+  std::vector<std::string> keys;
+  std::string request;
+  std::string expected;
+  for (int index = 0; index < kKeys; ++index) {
+    keys.push_back("pipeline-key-" + std::to_string(index));
+    request += EncodeRequest({"SET", keys.back(), std::to_string(index)});
+    expected += "+OK\r\n";
+  }
+  request += EncodeRequest({"NOSUCHCOMMAND"});
+  expected += reply::UnknownCommand("NOSUCHCOMMAND");
+  for (int index = 0; index < kKeys; ++index) {
+    request += EncodeRequest({"GET", keys[index]});
+    reply::AppendBulkString(std::to_string(index), &expected);
+  }
+  request += EncodeRequest({"DEL", keys.front(), keys.back()});
+  expected += reply::FromInt64(2);
+
+  ASSERT_EQ(write(peer.Get(), request.data(), request.size()),
+            static_cast<ssize_t>(request.size()));
+  ASSERT_EQ(client->ReadQuery(), static_cast<ssize_t>(request.size()));
+  EXPECT_EQ(client->ProcessInputBuffer(), ClientStatus::kOk);
+  EXPECT_FALSE(client->ShouldCloseAfterReply());
+  EXPECT_EQ(SendAndReadReply(client.get(), peer.Get()), expected);
+  for (const auto& key : keys) {
+    client->Db()->DeleteKey(key);
+  }
+}
+
+TEST(ClientTest, ProtocolErrorRepliesAfterEarlierPipelinedRequests) {
+  auto [client, peer] = CreateClient();
+  const std::string request = EncodeRequest({"PING"}) +
+                              EncodeRequest({"GET", "missing-pipeline-key"}) +
+                              "*1\r\n+GET\r\n";
+
+  ASSERT_EQ(write(peer.Get(), request.data(), request.size()),
+            static_cast<ssize_t>(request.size()));
+  ASSERT_EQ(client->ReadQuery(), static_cast<ssize_t>(request.size()));
+  EXPECT_EQ(client->ProcessInputBuffer(), ClientStatus::kOk);
+  EXPECT_TRUE(client->ShouldCloseAfterReply());
+  EXPECT_EQ(SendAndReadReply(client.get(), peer.Get()),
+            "+PONG\r\n$-1\r\n-ERR Protocol error: invalid request\r\n");
+}
+
 TEST(ClientTest, OutputLimitsControlBackpressure) {
   auto [client, peer] = CreateClient({4, 8, 16});
   EXPECT_EQ(client->AddReply(std::string_view("12345678")), 8);
@@ -213,6 +259,21 @@ TEST(ClientTest, OutputLimitsControlBackpressure) {
   EXPECT_FALSE(limited_client->HasPendingReplies());
 }
 
+TEST(ClientTest, LargeNegativeSRandMemberStopsAtOutputLimit) {
+  auto [client, peer] = CreateClient({1024, 2048, 4096});
+  const std::string request =
+      EncodeRequest({"DEL", "client-srandmember"}) +
+      EncodeRequest({"SADD", "client-srandmember", "a", "b", "c"}) +
+      EncodeRequest({"SRANDMEMBER", "client-srandmember", "-1000000000"});
+  ASSERT_EQ(write(peer.Get(), request.data(), request.size()),
+            static_cast<ssize_t>(request.size()));
+  ASSERT_EQ(client->ReadQuery(), static_cast<ssize_t>(request.size()));
+  EXPECT_EQ(client->ProcessInputBuffer(), ClientStatus::kOk);
+  EXPECT_TRUE(client->ShouldCloseAfterReply());
+  EXPECT_LE(client->PendingReplyBytes(), 4096);
+  EXPECT_EQ(SendAndReadReply(client.get(), peer.Get()), ":0\r\n:3\r\n");
+}
+
 TEST(ClientTest, QueuesSplitReplyAtomically) {
   auto [client, peer] = CreateClient({4, 8, 16});
   EXPECT_EQ(client->AddReply(std::string("header"), std::string("body")), 10);
@@ -0,0 +1,116 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "server/big_keys.h"
+#include "server/client.h"
+#include "server/commands/handlers.h"
+#include "server/reply.h"
+#include "server/server.h"
+#include "utils/string_utils.h"
+
+namespace redis_simple::command::bigkeys {
+namespace {
+void AppendField(std::string_view name, std::string_view value,
+                 std::string* const output) {
+  output->append(name).push_back(':');
+  output->append(value).append("\r\n");
+}
+
+void AppendField(std::string_view name, uint64_t value,
+                 std::string* const output) {
+  AppendField(name, std::to_string(value), output);
+}
+
+std::string_view StateName(BigKeysAnalysis::State state) {
+  switch (state) {
+    case BigKeysAnalysis::State::kIdle:
+      return "idle";
+    case BigKeysAnalysis::State::kRunning:
+      return "running";
+    case BigKeysAnalysis::State::kDone:
+      return "done";
+    case BigKeysAnalysis::State::kStopped:
+      return "stopped";
+  }
+  return "unknown";
+}
+
+// Nonempty buckets as lower_bound=keys, where each bucket holds sizes from
+// its bound up to twice it.
+std::string FormatHistogram(const TypeSizeStats::Histogram& histogram) {
+  std::string formatted;
+  for (size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+    if (histogram[bucket] == 0) {
+      continue;
+    }
+    if (!formatted.empty()) {
+      formatted.push_back(',');
+    }
+    const uint64_t lower = bucket == 0 ? 0 : uint64_t{1} << (bucket - 1);
+    formatted.append(std::to_string(lower))
+        .append("=")
+        .append(std::to_string(histogram[bucket]));
+  }
+  return formatted;
+}
+
+/*
+ * The progress of the analysis, then one section per type with keys: totals,
+ * the largest key by elements and by bytes, and log2 histograms of both.
+ */
+std::string FormatReport(const BigKeysAnalysis& analysis) {
+  std::string report = "# BigKeys\r\n";
+  AppendField("status", StateName(analysis.GetState()), &report);
+  AppendField("scanned_keys", analysis.ScannedKeys(), &report);
+  AppendField("elapsed_ms",
+              static_cast<uint64_t>(analysis.ElapsedMilliseconds()), &report);
+  const auto& types = analysis.Types();
+  for (size_t index = 0; index < types.size(); ++index) {
+    const auto& stats = types[index];
+    if (stats.keys == 0) {
+      continue;
+    }
+    report.append("\r\n# ")
+        .append(BigKeysAnalysis::TypeName(index))
+        .append("\r\n");
+    AppendField("keys", stats.keys, &report);
+    AppendField("elements", stats.elements, &report);
+    AppendField("bytes", stats.bytes, &report);
+    AppendField("largest_elements_key", stats.largest_by_elements.key,
+                &report);
+    AppendField("largest_elements", stats.largest_by_elements.size, &report);
+    AppendField("largest_bytes_key", stats.largest_by_bytes.key, &report);
+    AppendField("largest_bytes", stats.largest_by_bytes.size, &report);
+    AppendField("elements_log2", FormatHistogram(stats.elements_histogram),
+                &report);
+    AppendField("bytes_log2", FormatHistogram(stats.bytes_histogram),
+                &report);
+  }
+  return report;
+}
+}  // namespace
+
+/*
+ * BIGKEYS [START|STOP|STATUS]. START begins a new analysis that the cron runs
+ * in time slices, STOP abandons it, and STATUS, the default, reports what it
+ * has found so far.
+ */
+void HandleBigKeys(Client* const client) {
+  const auto& args = client->Args();
+  auto& analysis = Server::Get()->BigKeys();
+  if (args.empty() || utils::EqualsIgnoreCase(args[0], "STATUS")) {
+    client->AddReply(reply::FromBulkString(FormatReport(analysis)));
+  } else if (utils::EqualsIgnoreCase(args[0], "START")) {
+    analysis.Start();
+    client->AddReply(reply::FromString("OK"));
+  } else if (utils::EqualsIgnoreCase(args[0], "STOP")) {
+    analysis.Stop();
+    client->AddReply(reply::FromString("OK"));
+  } else {
+    client->AddReply(reply::FromError("ERR unknown subcommand '" +
+                                      std::string(args[0]) + "'"));
+  }
+}
+}  // namespace redis_simple::command::bigkeys
@@ -34,7 +34,16 @@ constexpr Command ReadCommand(std::string_view name, CommandCallback callback,
 
 constexpr Command WriteCommand(std::string_view name, CommandCallback callback,
                                CommandArity arity, KeySpec keys = NoKeys()) {
-  return {name, callback, arity, CommandAccess::kWrite, keys};
+  return {name, callback, arity, CommandAccess::kWrite, keys, true};
+}
+
+// A write that never adds data, so it still runs when memory is over the
+// limit and may be what brings it back under.
+constexpr Command ShrinkingCommand(std::string_view name,
+                                   CommandCallback callback,
+                                   CommandArity arity,
+                                   KeySpec keys = NoKeys()) {
+  return {name, callback, arity, CommandAccess::kWrite, keys, false};
 }
 
 constexpr Command AdminCommand(std::string_view name, CommandCallback callback,
@@ -72,15 +81,16 @@ constexpr std::array kCommandTable = {
     WriteCommand("APPEND", strings::HandleAppend, FixedArity(2), OneKey()),
     AdminCommand("BGREWRITEAOF", persistence::HandleBgRewriteAof,
                  FixedArity(0)),
+    AdminCommand("BIGKEYS", bigkeys::HandleBigKeys, {0, 1}),
     ReadCommand("DBSIZE", key::HandleDbSize, FixedArity(0)),
     WriteCommand("DECR", strings::HandleDecr, FixedArity(1), OneKey()),
-    WriteCommand("DEL", key::HandleDel, VariableArity(1), AllKeys()),
+    ShrinkingCommand("DEL", key::HandleDel, VariableArity(1), AllKeys()),
     ConnectionCommand("ECHO", session::HandleEcho, FixedArity(1)),
     ReadCommand("EXISTS", key::HandleExists, VariableArity(1), AllKeys()),
-    WriteCommand("EXPIRE", key::HandleExpire, FixedArity(2), OneKey()),
-    WriteCommand("FLUSHDB", key::HandleFlushDb, FixedArity(0)),
+    ShrinkingCommand("EXPIRE", key::HandleExpire, FixedArity(2), OneKey()),
+    ShrinkingCommand("FLUSHDB", key::HandleFlushDb, {0, 1}),
     ReadCommand("GET", strings::HandleGet, FixedArity(1), OneKey()),
-    WriteCommand("HDEL", hashes::HandleHDel, VariableArity(2), OneKey()),
+    ShrinkingCommand("HDEL", hashes::HandleHDel, VariableArity(2), OneKey()),
     ConnectionCommand("HELLO", session::HandleHello, {0, 1}),
     ReadCommand("HEXISTS", hashes::HandleHExists, FixedArity(2), OneKey()),
     ReadCommand("HGET", hashes::HandleHGet, FixedArity(2), OneKey()),
@@ -89,28 +99,32 @@ constexpr std::array kCommandTable = {
     ReadCommand("HKEYS", hashes::HandleHKeys, FixedArity(1), OneKey()),
     ReadCommand("HLEN", hashes::HandleHLen, FixedArity(1), OneKey()),
     ReadCommand("HMGET", hashes::HandleHMGet, VariableArity(2), OneKey()),
+    AdminCommand("HOTKEYS", hotkeys::HandleHotKeys, VariableArity(0)),
     WriteCommand("HSET", hashes::HandleHSet, VariableArity(3), OneKey()),
     ReadCommand("HVALS", hashes::HandleHVals, FixedArity(1), OneKey()),
     WriteCommand("INCR", strings::HandleIncr, FixedArity(1), OneKey()),
-    AdminCommand("INFO", persistence::HandleInfo, {0, 1}),
+    AdminCommand("INFO", info::HandleInfo, {0, 1}),
     ReadCommand("LINDEX", lists::HandleLIndex, FixedArity(2), OneKey()),
     ReadCommand("LLEN", lists::HandleLLen, FixedArity(1), OneKey()),
-    WriteCommand("LPOP", lists::HandleLPop, FixedArity(1), OneKey()),
+    ShrinkingCommand("LPOP", lists::HandleLPop, FixedArity(1), OneKey()),
     WriteCommand("LPUSH", lists::HandleLPush, VariableArity(2), OneKey()),
     ReadCommand("LRANGE", lists::HandleLRange, FixedArity(3), OneKey()),
-    WriteCommand("LREM", lists::HandleLRem, FixedArity(3), OneKey()),
+    ShrinkingCommand("LREM", lists::HandleLRem, FixedArity(3), OneKey()),
     WriteCommand("LSET", lists::HandleLSet, FixedArity(3), OneKey()),
-    WriteCommand("LTRIM", lists::HandleLTrim, FixedArity(3), OneKey()),
+    ShrinkingCommand("LTRIM", lists::HandleLTrim, FixedArity(3), OneKey()),
+    AdminCommand("MEMORY", memory::HandleMemory, VariableArity(1)),
     ReadCommand("MGET", strings::HandleMGet, VariableArity(1), AllKeys()),
     WriteCommand("MSET", strings::HandleMSet, VariableArity(2), AllKeys(0, 2)),
-    WriteCommand("PERSIST", key::HandlePersist, FixedArity(1), OneKey()),
-    WriteCommand("PEXPIRE", key::HandlePExpire, FixedArity(2), OneKey()),
-    WriteCommand("PEXPIREAT", key::HandlePExpireAt, FixedArity(2), OneKey()),
+    ShrinkingCommand("PERSIST", key::HandlePersist, FixedArity(1), OneKey()),
+    ShrinkingCommand("PEXPIRE", key::HandlePExpire, FixedArity(2), OneKey()),
+    ShrinkingCommand("PEXPIREAT", key::HandlePExpireAt, FixedArity(2),
+                     OneKey()),
     ConnectionCommand("PING", session::HandlePing, {0, 1}),
     ReadCommand("PTTL", key::HandlePTtl, FixedArity(1), OneKey()),
     ConnectionCommand("QUIT", session::HandleQuit, FixedArity(0)),
-    WriteCommand("RENAME", key::HandleRename, FixedArity(2), {0, 1, 1}),
-    WriteCommand("RPOP", lists::HandleRPop, FixedArity(1), OneKey()),
+    ReadCommand("RANDOMKEY", key::HandleRandomKey, FixedArity(0)),
+    ShrinkingCommand("RENAME", key::HandleRename, FixedArity(2), {0, 1, 1}),
+    ShrinkingCommand("RPOP", lists::HandleRPop, FixedArity(1), OneKey()),
     WriteCommand("RPUSH", lists::HandleRPush, VariableArity(2), OneKey()),
     WriteCommand("SADD", sets::HandleSAdd, VariableArity(2), OneKey()),
     ReadCommand("SCAN", key::HandleScan, VariableArity(1)),
@@ -120,11 +134,14 @@ constexpr std::array kCommandTable = {
     ReadCommand("SINTER", sets::HandleSInter, VariableArity(1), AllKeys()),
     ReadCommand("SISMEMBER", sets::HandleSIsMember, FixedArity(2), OneKey()),
     ReadCommand("SMEMBERS", sets::HandleSMembers, FixedArity(1), OneKey()),
-    WriteCommand("SREM", sets::HandleSRem, VariableArity(2), OneKey()),
+    ShrinkingCommand("SPOP", sets::HandleSPop, {1, 2}, OneKey()),
+    ReadCommand("SRANDMEMBER", sets::HandleSRandMember, {1, 2}, OneKey()),
+    ShrinkingCommand("SREM", sets::HandleSRem, VariableArity(2), OneKey()),
     ReadCommand("SUNION", sets::HandleSUnion, VariableArity(1), AllKeys()),
     ReadCommand("TTL", key::HandleTtl, FixedArity(1), OneKey()),
     ReadCommand("TYPE", key::HandleType, FixedArity(1), OneKey()),
-    WriteCommand("UNLINK", key::HandleUnlink, VariableArity(1), AllKeys()),
+    ShrinkingCommand("UNLINK", key::HandleUnlink, VariableArity(1),
+                     AllKeys()),
     WriteCommand("ZADD", zsets::HandleZAdd, VariableArity(3), OneKey()),
     ReadCommand("ZCARD", zsets::HandleZCard, FixedArity(1), OneKey()),
     ReadCommand("ZCOUNT", zsets::HandleZCount, FixedArity(3), OneKey()),
@@ -132,7 +149,7 @@ constexpr std::array kCommandTable = {
     ReadCommand("ZRANGEBYSCORE", zsets::HandleZRangeByScore, VariableArity(3),
                 OneKey()),
     ReadCommand("ZRANK", zsets::HandleZRank, FixedArity(2), OneKey()),
-    WriteCommand("ZREM", zsets::HandleZRem, VariableArity(2), OneKey()),
+    ShrinkingCommand("ZREM", zsets::HandleZRem, VariableArity(2), OneKey()),
     ReadCommand("ZREVRANGE", zsets::HandleZRevRange, VariableArity(3),
                 OneKey()),
     ReadCommand("ZSCORE", zsets::HandleZScore, FixedArity(2), OneKey()),
@@ -46,7 +46,23 @@ struct Command {
   CommandArity arity;
   CommandAccess access;
   KeySpec keys;
+  // Whether the command may add data and is refused while used memory stays
+  // above maxmemory after eviction.
+  bool deny_oom{};
 };
 
+// Call visitor with every argument of args that spec marks as a key.
+template <typename Visitor>
+void ForEachKey(const KeySpec& spec, const CommandArgs& args,
+                Visitor&& visitor) {
+  if (!spec.HasKeys()) {
+    return;
+  }
+  for (size_t index = spec.first; index < args.size() && index <= spec.last;
+       index += spec.step) {
+    visitor(args[index]);
+  }
+}
+
 const Command* Find(std::string_view name);
 }  // namespace redis_simple::command
@@ -3,6 +3,8 @@
 #include <gtest/gtest.h>
 
 #include <array>
+#include <string_view>
+#include <vector>
 
 namespace redis_simple::command {
 TEST(CommandRegistryTest, FindsCommandsCaseInsensitively) {
@@ -60,6 +62,14 @@ TEST(CommandRegistryTest, ExposesCommandMetadata) {
   EXPECT_EQ(mset->keys.last, KeySpec::kAllRemaining);
   EXPECT_EQ(mset->keys.step, 2);
 
+  EXPECT_TRUE(mset->deny_oom);
+  EXPECT_FALSE(get->deny_oom);
+
+  const auto* del = Find("DEL");
+  ASSERT_NE(del, nullptr);
+  EXPECT_EQ(del->access, CommandAccess::kWrite);
+  EXPECT_FALSE(del->deny_oom);
+
   const auto* ping = Find("PING");
   ASSERT_NE(ping, nullptr);
   EXPECT_EQ(ping->access, CommandAccess::kConnection);
@@ -75,5 +85,45 @@ TEST(CommandRegistryTest, ExposesCommandMetadata) {
   EXPECT_EQ(info->access, CommandAccess::kAdmin);
   EXPECT_TRUE(info->arity.Accepts(0));
   EXPECT_TRUE(info->arity.Accepts(1));
+
+  const auto* memory = Find("MEMORY");
+  ASSERT_NE(memory, nullptr);
+  EXPECT_EQ(memory->access, CommandAccess::kAdmin);
+  EXPECT_FALSE(memory->arity.Accepts(0));
+  EXPECT_TRUE(memory->arity.Accepts(4));
+
+  const auto* bigkeys = Find("BIGKEYS");
+  ASSERT_NE(bigkeys, nullptr);
+  EXPECT_EQ(bigkeys->access, CommandAccess::kAdmin);
+  EXPECT_TRUE(bigkeys->arity.Accepts(0));
+  EXPECT_FALSE(bigkeys->arity.Accepts(2));
+
+  const auto* hotkeys = Find("HOTKEYS");
+  ASSERT_NE(hotkeys, nullptr);
+  EXPECT_EQ(hotkeys->access, CommandAccess::kAdmin);
+  EXPECT_TRUE(hotkeys->arity.Accepts(0));
+  EXPECT_TRUE(hotkeys->arity.Accepts(4));
+
+  const auto* flushdb = Find("FLUSHDB");
+  ASSERT_NE(flushdb, nullptr);
+  EXPECT_TRUE(flushdb->arity.Accepts(0));
+  EXPECT_TRUE(flushdb->arity.Accepts(1));
+  EXPECT_FALSE(flushdb->arity.Accepts(2));
+}
+
+TEST(CommandRegistryTest, ForEachKeyFollowsKeySpec) {
+  std::vector<std::string_view> keys;
+  auto collect = [&keys](std::string_view key) { keys.push_back(key); };
+
+  ForEachKey(Find("MSET")->keys, {"k1", "v1", "k2", "v2"}, collect);
+  EXPECT_EQ(keys, (std::vector<std::string_view>{"k1", "k2"}));
+
+  keys.clear();
+  ForEachKey(Find("HMGET")->keys, {"hash", "f1", "f2"}, collect);
+  EXPECT_EQ(keys, (std::vector<std::string_view>{"hash"}));
+
+  keys.clear();
+  ForEachKey(Find("PING")->keys, {"message"}, collect);
+  EXPECT_TRUE(keys.empty());
 }
 }  // namespace redis_simple::command
@@ -14,6 +14,7 @@ void HandlePersist(Client* client);
 void HandlePExpire(Client* client);
 void HandlePExpireAt(Client* client);
 void HandlePTtl(Client* client);
+void HandleRandomKey(Client* client);
 void HandleRename(Client* client);
 void HandleScan(Client* client);
 void HandleTtl(Client* client);
@@ -30,9 +31,24 @@ void HandleQuit(Client* client);
 
 namespace redis_simple::command::persistence {
 void HandleBgRewriteAof(Client* client);
-void HandleInfo(Client* client);
 }  // namespace redis_simple::command::persistence
 
+namespace redis_simple::command::info {
+void HandleInfo(Client* client);
+}  // namespace redis_simple::command::info
+
+namespace redis_simple::command::bigkeys {
+void HandleBigKeys(Client* client);
+}  // namespace redis_simple::command::bigkeys
+
+namespace redis_simple::command::hotkeys {
+void HandleHotKeys(Client* client);
+}  // namespace redis_simple::command::hotkeys
+
+namespace redis_simple::command::memory {
+void HandleMemory(Client* client);
+}  // namespace redis_simple::command::memory
+
 namespace redis_simple::command::strings {
 void HandleAppend(Client* client);
 void HandleDecr(Client* client);
@@ -63,6 +79,8 @@ void HandleSDiff(Client* client);
 void HandleSIsMember(Client* client);
 void HandleSInter(Client* client);
 void HandleSMembers(Client* client);
+void HandleSPop(Client* client);
+void HandleSRandMember(Client* client);
 void HandleSRem(Client* client);
 void HandleSUnion(Client* client);
 }  // namespace redis_simple::command::sets
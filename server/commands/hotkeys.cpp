@@ -0,0 +1,78 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "server/client.h"
+#include "server/commands/handlers.h"
+#include "server/db/db.h"
+#include "server/db/eviction.h"
+#include "server/reply.h"
+#include "utils/string_utils.h"
+
+namespace redis_simple::command::hotkeys {
+namespace {
+// Keys reported unless COUNT is given.
+constexpr size_t kDefaultCount = 10;
+// Upper bound on both COUNT and SAMPLES.
+constexpr int64_t kMaxValue = 1000000;
+}  // namespace
+
+/*
+ * HOTKEYS [COUNT count] [SAMPLES keys]. Replies with the most accessed keys
+ * and their access counts. By default they come from the access sketch,
+ * which costs no scanning but is fed only when --hotkeys-sample-rate is set;
+ * SAMPLES instead scans that many keys and ranks them by the LFU counters of
+ * their objects, which only an LFU eviction policy maintains.
+ */
+void HandleHotKeys(Client* const client) {
+  const auto& args = client->Args();
+  if (args.size() % 2 != 0) {
+    client->AddReply(reply::SyntaxError());
+    return;
+  }
+  size_t count = kDefaultCount;
+  size_t samples = 0;
+  for (size_t index = 0; index < args.size(); index += 2) {
+    int64_t value = 0;
+    const bool is_count = utils::EqualsIgnoreCase(args[index], "COUNT");
+    if (!is_count && !utils::EqualsIgnoreCase(args[index], "SAMPLES")) {
+      client->AddReply(reply::SyntaxError());
+      return;
+    }
+    if (!utils::ToInt64(args[index + 1], &value) || value <= 0 ||
+        value > kMaxValue) {
+      client->AddReply(
+          reply::FromError("ERR value is out of range, must be positive"));
+      return;
+    }
+    (is_count ? count : samples) = static_cast<size_t>(value);
+  }
+  auto* const db = client->Db();
+  if (db == nullptr) {
+    client->AddReply(reply::FromError("ERR db unavailable"));
+    return;
+  }
+  if (samples == 0 && !db->TracksHotKeys()) {
+    client->AddReply(
+        reply::FromError("ERR hot key tracking is off, set "
+                         "hotkeys-sample-rate or use SAMPLES"));
+    return;
+  }
+  if (samples != 0 && !db::TracksFrequency(db->GetEvictionPolicy())) {
+    client->AddReply(
+        reply::FromError("ERR an LFU maxmemory-policy is required to rank "
+                         "sampled keys"));
+    return;
+  }
+  const auto hot_keys = samples == 0 ? db->HotKeys(count)
+                                     : db->SampleHotKeys(count, samples);
+  std::string encoded =
+      reply::FromMapHeader(hot_keys.size(), client->Protocol());
+  for (const auto& hot_key : hot_keys) {
+    reply::AppendBulkString(hot_key.key, &encoded);
+    encoded.append(reply::FromInt64(static_cast<int64_t>(hot_key.hits)));
+  }
+  client->AddReply(std::move(encoded));
+}
+}  // namespace redis_simple::command::hotkeys
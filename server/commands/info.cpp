@@ -0,0 +1,248 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "memory/defrag.h"
+#include "memory/slab_allocator.h"
+#include "memory/used_memory.h"
+#include "server/aof.h"
+#include "server/client.h"
+#include "server/commands/handlers.h"
+#include "server/db/db.h"
+#include "server/reply.h"
+#include "server/server.h"
+#include "utils/string_utils.h"
+
+namespace redis_simple::command::info {
+namespace {
+void AppendField(std::string_view name, std::string_view value,
+                 std::string* const output) {
+  output->append(name).push_back(':');
+  output->append(value).append("\r\n");
+}
+
+void AppendField(std::string_view name, size_t value,
+                 std::string* const output) {
+  AppendField(name, std::to_string(value), output);
+}
+
+void AppendField(std::string_view name, int64_t value,
+                 std::string* const output) {
+  AppendField(name, std::to_string(value), output);
+}
+
+std::string FormatPercent(size_t part, size_t whole) {
+  std::array<char, 32> percent{};
+  std::snprintf(percent.data(), percent.size(), "%.2f",
+                whole == 0 ? 0.0
+                           : 100.0 * static_cast<double>(part) /
+                                 static_cast<double>(whole));
+  return percent.data();
+}
+
+/*
+ * Used memory against the maxmemory limit and split into overhead and
+ * dataset, value bytes by encoding, what the async reclaimer has yet to free,
+ * the malloc heap and its free share, then slab allocator totals, one line per
+ * size class in use, and the bytes held by each subsystem. Fragmentation is
+ * the share of heap or slab bytes not in use.
+ */
+void AppendMemory(Client* const /*client*/, std::string* const info) {
+  info->append("# Memory\r\n");
+  auto* const server = Server::Get();
+  const auto memory = server->MemoryBreakdown();
+  AppendField("used_memory", memory.used_bytes, info);
+  AppendField("used_memory_startup", memory.startup_bytes, info);
+  AppendField("used_memory_overhead", memory.overhead_bytes, info);
+  AppendField("used_memory_dataset", memory.dataset_bytes, info);
+  AppendField("used_memory_dataset_perc",
+              FormatPercent(memory.dataset_bytes,
+                            memory.used_bytes > memory.startup_bytes
+                                ? memory.used_bytes - memory.startup_bytes
+                                : 0),
+              info);
+  AppendField("mem_clients_query", memory.clients.query_bytes, info);
+  AppendField("mem_clients_output", memory.clients.output_bytes, info);
+  AppendField("mem_aof_buffer", memory.aof_buffer_bytes, info);
+  AppendField("mem_keyspace_table", memory.keyspace.keyspace_bytes, info);
+  AppendField("mem_expires_index", memory.keyspace.expires_bytes, info);
+  AppendField("mem_prefix_index", memory.keyspace.prefix_index_bytes, info);
+  for (const auto& encoding : memory.keyspace.encodings) {
+    AppendField("mem_encoding_" + std::string(encoding.encoding),
+                "keys=" + std::to_string(encoding.keys) +
+                    ",bytes=" + std::to_string(encoding.bytes),
+                info);
+  }
+  if (const auto* const db = server->Db()) {
+    AppendField("lazyfree_pending_objects", db->PendingReclaims(), info);
+    AppendField("lazyfree_pending_bytes", db->PendingReclaimBytes(), info);
+  }
+  AppendField("maxmemory", server->MaxMemory(), info);
+  AppendField("maxmemory_policy",
+              db::EvictionPolicyName(server->MaxMemoryPolicy()), info);
+  const auto heap = in_memory::HeapMemoryStats();
+  AppendField("allocator_heap_bytes", heap.heap_bytes, info);
+  AppendField("allocator_frag_bytes", heap.free_bytes, info);
+  AppendField("allocator_frag_perc",
+              FormatPercent(heap.free_bytes, heap.heap_bytes), info);
+  const auto stats = in_memory::SlabMemoryStats();
+  size_t slab_bytes = 0;
+  size_t used_bytes = 0;
+  size_t free_bytes = 0;
+  for (const auto& size_class : stats.classes) {
+    slab_bytes += size_class.slab_bytes;
+    used_bytes += size_class.used_bytes;
+    free_bytes += size_class.free_bytes;
+  }
+  AppendField("slab_bytes", slab_bytes, info);
+  AppendField("slab_used_bytes", used_bytes, info);
+  AppendField("slab_free_bytes", free_bytes, info);
+  AppendField("slab_fragmentation_perc",
+              FormatPercent(slab_bytes - used_bytes, slab_bytes), info);
+  AppendField("slab_large_bytes", stats.large_bytes, info);
+  for (const auto& size_class : stats.classes) {
+    if (size_class.slab_bytes == 0) {
+      continue;
+    }
+    const std::string value =
+        "slab_bytes=" + std::to_string(size_class.slab_bytes) +
+        ",used_bytes=" + std::to_string(size_class.used_bytes) +
+        ",free_bytes=" + std::to_string(size_class.free_bytes) +
+        ",fragmentation_perc=" +
+        FormatPercent(size_class.slab_bytes - size_class.used_bytes,
+                      size_class.slab_bytes);
+    AppendField("slab_class_" + std::to_string(size_class.object_size), value,
+                info);
+  }
+  for (size_t tag = 0; tag < in_memory::kSlabTagCount; ++tag) {
+    const std::string name(
+        in_memory::SlabTagName(static_cast<in_memory::SlabTag>(tag)));
+    AppendField(name + "_bytes", stats.tag_bytes[tag], info);
+  }
+}
+
+void AppendPersistence(Client* const client, std::string* const info) {
+  info->append("# Persistence\r\n");
+  const auto* const append_only_file = client->Aof();
+  AppendField("aof_enabled", append_only_file == nullptr ? "0" : "1", info);
+  if (append_only_file == nullptr) {
+    AppendField("aof_rewrite_in_progress", "0", info);
+    AppendField("aof_last_bgrewrite_status", "none", info);
+    AppendField("aof_last_error", "none", info);
+    AppendField("aof_current_size", size_t{0}, info);
+    AppendField("aof_base_size", size_t{0}, info);
+    AppendField("aof_pending_bytes", size_t{0}, info);
+    return;
+  }
+
+  const auto state = append_only_file->State();
+  AppendField("aof_rewrite_in_progress", state.rewrite_in_progress ? "1" : "0",
+              info);
+  AppendField("aof_last_bgrewrite_status",
+              aof::RewriteStatusName(state.rewrite_status), info);
+  AppendField("aof_last_error", aof::ErrorName(state.last_error), info);
+  AppendField("aof_current_size", state.current_size, info);
+  AppendField("aof_base_size", state.base_size, info);
+  AppendField("aof_pending_bytes", state.pending_bytes, info);
+}
+
+void AppendTableStats(std::string_view prefix, const db::TableStats& stats,
+                      std::string* const info) {
+  const std::string name(prefix);
+  AppendField(name + "_shards", stats.shards, info);
+  AppendField(name + "_buckets", stats.buckets, info);
+  AppendField(name + "_rehashing", stats.rehashing ? "1" : "0", info);
+  AppendField(name + "_rehashed_buckets", stats.rehashed_buckets, info);
+}
+
+void AppendStats(Client* const client, std::string* const info) {
+  info->append("# Stats\r\n");
+  const auto* const db = client->Db();
+  if (db == nullptr) {
+    return;
+  }
+  const auto& rehash = db->RehashStats();
+  AppendField("active_rehash_cycles", static_cast<size_t>(rehash.cycles),
+              info);
+  AppendField("active_rehash_time_us", rehash.total_microseconds, info);
+  AppendField("active_rehash_max_stall_us", rehash.max_stall_microseconds,
+              info);
+  const auto& expire = db->ExpireStats();
+  AppendField("expired_keys", static_cast<size_t>(expire.expired_keys), info);
+  AppendField("evicted_keys",
+              static_cast<size_t>(db->EvictStats().evicted_keys), info);
+  AppendField("lazyfreed_objects",
+              static_cast<size_t>(db->ReclaimedObjects()), info);
+  std::array<char, 32> stale_percent{};
+  std::snprintf(stale_percent.data(), stale_percent.size(), "%.2f",
+                expire.stale_percent);
+  AppendField("expired_stale_perc", stale_percent.data(), info);
+  AppendField("expire_cycle_cpu_milliseconds",
+              expire.total_microseconds / 1000, info);
+  AppendField("active_expire_slow_cycles",
+              static_cast<size_t>(expire.slow_cycles), info);
+  AppendField("active_expire_fast_cycles",
+              static_cast<size_t>(expire.fast_cycles), info);
+  const auto& defrag = db->DefragStats();
+  AppendField("active_defrag_running",
+              static_cast<size_t>(Server::Get()->Defragger().CyclePercent()),
+              info);
+  AppendField("active_defrag_hits", static_cast<size_t>(defrag.hits), info);
+  AppendField("active_defrag_misses", static_cast<size_t>(defrag.misses),
+              info);
+  AppendField("active_defrag_key_hits", static_cast<size_t>(defrag.key_hits),
+              info);
+  AppendField("active_defrag_key_misses",
+              static_cast<size_t>(defrag.key_misses), info);
+  AppendField("active_defrag_bytes_moved",
+              static_cast<size_t>(defrag.bytes_moved), info);
+  AppendField("active_defrag_passes", static_cast<size_t>(defrag.passes),
+              info);
+  AppendField("active_defrag_time_us", defrag.total_microseconds, info);
+  AppendTableStats("keyspace", db->KeyspaceTableStats(), info);
+  AppendField("expires_keys", db->ExpiringKeyCount(), info);
+  const auto prefix_index = db->PrefixStats();
+  AppendField("prefix_index_enabled", prefix_index.enabled ? "1" : "0", info);
+  AppendField("prefix_index_keys", prefix_index.keys, info);
+  AppendField("prefix_index_nodes", prefix_index.nodes, info);
+  AppendField("prefix_index_memory_bytes", prefix_index.memory_bytes, info);
+}
+
+struct Section {
+  std::string_view name;
+  void (*append)(Client* client, std::string* info);
+};
+
+constexpr Section kSections[] = {
+    {"memory", AppendMemory},
+    {"persistence", AppendPersistence},
+    {"stats", AppendStats},
+};
+}  // namespace
+
+void HandleInfo(Client* const client) {
+  const auto& args = client->Args();
+  if (args.size() > 1) {
+    client->AddReply(reply::WrongNumberOfArguments());
+    return;
+  }
+  const bool all_sections = args.empty() ||
+                            utils::EqualsIgnoreCase(args[0], "all") ||
+                            utils::EqualsIgnoreCase(args[0], "default");
+
+  std::string info;
+  for (const auto& section : kSections) {
+    if (!all_sections && !utils::EqualsIgnoreCase(args[0], section.name)) {
+      continue;
+    }
+    if (!info.empty()) {
+      info.append("\r\n");
+    }
+    section.append(client, &info);
+  }
+  client->AddReply(reply::FromBulkString(info));
+}
+}  // namespace redis_simple::command::info
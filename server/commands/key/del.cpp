@@ -13,11 +13,11 @@ using DeleteOperation = db::DbStatus (db::RedisDb::*)(std::string_view);
 int DeleteKeys(db::RedisDb* const redis_db, const CommandArgs& keys,
                DeleteOperation operation) {
   int deleted = 0;
-  for (std::string_view key : keys) {
+  redis_db->ForEachKeyPrefetched(keys, [&](std::string_view key) {
     if ((redis_db->*operation)(key) == db::DbStatus::kOk) {
       ++deleted;
     }
-  }
+  });
   return deleted;
 }
 
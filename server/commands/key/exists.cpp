@@ -10,11 +10,11 @@ namespace redis_simple::command::key {
 namespace {
 int CountExistingKeys(db::RedisDb* const redis_db, const CommandArgs& keys) {
   int existing = 0;
-  for (std::string_view key : keys) {
+  redis_db->ForEachKeyPrefetched(keys, [&](std::string_view key) {
     if (redis_db->LookupKey(key) != nullptr) {
       ++existing;
     }
-  }
+  });
   return existing;
 }
 }  // namespace
@@ -78,7 +78,7 @@ void AddExpireReply(Client* const client, int64_t ttl_ms) {
   }
   if (auto* redis_db = client->Db()) {
     int64_t expire = 0;
-    if (!ExpireAtFromTtl(args.ttl, ttl_ms, utils::NowInMilliseconds(),
+    if (!ExpireAtFromTtl(args.ttl, ttl_ms, utils::CachedNowInMilliseconds(),
                          &expire)) {
       client->AddReply(reply::FromError("ERR invalid expire time"));
       return;
@@ -197,16 +197,37 @@ void HandleDbSize(Client* const client) {
   client->AddReply(reply::FromError("ERR db unavailable"));
 }
 
+/*
+ * FLUSHDB [ASYNC|SYNC]. ASYNC detaches the keyspace and frees it on the
+ * reclaimer thread; without either, the lazyfree-lazy-user-flush option
+ * decides.
+ */
 void HandleFlushDb(Client* const client) {
-  if (!client->Args().empty()) {
+  const auto& args = client->Args();
+  if (args.size() > 1) {
     client->AddReply(reply::WrongNumberOfArguments());
     return;
   }
   if (auto* redis_db = client->Db()) {
+    bool async = redis_db->LazyFree().user_flush;
+    if (!args.empty()) {
+      if (utils::EqualsIgnoreCase(args[0], "ASYNC")) {
+        async = true;
+      } else if (utils::EqualsIgnoreCase(args[0], "SYNC")) {
+        async = false;
+      } else {
+        client->AddReply(reply::SyntaxError());
+        return;
+      }
+    }
     if (redis_db->KeyCount() > 0) {
       client->MarkModified();
     }
-    redis_db->Flush();
+    if (async) {
+      redis_db->FlushAsync();
+    } else {
+      redis_db->Flush();
+    }
     client->AddReply(reply::FromString("OK"));
     return;
   }
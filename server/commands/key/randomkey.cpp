@@ -0,0 +1,27 @@
+#include <optional>
+#include <string>
+
+#include "logging/logger.h"
+#include "server/client.h"
+#include "server/commands/handlers.h"
+#include "server/db/db.h"
+#include "server/reply.h"
+
+namespace redis_simple::command::key {
+void HandleRandomKey(Client* const client) {
+  RS_LOG_DEBUG("randomkey command called\n");
+  if (!client->Args().empty()) {
+    client->AddReply(reply::WrongNumberOfArguments());
+    return;
+  }
+
+  if (auto* redis_db = client->Db()) {
+    const auto key = redis_db->RandomKey();
+    client->AddReply(key.has_value() ? reply::FromBulkString(*key)
+                                     : reply::Null(client->Protocol()));
+  } else {
+    RS_LOG_DEBUG("db unavailable\n");
+    client->AddReply(reply::FromError("ERR db unavailable"));
+  }
+}
+}  // namespace redis_simple::command::key
@@ -92,12 +92,13 @@ void AddParseError(Client* const client, ParseStatus status) {
   }
 }
 
-size_t ScanReplyCapacity(const std::vector<std::string_view>& keys) {
+template <typename Keys>
+size_t ScanReplyCapacity(const Keys& keys) {
   constexpr size_t kReplyOverhead = 64;
   constexpr size_t kBulkStringOverhead = 32;
   constexpr size_t kMaxSize = std::numeric_limits<size_t>::max();
   size_t capacity = kReplyOverhead;
-  for (const auto key : keys) {
+  for (const std::string_view key : keys) {
     if (capacity > kMaxSize - kBulkStringOverhead ||
         key.size() > kMaxSize - capacity - kBulkStringOverhead) {
       return 0;
@@ -107,8 +108,8 @@ size_t ScanReplyCapacity(const std::vector<std::string_view>& keys) {
   return capacity;
 }
 
-std::string EncodeScanReply(size_t cursor,
-                            const std::vector<std::string_view>& keys) {
+template <typename Keys>
+std::string EncodeScanReply(size_t cursor, const Keys& keys) {
   std::string encoded;
   const size_t capacity = ScanReplyCapacity(keys);
   if (capacity > 0) {
@@ -124,11 +125,52 @@ std::string EncodeScanReply(size_t cursor,
                                      static_cast<size_t>(cursor_length));
   reply::AppendBulkString(cursor_text, &encoded);
   reply::AppendArrayHeader(keys.size(), &encoded);
-  for (const auto key : keys) {
+  for (const std::string_view key : keys) {
     reply::AppendBulkString(key, &encoded);
   }
   return encoded;
 }
+
+void ScanKeyspace(Client* const client, const ScanArgs& args,
+                  size_t cursor) {
+  auto* const redis_db = client->Db();
+  std::vector<std::string_view> keys;
+  keys.reserve(
+      std::min({args.count, redis_db->KeyCount(), kMaxInitialKeyCapacity}));
+  const auto collect_key = [&args, &keys](std::string_view key) {
+    const bool matches_pattern =
+        !args.pattern.has_value() || utils::MatchesGlob(key, *args.pattern);
+    if (matches_pattern) {
+      keys.push_back(key);
+    }
+  };
+  const size_t next_cursor =
+      redis_db->ScanKeys(cursor, args.count, collect_key);
+  client->AddReply(EncodeScanReply(next_cursor, keys));
+}
+
+/*
+ * Walk only the keys under the pattern's literal prefix. The index hands out
+ * key views that do not outlive the callback, so matches are copied. A cursor
+ * the index no longer knows restarts the iteration as a keyspace scan, which
+ * may repeat keys but never misses one.
+ */
+void ScanWithPrefixIndex(Client* const client, const ScanArgs& args,
+                         std::string_view prefix) {
+  std::vector<std::string> keys;
+  keys.reserve(std::min(args.count, kMaxInitialKeyCapacity));
+  const auto next_cursor = client->Db()->ScanKeysWithPrefix(
+      args.cursor, prefix, args.count, [&args, &keys](std::string_view key) {
+        if (utils::MatchesGlob(key, *args.pattern)) {
+          keys.emplace_back(key);
+        }
+      });
+  if (!next_cursor.has_value()) {
+    ScanKeyspace(client, args, 0);
+    return;
+  }
+  client->AddReply(EncodeScanReply(*next_cursor, keys));
+}
 }  // namespace
 
 void HandleScan(Client* const client) {
@@ -145,18 +187,15 @@ void HandleScan(Client* const client) {
     return;
   }
 
-  std::vector<std::string_view> keys;
-  keys.reserve(
-      std::min({args.count, redis_db->KeyCount(), kMaxInitialKeyCapacity}));
-  const auto collect_key = [&args, &keys](std::string_view key) {
-    const bool matches_pattern =
-        !args.pattern.has_value() || utils::MatchesGlob(key, *args.pattern);
-    if (matches_pattern) {
-      keys.push_back(key);
+  if (redis_db->HasPrefixIndex() && args.pattern.has_value()) {
+    const std::string prefix = utils::GlobLiteralPrefix(*args.pattern);
+    // Cursors from the keyspace keep scanning the keyspace.
+    if (db::PrefixIndex::IsCursor(args.cursor) ||
+        (args.cursor == 0 && !prefix.empty())) {
+      ScanWithPrefixIndex(client, args, prefix);
+      return;
     }
-  };
-  const size_t next_cursor =
-      redis_db->ScanKeys(args.cursor, args.count, collect_key);
-  client->AddReply(EncodeScanReply(next_cursor, keys));
+  }
+  ScanKeyspace(client, args, args.cursor);
 }
 }  // namespace redis_simple::command::key
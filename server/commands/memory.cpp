@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "server/client.h"
+#include "server/commands/handlers.h"
+#include "server/db/db.h"
+#include "server/reply.h"
+#include "server/server.h"
+#include "utils/string_utils.h"
+
+namespace redis_simple::command::memory {
+namespace {
+// Elements measured per collection by MEMORY USAGE unless SAMPLES is given.
+constexpr size_t kDefaultUsageSamples = 5;
+
+void AppendIntField(std::string_view name, size_t value,
+                    std::string* const reply) {
+  reply::AppendBulkString(name, reply);
+  reply->append(reply::FromInt64(static_cast<int64_t>(value)));
+}
+
+/*
+ * MEMORY USAGE key [SAMPLES count]. SAMPLES 0 measures every element.
+ */
+void HandleUsage(Client* const client) {
+  const auto& args = client->Args();
+  if (args.size() != 2 && args.size() != 4) {
+    client->AddReply(reply::SyntaxError());
+    return;
+  }
+  size_t samples = kDefaultUsageSamples;
+  if (args.size() == 4) {
+    int64_t count = 0;
+    if (!utils::EqualsIgnoreCase(args[2], "SAMPLES")) {
+      client->AddReply(reply::SyntaxError());
+      return;
+    }
+    if (!utils::ToInt64(args[3], &count) || count < 0) {
+      client->AddReply(
+          reply::FromError("ERR value is not an integer or out of range"));
+      return;
+    }
+    samples = static_cast<size_t>(count);
+  }
+  auto* const db = client->Db();
+  if (db == nullptr) {
+    client->AddReply(reply::FromError("ERR db unavailable"));
+    return;
+  }
+  const auto usage = db->MemoryUsage(args[1], samples);
+  client->AddReply(usage.has_value()
+                       ? reply::FromInt64(static_cast<int64_t>(*usage))
+                       : reply::Null(client->Protocol()));
+}
+
+/*
+ * MEMORY STATS: the breakdown INFO memory reports, as a map.
+ */
+void HandleStats(Client* const client) {
+  if (client->Args().size() != 1) {
+    client->AddReply(reply::WrongNumberOfArguments());
+    return;
+  }
+  auto* const db = client->Db();
+  if (db == nullptr) {
+    client->AddReply(reply::FromError("ERR db unavailable"));
+    return;
+  }
+  const auto memory = Server::Get()->MemoryBreakdown();
+  const size_t keys = db->KeyCount();
+  const size_t net_bytes = memory.used_bytes > memory.startup_bytes
+                               ? memory.used_bytes - memory.startup_bytes
+                               : 0;
+  constexpr size_t kFixedFields = 13;
+  std::string encoded = reply::FromMapHeader(
+      kFixedFields + memory.keyspace.encodings.size(), client->Protocol());
+  AppendIntField("total.allocated", memory.used_bytes, &encoded);
+  AppendIntField("startup.allocated", memory.startup_bytes, &encoded);
+  AppendIntField("clients.query", memory.clients.query_bytes, &encoded);
+  AppendIntField("clients.output", memory.clients.output_bytes, &encoded);
+  AppendIntField("aof.buffer", memory.aof_buffer_bytes, &encoded);
+  AppendIntField("overhead.hashtable.main", memory.keyspace.keyspace_bytes,
+                 &encoded);
+  AppendIntField("overhead.hashtable.expires", memory.keyspace.expires_bytes,
+                 &encoded);
+  AppendIntField("overhead.prefix.index", memory.keyspace.prefix_index_bytes,
+                 &encoded);
+  AppendIntField("overhead.total", memory.overhead_bytes, &encoded);
+  AppendIntField("keys.count", keys, &encoded);
+  AppendIntField("keys.bytes-per-key", keys == 0 ? 0 : net_bytes / keys,
+                 &encoded);
+  AppendIntField("dataset.bytes", memory.dataset_bytes, &encoded);
+  reply::AppendBulkString("dataset.percentage", &encoded);
+  encoded.append(reply::FromFloat(
+      net_bytes == 0 ? 0.0
+                     : 100.0 * static_cast<double>(memory.dataset_bytes) /
+                           static_cast<double>(net_bytes),
+      client->Protocol()));
+  for (const auto& encoding : memory.keyspace.encodings) {
+    AppendIntField("encoding." + std::string(encoding.encoding) + ".bytes",
+                   encoding.bytes, &encoded);
+  }
+  client->AddReply(std::move(encoded));
+}
+}  // namespace
+
+void HandleMemory(Client* const client) {
+  const auto& args = client->Args();
+  if (utils::EqualsIgnoreCase(args[0], "USAGE")) {
+    HandleUsage(client);
+  } else if (utils::EqualsIgnoreCase(args[0], "STATS")) {
+    HandleStats(client);
+  } else {
+    client->AddReply(reply::FromError("ERR unknown subcommand '" +
+                                      std::string(args[0]) + "'"));
+  }
+}
+}  // namespace redis_simple::command::memory
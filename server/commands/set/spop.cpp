@@ -0,0 +1,146 @@
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "logging/logger.h"
+#include "server/client.h"
+#include "server/commands/handlers.h"
+#include "server/db/db.h"
+#include "server/reply.h"
+#include "utils/string_utils.h"
+
+namespace redis_simple::command::sets {
+namespace {
+struct SPopArgs {
+  std::string_view key;
+  std::optional<size_t> count;
+};
+
+struct SPopResult {
+  std::vector<std::string> members;
+  bool deleted_key{};
+};
+
+enum class ParseStatus {
+  kOk,
+  kWrongArgumentCount,
+  kInvalidCount,
+};
+
+ParseStatus ParseArgs(const CommandArgs& args, SPopArgs* spop_args);
+bool SPop(db::RedisDb* redis_db, const SPopArgs* args, SPopResult* result);
+void Propagate(Client* client, const SPopArgs* args, SPopResult* result);
+std::string EncodeReply(const SPopArgs* args, const SPopResult* result,
+                        reply::ProtocolVersion protocol);
+}  // namespace
+
+void HandleSPop(Client* const client) {
+  SPopArgs args;
+  const ParseStatus status = ParseArgs(client->Args(), &args);
+  if (status == ParseStatus::kWrongArgumentCount) {
+    client->AddReply(reply::WrongNumberOfArguments());
+    return;
+  }
+  if (status == ParseStatus::kInvalidCount) {
+    client->AddReply(
+        reply::FromError("ERR value is out of range, must be positive"));
+    return;
+  }
+
+  if (auto* redis_db = client->Db()) {
+    SPopResult result;
+    if (!SPop(redis_db, &args, &result)) {
+      client->AddReply(reply::WrongTypeError());
+      return;
+    }
+    client->AddReply(EncodeReply(&args, &result, client->Protocol()));
+    Propagate(client, &args, &result);
+  } else {
+    RS_LOG_DEBUG("db unavailable\n");
+    client->AddReply(reply::FromError("ERR db unavailable"));
+  }
+}
+
+namespace {
+
+ParseStatus ParseArgs(const CommandArgs& args, SPopArgs* const spop_args) {
+  if (args.empty() || args.size() > 2) {
+    RS_LOG_DEBUG("invalid number of args\n");
+    return ParseStatus::kWrongArgumentCount;
+  }
+  spop_args->key = args[0];
+  if (args.size() == 2) {
+    int64_t count = 0;
+    if (!utils::ToInt64(args[1], &count) || count < 0) {
+      return ParseStatus::kInvalidCount;
+    }
+    spop_args->count = static_cast<size_t>(count);
+  }
+  return ParseStatus::kOk;
+}
+
+bool SPop(db::RedisDb* redis_db, const SPopArgs* args,
+          SPopResult* const result) {
+  auto* obj = redis_db->MutableLookupKey(args->key);
+  if (obj == nullptr) {
+    return true;
+  }
+  if (obj->Type() != db::RedisObject::ObjectType::kSet) {
+    return false;
+  }
+  try {
+    auto* const set = obj->Set();
+    result->members = set->PopRandomMembers(args->count.value_or(1));
+    if (set->Size() == 0) {
+      result->deleted_key = true;
+      redis_db->DeleteKey(args->key);
+    }
+    return true;
+  } catch (const std::exception& e) {
+    RS_LOG_DEBUG("catch exception %s", e.what());
+    return false;
+  }
+}
+
+/*
+ * Popped members are picked at random, so the AOF records which ones were
+ * removed rather than the SPOP itself.
+ */
+void Propagate(Client* const client, const SPopArgs* args,
+               SPopResult* const result) {
+  if (result->members.empty()) {
+    return;
+  }
+  client->MarkModified();
+  if (result->deleted_key) {
+    client->PropagateAs("DEL", {std::string(args->key)});
+    return;
+  }
+  std::vector<std::string> srem_args;
+  srem_args.reserve(result->members.size() + 1);
+  srem_args.emplace_back(args->key);
+  for (auto& member : result->members) {
+    srem_args.push_back(std::move(member));
+  }
+  client->PropagateAs("SREM", std::move(srem_args));
+}
+
+std::string EncodeReply(const SPopArgs* args, const SPopResult* result,
+                        reply::ProtocolVersion protocol) {
+  if (!args->count.has_value()) {
+    return result->members.empty()
+               ? reply::Null(protocol)
+               : reply::FromBulkString(result->members.front());
+  }
+  std::string encoded = reply::FromSetHeader(result->members.size(), protocol);
+  for (const auto& member : result->members) {
+    reply::AppendBulkString(member, &encoded);
+  }
+  return encoded;
+}
+}  // namespace
+}  // namespace redis_simple::command::sets
@@ -0,0 +1,123 @@
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "logging/logger.h"
+#include "server/client.h"
+#include "server/commands/handlers.h"
+#include "server/db/db.h"
+#include "server/reply.h"
+#include "utils/string_utils.h"
+
+namespace redis_simple::command::sets {
+namespace {
+struct SRandMemberArgs {
+  std::string_view key;
+  std::optional<int64_t> count;
+};
+
+enum class ParseStatus {
+  kOk,
+  kWrongArgumentCount,
+  kInvalidCount,
+};
+
+// Replies to large negative counts repeat members, so bound them like Redis.
+constexpr int64_t kMinCount = -(std::numeric_limits<int64_t>::max() / 2);
+
+ParseStatus ParseArgs(const CommandArgs& args, SRandMemberArgs* srand_args);
+// Replies to negative counts stop growing once they pass max_bytes.
+std::optional<std::string> SRandMember(db::RedisDb* redis_db,
+                                       const SRandMemberArgs* args,
+                                       reply::ProtocolVersion protocol,
+                                       size_t max_bytes);
+}  // namespace
+
+void HandleSRandMember(Client* const client) {
+  SRandMemberArgs args;
+  const ParseStatus status = ParseArgs(client->Args(), &args);
+  if (status == ParseStatus::kWrongArgumentCount) {
+    client->AddReply(reply::WrongNumberOfArguments());
+    return;
+  }
+  if (status == ParseStatus::kInvalidCount) {
+    client->AddReply(
+        reply::FromError("ERR value is not an integer or out of range"));
+    return;
+  }
+
+  if (auto* redis_db = client->Db()) {
+    auto encoded = SRandMember(redis_db, &args, client->Protocol(),
+                               client->ReplyBytesAvailable());
+    if (!encoded.has_value()) {
+      client->AddReply(reply::WrongTypeError());
+      return;
+    }
+    // A reply cut short at the output limit is still over it, so AddReply()
+    // drops it and closes the client as for any other oversized reply.
+    client->AddReply(std::move(*encoded));
+  } else {
+    RS_LOG_DEBUG("db unavailable\n");
+    client->AddReply(reply::FromError("ERR db unavailable"));
+  }
+}
+
+namespace {
+
+ParseStatus ParseArgs(const CommandArgs& args,
+                      SRandMemberArgs* const srand_args) {
+  if (args.empty() || args.size() > 2) {
+    RS_LOG_DEBUG("invalid number of args\n");
+    return ParseStatus::kWrongArgumentCount;
+  }
+  srand_args->key = args[0];
+  if (args.size() == 2) {
+    int64_t count = 0;
+    if (!utils::ToInt64(args[1], &count) || count < kMinCount) {
+      return ParseStatus::kInvalidCount;
+    }
+    srand_args->count = count;
+  }
+  return ParseStatus::kOk;
+}
+
+std::optional<std::string> SRandMember(db::RedisDb* redis_db,
+                                       const SRandMemberArgs* args,
+                                       reply::ProtocolVersion protocol,
+                                       size_t max_bytes) {
+  const auto* obj = redis_db->LookupKey(args->key);
+  if (obj != nullptr && obj->Type() != db::RedisObject::ObjectType::kSet) {
+    return std::nullopt;
+  }
+  try {
+    const auto* set = obj == nullptr ? nullptr : obj->Set();
+    if (!args->count.has_value()) {
+      const auto member = set == nullptr ? std::nullopt : set->RandomMember();
+      return member.has_value() ? reply::FromBulkString(*member)
+                                : reply::Null(protocol);
+    }
+    if (set == nullptr || *args->count == 0) {
+      return reply::FromArrayHeader(0);
+    }
+    if (*args->count > 0) {
+      return reply::FromBulkStringArray(
+          set->RandomMembers(static_cast<size_t>(*args->count)));
+    }
+    // A negative count allows repeats, so every member is drawn on its own.
+    const auto count = static_cast<size_t>(-*args->count);
+    std::string encoded = reply::FromArrayHeader(count);
+    for (size_t i = 0; i < count && encoded.size() <= max_bytes; ++i) {
+      reply::AppendBulkString(set->RandomMember().value_or(""), &encoded);
+    }
+    return encoded;
+  } catch (const std::exception& e) {
+    RS_LOG_DEBUG("catch exception %s", e.what());
+    return std::nullopt;
+  }
+}
+}  // namespace
+}  // namespace redis_simple::command::sets
@@ -19,7 +19,7 @@ enum class GetStatus : std::uint8_t {
 };
 
 struct GetResult {
-  const std::string* value;
+  const db::RedisObject* object;
   GetStatus status;
 };
 
@@ -39,8 +39,10 @@ void HandleGet(Client* const client) {
     const auto value_result = Get(redis_db, &args);
     if (value_result.status == GetStatus::kWrongType) {
       client->AddReply(reply::WrongTypeError());
-    } else if (value_result.value != nullptr) {
-      client->AddReply(reply::FromBulkString(*value_result.value));
+    } else if (value_result.object != nullptr) {
+      db::RedisObject::IntegerBuffer buffer;
+      client->AddReply(
+          reply::FromBulkString(value_result.object->StringView(&buffer)));
     } else {
       client->AddReply(reply::Null(client->Protocol()));
     }
@@ -73,7 +75,7 @@ GetResult Get(db::RedisDb* redis_db, const StringArgs* args) {
     return {nullptr, GetStatus::kWrongType};
   }
   if (obj != nullptr) {
-    return {&obj->String(), GetStatus::kOk};
+    return {obj, GetStatus::kOk};
   }
   return {nullptr, GetStatus::kMissing};
 }
@@ -89,7 +89,7 @@ int ParseSetOption(const CommandArgs& args, size_t* const idx,
   }
   constexpr int64_t kMillisecondsPerSecond = 1000;
   const int64_t multiplier = expires_in_seconds ? kMillisecondsPerSecond : 1;
-  if (!ExpireAtFromTtl(ttl, multiplier, utils::NowInMilliseconds(),
+  if (!ExpireAtFromTtl(ttl, multiplier, utils::CachedNowInMilliseconds(),
                        &string_args->expire)) {
     return -1;
   }
@@ -114,7 +114,7 @@ bool ExpireAtFromTtl(int64_t ttl, int64_t multiplier, int64_t now,
 }
 
 int Set(db::RedisDb* redis_db, const StringArgs* args) {
-  auto value = db::RedisObject::CreateWithString(std::string(args->value));
+  auto value = db::RedisObject::CreateWithString(args->value);
   const auto status =
       redis_db->SetKey(args->key, std::move(value), args->expire, args->flags);
   return status == db::DbStatus::kError ? -1 : 0;
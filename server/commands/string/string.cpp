@@ -23,7 +23,7 @@ enum class StringStatus : std::uint8_t {
 };
 
 struct StringResult {
-  const std::string* value;
+  const db::RedisObject* object;
   StringStatus status;
 };
 
@@ -35,7 +35,7 @@ StringResult LookupString(db::RedisDb* const redis_db, std::string_view key) {
   if (object->Type() != db::RedisObject::ObjectType::kString) {
     return {nullptr, StringStatus::kWrongType};
   }
-  return {&object->String(), StringStatus::kOk};
+  return {object, StringStatus::kOk};
 }
 
 std::optional<int64_t> ToReplyInteger(size_t value) {
@@ -75,10 +75,18 @@ void HandleIncrement(Client* const client, int64_t increment) {
     client->AddReply(reply::WrongTypeError());
     return;
   }
+  const bool integer_encoded =
+      object != nullptr &&
+      object->GetEncoding() == db::RedisObject::Encoding::kInt;
   int64_t value = 0;
-  if (object != nullptr && !utils::ToInt64(object->String(), &value)) {
-    client->AddReply(reply::FromError("ERR value is not an integer"));
-    return;
+  if (integer_encoded) {
+    value = object->Integer();
+  } else if (object != nullptr) {
+    db::RedisObject::IntegerBuffer buffer;
+    if (!utils::ToInt64(object->StringView(&buffer), &value)) {
+      client->AddReply(reply::FromError("ERR value is not an integer"));
+      return;
+    }
   }
   bool ok = false;
   const int64_t next = IncrementValue(value, increment, &ok);
@@ -87,13 +95,13 @@ void HandleIncrement(Client* const client, int64_t increment) {
         reply::FromError("ERR increment or decrement would overflow"));
     return;
   }
-  std::string next_value = std::to_string(next);
-  if (object != nullptr) {
-    *object->MutableString() = std::move(next_value);
-  } else if (redis_db->SetKey(
-                 args[0],
-                 db::RedisObject::CreateWithString(std::move(next_value)),
-                 0) == db::DbStatus::kError) {
+  // Counters are updated in place unless the object is shared or the result
+  // belongs in a shared object.
+  const bool updated = integer_encoded && object->SetIntegerInPlace(next);
+  if (!updated &&
+      redis_db->SetKey(args[0], db::RedisObject::CreateWithInteger(next), 0,
+                       db::ToInt(db::SetKeyFlag::kKeepTtl)) ==
+          db::DbStatus::kError) {
     client->AddReply(reply::FromError("ERR failed to set key"));
     return;
   }
@@ -133,7 +141,7 @@ void HandleAppend(Client* const client) {
     }
     if (redis_db->SetKey(
             key,
-            db::RedisObject::CreateWithString(std::string(value_to_append)),
+            db::RedisObject::CreateWithString(value_to_append),
             0) == db::DbStatus::kError) {
       client->AddReply(reply::FromError("ERR failed to set key"));
       return;
@@ -142,10 +150,19 @@ void HandleAppend(Client* const client) {
     client->AddReply(reply::FromInt64(*length));
     return;
   }
-  std::string* const value = object->MutableString();
-  value->append(value_to_append);
+  size_t new_length = 0;
+  if (std::string* const value = object->MutableString()) {
+    value->append(value_to_append);
+    new_length = value->size();
+  } else {
+    std::string appended = object->String();
+    appended.append(value_to_append);
+    new_length = appended.size();
+    redis_db->SetKey(key, db::RedisObject::CreateWithString(appended), 0,
+                     db::ToInt(db::SetKeyFlag::kKeepTtl));
+  }
   client->MarkModified();
-  const auto length = ToReplyInteger(value->size());
+  const auto length = ToReplyInteger(new_length);
   client->AddReply(length.has_value()
                        ? reply::FromInt64(*length)
                        : reply::FromError("ERR string length out of range"));
@@ -163,14 +180,15 @@ void HandleMGet(Client* const client) {
     return;
   }
   std::string encoded = reply::FromArrayHeader(keys.size());
-  for (const auto& key : keys) {
+  redis_db->ForEachKeyPrefetched(keys, [&](std::string_view key) {
     const auto result = LookupString(redis_db, key);
     if (result.status == StringStatus::kOk) {
-      reply::AppendBulkString(*result.value, &encoded);
+      db::RedisObject::IntegerBuffer buffer;
+      reply::AppendBulkString(result.object->StringView(&buffer), &encoded);
     } else {
       encoded.append(reply::Null(client->Protocol()));
     }
-  }
+  });
   client->AddReply(std::move(encoded));
 }
 
@@ -187,8 +205,7 @@ void HandleMSet(Client* const client) {
   }
   for (size_t i = 0; i < args.size(); i += 2) {
     redis_db->SetKey(
-        args[i], db::RedisObject::CreateWithString(std::string(args[i + 1])),
-        0);
+        args[i], db::RedisObject::CreateWithString(args[i + 1]), 0);
   }
   client->MarkModified();
   client->AddReply(reply::FromString("OK"));
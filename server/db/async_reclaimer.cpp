@@ -1,9 +1,13 @@
 #include "server/db/async_reclaimer.h"
 
+#include <cstdint>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <utility>
 
+#include "memory/slab_allocator.h"
+
 namespace redis_simple::db {
 AsyncReclaimer::AsyncReclaimer() : worker_([this] { Run(); }) {}
 
@@ -11,12 +15,27 @@ bool AsyncReclaimer::Reclaim(RedisObjectPtr object) {
   if (object == nullptr) {
     return false;
   }
+  const size_t bytes = object->Bytes(kObjectBytesSamples);
+  return Enqueue(Item{std::move(object), nullptr, bytes});
+}
+
+bool AsyncReclaimer::ReclaimKeyspace(
+    std::unique_ptr<DetachedKeyspace> keyspace) {
+  if (keyspace == nullptr) {
+    return false;
+  }
+  const size_t bytes = keyspace->bytes;
+  return Enqueue(Item{nullptr, std::move(keyspace), bytes});
+}
+
+bool AsyncReclaimer::Enqueue(Item item) {
   {
     const std::scoped_lock lock(mutex_);
     if (stopping_) {
       return false;
     }
-    pending_.push_back(std::move(object));
+    pending_bytes_ += item.bytes;
+    pending_.push_back(std::move(item));
   }
   work_available_.notify_one();
   return true;
@@ -32,6 +51,16 @@ size_t AsyncReclaimer::PendingCount() const {
   return pending_.size() + reclaiming_;
 }
 
+size_t AsyncReclaimer::PendingBytes() const {
+  const std::scoped_lock lock(mutex_);
+  return pending_bytes_;
+}
+
+uint64_t AsyncReclaimer::ReclaimedCount() const {
+  const std::scoped_lock lock(mutex_);
+  return reclaimed_;
+}
+
 AsyncReclaimer::~AsyncReclaimer() {
   {
     const std::scoped_lock lock(mutex_);
@@ -45,7 +74,7 @@ AsyncReclaimer::~AsyncReclaimer() {
 
 void AsyncReclaimer::Run() {
   while (true) {
-    std::deque<RedisObjectPtr> batch;
+    std::deque<Item> batch;
     {
       std::unique_lock<std::mutex> lock(mutex_);
       work_available_.wait(lock,
@@ -61,11 +90,18 @@ void AsyncReclaimer::Run() {
     }
 
     const size_t batch_size = batch.size();
+    size_t batch_bytes = 0;
+    for (const auto& item : batch) {
+      batch_bytes += item.bytes;
+    }
     batch.clear();
+    in_memory::SlabReleaseThreadCache();
 
     {
       const std::scoped_lock lock(mutex_);
       reclaiming_ -= batch_size;
+      reclaimed_ += batch_size;
+      pending_bytes_ -= batch_bytes;
       if (pending_.empty() && reclaiming_ == 0) {
         idle_.notify_all();
       }
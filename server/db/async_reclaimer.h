@@ -2,32 +2,64 @@
 
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <thread>
 
+#include "memory/sharded_dict.h"
+#include "server/db/expire_index.h"
+#include "server/db/prefix_index.h"
 #include "server/db/redis_obj.h"
 
 namespace redis_simple::db {
+// The tables of a database that was flushed asynchronously.
+struct DetachedKeyspace {
+  std::unique_ptr<in_memory::ShardedDict<RedisObjectPtr>> dict;
+  ExpireIndex expires;
+  std::unique_ptr<PrefixIndex> prefix_index;
+  // Estimated heap bytes the tables hold, reported until they are freed.
+  size_t bytes{};
+};
+
 class AsyncReclaimer {
  public:
   AsyncReclaimer();
   AsyncReclaimer(const AsyncReclaimer&) = delete;
   AsyncReclaimer& operator=(const AsyncReclaimer&) = delete;
   bool Reclaim(RedisObjectPtr object);
+  bool ReclaimKeyspace(std::unique_ptr<DetachedKeyspace> keyspace);
   void WaitUntilIdle();
+  // Objects and keyspaces not yet freed.
   size_t PendingCount() const;
+  // Estimated heap bytes not yet freed.
+  size_t PendingBytes() const;
+  // Objects and keyspaces freed so far.
+  uint64_t ReclaimedCount() const;
   ~AsyncReclaimer();
 
  private:
+  // Elements measured per collection to estimate the bytes of an object.
+  static constexpr size_t kObjectBytesSamples = 16;
+  // One object or one keyspace.
+  struct Item {
+    RedisObjectPtr object;
+    std::unique_ptr<DetachedKeyspace> keyspace;
+    size_t bytes{};
+  };
+  bool Enqueue(Item item);
   void Run();
 
   mutable std::mutex mutex_;
   std::condition_variable work_available_;
   std::condition_variable idle_;
-  std::deque<RedisObjectPtr> pending_;
-  std::thread worker_;
+  std::deque<Item> pending_;
   size_t reclaiming_{};
+  size_t pending_bytes_{};
+  uint64_t reclaimed_{};
   bool stopping_{};
+  // Declared last so the worker starts only after the state it reads exists.
+  std::thread worker_;
 };
 }  // namespace redis_simple::db
@@ -2,7 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <utility>
 
 namespace redis_simple::db {
 TEST(AsyncReclaimerTest, ReclaimsObjectsOnWorkerThread) {
@@ -17,5 +20,27 @@ TEST(AsyncReclaimerTest, ReclaimsObjectsOnWorkerThread) {
 
   reclaimer.WaitUntilIdle();
   EXPECT_EQ(reclaimer.PendingCount(), 0);
+  EXPECT_EQ(reclaimer.PendingBytes(), 0);
+}
+
+TEST(AsyncReclaimerTest, ReclaimsDetachedKeyspace) {
+  AsyncReclaimer reclaimer;
+  EXPECT_FALSE(reclaimer.ReclaimKeyspace(nullptr));
+
+  auto keyspace = std::make_unique<DetachedKeyspace>();
+  keyspace->dict = in_memory::ShardedDict<RedisObjectPtr>::Create(4);
+  for (int index = 0; index < 1000; ++index) {
+    std::string key = "key:" + std::to_string(index);
+    keyspace->expires.Add(key, index);
+    keyspace->dict->Set(std::move(key),
+                        RedisObject::CreateWithString(std::string(64, 'x')));
+  }
+  keyspace->bytes = 1 << 20;
+  ASSERT_TRUE(reclaimer.ReclaimKeyspace(std::move(keyspace)));
+  EXPECT_LE(reclaimer.PendingBytes(), size_t{1} << 20);
+
+  reclaimer.WaitUntilIdle();
+  EXPECT_EQ(reclaimer.PendingCount(), 0);
+  EXPECT_EQ(reclaimer.PendingBytes(), 0);
 }
 }  // namespace redis_simple::db
@@ -1,6 +1,7 @@
 #include "db.h"
 
 #include <algorithm>
+#include <array>
 #include <cinttypes>
 #include <cstdint>
 #include <memory>
@@ -11,36 +12,73 @@
 #include <vector>
 
 #include "logging/logger.h"
+#include "memory/prefetch.h"
+#include "memory/slab_allocator.h"
 #include "utils/time_utils.h"
 
 namespace redis_simple::db {
-std::unique_ptr<RedisDb> RedisDb::Create() {
-  return std::unique_ptr<RedisDb>(new RedisDb());
+namespace {
+template <typename V>
+TableStats StatsOf(const in_memory::ShardedDict<V>& table) {
+  TableStats stats;
+  stats.keys = table.Size();
+  stats.shards = table.ShardCount();
+  for (size_t index = 0; index < table.ShardCount(); ++index) {
+    const auto& shard = table.ShardAt(index);
+    stats.buckets += shard.BucketCount();
+    const auto rehash_index = shard.RehashIndex();
+    stats.rehashing = stats.rehashing || rehash_index.has_value();
+    stats.rehashed_buckets += rehash_index.value_or(0);
+  }
+  return stats;
 }
+}  // namespace
 
-RedisDb::RedisDb()
-    : dict_(in_memory::Dict<std::string, RedisObjectPtr>::Create()),
-      expires_(in_memory::Dict<std::string, int64_t>::Create()) {}
+std::unique_ptr<RedisDb> RedisDb::Create(size_t shards, bool prefix_index) {
+  return std::unique_ptr<RedisDb>(new RedisDb(shards, prefix_index));
+}
+
+RedisDb::RedisDb(size_t shards, bool prefix_index)
+    : dict_(in_memory::ShardedDict<RedisObjectPtr>::Create(shards)),
+      prefix_index_(prefix_index ? std::make_unique<PrefixIndex>() : nullptr) {
+}
 
 const RedisObject* RedisDb::LookupKey(std::string_view key) {
   return MutableLookupKey(key);
 }
 
 RedisObject* RedisDb::MutableLookupKey(std::string_view key) {
-  auto* const result = dict_->FindValue(key);
+  const size_t hash = dict_->KeyHash(key);
+  auto* const result = dict_->FindValue(key, hash);
   if (result == nullptr) {
     return nullptr;
   }
-  RedisObject* object = result->get();
-  if (IsKeyExpired(key)) {
+  RedisObject* const object = result->get();
+  if (IsExpired(*object)) {
     RS_LOG_DEBUG("look up key expired\n");
     // If key is already expired, delete the key and return a null pointer.
-    object = nullptr;
-    DeleteKey(key);
+    RemoveKey(key, lazy_free_.expire);
+    ++expire_stats_.expired_keys;
+    return nullptr;
   }
+  TouchObject(object, object);
+  RecordAccess(key, hash);
   return object;
 }
 
+void RedisDb::PrefetchKeys(const std::string_view* keys, size_t count) {
+  std::array<RedisObjectPtr*, kPrefetchBatch> objects{};
+  for (size_t start = 0; start < count; start += kPrefetchBatch) {
+    const size_t group = std::min(kPrefetchBatch, count - start);
+    dict_->FindMany(keys + start, group, objects.data());
+    for (size_t index = 0; index < group; ++index) {
+      if (objects[index] != nullptr) {
+        in_memory::Prefetch(objects[index]->get());
+      }
+    }
+  }
+}
+
 DbStatus RedisDb::SetKey(std::string_view key, RedisObjectPtr object,
                          int64_t expire) {
   return SetKey(key, std::move(object), expire, 0);
@@ -51,62 +89,112 @@ DbStatus RedisDb::SetKey(std::string_view key, RedisObjectPtr object,
   if (object == nullptr) {
     return DbStatus::kError;
   }
-  dict_->Set(std::string(key), std::move(object));
-  if (!HasFlag(flags, SetKeyFlag::kKeepTtl) && expire == 0) {
-    expires_->Delete(key);
+  const size_t hash = dict_->KeyHash(key);
+  RedisObjectPtr* const existing = dict_->FindValue(key, hash);
+  const int64_t previous = existing == nullptr ? 0 : (*existing)->Expire();
+  if (expire == 0 && HasFlag(flags, SetKeyFlag::kKeepTtl)) {
+    expire = previous;
   }
-  if (expire > 0) {
-    expires_->Set(std::string(key), expire);
-    RS_LOG_DEBUG("add expire %" PRId64 "\n", expire);
+  if (expire != 0 || RanksByAccess(eviction_policy_)) {
+    object = RedisObject::Unshare(std::move(object));
+  }
+  TouchObject(object.get(), existing == nullptr ? nullptr : existing->get());
+  RecordAccess(key, hash);
+  object->SetExpire(expire);
+  if (existing != nullptr) {
+    FreeObject(std::exchange(*existing, std::move(object)),
+               lazy_free_.server_del);
+  } else {
+    dict_->Set(std::string(key), std::move(object), hash);
+    if (prefix_index_ != nullptr) {
+      prefix_index_->Add(key);
+    }
+  }
+  if (expire != previous) {
+    if (previous != 0) {
+      expires_.Remove(key, previous);
+    }
+    if (expire != 0) {
+      expires_.Add(StoredKey(key, hash), expire);
+      RS_LOG_DEBUG("add expire %" PRId64 "\n", expire);
+    }
   }
   return DbStatus::kOk;
 }
 
 DbStatus RedisDb::DeleteKey(std::string_view key) {
-  if (!dict_->Delete(key)) {
-    return DbStatus::kError;
-  }
-  if (expires_->Size() > 0) {
-    expires_->Delete(key);
-  }
-  return DbStatus::kOk;
+  return RemoveKey(key, lazy_free_.user_del);
 }
 
 DbStatus RedisDb::UnlinkKey(std::string_view key) {
-  if (IsKeyExpired(key)) {
-    DeleteKey(key);
+  auto object = DetachKey(key);
+  if (!object.has_value()) {
     return DbStatus::kError;
   }
-  auto object = dict_->Extract(key);
-  if (!object.has_value()) {
+  if (IsExpired(**object)) {
+    ++expire_stats_.expired_keys;
+    FreeObject(std::move(*object), lazy_free_.expire);
     return DbStatus::kError;
   }
-  expires_->Delete(key);
-  return reclaimer_.Reclaim(std::move(*object)) ? DbStatus::kOk
-                                                : DbStatus::kError;
+  FreeObject(std::move(*object), /*lazy=*/true);
+  return DbStatus::kOk;
 }
 
 DbStatus RedisDb::ExpireKeyAt(std::string_view key, int64_t expire) {
-  if (LookupKey(key) == nullptr) {
+  RedisObject* object = MutableLookupKey(key);
+  if (object == nullptr) {
     return DbStatus::kError;
   }
-  if (!loading_ && expire <= utils::NowInMilliseconds()) {
-    return DeleteKey(key);
+  if (!loading_ && expire <= utils::CachedNowInMilliseconds()) {
+    return RemoveKey(key, lazy_free_.expire);
+  }
+  if (object->IsShared()) {
+    RedisObjectPtr* const slot = dict_->FindValue(key);
+    *slot = RedisObject::Unshare(std::move(*slot));
+    object = slot->get();
+  }
+  if (object->Expire() != 0) {
+    expires_.Remove(key, object->Expire());
   }
-  expires_->Set(std::string(key), expire);
+  object->SetExpire(expire);
+  expires_.Add(StoredKey(key, dict_->KeyHash(key)), expire);
   return DbStatus::kOk;
 }
 
 std::optional<int64_t> RedisDb::Expiration(std::string_view key) const {
-  const auto* expire = expires_->FindValue(key);
-  return expire == nullptr ? std::nullopt : std::optional<int64_t>(*expire);
+  const auto* object = dict_->FindValue(key);
+  if (object == nullptr || (*object)->Expire() == 0) {
+    return std::nullopt;
+  }
+  return (*object)->Expire();
+}
+
+std::optional<std::string> RedisDb::RandomKey() {
+  std::string key;
+  bool expired = false;
+  while (dict_->RandomEntry([this, &key, &expired](
+                                std::string_view entry_key,
+                                const RedisObjectPtr& object) {
+    key.assign(entry_key);
+    expired = IsExpired(*object);
+  })) {
+    if (!expired) {
+      return key;
+    }
+    RemoveKey(key, lazy_free_.expire);
+    ++expire_stats_.expired_keys;
+  }
+  return std::nullopt;
 }
 
 DbStatus RedisDb::PersistKey(std::string_view key) {
-  if (LookupKey(key) == nullptr || expires_->FindValue(key) == nullptr) {
+  RedisObject* const object = MutableLookupKey(key);
+  if (object == nullptr || object->Expire() == 0) {
     return DbStatus::kError;
   }
-  return expires_->Delete(key) ? DbStatus::kOk : DbStatus::kError;
+  const int64_t expire = object->Expire();
+  object->SetExpire(0);
+  return expires_.Remove(key, expire) ? DbStatus::kOk : DbStatus::kError;
 }
 
 DbStatus RedisDb::RenameKey(std::string_view old_key,
@@ -118,35 +206,25 @@ DbStatus RedisDb::RenameKey(std::string_view old_key,
     return DbStatus::kOk;
   }
 
-  auto* object = dict_->FindValue(old_key);
-  if (object == nullptr) {
+  auto object = DetachKey(old_key);
+  if (!object.has_value()) {
     return DbStatus::kError;
   }
-  const auto* expire = expires_->FindValue(old_key);
-  const std::optional<int64_t> expire_value =
-      expire == nullptr ? std::nullopt : std::optional<int64_t>(*expire);
-  RedisObjectPtr moved_object = std::move(*object);
-  dict_->Delete(old_key);
-  dict_->Set(std::string(new_key), std::move(moved_object));
-  expires_->Delete(old_key);
-  if (expire_value.has_value()) {
-    expires_->Set(std::string(new_key), *expire_value);
-  } else {
-    expires_->Delete(new_key);
-  }
-  return DbStatus::kOk;
+  const int64_t expire = (*object)->Expire();
+  // The expiration travels with the object and replaces the target's.
+  return SetKey(new_key, std::move(*object), expire);
 }
 
 int64_t RedisDb::TimeToLive(std::string_view key, TtlResolution resolution) {
-  if (LookupKey(key) == nullptr) {
+  const RedisObject* const object = LookupKey(key);
+  if (object == nullptr) {
     return -2;
   }
-  const auto* expire = expires_->FindValue(key);
-  if (expire == nullptr) {
+  if (object->Expire() == 0) {
     return -1;
   }
   const int64_t ttl =
-      std::max<int64_t>(*expire - utils::NowInMilliseconds(), 0);
+      std::max<int64_t>(object->Expire() - utils::CachedNowInMilliseconds(), 0);
   if (resolution == TtlResolution::kMilliseconds) {
     return ttl;
   }
@@ -157,52 +235,428 @@ int64_t RedisDb::TimeToLive(std::string_view key, TtlResolution resolution) {
 }
 
 void RedisDb::Flush() {
+  expires_.Clear();
   dict_->Clear();
-  expires_->Clear();
-  expire_cursor_ = 0;
+  eviction_pool_.Clear();
+  hot_keys_.Clear();
+  hot_key_cursor_ = 0;
+  if (prefix_index_ != nullptr) {
+    prefix_index_->Clear();
+  }
+  in_memory::SlabReleaseThreadCache();
 }
 
-ExpireSampleResult RedisDb::ExpireSome(size_t max_samples, int64_t now) {
+void RedisDb::FlushAsync() {
+  auto keyspace = std::make_unique<DetachedKeyspace>();
+  const KeyspaceMemory memory = MemoryBreakdown();
+  keyspace->bytes = memory.keyspace_bytes + memory.expires_bytes +
+                    memory.prefix_index_bytes;
+  for (const auto& encoding : memory.encodings) {
+    keyspace->bytes += encoding.bytes;
+  }
+  const size_t shards = dict_->ShardCount();
+  keyspace->dict = std::exchange(
+      dict_, in_memory::ShardedDict<RedisObjectPtr>::Create(shards));
+  keyspace->expires = std::move(expires_);
+  expires_.Clear();
+  if (prefix_index_ != nullptr) {
+    keyspace->prefix_index =
+        std::exchange(prefix_index_, std::make_unique<PrefixIndex>());
+  }
+  eviction_pool_.Clear();
+  hot_keys_.Clear();
+  hot_key_cursor_ = 0;
+  reclaimer_.ReclaimKeyspace(std::move(keyspace));
+}
+
+ExpireSampleResult RedisDb::ExpireSome(size_t max_keys, int64_t now) {
   ExpireSampleResult result;
-  if (max_samples == 0 || expires_->Size() == 0) {
+  if (max_keys == 0 || expires_.Size() == 0) {
     return result;
   }
 
-  std::vector<std::string_view> expired_keys;
-  expired_keys.reserve(max_samples);
-  bool scan_complete = false;
-  while (result.sampled < max_samples && !scan_complete) {
-    const auto next_cursor = expires_->Scan(
-        expire_cursor_, [&result, &expired_keys, max_samples, now](
-                            const std::string& key, const int64_t& expire) {
-          if (result.sampled >= max_samples) {
-            return;
-          }
-          ++result.sampled;
-          if (expire <= now) {
-            expired_keys.push_back(key);
-          }
-        });
-    scan_complete = !next_cursor.has_value();
-    expire_cursor_ = next_cursor.value_or(0);
-  }
-  for (const auto& key : expired_keys) {
-    if (DeleteKey(key) == DbStatus::kOk) {
-      ++result.expired;
+  std::vector<std::string> due_keys;
+  due_keys.reserve(std::min(max_keys, expires_.Size()));
+  result.sampled = expires_.PopDue(now, max_keys, &due_keys);
+  // The index no longer holds these keys, so drop them from the keyspace
+  // directly rather than through DeleteKey().
+  for (const auto& key : due_keys) {
+    auto object = dict_->Extract(key);
+    if (!object.has_value()) {
+      continue;
+    }
+    ++result.expired;
+    if (prefix_index_ != nullptr) {
+      prefix_index_->Remove(key);
     }
+    FreeObject(std::move(*object), lazy_free_.expire);
   }
+  expire_stats_.expired_keys += result.expired;
   return result;
 }
 
-bool RedisDb::IsKeyExpired(std::string_view key) const {
-  if (loading_ || expires_->Size() == 0) {
-    return false;
+void RedisDb::ActiveExpire(ExpireCycle cycle, size_t batch_keys,
+                           int64_t budget_microseconds) {
+  // Overdue keys counted for the stale estimate. Past this many the estimate
+  // is a lower bound, which keeps the count cheap when expiration falls
+  // behind.
+  constexpr size_t kStaleCountLimit = 10000;
+  constexpr double kStaleSmoothing = 0.05;
+  const int64_t start = utils::NowInMicroseconds();
+  int64_t elapsed = 0;
+  while (elapsed < budget_microseconds) {
+    // A short batch means no more keys are due.
+    const auto batch = ExpireSome(batch_keys, utils::NowInMilliseconds());
+    elapsed = utils::NowInMicroseconds() - start;
+    if (batch.sampled < batch_keys) {
+      break;
+    }
   }
-  const auto* result = expires_->FindValue(key);
-  if (result == nullptr) {
+  expire_stats_.total_microseconds += elapsed;
+  if (cycle == ExpireCycle::kFast) {
+    ++expire_stats_.fast_cycles;
+    return;
+  }
+  ++expire_stats_.slow_cycles;
+  const size_t volatile_keys = expires_.Size();
+  const double stale =
+      volatile_keys == 0
+          ? 0
+          : 100.0 *
+                static_cast<double>(expires_.CountDue(
+                    utils::NowInMilliseconds(), kStaleCountLimit)) /
+                static_cast<double>(volatile_keys);
+  expire_stats_.stale_percent = stale * kStaleSmoothing +
+                                expire_stats_.stale_percent *
+                                    (1 - kStaleSmoothing);
+}
+
+bool RedisDb::ResizeTablesIfNeeded(int buckets) {
+  dict_->ShrinkIfNeeded();
+  return dict_->Rehash(buckets);
+}
+
+bool RedisDb::ReserveTables(size_t keys) { return dict_->Reserve(keys); }
+
+void RedisDb::ActiveRehash(int64_t budget_microseconds) {
+  constexpr int kRehashBucketsPerStep = 100;
+  dict_->ShrinkIfNeeded();
+  if (!dict_->IsRehashing()) {
+    return;
+  }
+  const int64_t start = utils::NowInMicroseconds();
+  int64_t elapsed = 0;
+  bool pending = true;
+  while (pending && elapsed < budget_microseconds) {
+    pending = ResizeTablesIfNeeded(kRehashBucketsPerStep);
+    elapsed = utils::NowInMicroseconds() - start;
+  }
+  ++rehash_stats_.cycles;
+  rehash_stats_.total_microseconds += elapsed;
+  rehash_stats_.max_stall_microseconds =
+      std::max(rehash_stats_.max_stall_microseconds, elapsed);
+}
+
+size_t RedisDb::ActiveDefrag(size_t cursor, int64_t budget_microseconds) {
+  const int64_t start = utils::NowInMicroseconds();
+  in_memory::DefragStats blocks;
+  std::optional<size_t> next = cursor;
+  for (size_t steps = 1; next.has_value(); ++steps) {
+    next = dict_->Scan(*next, [this, &blocks](std::string_view /*key*/,
+                                              const RedisObjectPtr& object) {
+      if (object->Defrag(&blocks)) {
+        ++defrag_stats_.key_hits;
+      } else {
+        ++defrag_stats_.key_misses;
+      }
+    });
+    if (steps % utils::kStepsPerClockRead == 0 &&
+        utils::NowInMicroseconds() - start >= budget_microseconds) {
+      break;
+    }
+  }
+  defrag_stats_.hits += blocks.hits;
+  defrag_stats_.misses += blocks.misses;
+  defrag_stats_.bytes_moved += blocks.bytes_moved;
+  ++defrag_stats_.cycles;
+  defrag_stats_.total_microseconds += utils::NowInMicroseconds() - start;
+  if (!next.has_value()) {
+    ++defrag_stats_.passes;
+  }
+  return next.value_or(0);
+}
+
+void RedisDb::SetHotKeySampleRate(uint32_t rate) {
+  hot_key_sample_rate_ = std::min(rate, kMaxHotKeySampleRate);
+  hot_key_countdown_ = hot_key_sample_rate_;
+  if (hot_key_sample_rate_ == 0) {
+    hot_keys_.Clear();
+  }
+}
+
+void RedisDb::RecordAccess(std::string_view key, size_t hash) {
+  if (hot_key_sample_rate_ == 0 || loading_ || --hot_key_countdown_ != 0) {
+    return;
+  }
+  hot_key_countdown_ = hot_key_sample_rate_;
+  hot_keys_.Record(key, hash, utils::CachedNowInMilliseconds(),
+                   hot_key_sample_rate_);
+}
+
+std::vector<HotKey> RedisDb::HotKeys(size_t count) {
+  std::vector<HotKey> hot_keys;
+  for (auto& hot_key : hot_keys_.Top(HotKeySketch::kCapacity)) {
+    if (hot_keys.size() == count) {
+      break;
+    }
+    const auto* const object = dict_->FindValue(hot_key.key);
+    if (object != nullptr && !IsExpired(**object)) {
+      hot_keys.push_back(std::move(hot_key));
+    }
+  }
+  return hot_keys;
+}
+
+std::vector<HotKey> RedisDb::SampleHotKeys(size_t count, size_t samples) {
+  std::vector<HotKey> hot_keys;
+  if (!TracksFrequency(eviction_policy_) || count == 0 ||
+      dict_->Size() == 0) {
+    return hot_keys;
+  }
+  const int64_t now = utils::CachedNowInMilliseconds();
+  samples = std::min(samples, dict_->Size());
+  size_t seen = 0;
+  std::optional<size_t> cursor = hot_key_cursor_;
+  do {
+    cursor = dict_->Scan(*cursor, [this, now, &seen, &hot_keys](
+                                      std::string_view key,
+                                      const RedisObjectPtr& object) {
+      ++seen;
+      if (!object->IsShared() && !IsExpired(*object)) {
+        hot_keys.push_back(
+            HotKey{std::string(key), LfuCounter(object->Lru(), now)});
+      }
+    });
+    // Wrap around so a scan that began mid-keyspace still sees every key.
+    if (!cursor.has_value()) {
+      cursor = 0;
+    }
+  } while (seen < samples);
+  hot_key_cursor_ = *cursor;
+  count = std::min(count, hot_keys.size());
+  std::partial_sort(hot_keys.begin(), hot_keys.begin() + count,
+                    hot_keys.end(), [](const HotKey& a, const HotKey& b) {
+                      return a.hits > b.hits ||
+                             (a.hits == b.hits && a.key < b.key);
+                    });
+  hot_keys.resize(count);
+  return hot_keys;
+}
+
+void RedisDb::SetEvictionPolicy(EvictionPolicy policy) {
+  eviction_policy_ = policy;
+  eviction_pool_.Clear();
+}
+
+std::optional<std::string> RedisDb::EvictKey() {
+  std::optional<std::string> key = EvictionCandidate();
+  if (!key.has_value()) {
+    return std::nullopt;
+  }
+  auto object = DetachKey(*key);
+  if (!object.has_value()) {
+    return std::nullopt;
+  }
+  FreeObject(std::move(*object), /*lazy=*/true);
+  ++eviction_stats_.evicted_keys;
+  return key;
+}
+
+/*
+ * Random and TTL eviction need no ranking: the first draws any key and the
+ * second takes the earliest deadline from the expire index. LRU and LFU add a
+ * few sampled keys to the pool and take its best candidate that still
+ * qualifies; volatile-lru falls back to the earliest deadline if sampling
+ * found no key with a TTL.
+ */
+std::optional<std::string> RedisDb::EvictionCandidate() {
+  switch (eviction_policy_) {
+    case EvictionPolicy::kNoEviction:
+      return std::nullopt;
+    case EvictionPolicy::kAllKeysRandom: {
+      std::optional<std::string> key;
+      dict_->RandomEntry(
+          [&key](std::string_view entry_key, const RedisObjectPtr&) {
+            key.emplace(entry_key);
+          });
+      return key;
+    }
+    case EvictionPolicy::kVolatileTtl: {
+      const auto key = expires_.NextKey();
+      return key.has_value() ? std::optional<std::string>(*key) : std::nullopt;
+    }
+    case EvictionPolicy::kAllKeysLru:
+    case EvictionPolicy::kAllKeysLfu:
+    case EvictionPolicy::kVolatileLru:
+      break;
+  }
+  const bool volatile_only = eviction_policy_ == EvictionPolicy::kVolatileLru;
+  if (volatile_only && expires_.Size() == 0) {
+    return std::nullopt;
+  }
+  SampleEvictionPool();
+  while (auto key = eviction_pool_.Pop()) {
+    const auto* const object = dict_->FindValue(*key);
+    if (object != nullptr && (!volatile_only || (*object)->Expire() != 0)) {
+      return key;
+    }
+  }
+  if (volatile_only) {
+    const auto key = expires_.NextKey();
+    return key.has_value() ? std::optional<std::string>(*key) : std::nullopt;
+  }
+  return std::nullopt;
+}
+
+void RedisDb::SampleEvictionPool() {
+  constexpr uint64_t kMaxLfuCounter = 255;
+  const bool volatile_only = eviction_policy_ == EvictionPolicy::kVolatileLru;
+  const bool frequency = TracksFrequency(eviction_policy_);
+  const int64_t now = utils::CachedNowInMilliseconds();
+  const uint32_t clock = LruClock(now);
+  const size_t draws = volatile_only ? kEvictionSamples * kVolatileSampleDraws
+                                     : kEvictionSamples;
+  size_t sampled = 0;
+  for (size_t draw = 0; draw < draws && sampled < kEvictionSamples; ++draw) {
+    dict_->RandomEntry([&](std::string_view key, const RedisObjectPtr& object) {
+      if (volatile_only && object->Expire() == 0) {
+        return;
+      }
+      ++sampled;
+      eviction_pool_.Offer(
+          key, frequency ? kMaxLfuCounter - LfuCounter(object->Lru(), now)
+                         : IdleSeconds(object->Lru(), clock));
+    });
+  }
+}
+
+std::optional<RedisObjectPtr> RedisDb::DetachKey(std::string_view key) {
+  const size_t hash = dict_->KeyHash(key);
+  const RedisObjectPtr* const object = dict_->FindValue(key, hash);
+  if (object == nullptr) {
+    return std::nullopt;
+  }
+  if ((*object)->Expire() != 0) {
+    expires_.Remove(key, (*object)->Expire());
+  }
+  if (prefix_index_ != nullptr) {
+    prefix_index_->Remove(key);
+  }
+  return dict_->Extract(key, hash);
+}
+
+DbStatus RedisDb::RemoveKey(std::string_view key, bool lazy) {
+  auto object = DetachKey(key);
+  if (!object.has_value()) {
+    return DbStatus::kError;
+  }
+  FreeObject(std::move(*object), lazy);
+  return DbStatus::kOk;
+}
+
+void RedisDb::FreeObject(RedisObjectPtr object, bool lazy) {
+  if (lazy && object->FreeEffort() > kLazyFreeEffort) {
+    reclaimer_.Reclaim(std::move(object));
+  }
+}
+
+std::optional<size_t> RedisDb::MemoryUsage(std::string_view key,
+                                           size_t samples) {
+  const auto* const object = dict_->FindValue(key);
+  if (object == nullptr || IsExpired(**object)) {
+    return std::nullopt;
+  }
+  const size_t keys = dict_->Size();
+  return (*object)->Bytes(samples) + dict_->Bytes(kMemorySamples) / keys;
+}
+
+KeyspaceMemory RedisDb::MemoryBreakdown() {
+  KeyspaceMemory memory;
+  memory.keyspace_bytes = dict_->Bytes(kMemorySamples);
+  memory.expires_bytes = expires_.Bytes(kMemorySamples);
+  if (prefix_index_ != nullptr) {
+    memory.prefix_index_bytes = prefix_index_->MemoryUsage();
+  }
+  const auto measure = [&memory](const RedisObject& object) {
+    const std::string_view encoding = object.EncodingName();
+    auto it = std::lower_bound(
+        memory.encodings.begin(), memory.encodings.end(), encoding,
+        [](const EncodingMemory& entry, std::string_view name) {
+          return entry.encoding < name;
+        });
+    if (it == memory.encodings.end() || it->encoding != encoding) {
+      it = memory.encodings.insert(it, EncodingMemory{encoding});
+    }
+    ++it->keys;
+    it->bytes += object.Bytes(kMemorySamples);
+  };
+  const size_t keys = dict_->Size();
+  if (keys <= kMemoryKeySamples) {
+    ForEachObject([&measure](std::string_view /*key*/,
+                             const RedisObject& object) {
+      measure(object);
+      return true;
+    });
+    return memory;
+  }
+  size_t sampled = 0;
+  for (size_t draw = 0; draw < kMemoryKeySamples; ++draw) {
+    dict_->RandomEntry(
+        [&](std::string_view /*key*/, const RedisObjectPtr& object) {
+          measure(*object);
+          ++sampled;
+        });
+  }
+  for (auto& entry : memory.encodings) {
+    entry.keys = entry.keys * keys / sampled;
+    entry.bytes = entry.bytes * keys / sampled;
+  }
+  return memory;
+}
+
+TableStats RedisDb::KeyspaceTableStats() const { return StatsOf(*dict_); }
+
+PrefixIndexStats RedisDb::PrefixStats() const {
+  PrefixIndexStats stats;
+  if (prefix_index_ == nullptr) {
+    return stats;
+  }
+  stats.enabled = true;
+  stats.keys = prefix_index_->Size();
+  stats.nodes = prefix_index_->NodeCount();
+  stats.memory_bytes = prefix_index_->MemoryUsage();
+  return stats;
+}
+
+void RedisDb::TouchObject(RedisObject* const object,
+                          const RedisObject* const previous) const {
+  if (object->IsShared()) {
+    return;
+  }
+  const int64_t now = utils::CachedNowInMilliseconds();
+  if (!TracksFrequency(eviction_policy_)) {
+    object->SetLru(LruClock(now));
+  } else if (previous == nullptr) {
+    object->SetLru(LfuInitial(now));
+  } else {
+    object->SetLru(LfuTouch(previous->Lru(), now));
+  }
+}
+
+bool RedisDb::IsExpired(const RedisObject& object) const {
+  if (loading_ || object.Expire() == 0) {
     return false;
   }
-  const int64_t now = utils::NowInMilliseconds();
-  return *result <= now;
+  return object.Expire() <= utils::CachedNowInMilliseconds();
 }
 }  // namespace redis_simple::db
@@ -1,14 +1,20 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
-#include "memory/dict.h"
+#include "memory/sharded_dict.h"
 #include "server/db/async_reclaimer.h"
+#include "server/db/eviction.h"
+#include "server/db/expire_index.h"
+#include "server/db/hot_keys.h"
+#include "server/db/prefix_index.h"
 #include "server/db/redis_obj.h"
 
 namespace redis_simple::aof {
@@ -35,6 +41,100 @@ struct ExpireSampleResult {
   size_t expired{};
 };
 
+struct TableStats {
+  size_t keys{};
+  size_t buckets{};
+  bool rehashing{};
+  // Buckets of the old table already migrated by the in-progress rehash.
+  size_t rehashed_buckets{};
+  // Independently rehashing sub-tables the stats are summed over.
+  size_t shards{};
+};
+
+enum class ExpireCycle {
+  // Cron-driven cycle with a budget proportional to the cron period.
+  kSlow,
+  // Short cycle run before polling while keys are due.
+  kFast,
+};
+
+struct ActiveExpireStats {
+  // Keys deleted because their TTL passed, by lookups or active expiration.
+  uint64_t expired_keys{};
+  uint64_t slow_cycles{};
+  uint64_t fast_cycles{};
+  int64_t total_microseconds{};
+  // Running average of the share of volatile keys left past their deadline at
+  // the end of each slow cycle.
+  double stale_percent{};
+};
+
+struct ActiveRehashStats {
+  uint64_t cycles{};
+  int64_t total_microseconds{};
+  // Longest single cron slice spent rehashing.
+  int64_t max_stall_microseconds{};
+};
+
+struct EvictionStats {
+  // Keys removed to bring used memory back under maxmemory.
+  uint64_t evicted_keys{};
+};
+
+struct ActiveDefragStats {
+  // Heap blocks moved to fresh memory, and blocks examined but left in place.
+  uint64_t hits{};
+  uint64_t misses{};
+  uint64_t bytes_moved{};
+  // Keys with at least one block moved, and keys with none.
+  uint64_t key_hits{};
+  uint64_t key_misses{};
+  uint64_t cycles{};
+  int64_t total_microseconds{};
+  // Completed passes over the whole keyspace.
+  uint64_t passes{};
+};
+
+struct EncodingMemory {
+  // As RedisObject::EncodingName() reports it.
+  std::string_view encoding;
+  size_t keys{};
+  // Bytes of the values, without the keyspace entries that hold them.
+  size_t bytes{};
+};
+
+struct KeyspaceMemory {
+  // Keyspace tables and entries, including key names but not values.
+  size_t keyspace_bytes{};
+  size_t expires_bytes{};
+  size_t prefix_index_bytes{};
+  // Value bytes by encoding, ordered by name. Measured from a sample of keys
+  // when the keyspace is large.
+  std::vector<EncodingMemory> encodings;
+};
+
+// Which deletions hand their values to the async reclaimer instead of freeing
+// them inline. Values go there only if freeing them takes more than
+// RedisDb::kLazyFreeEffort allocations.
+struct LazyFreeOptions {
+  // FLUSHDB without ASYNC or SYNC.
+  bool user_flush{};
+  // DeleteKey(), as DEL and commands that empty a collection use it.
+  bool user_del{};
+  // Keys removed by lazy or active expiration.
+  bool expire{};
+  // Values replaced by SetKey() and RenameKey().
+  bool server_del{};
+};
+
+struct PrefixIndexStats {
+  bool enabled{};
+  size_t keys{};
+  size_t nodes{};
+  // Bytes the index adds on top of the keyspace.
+  size_t memory_bytes{};
+};
+
 constexpr int ToInt(SetKeyFlag flag) { return static_cast<int>(flag); }
 constexpr bool HasFlag(int flags, SetKeyFlag flag) {
   return (flags & ToInt(flag)) != 0;
@@ -42,7 +142,17 @@ constexpr bool HasFlag(int flags, SetKeyFlag flag) {
 
 class RedisDb {
  public:
-  static std::unique_ptr<RedisDb> Create();
+  static constexpr size_t kDefaultKeyspaceShards = 16;
+  // Values that free more allocations than this go to the async reclaimer
+  // when lazy freeing applies; smaller ones are cheaper to free inline.
+  static constexpr size_t kLazyFreeEffort = 64;
+  // Upper bound on SetHotKeySampleRate().
+  static constexpr uint32_t kMaxHotKeySampleRate = 1000000;
+  // The keyspace is split into shards sub-tables, rounded up to a power of
+  // two. With prefix_index, key names are also kept in a PrefixIndex so SCAN
+  // MATCH with a literal prefix visits only the keys under it.
+  static std::unique_ptr<RedisDb> Create(
+      size_t shards = kDefaultKeyspaceShards, bool prefix_index = false);
   const RedisObject* LookupKey(std::string_view key);
   RedisObject* MutableLookupKey(std::string_view key);
   DbStatus SetKey(std::string_view key, RedisObjectPtr object, int64_t expire);
@@ -54,8 +164,20 @@ class RedisDb {
   DbStatus PersistKey(std::string_view key);
   DbStatus RenameKey(std::string_view old_key, std::string_view new_key);
   std::optional<int64_t> Expiration(std::string_view key) const;
+  // A live key chosen uniformly at random, or std::nullopt if there is none.
+  // Expired keys drawn along the way are deleted.
+  std::optional<std::string> RandomKey();
   int64_t TimeToLive(std::string_view key, TtlResolution resolution);
   size_t KeyCount() const { return dict_->Size(); }
+  size_t ExpiringKeyCount() const { return expires_.Size(); }
+  // Warm the cache lines that looking up keys will touch: keyspace buckets,
+  // entries, and the objects they own.
+  void PrefetchKeys(const std::string_view* keys, size_t count);
+  // Call visitor(key) for every key in order, prefetching each group of keys
+  // before the visitor looks them up. The visitor may mutate the database.
+  template <typename Visitor>
+  void ForEachKeyPrefetched(const std::vector<std::string_view>& keys,
+                            Visitor&& visitor);
   // Key views and object references remain valid only until the database is
   // mutated. Returning false from the visitor stops further callbacks.
   template <typename Visitor>
@@ -63,18 +185,150 @@ class RedisDb {
   // Key views remain valid until the database is mutated.
   template <typename Visitor>
   size_t ScanKeys(size_t cursor, size_t bucket_count, Visitor&& visitor);
+  // ScanKeys() that also passes each live key's object, without counting
+  // the visit as an access.
+  template <typename Visitor>
+  size_t ScanObjects(size_t cursor, size_t bucket_count, Visitor&& visitor);
+  bool HasPrefixIndex() const { return prefix_index_ != nullptr; }
+  // Call visitor(key) for the live keys among the next count keys starting
+  // with prefix. Requires HasPrefixIndex(). Returns the next cursor as
+  // PrefixIndex::Scan() does. The key view is valid only during the callback.
+  template <typename Visitor>
+  std::optional<size_t> ScanKeysWithPrefix(size_t cursor,
+                                           std::string_view prefix,
+                                           size_t count, Visitor&& visitor);
   void Flush();
-  ExpireSampleResult ExpireSome(size_t max_samples, int64_t now);
+  // Empty the database at once and free the detached tables on the reclaimer
+  // thread.
+  void FlushAsync();
+  void SetLazyFreeOptions(const LazyFreeOptions& options) {
+    lazy_free_ = options;
+  }
+  const LazyFreeOptions& LazyFree() const { return lazy_free_; }
+  // Delete up to max_keys keys due at now, earliest deadline first.
+  ExpireSampleResult ExpireSome(size_t max_keys, int64_t now);
+  // Delete due keys in batches of batch_keys until none are due or the budget
+  // is spent.
+  void ActiveExpire(ExpireCycle cycle, size_t batch_keys,
+                    int64_t budget_microseconds);
+  bool HasDueKeys(int64_t now) const {
+    const auto deadline = expires_.NextDeadline();
+    return deadline.has_value() && *deadline <= now;
+  }
+  // Start shrinking sparse tables and migrate up to `buckets` buckets of any
+  // in-progress rehash per table. Return true if rehashing work remains.
+  bool ResizeTablesIfNeeded(int buckets);
+  // Presize the keyspace before loading a known number of keys so the load
+  // does not rehash. Return false if a table cannot grow.
+  bool ReserveTables(size_t keys);
+  // Resize tables from the cron until no rehash work remains or the budget is
+  // spent.
+  void ActiveRehash(int64_t budget_microseconds);
+  // Defragment the values of keys in SCAN order from cursor until the budget
+  // is spent. Returns the cursor to resume from, or 0 once the pass has
+  // covered the keyspace.
+  size_t ActiveDefrag(size_t cursor, int64_t budget_microseconds);
+  // Set how keys are ranked for eviction and what the access bits of their
+  // objects record. Policies that rank by access stop keys sharing integer
+  // objects from then on.
+  void SetEvictionPolicy(EvictionPolicy policy);
+  EvictionPolicy GetEvictionPolicy() const { return eviction_policy_; }
+  // Remove one key chosen by the eviction policy and return its name, or
+  // std::nullopt if the policy finds no candidate. Values that are costly to
+  // free go to the async reclaimer, so memory may drop only once it catches
+  // up.
+  std::optional<std::string> EvictKey();
+  // Values handed to the async reclaimer and not yet freed.
+  size_t PendingReclaims() const { return reclaimer_.PendingCount(); }
+  // Values and keyspaces the async reclaimer has freed.
+  uint64_t ReclaimedObjects() const { return reclaimer_.ReclaimedCount(); }
+  // Estimated bytes those values and flushed keyspaces still hold.
+  size_t PendingReclaimBytes() const { return reclaimer_.PendingBytes(); }
+  // Feed one in rate lookups and writes to the hot key sketch, or none if
+  // rate is 0, which is the default.
+  void SetHotKeySampleRate(uint32_t rate);
+  bool TracksHotKeys() const { return hot_key_sample_rate_ != 0; }
+  // Up to count of the most accessed live keys, from the sketch. Empty unless
+  // TracksHotKeys().
+  std::vector<HotKey> HotKeys(size_t count);
+  // Up to count keys with the highest LFU counters among about samples keys,
+  // scanned onward from where the previous call stopped. Requires an LFU
+  // eviction policy, since only then do objects count accesses.
+  std::vector<HotKey> SampleHotKeys(size_t count, size_t samples);
+  // Bytes held by key's value plus its share of the keyspace table, or
+  // std::nullopt if the key does not exist. With samples, collections measure
+  // only that many elements and extrapolate the rest. Does not count as an
+  // access.
+  std::optional<size_t> MemoryUsage(std::string_view key, size_t samples);
+  // Where the keyspace's memory goes, estimated from samples so it stays
+  // cheap enough for INFO on a large keyspace.
+  KeyspaceMemory MemoryBreakdown();
+  TableStats KeyspaceTableStats() const;
+  PrefixIndexStats PrefixStats() const;
+  const ActiveRehashStats& RehashStats() const { return rehash_stats_; }
+  const ActiveExpireStats& ExpireStats() const { return expire_stats_; }
+  const EvictionStats& EvictStats() const { return eviction_stats_; }
+  const ActiveDefragStats& DefragStats() const { return defrag_stats_; }
 
  private:
   friend class aof::Aof;
-  RedisDb();
+  static constexpr size_t kPrefetchBatch = 16;
+  // Keys sampled into the eviction pool per eviction.
+  static constexpr size_t kEvictionSamples = 5;
+  // Draws per sample when only volatile keys qualify, so a keyspace with few
+  // of them still fills the pool.
+  static constexpr size_t kVolatileSampleDraws = 4;
+  // Entries measured per table, and elements per collection, by
+  // MemoryBreakdown().
+  static constexpr size_t kMemorySamples = 64;
+  // Keyspaces up to this size have every value measured by
+  // MemoryBreakdown(); larger ones have this many drawn at random.
+  static constexpr size_t kMemoryKeySamples = 1024;
+  RedisDb(size_t shards, bool prefix_index);
   void SetLoading(bool loading) { loading_ = loading; }
-  bool IsKeyExpired(std::string_view key) const;
-  std::unique_ptr<in_memory::Dict<std::string, RedisObjectPtr>> dict_;
-  std::unique_ptr<in_memory::Dict<std::string, int64_t>> expires_;
+  bool IsExpired(const RedisObject& object) const;
+  // Record an access to object in its access bits. previous is the object it
+  // replaces, whose access frequency carries over.
+  void TouchObject(RedisObject* object, const RedisObject* previous) const;
+  std::optional<std::string> EvictionCandidate();
+  void SampleEvictionPool();
+  // The name the keyspace stores for key, which must exist. The expire index
+  // is given this name, which it may keep a view of.
+  std::string_view StoredKey(std::string_view key, size_t hash) {
+    return *dict_->FindKey(key, hash);
+  }
+  // Take key's value out of the keyspace and its indexes, or return
+  // std::nullopt if key does not exist. The indexes are updated before the
+  // keyspace entry, whose name the expire index may view, is freed.
+  std::optional<RedisObjectPtr> DetachKey(std::string_view key);
+  // Remove key, freeing its value as FreeObject() does.
+  DbStatus RemoveKey(std::string_view key, bool lazy);
+  // Free object on the async reclaimer if lazy and it is costly to free, and
+  // inline otherwise.
+  void FreeObject(RedisObjectPtr object, bool lazy);
+  // Count an access to key, whose keyspace hash is hash, in the hot key
+  // sketch if this access is sampled.
+  void RecordAccess(std::string_view key, size_t hash);
+  std::unique_ptr<in_memory::ShardedDict<RedisObjectPtr>> dict_;
+  // Volatile keys by deadline for active expiration. Lookups read the
+  // expiration stored in the object instead.
+  ExpireIndex expires_;
+  // Null unless the database was created with a prefix index.
+  std::unique_ptr<PrefixIndex> prefix_index_;
   AsyncReclaimer reclaimer_;
-  size_t expire_cursor_{};
+  LazyFreeOptions lazy_free_;
+  ActiveRehashStats rehash_stats_;
+  ActiveExpireStats expire_stats_;
+  EvictionPolicy eviction_policy_{EvictionPolicy::kNoEviction};
+  EvictionPool eviction_pool_;
+  EvictionStats eviction_stats_;
+  ActiveDefragStats defrag_stats_;
+  HotKeySketch hot_keys_;
+  uint32_t hot_key_sample_rate_{};
+  // Accesses left until the next sampled one.
+  uint32_t hot_key_countdown_{};
+  // Where SampleHotKeys() resumes its scan.
+  size_t hot_key_cursor_{};
   // Replay defers expiration checks until all historical writes are applied.
   bool loading_{};
 };
@@ -90,9 +344,9 @@ bool RedisDb::ForEachObject(Visitor&& visitor) {
   while (cursor.has_value()) {
     cursor = dict_->Scan(
         *cursor, [this, &visitor, &keep_visiting](
-                     const std::string& key, const RedisObjectPtr& object) {
-          if (keep_visiting && !IsKeyExpired(key)) {
-            keep_visiting = visitor(std::string_view(key), *object);
+                     std::string_view key, const RedisObjectPtr& object) {
+          if (keep_visiting && !IsExpired(*object)) {
+            keep_visiting = visitor(key, *object);
           }
         });
     if (!keep_visiting) {
@@ -102,9 +356,45 @@ bool RedisDb::ForEachObject(Visitor&& visitor) {
   return true;
 }
 
+template <typename Visitor>
+void RedisDb::ForEachKeyPrefetched(const std::vector<std::string_view>& keys,
+                                   Visitor&& visitor) {
+  for (size_t start = 0; start < keys.size(); start += kPrefetchBatch) {
+    const size_t count = std::min(kPrefetchBatch, keys.size() - start);
+    PrefetchKeys(keys.data() + start, count);
+    for (size_t index = start; index < start + count; ++index) {
+      visitor(keys[index]);
+    }
+  }
+}
+
+template <typename Visitor>
+std::optional<size_t> RedisDb::ScanKeysWithPrefix(size_t cursor,
+                                                  std::string_view prefix,
+                                                  size_t count,
+                                                  Visitor&& visitor) {
+  return prefix_index_->Scan(
+      cursor, prefix, count, [this, &visitor](std::string_view key) {
+        const auto* const object = dict_->FindValue(key);
+        if (object != nullptr && !IsExpired(**object)) {
+          visitor(key);
+        }
+      });
+}
+
 template <typename Visitor>
 size_t RedisDb::ScanKeys(size_t cursor, size_t bucket_count,
                          Visitor&& visitor) {
+  return ScanObjects(cursor, bucket_count,
+                     [&visitor](std::string_view key,
+                                const RedisObject& /*object*/) {
+                       visitor(key);
+                     });
+}
+
+template <typename Visitor>
+size_t RedisDb::ScanObjects(size_t cursor, size_t bucket_count,
+                            Visitor&& visitor) {
   if (bucket_count == 0 || dict_->Size() == 0) {
     return 0;
   }
@@ -114,9 +404,9 @@ size_t RedisDb::ScanKeys(size_t cursor, size_t bucket_count,
        ++scanned) {
     next_cursor = dict_->Scan(
         *next_cursor,
-        [this, &visitor](const std::string& key, const RedisObjectPtr&) {
-          if (!IsKeyExpired(key)) {
-            visitor(std::string_view(key));
+        [this, &visitor](std::string_view key, const RedisObjectPtr& object) {
+          if (!IsExpired(*object)) {
+            visitor(key, *object);
           }
         });
   }
@@ -3,11 +3,16 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
+#include "data_types/hash/hash.h"
+#include "memory/slab_allocator.h"
 #include "utils/time_utils.h"
 
 namespace redis_simple::db {
@@ -83,12 +88,61 @@ TEST(RedisDbTest, ExpireSamplingWorksWhenFewKeysHaveTtl) {
   ASSERT_EQ(
       redis_db->SetKey("expired", RedisObject::CreateWithString("gone"), 1),
       DbStatus::kOk);
+  for (int index = 0; index < 20; ++index) {
+    ASSERT_EQ(redis_db->SetKey("later-" + std::to_string(index),
+                               RedisObject::CreateWithString("value"),
+                               100 + index),
+              DbStatus::kOk);
+  }
 
   const auto sample = redis_db->ExpireSome(20, 2);
 
   EXPECT_EQ(sample.sampled, 1);
   EXPECT_EQ(sample.expired, 1);
-  EXPECT_EQ(redis_db->KeyCount(), 20);
+  EXPECT_EQ(redis_db->KeyCount(), 40);
+  EXPECT_EQ(redis_db->ExpiringKeyCount(), 20);
+}
+
+TEST(RedisDbTest, ActiveExpireDeletesDueKeysAndRecordsStats) {
+  auto redis_db = RedisDb::Create();
+  const int64_t now = utils::NowInMilliseconds();
+  for (int index = 0; index < 50; ++index) {
+    ASSERT_EQ(redis_db->SetKey("due-" + std::to_string(index),
+                               RedisObject::CreateWithString("v"), 1),
+              DbStatus::kOk);
+  }
+  ASSERT_EQ(redis_db->SetKey("later", RedisObject::CreateWithString("v"),
+                             now + 60'000),
+            DbStatus::kOk);
+  EXPECT_TRUE(redis_db->HasDueKeys(now));
+
+  redis_db->ActiveExpire(ExpireCycle::kSlow, 20, 1'000'000);
+  EXPECT_FALSE(redis_db->HasDueKeys(now));
+  EXPECT_EQ(redis_db->KeyCount(), 1);
+  const auto& stats = redis_db->ExpireStats();
+  EXPECT_EQ(stats.expired_keys, 50);
+  EXPECT_EQ(stats.slow_cycles, 1);
+  EXPECT_EQ(stats.stale_percent, 0);
+
+  ASSERT_EQ(redis_db->SetKey("lazy", RedisObject::CreateWithString("v"), 1),
+            DbStatus::kOk);
+  EXPECT_EQ(redis_db->LookupKey("lazy"), nullptr);
+  EXPECT_EQ(redis_db->ExpireStats().expired_keys, 51);
+}
+
+TEST(RedisDbTest, LookupsShareTheCachedClock) {
+  auto redis_db = RedisDb::Create();
+  {
+    const utils::CachedClockScope cached_clock;
+    const int64_t now = utils::CachedNowInMilliseconds();
+    ASSERT_EQ(redis_db->SetKey("key", RedisObject::CreateWithString("v"),
+                               now + 1),
+              DbStatus::kOk);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_NE(redis_db->LookupKey("key"), nullptr);
+    EXPECT_EQ(redis_db->TimeToLive("key", TtlResolution::kMilliseconds), 1);
+  }
+  EXPECT_EQ(redis_db->LookupKey("key"), nullptr);
 }
 
 TEST(RedisDbTest, ExpirePersistAndTtl) {
@@ -111,6 +165,27 @@ TEST(RedisDbTest, ExpirePersistAndTtl) {
   EXPECT_EQ(redis_db->LookupKey("key"), nullptr);
 }
 
+TEST(RedisDbTest, ExpiringASharedIntegerGivesTheKeyItsOwnObject) {
+  auto redis_db = RedisDb::Create();
+  ASSERT_EQ(redis_db->SetKey("a", RedisObject::CreateWithString("7"), 0),
+            DbStatus::kOk);
+  ASSERT_EQ(redis_db->SetKey("b", RedisObject::CreateWithString("7"), 0),
+            DbStatus::kOk);
+  EXPECT_EQ(redis_db->LookupKey("a"), redis_db->LookupKey("b"));
+
+  const int64_t future = utils::NowInMilliseconds() + 60'000;
+  ASSERT_EQ(redis_db->ExpireKeyAt("a", future), DbStatus::kOk);
+  EXPECT_NE(redis_db->LookupKey("a"), redis_db->LookupKey("b"));
+  EXPECT_EQ(redis_db->Expiration("a"), future);
+  EXPECT_EQ(redis_db->Expiration("b"), std::nullopt);
+  EXPECT_EQ(redis_db->LookupKey("a")->Integer(), 7);
+
+  ASSERT_EQ(redis_db->SetKey("c", RedisObject::CreateWithString("7"), future),
+            DbStatus::kOk);
+  EXPECT_FALSE(redis_db->LookupKey("c")->IsShared());
+  EXPECT_TRUE(redis_db->LookupKey("b")->IsShared());
+}
+
 TEST(RedisDbTest, TtlRoundsToNearestSecond) {
   auto redis_db = RedisDb::Create();
   const int64_t now = utils::NowInMilliseconds();
@@ -146,6 +221,140 @@ TEST(RedisDbTest, RenameAndFlush) {
   EXPECT_EQ(redis_db->LookupKey("target"), nullptr);
 }
 
+TEST(RedisDbTest, FlushAsyncEmptiesAtOnceAndFreesInBackground) {
+  auto redis_db = RedisDb::Create(RedisDb::kDefaultKeyspaceShards,
+                                  /*prefix_index=*/true);
+  const int64_t future = utils::NowInMilliseconds() + 60'000;
+  for (int index = 0; index < 1000; ++index) {
+    ASSERT_EQ(redis_db->SetKey("key:" + std::to_string(index),
+                               RedisObject::CreateWithString("value"),
+                               index % 2 == 0 ? future : 0),
+              DbStatus::kOk);
+  }
+
+  redis_db->FlushAsync();
+  EXPECT_EQ(redis_db->KeyCount(), 0);
+  EXPECT_EQ(redis_db->ExpiringKeyCount(), 0);
+  EXPECT_EQ(redis_db->PrefixStats().keys, 0);
+  EXPECT_EQ(redis_db->LookupKey("key:0"), nullptr);
+
+  ASSERT_EQ(redis_db->SetKey("key:0", RedisObject::CreateWithString("new"),
+                             future),
+            DbStatus::kOk);
+  EXPECT_EQ(redis_db->LookupKey("key:0")->String(), "new");
+  EXPECT_EQ(redis_db->ExpiringKeyCount(), 1);
+
+  while (redis_db->PendingReclaims() > 0) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(redis_db->PendingReclaimBytes(), 0);
+}
+
+TEST(RedisDbTest, FlushReturnsSlabMemory) {
+  const auto slab_bytes = [] {
+    size_t bytes = 0;
+    for (const auto& size_class : in_memory::SlabMemoryStats().classes) {
+      bytes += size_class.slab_bytes;
+    }
+    return bytes;
+  };
+  auto redis_db = RedisDb::Create();
+  const size_t before = slab_bytes();
+  for (int index = 0; index < 50000; ++index) {
+    ASSERT_EQ(redis_db->SetKey("key:" + std::to_string(index),
+                               RedisObject::CreateWithString("value"), 0),
+              DbStatus::kOk);
+  }
+  const size_t filled = slab_bytes();
+  ASSERT_GT(filled, before);
+  redis_db->Flush();
+  // Dict entries and objects went back to their slabs, and the emptied slabs
+  // were freed, including any left by earlier tests.
+  const size_t after = slab_bytes();
+  EXPECT_LT(after - std::min(after, before), (filled - before) / 4);
+}
+
+TEST(RedisDbTest, LazyFreeSendsOnlyCostlyValuesToReclaimer) {
+  const auto make_hash = [](int fields) {
+    auto hash = hash::Hash::Create();
+    for (int index = 0; index < fields; ++index) {
+      hash->Set("field:" + std::to_string(index), "value");
+    }
+    return RedisObject::CreateWithHash(std::move(hash));
+  };
+  const auto reclaimed = [](RedisDb* const redis_db) {
+    while (redis_db->PendingReclaims() > 0) {
+      std::this_thread::yield();
+    }
+    return redis_db->ReclaimedObjects();
+  };
+  auto redis_db = RedisDb::Create();
+  ASSERT_EQ(redis_db->SetKey("big", make_hash(1000), 0), DbStatus::kOk);
+  EXPECT_EQ(redis_db->DeleteKey("big"), DbStatus::kOk);
+  EXPECT_EQ(reclaimed(redis_db.get()), 0);
+
+  LazyFreeOptions options;
+  options.user_del = true;
+  options.expire = true;
+  options.server_del = true;
+  redis_db->SetLazyFreeOptions(options);
+  ASSERT_EQ(redis_db->SetKey("small", make_hash(10), 0), DbStatus::kOk);
+  EXPECT_EQ(redis_db->DeleteKey("small"), DbStatus::kOk);
+  EXPECT_EQ(reclaimed(redis_db.get()), 0);
+
+  ASSERT_EQ(redis_db->SetKey("big", make_hash(1000), 0), DbStatus::kOk);
+  EXPECT_EQ(redis_db->DeleteKey("big"), DbStatus::kOk);
+  EXPECT_EQ(reclaimed(redis_db.get()), 1);
+
+  ASSERT_EQ(redis_db->SetKey("big", make_hash(1000), 0), DbStatus::kOk);
+  ASSERT_EQ(
+      redis_db->SetKey("big", RedisObject::CreateWithString("value"), 0),
+      DbStatus::kOk);
+  EXPECT_EQ(reclaimed(redis_db.get()), 2);
+
+  ASSERT_EQ(redis_db->SetKey("big", make_hash(1000), 1), DbStatus::kOk);
+  EXPECT_EQ(redis_db->LookupKey("big"), nullptr);
+  EXPECT_EQ(reclaimed(redis_db.get()), 3);
+
+  ASSERT_EQ(redis_db->SetKey("due", make_hash(1000), 1), DbStatus::kOk);
+  EXPECT_EQ(redis_db->ExpireSome(10, utils::NowInMilliseconds()).expired, 1);
+  EXPECT_EQ(reclaimed(redis_db.get()), 4);
+}
+
+TEST(RedisDbTest, ExpirationIsStoredWithTheObject) {
+  auto redis_db = RedisDb::Create();
+  const int64_t future = utils::NowInMilliseconds() + 60'000;
+
+  ASSERT_EQ(
+      redis_db->SetKey("volatile", RedisObject::CreateWithString("v"), future),
+      DbStatus::kOk);
+  ASSERT_EQ(
+      redis_db->SetKey("target", RedisObject::CreateWithString("t"), future),
+      DbStatus::kOk);
+  ASSERT_NE(redis_db->LookupKey("volatile"), nullptr);
+  EXPECT_EQ(redis_db->LookupKey("volatile")->Expire(), future);
+  EXPECT_EQ(redis_db->ExpiringKeyCount(), 2);
+
+  // Renaming a persistent key over a volatile one drops the target's TTL.
+  ASSERT_EQ(redis_db->SetKey("plain", RedisObject::CreateWithString("p"), 0),
+            DbStatus::kOk);
+  EXPECT_EQ(redis_db->RenameKey("plain", "target"), DbStatus::kOk);
+  EXPECT_EQ(redis_db->Expiration("target"), std::nullopt);
+  EXPECT_EQ(redis_db->ExpiringKeyCount(), 1);
+
+  EXPECT_EQ(redis_db->RenameKey("volatile", "moved"), DbStatus::kOk);
+  EXPECT_EQ(redis_db->Expiration("moved"), future);
+  EXPECT_EQ(redis_db->ExpiringKeyCount(), 1);
+
+  EXPECT_EQ(redis_db->PersistKey("moved"), DbStatus::kOk);
+  EXPECT_EQ(redis_db->LookupKey("moved")->Expire(), 0);
+  EXPECT_EQ(redis_db->ExpiringKeyCount(), 0);
+
+  ASSERT_EQ(redis_db->ExpireKeyAt("moved", future), DbStatus::kOk);
+  EXPECT_EQ(redis_db->UnlinkKey("moved"), DbStatus::kOk);
+  EXPECT_EQ(redis_db->ExpiringKeyCount(), 0);
+}
+
 TEST(RedisDbTest, ScansKeysIncrementallyWithoutExpiredKeys) {
   auto redis_db = RedisDb::Create();
   ASSERT_EQ(redis_db->ScanKeys(0, 1, [](std::string_view) {}), 0);
@@ -172,4 +381,347 @@ TEST(RedisDbTest, ScansKeysIncrementallyWithoutExpiredKeys) {
   std::sort(keys.begin(), keys.end());
   EXPECT_EQ(keys, std::vector<std::string>({"alpha", "beta", "gamma"}));
 }
+
+TEST(RedisDbTest, ScansKeysUnderPrefixThroughIndex) {
+  auto redis_db = RedisDb::Create(RedisDb::kDefaultKeyspaceShards, true);
+  ASSERT_TRUE(redis_db->HasPrefixIndex());
+  EXPECT_FALSE(RedisDb::Create()->HasPrefixIndex());
+  for (int index = 0; index < 50; ++index) {
+    const std::string suffix = std::to_string(index);
+    ASSERT_EQ(redis_db->SetKey("user:" + suffix,
+                               RedisObject::CreateWithString("v"), 0),
+              DbStatus::kOk);
+    ASSERT_EQ(redis_db->SetKey("order:" + suffix,
+                               RedisObject::CreateWithString("v"), 0),
+              DbStatus::kOk);
+  }
+  ASSERT_EQ(redis_db->SetKey("user:expired", RedisObject::CreateWithString("v"),
+                             1),
+            DbStatus::kOk);
+  ASSERT_EQ(redis_db->DeleteKey("user:0"), DbStatus::kOk);
+  ASSERT_EQ(redis_db->RenameKey("user:1", "order:user:1"), DbStatus::kOk);
+  EXPECT_EQ(redis_db->PrefixStats().keys, 100);
+
+  std::vector<std::string> keys;
+  const auto collect = [&keys](std::string_view key) {
+    keys.emplace_back(key);
+  };
+  auto cursor = redis_db->ScanKeysWithPrefix(0, "user:", 10, collect);
+  ASSERT_TRUE(cursor.has_value());
+  ASSERT_TRUE(PrefixIndex::IsCursor(*cursor));
+  EXPECT_EQ(redis_db->ScanKeysWithPrefix(*cursor, "order:", 10, collect),
+            std::nullopt);
+  // Keys added behind or ahead of the cursor do not disturb the scan.
+  ASSERT_EQ(redis_db->SetKey("user:00", RedisObject::CreateWithString("v"), 0),
+            DbStatus::kOk);
+  ASSERT_EQ(redis_db->SetKey("user:999", RedisObject::CreateWithString("v"), 0),
+            DbStatus::kOk);
+  while (*cursor != 0) {
+    cursor = redis_db->ScanKeysWithPrefix(*cursor, "user:", 10, collect);
+    ASSERT_TRUE(cursor.has_value());
+  }
+  EXPECT_EQ(redis_db->ScanKeysWithPrefix(PrefixIndex::kCursorTag | 12345,
+                                         "user:", 10, collect),
+            std::nullopt);
+
+  EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+  EXPECT_EQ(std::adjacent_find(keys.begin(), keys.end()), keys.end());
+  EXPECT_EQ(std::count(keys.begin(), keys.end(), "user:expired"), 0);
+  EXPECT_EQ(std::count(keys.begin(), keys.end(), "user:1"), 0);
+  EXPECT_EQ(std::count(keys.begin(), keys.end(), "user:999"), 1);
+  for (int index = 2; index < 50; ++index) {
+    EXPECT_EQ(std::count(keys.begin(), keys.end(),
+                         "user:" + std::to_string(index)),
+              1)
+        << index;
+  }
+
+  // A cursor resumes from the same key each time it is used, and ages out
+  // only after kMaxCursors newer cursors.
+  const auto ignore = [](std::string_view /*key*/) {};
+  const auto first = redis_db->ScanKeysWithPrefix(0, "user:", 5, ignore);
+  ASSERT_TRUE(first.has_value());
+  std::vector<std::string> retried[2];
+  for (auto& batch : retried) {
+    const auto next = redis_db->ScanKeysWithPrefix(
+        *first, "user:", 5,
+        [&batch](std::string_view key) { batch.emplace_back(key); });
+    ASSERT_TRUE(next.has_value());
+    EXPECT_NE(*next, 0);
+  }
+  EXPECT_EQ(retried[0].size(), 5);
+  EXPECT_EQ(retried[0], retried[1]);
+  for (size_t index = 1; index < PrefixIndex::kMaxCursors; ++index) {
+    ASSERT_TRUE(
+        redis_db->ScanKeysWithPrefix(0, "user:", 1, ignore).has_value());
+  }
+  EXPECT_EQ(redis_db->ScanKeysWithPrefix(*first, "user:", 5, ignore),
+            std::nullopt);
+
+  const auto stats = redis_db->PrefixStats();
+  EXPECT_TRUE(stats.enabled);
+  EXPECT_GT(stats.memory_bytes, 0);
+  redis_db->Flush();
+  EXPECT_EQ(redis_db->PrefixStats().keys, 0);
+  EXPECT_FALSE(RedisDb::Create()->PrefixStats().enabled);
+}
+
+TEST(RedisDbTest, ResizesTablesAfterMassDelete) {
+  auto redis_db = RedisDb::Create();
+  for (int index = 0; index < 2048; ++index) {
+    const std::string key = "key:" + std::to_string(index);
+    ASSERT_EQ(redis_db->SetKey(key, RedisObject::CreateWithString("v"),
+                               utils::NowInMilliseconds() + 60000),
+              DbStatus::kOk);
+  }
+  const auto before = redis_db->KeyspaceTableStats();
+  EXPECT_GE(before.buckets, 1024);
+  for (int index = 8; index < 2048; ++index) {
+    ASSERT_EQ(redis_db->DeleteKey("key:" + std::to_string(index)),
+              DbStatus::kOk);
+  }
+  do {
+    redis_db->ActiveRehash(1000);
+  } while (redis_db->KeyspaceTableStats().rehashing);
+  EXPECT_FALSE(redis_db->ResizeTablesIfNeeded(100));
+  EXPECT_LT(redis_db->KeyspaceTableStats().buckets, before.buckets);
+  EXPECT_EQ(redis_db->KeyspaceTableStats().keys, 8);
+  EXPECT_EQ(redis_db->KeyCount(), 8);
+  for (int index = 0; index < 8; ++index) {
+    const std::string key = "key:" + std::to_string(index);
+    EXPECT_NE(redis_db->LookupKey(key), nullptr) << key;
+    EXPECT_TRUE(redis_db->Expiration(key).has_value()) << key;
+  }
+}
+
+TEST(RedisDbTest, ExpireIndexFollowsKeysThroughResizesAndRenames) {
+  auto redis_db = RedisDb::Create();
+  const int64_t deadline = utils::NowInMilliseconds() + 60000;
+  for (int index = 0; index < 1024; ++index) {
+    // Long enough to live on the heap, and gone once SetKey() returns.
+    std::string key = "a-long-volatile-key:" + std::to_string(index);
+    ASSERT_EQ(redis_db->SetKey(key, RedisObject::CreateWithString("v"),
+                               deadline + index),
+              DbStatus::kOk);
+  }
+  for (int index = 0; index < 1024; index += 2) {
+    ASSERT_EQ(redis_db->DeleteKey("a-long-volatile-key:" +
+                                  std::to_string(index)),
+              DbStatus::kOk);
+  }
+  do {
+    redis_db->ActiveRehash(1000);
+  } while (redis_db->KeyspaceTableStats().rehashing);
+  ASSERT_EQ(redis_db->RenameKey("a-long-volatile-key:1", "renamed"),
+            DbStatus::kOk);
+  ASSERT_EQ(redis_db->ExpireKeyAt("a-long-volatile-key:3", deadline - 1),
+            DbStatus::kOk);
+  ASSERT_EQ(redis_db->SetKey("a-long-volatile-key:5",
+                             RedisObject::CreateWithString("w"), deadline - 2),
+            DbStatus::kOk);
+  ASSERT_EQ(redis_db->ExpiringKeyCount(), 512);
+
+  const auto first = redis_db->ExpireSome(2, deadline);
+  EXPECT_EQ(first.expired, 2);
+  EXPECT_EQ(redis_db->LookupKey("a-long-volatile-key:3"), nullptr);
+  EXPECT_EQ(redis_db->LookupKey("a-long-volatile-key:5"), nullptr);
+  EXPECT_EQ(redis_db->ExpireSome(1024, deadline + 1024).expired, 510);
+  EXPECT_EQ(redis_db->KeyCount(), 0);
+  EXPECT_EQ(redis_db->ExpiringKeyCount(), 0);
+}
+
+TEST(RedisDbTest, EvictsLeastRecentlyUsedKeysFirst) {
+  auto redis_db = RedisDb::Create();
+  redis_db->SetEvictionPolicy(EvictionPolicy::kAllKeysLru);
+  constexpr int kKeys = 1000;
+  constexpr int kEvictions = 100;
+  constexpr uint32_t kDaySeconds = 24 * 60 * 60;
+  const uint32_t clock = LruClock(utils::CachedNowInMilliseconds());
+  for (int index = 0; index < kKeys; ++index) {
+    const std::string key = std::to_string(index);
+    ASSERT_EQ(redis_db->SetKey(key, RedisObject::CreateWithString("v"), 0),
+              DbStatus::kOk);
+    if (index % 2 == 0) {
+      redis_db->MutableLookupKey(key)->SetLru(clock - kDaySeconds);
+    }
+  }
+
+  // The pool keeps the best of every sample, so nearly every eviction finds
+  // one of the idle keys.
+  int idle_evictions = 0;
+  for (int eviction = 0; eviction < kEvictions; ++eviction) {
+    const auto key = redis_db->EvictKey();
+    ASSERT_TRUE(key.has_value());
+    EXPECT_EQ(redis_db->LookupKey(*key), nullptr);
+    idle_evictions += std::stoi(*key) % 2 == 0 ? 1 : 0;
+  }
+  EXPECT_GE(idle_evictions, kEvictions * 9 / 10);
+  EXPECT_EQ(redis_db->KeyCount(), kKeys - kEvictions);
+  EXPECT_EQ(redis_db->EvictStats().evicted_keys, kEvictions);
+}
+
+TEST(RedisDbTest, EvictsOnlyWhatThePolicyAllows) {
+  auto redis_db = RedisDb::Create();
+  const int64_t now = utils::NowInMilliseconds();
+  ASSERT_EQ(redis_db->SetKey("persistent", RedisObject::CreateWithString("v"),
+                             0),
+            DbStatus::kOk);
+  ASSERT_EQ(redis_db->SetKey("late", RedisObject::CreateWithString("v"),
+                             now + 60000),
+            DbStatus::kOk);
+  ASSERT_EQ(redis_db->SetKey("soon", RedisObject::CreateWithString("v"),
+                             now + 30000),
+            DbStatus::kOk);
+  EXPECT_EQ(redis_db->EvictKey(), std::nullopt);
+
+  redis_db->SetEvictionPolicy(EvictionPolicy::kVolatileTtl);
+  EXPECT_EQ(redis_db->EvictKey(), std::optional<std::string>("soon"));
+  EXPECT_EQ(redis_db->ExpiringKeyCount(), 1);
+
+  redis_db->SetEvictionPolicy(EvictionPolicy::kVolatileLru);
+  EXPECT_EQ(redis_db->EvictKey(), std::optional<std::string>("late"));
+  EXPECT_EQ(redis_db->EvictKey(), std::nullopt);
+
+  redis_db->SetEvictionPolicy(EvictionPolicy::kAllKeysRandom);
+  EXPECT_EQ(redis_db->EvictKey(), std::optional<std::string>("persistent"));
+  EXPECT_EQ(redis_db->EvictKey(), std::nullopt);
+  EXPECT_EQ(redis_db->EvictStats().evicted_keys, 3);
+}
+
+TEST(RedisDbTest, LookupsRecordAccessesForEviction) {
+  auto redis_db = RedisDb::Create();
+  redis_db->SetEvictionPolicy(EvictionPolicy::kAllKeysLru);
+  ASSERT_EQ(redis_db->SetKey("counter", RedisObject::CreateWithInteger(1), 0),
+            DbStatus::kOk);
+  RedisObject* const object = redis_db->MutableLookupKey("counter");
+  ASSERT_NE(object, nullptr);
+  // Keys ranked by access cannot share one integer object.
+  EXPECT_FALSE(object->IsShared());
+  object->SetLru(0);
+  redis_db->LookupKey("counter");
+  EXPECT_EQ(object->Lru(), LruClock(utils::CachedNowInMilliseconds()));
+
+  redis_db->SetEvictionPolicy(EvictionPolicy::kAllKeysLfu);
+  ASSERT_EQ(redis_db->SetKey("hot", RedisObject::CreateWithString("v"), 0),
+            DbStatus::kOk);
+  const int64_t now = utils::CachedNowInMilliseconds();
+  for (int access = 0; access < 1000; ++access) {
+    redis_db->LookupKey("hot");
+  }
+  EXPECT_GT(LfuCounter(redis_db->LookupKey("hot")->Lru(), now),
+            kLfuInitialCounter);
+}
+
+TEST(RedisDbTest, ReportsMemoryUsageAndBreakdown) {
+  auto redis_db = RedisDb::Create();
+  EXPECT_EQ(redis_db->MemoryUsage("missing", 0), std::nullopt);
+  const std::string value(1000, 'x');
+  ASSERT_EQ(redis_db->SetKey("raw", RedisObject::CreateWithString(value), 0),
+            DbStatus::kOk);
+  ASSERT_EQ(redis_db->SetKey("embedded", RedisObject::CreateWithString("v"),
+                             utils::NowInMilliseconds() + 60'000),
+            DbStatus::kOk);
+  const auto usage = redis_db->MemoryUsage("raw", 0);
+  ASSERT_TRUE(usage.has_value());
+  EXPECT_GT(*usage, value.size());
+  EXPECT_LT(*usage, *redis_db->MemoryUsage("embedded", 0) + 2 * value.size());
+
+  const auto memory = redis_db->MemoryBreakdown();
+  EXPECT_GT(memory.keyspace_bytes, 0);
+  EXPECT_GT(memory.expires_bytes, 0);
+  EXPECT_EQ(memory.prefix_index_bytes, 0);
+  ASSERT_EQ(memory.encodings.size(), 2);
+  EXPECT_EQ(memory.encodings[0].encoding, "embstr");
+  EXPECT_EQ(memory.encodings[0].keys, 1);
+  EXPECT_EQ(memory.encodings[1].encoding, "raw");
+  EXPECT_GT(memory.encodings[1].bytes, value.size());
+}
+
+TEST(RedisDbTest, ActiveDefragCompletesPassesAndKeepsValues) {
+  auto redis_db = RedisDb::Create();
+  constexpr int kKeys = 200;
+  for (int index = 0; index < kKeys; ++index) {
+    const std::string value(100 + index, 'a' + index % 26);
+    ASSERT_EQ(redis_db->SetKey("key:" + std::to_string(index),
+                               RedisObject::CreateWithString(value), 0),
+              DbStatus::kOk);
+  }
+  size_t cursor = 0;
+  do {
+    cursor = redis_db->ActiveDefrag(cursor, 1'000'000);
+  } while (cursor != 0);
+  const auto& stats = redis_db->DefragStats();
+  EXPECT_EQ(stats.passes, 1);
+  EXPECT_GE(stats.cycles, 1);
+  EXPECT_GE(stats.key_hits + stats.key_misses, kKeys);
+  EXPECT_GE(stats.hits + stats.misses, kKeys);
+  for (int index = 0; index < kKeys; ++index) {
+    const auto* object = redis_db->LookupKey("key:" + std::to_string(index));
+    ASSERT_NE(object, nullptr);
+    EXPECT_EQ(object->String(), std::string(100 + index, 'a' + index % 26));
+  }
+}
+
+TEST(RedisDbTest, ReportsHotKeysFromSketchAndSamples) {
+  auto redis_db = RedisDb::Create();
+  EXPECT_FALSE(redis_db->TracksHotKeys());
+  redis_db->LookupKey("key:7");
+  redis_db->SetHotKeySampleRate(1);
+  for (int index = 0; index < 100; ++index) {
+    ASSERT_EQ(redis_db->SetKey("key:" + std::to_string(index),
+                               RedisObject::CreateWithString("value"), 0),
+              DbStatus::kOk);
+  }
+  for (int access = 0; access < 500; ++access) {
+    redis_db->LookupKey("key:99");
+    redis_db->LookupKey("key:7");
+  }
+  ASSERT_EQ(redis_db->DeleteKey("key:99"), DbStatus::kOk);
+  for (int access = 0; access < 200; ++access) {
+    redis_db->LookupKey("key:42");
+  }
+  const auto hot_keys = redis_db->HotKeys(2);
+  ASSERT_EQ(hot_keys.size(), 2);
+  // Deleted keys are left out.
+  EXPECT_EQ(hot_keys[0].key, "key:7");
+  EXPECT_GE(hot_keys[0].hits, 500);
+  EXPECT_EQ(hot_keys[1].key, "key:42");
+  EXPECT_TRUE(redis_db->SampleHotKeys(2, 100).empty());
+
+  redis_db->SetEvictionPolicy(EvictionPolicy::kAllKeysLfu);
+  ASSERT_EQ(redis_db->SetKey("cold", RedisObject::CreateWithString("v"), 0),
+            DbStatus::kOk);
+  ASSERT_EQ(redis_db->SetKey("warm", RedisObject::CreateWithString("v"), 0),
+            DbStatus::kOk);
+  for (int access = 0; access < 10000; ++access) {
+    redis_db->LookupKey("warm");
+  }
+  const auto sampled = redis_db->SampleHotKeys(1, redis_db->KeyCount());
+  ASSERT_EQ(sampled.size(), 1);
+  EXPECT_EQ(sampled[0].key, "warm");
+  EXPECT_GT(sampled[0].hits, kLfuInitialCounter);
+
+  redis_db->Flush();
+  EXPECT_TRUE(redis_db->HotKeys(10).empty());
+}
+
+TEST(RedisDbTest, SampledHotKeysScaleCountsByTheRate) {
+  auto redis_db = RedisDb::Create();
+  redis_db->SetHotKeySampleRate(4);
+  ASSERT_TRUE(redis_db->TracksHotKeys());
+  ASSERT_EQ(redis_db->SetKey("hot", RedisObject::CreateWithString("v"), 0),
+            DbStatus::kOk);
+  // Together with the write, every fourth of these accesses is recorded.
+  for (int access = 0; access < 399; ++access) {
+    redis_db->LookupKey("hot");
+  }
+  const auto hot_keys = redis_db->HotKeys(1);
+  ASSERT_EQ(hot_keys.size(), 1);
+  EXPECT_EQ(hot_keys[0].key, "hot");
+  EXPECT_EQ(hot_keys[0].hits, 400);
+
+  redis_db->SetHotKeySampleRate(0);
+  EXPECT_FALSE(redis_db->TracksHotKeys());
+  EXPECT_TRUE(redis_db->HotKeys(1).empty());
+}
 }  // namespace redis_simple::db
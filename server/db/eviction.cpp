@@ -0,0 +1,130 @@
+#include "server/db/eviction.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "memory/random.h"
+#include "server/db/redis_obj.h"
+#include "utils/string_utils.h"
+
+namespace redis_simple::db {
+namespace {
+struct PolicyName {
+  EvictionPolicy policy;
+  std::string_view name;
+};
+
+constexpr std::array kPolicyNames = {
+    PolicyName{EvictionPolicy::kNoEviction, "noeviction"},
+    PolicyName{EvictionPolicy::kAllKeysLru, "allkeys-lru"},
+    PolicyName{EvictionPolicy::kAllKeysLfu, "allkeys-lfu"},
+    PolicyName{EvictionPolicy::kAllKeysRandom, "allkeys-random"},
+    PolicyName{EvictionPolicy::kVolatileLru, "volatile-lru"},
+    PolicyName{EvictionPolicy::kVolatileTtl, "volatile-ttl"},
+};
+
+constexpr int64_t kMillisecondsPerSecond = 1000;
+constexpr int64_t kMillisecondsPerMinute = 60 * kMillisecondsPerSecond;
+constexpr uint32_t kLfuCounterBits = 8;
+constexpr uint32_t kLfuCounterMask = (1U << kLfuCounterBits) - 1;
+constexpr uint32_t kLfuMinuteMask = RedisObject::kMaxLru >> kLfuCounterBits;
+
+uint32_t LfuMinute(int64_t now_ms) {
+  return static_cast<uint32_t>(now_ms / kMillisecondsPerMinute) &
+         kLfuMinuteMask;
+}
+
+uint32_t LfuBits(uint32_t minute, uint32_t counter) {
+  return (minute << kLfuCounterBits) | counter;
+}
+
+// Minutes between two LfuMinute() stamps, allowing for one wrap.
+uint32_t ElapsedMinutes(uint32_t then, uint32_t now) {
+  return now >= then ? now - then : kLfuMinuteMask - then + now + 1;
+}
+}  // namespace
+
+std::optional<EvictionPolicy> ParseEvictionPolicy(std::string_view name) {
+  for (const auto& entry : kPolicyNames) {
+    if (utils::EqualsIgnoreCase(name, entry.name)) {
+      return entry.policy;
+    }
+  }
+  return std::nullopt;
+}
+
+std::string_view EvictionPolicyName(EvictionPolicy policy) {
+  for (const auto& entry : kPolicyNames) {
+    if (entry.policy == policy) {
+      return entry.name;
+    }
+  }
+  return "unknown";
+}
+
+uint32_t LruClock(int64_t now_ms) {
+  return static_cast<uint32_t>(now_ms / kMillisecondsPerSecond) &
+         RedisObject::kMaxLru;
+}
+
+uint32_t IdleSeconds(uint32_t lru, uint32_t clock) {
+  return clock >= lru ? clock - lru : RedisObject::kMaxLru - lru + clock + 1;
+}
+
+uint32_t LfuInitial(int64_t now_ms) {
+  return LfuBits(LfuMinute(now_ms), kLfuInitialCounter);
+}
+
+uint32_t LfuCounter(uint32_t bits, int64_t now_ms) {
+  const uint32_t counter = bits & kLfuCounterMask;
+  const uint32_t elapsed =
+      ElapsedMinutes(bits >> kLfuCounterBits, LfuMinute(now_ms));
+  return elapsed >= counter ? 0 : counter - elapsed;
+}
+
+uint32_t LfuTouch(uint32_t bits, int64_t now_ms) {
+  uint32_t counter = LfuCounter(bits, now_ms);
+  if (counter < kLfuCounterMask) {
+    const uint32_t base =
+        counter > kLfuInitialCounter ? counter - kLfuInitialCounter : 0;
+    if (in_memory::RandomIndex(size_t{base} * kLfuLogFactor + 1) == 0) {
+      ++counter;
+    }
+  }
+  return LfuBits(LfuMinute(now_ms), counter);
+}
+
+void EvictionPool::Offer(std::string_view key, uint64_t score) {
+  if (candidates_.size() == kSize && score <= candidates_.front().score) {
+    return;
+  }
+  // A key sampled again replaces its older score.
+  const auto existing =
+      std::find_if(candidates_.begin(), candidates_.end(),
+                   [key](const Candidate& c) { return c.key == key; });
+  if (existing != candidates_.end()) {
+    candidates_.erase(existing);
+  } else if (candidates_.size() == kSize) {
+    candidates_.erase(candidates_.begin());
+  }
+  const auto position = std::upper_bound(
+      candidates_.begin(), candidates_.end(), score,
+      [](uint64_t value, const Candidate& c) { return value < c.score; });
+  candidates_.insert(position, Candidate{score, std::string(key)});
+}
+
+std::optional<std::string> EvictionPool::Pop() {
+  if (candidates_.empty()) {
+    return std::nullopt;
+  }
+  std::string key = std::move(candidates_.back().key);
+  candidates_.pop_back();
+  return key;
+}
+}  // namespace redis_simple::db
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace redis_simple::db {
+enum class EvictionPolicy : uint8_t {
+  // Reject commands that may add data once memory is over the limit.
+  kNoEviction,
+  // Evict the least recently used key.
+  kAllKeysLru,
+  // Evict the least frequently used key.
+  kAllKeysLfu,
+  // Evict a key chosen uniformly at random.
+  kAllKeysRandom,
+  // Evict the least recently used key among those with a TTL.
+  kVolatileLru,
+  // Evict the key with the nearest expiration.
+  kVolatileTtl,
+};
+
+std::optional<EvictionPolicy> ParseEvictionPolicy(std::string_view name);
+std::string_view EvictionPolicyName(EvictionPolicy policy);
+// Whether objects carry an access frequency rather than an access time.
+constexpr bool TracksFrequency(EvictionPolicy policy) {
+  return policy == EvictionPolicy::kAllKeysLfu;
+}
+// Whether the policy ranks keys by the access bits of their own object, so
+// keys cannot share one.
+constexpr bool RanksByAccess(EvictionPolicy policy) {
+  return policy == EvictionPolicy::kAllKeysLru ||
+         policy == EvictionPolicy::kAllKeysLfu ||
+         policy == EvictionPolicy::kVolatileLru;
+}
+
+/*
+ * Access bits kept in the 24 LRU bits of each RedisObject. Under LRU policies
+ * they hold the access time in seconds, wrapping about every 194 days. Under
+ * LFU they hold the minute of the last decay in the upper 16 bits and an 8-bit
+ * logarithmic access counter in the lower 8: each access increments the
+ * counter with probability 1 / ((counter - kLfuInitialCounter) * kLfuLogFactor
+ * + 1), and it loses one for every minute without an access, so it saturates
+ * only after about a million hits and old popularity fades.
+ */
+inline constexpr uint32_t kLfuInitialCounter = 5;
+inline constexpr uint32_t kLfuLogFactor = 10;
+uint32_t LruClock(int64_t now_ms);
+// Seconds since lru was stamped by LruClock() at clock.
+uint32_t IdleSeconds(uint32_t lru, uint32_t clock);
+// Access bits for a new key under LFU.
+uint32_t LfuInitial(int64_t now_ms);
+// Access bits after one more access at now_ms.
+uint32_t LfuTouch(uint32_t bits, int64_t now_ms);
+// The counter in bits after decaying it to now_ms.
+uint32_t LfuCounter(uint32_t bits, int64_t now_ms);
+
+/*
+ * The best eviction candidates seen so far, kept across evictions so each
+ * eviction samples only a few keys yet still picks from many. Higher scores are
+ * evicted first. The pool holds names only; the caller must check that a key
+ * it pops still exists.
+ */
+class EvictionPool {
+ public:
+  static constexpr size_t kSize = 16;
+  // Keep key if the pool has room or it beats the lowest-scoring candidate.
+  void Offer(std::string_view key, uint64_t score);
+  // Remove and return the highest-scoring candidate.
+  std::optional<std::string> Pop();
+  size_t Size() const { return candidates_.size(); }
+  void Clear() { candidates_.clear(); }
+
+ private:
+  struct Candidate {
+    uint64_t score;
+    std::string key;
+  };
+  // Ordered by ascending score.
+  std::vector<Candidate> candidates_;
+};
+}  // namespace redis_simple::db
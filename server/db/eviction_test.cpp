@@ -0,0 +1,71 @@
+#include "server/db/eviction.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "server/db/redis_obj.h"
+
+namespace redis_simple::db {
+namespace {
+constexpr int64_t kMinuteMilliseconds = 60 * 1000;
+}  // namespace
+
+TEST(EvictionTest, ParsesPolicyNames) {
+  for (const auto policy :
+       {EvictionPolicy::kNoEviction, EvictionPolicy::kAllKeysLru,
+        EvictionPolicy::kAllKeysLfu, EvictionPolicy::kAllKeysRandom,
+        EvictionPolicy::kVolatileLru, EvictionPolicy::kVolatileTtl}) {
+    EXPECT_EQ(ParseEvictionPolicy(EvictionPolicyName(policy)), policy);
+  }
+  EXPECT_EQ(ParseEvictionPolicy("ALLKEYS-LRU"), EvictionPolicy::kAllKeysLru);
+  EXPECT_EQ(ParseEvictionPolicy("volatile-lfu"), std::nullopt);
+  EXPECT_EQ(ParseEvictionPolicy(""), std::nullopt);
+}
+
+TEST(EvictionTest, MeasuresIdleTimeAcrossClockWrap) {
+  const uint32_t clock = LruClock(int64_t{5000} * 1000);
+  EXPECT_EQ(IdleSeconds(LruClock(int64_t{4000} * 1000), clock), 1000);
+  EXPECT_EQ(IdleSeconds(clock, clock), 0);
+  EXPECT_EQ(IdleSeconds(RedisObject::kMaxLru - 9, 10), 20);
+}
+
+TEST(EvictionTest, LfuCounterGrowsLogarithmicallyAndDecays) {
+  const int64_t now = 1000 * kMinuteMilliseconds;
+  uint32_t bits = LfuInitial(now);
+  EXPECT_EQ(LfuCounter(bits, now), kLfuInitialCounter);
+  // The first access past the initial value always counts.
+  bits = LfuTouch(bits, now);
+  EXPECT_EQ(LfuCounter(bits, now), kLfuInitialCounter + 1);
+  for (int access = 0; access < 10000; ++access) {
+    bits = LfuTouch(bits, now);
+  }
+  const uint32_t counter = LfuCounter(bits, now);
+  EXPECT_GT(counter, kLfuInitialCounter + 10);
+  EXPECT_LT(counter, 255);
+
+  EXPECT_EQ(LfuCounter(bits, now + 3 * kMinuteMilliseconds), counter - 3);
+  EXPECT_EQ(LfuCounter(bits, now + 1000 * kMinuteMilliseconds), 0);
+}
+
+TEST(EvictionTest, PoolKeepsTheHighestScores) {
+  EvictionPool pool;
+  for (uint64_t score = 0; score < 2 * EvictionPool::kSize; ++score) {
+    pool.Offer("key" + std::to_string(score), score);
+  }
+  EXPECT_EQ(pool.Size(), EvictionPool::kSize);
+  pool.Offer("low", 0);
+  EXPECT_EQ(pool.Size(), EvictionPool::kSize);
+
+  // A key sampled again takes its new score instead of a second slot.
+  pool.Offer("key20", 100);
+  EXPECT_EQ(pool.Size(), EvictionPool::kSize);
+  EXPECT_EQ(pool.Pop(), std::optional<std::string>("key20"));
+  EXPECT_EQ(pool.Pop(), std::optional<std::string>("key31"));
+
+  pool.Clear();
+  EXPECT_EQ(pool.Pop(), std::nullopt);
+}
+}  // namespace redis_simple::db
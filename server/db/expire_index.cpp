@@ -0,0 +1,75 @@
+#include "server/db/expire_index.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "memory/used_memory.h"
+
+namespace redis_simple::db {
+void ExpireIndex::Add(std::string_view key, int64_t deadline) {
+  entries_.insert(Entry{deadline, Key(key)});
+}
+
+bool ExpireIndex::Remove(std::string_view key, int64_t deadline) {
+  const auto it = entries_.find(Position(deadline, key));
+  if (it == entries_.end()) {
+    return false;
+  }
+  entries_.erase(it);
+  return true;
+}
+
+size_t ExpireIndex::PopDue(int64_t now, size_t max_keys,
+                           std::vector<std::string>* const keys) {
+  size_t popped = 0;
+  while (popped < max_keys && !entries_.empty() &&
+         entries_.begin()->deadline <= now) {
+    keys->emplace_back(
+        std::move(entries_.extract(entries_.begin()).value().key));
+    ++popped;
+  }
+  return popped;
+}
+
+size_t ExpireIndex::CountDue(int64_t now, size_t limit) const {
+  size_t count = 0;
+  for (auto it = entries_.begin();
+       count < limit && it != entries_.end() && it->deadline <= now; ++it) {
+    ++count;
+  }
+  return count;
+}
+
+/*
+ * Tree nodes are not visible through std::set, so each is taken to be the
+ * entry plus a color word and three links. Viewed key names belong to the
+ * keyspace and are not counted.
+ */
+size_t ExpireIndex::Bytes(size_t samples) const {
+  constexpr size_t kNodeBytes = sizeof(Entry) + 4 * sizeof(void*);
+  const size_t limit =
+      samples == 0 ? entries_.size() : std::min(samples, entries_.size());
+  size_t measured = 0;
+  size_t key_bytes = 0;
+  for (auto it = entries_.begin(); measured < limit; ++it, ++measured) {
+    key_bytes += in_memory::OwnedBytes(it->key);
+  }
+  return entries_.size() * kNodeBytes +
+         (measured == 0 ? 0 : key_bytes * entries_.size() / measured);
+}
+
+std::optional<int64_t> ExpireIndex::NextDeadline() const {
+  if (entries_.empty()) {
+    return std::nullopt;
+  }
+  return entries_.begin()->deadline;
+}
+
+std::optional<std::string_view> ExpireIndex::NextKey() const {
+  if (entries_.empty()) {
+    return std::nullopt;
+  }
+  return entries_.begin()->key;
+}
+}  // namespace redis_simple::db
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "memory/hash_table.h"
+
+namespace redis_simple::db {
+/*
+ * Volatile keys ordered by deadline, so active expiration pops exactly the
+ * keys that are due instead of sampling ones that are not. The deadline is
+ * owned by the key's RedisObject; the index keeps a copy for ordering and must
+ * be told whenever a key gains, changes or loses its TTL.
+ *
+ * When keyspace keys never move (in_memory::kHashTableKeysAreStable), the index
+ * holds views of the names stored in the keyspace rather than copies. Add()
+ * must then be given the stored name, and a key must be removed from the index
+ * before its keyspace entry is freed.
+ */
+class ExpireIndex {
+ public:
+  void Add(std::string_view key, int64_t deadline);
+  bool Remove(std::string_view key, int64_t deadline);
+  // Remove up to max_keys keys whose deadline is at or before now, earliest
+  // first, appending them to keys.
+  size_t PopDue(int64_t now, size_t max_keys, std::vector<std::string>* keys);
+  std::optional<int64_t> NextDeadline() const;
+  // The key with the earliest deadline, valid until the index changes.
+  std::optional<std::string_view> NextKey() const;
+  // Number of keys due at now, counting no further than limit.
+  size_t CountDue(int64_t now, size_t limit) const;
+  size_t Size() const { return entries_.size(); }
+  // Approximate heap bytes of the index. With samples, only that many key
+  // names are measured and the rest are extrapolated.
+  size_t Bytes(size_t samples = 0) const;
+  void Clear() { entries_.clear(); }
+
+ private:
+  using Key = std::conditional_t<in_memory::kHashTableKeysAreStable,
+                                 std::string_view, std::string>;
+  struct Entry {
+    int64_t deadline;
+    Key key;
+  };
+  using Position = std::pair<int64_t, std::string_view>;
+  // Orders entries by deadline, then key, and finds them by Position without
+  // copying the key.
+  struct EntryLess {
+    using is_transparent = void;
+    static Position Of(const Entry& entry) {
+      return {entry.deadline, entry.key};
+    }
+    static const Position& Of(const Position& position) { return position; }
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const {
+      return Of(a) < Of(b);
+    }
+  };
+  std::set<Entry, EntryLess> entries_;
+};
+}  // namespace redis_simple::db
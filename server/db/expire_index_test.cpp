@@ -0,0 +1,48 @@
+#include "server/db/expire_index.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace redis_simple::db {
+TEST(ExpireIndexTest, PopsDueKeysInDeadlineOrder) {
+  ExpireIndex index;
+  index.Add("late", 300);
+  index.Add("early", 100);
+  index.Add("tie-b", 200);
+  index.Add("tie-a", 200);
+  ASSERT_EQ(index.Size(), 4);
+  EXPECT_EQ(index.NextDeadline(), std::optional<int64_t>(100));
+  EXPECT_EQ(index.NextKey(), std::optional<std::string_view>("early"));
+  EXPECT_EQ(index.CountDue(200, 10), 3);
+  EXPECT_EQ(index.CountDue(200, 2), 2);
+
+  std::vector<std::string> keys;
+  EXPECT_EQ(index.PopDue(50, 10, &keys), 0);
+  EXPECT_EQ(index.PopDue(250, 2, &keys), 2);
+  EXPECT_EQ(index.PopDue(250, 10, &keys), 1);
+  EXPECT_EQ(keys, std::vector<std::string>({"early", "tie-a", "tie-b"}));
+  EXPECT_EQ(index.Size(), 1);
+  EXPECT_EQ(index.NextDeadline(), std::optional<int64_t>(300));
+}
+
+TEST(ExpireIndexTest, RemovesOnlyTheMatchingDeadline) {
+  ExpireIndex index;
+  index.Add("key", 100);
+  EXPECT_FALSE(index.Remove("key", 200));
+  EXPECT_FALSE(index.Remove("other", 100));
+  EXPECT_TRUE(index.Remove("key", 100));
+  EXPECT_EQ(index.Size(), 0);
+  EXPECT_EQ(index.NextDeadline(), std::nullopt);
+  EXPECT_EQ(index.NextKey(), std::nullopt);
+
+  index.Add("key", 100);
+  index.Clear();
+  std::vector<std::string> keys;
+  EXPECT_EQ(index.PopDue(1000, 10, &keys), 0);
+}
+}  // namespace redis_simple::db
@@ -0,0 +1,149 @@
+#include "server/db/hot_keys.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "memory/hash_function.h"
+
+namespace redis_simple::db {
+namespace {
+static_assert((HotKeySketch::kWidth & (HotKeySketch::kWidth - 1)) == 0,
+              "sketch width must be a power of two");
+// Halving more often than this clears every count anyway.
+constexpr int64_t kMaxDecayShift = 32;
+}  // namespace
+
+HotKeySketch::HotKeySketch()
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays): counter rows
+    : counters_(std::make_unique<uint32_t[]>(kDepth * kWidth)) {
+  candidates_.reserve(kCapacity);
+}
+
+void HotKeySketch::Positions(uint64_t hash, size_t* const positions) {
+  // Double hashing: row i probes low + i * high, with high odd so the rows
+  // differ for every key.
+  const uint64_t low = hash & std::numeric_limits<uint32_t>::max();
+  const uint64_t high = (hash >> 32) | 1;
+  for (size_t row = 0; row < kDepth; ++row) {
+    positions[row] = row * kWidth + ((low + row * high) & (kWidth - 1));
+  }
+}
+
+void HotKeySketch::Record(std::string_view key, uint64_t hash,
+                          int64_t now_ms, uint32_t weight) {
+  if (now_ms - last_decay_ms_ >= kDecayMilliseconds) {
+    Decay(now_ms);
+  }
+  std::array<size_t, kDepth> positions{};
+  Positions(hash, positions.data());
+  uint64_t estimate = std::numeric_limits<uint64_t>::max();
+  for (const size_t position : positions) {
+    uint32_t& counter = counters_[position];
+    counter = static_cast<uint32_t>(
+        std::min<uint64_t>(static_cast<uint64_t>(counter) + weight,
+                           std::numeric_limits<uint32_t>::max()));
+    estimate = std::min<uint64_t>(estimate, counter);
+  }
+  if (estimate > min_hits_) {
+    Offer(key, hash, estimate);
+  }
+}
+
+void HotKeySketch::Offer(std::string_view key, uint64_t hash, uint64_t hits) {
+  auto candidate = std::find_if(
+      candidates_.begin(), candidates_.end(), [hash, key](const Candidate& c) {
+        return c.hash == hash && c.key == key;
+      });
+  if (candidate != candidates_.end()) {
+    candidate->hits = hits;
+    // Estimates only grow between decays, so the minimum moves only when its
+    // own entry does.
+    if (candidates_.size() < kCapacity ||
+        static_cast<size_t>(candidate - candidates_.begin()) != min_index_) {
+      return;
+    }
+  } else if (candidates_.size() < kCapacity) {
+    candidates_.push_back(Candidate{hash, hits, std::string(key)});
+    if (candidates_.size() < kCapacity) {
+      return;
+    }
+  } else {
+    candidates_[min_index_] = Candidate{hash, hits, std::string(key)};
+  }
+  UpdateMinimum();
+}
+
+void HotKeySketch::UpdateMinimum() {
+  const auto minimum = std::min_element(
+      candidates_.begin(), candidates_.end(),
+      [](const Candidate& a, const Candidate& b) { return a.hits < b.hits; });
+  min_index_ = static_cast<size_t>(minimum - candidates_.begin());
+  min_hits_ = minimum->hits;
+}
+
+void HotKeySketch::Decay(int64_t now_ms) {
+  const int64_t shift = std::min(
+      (now_ms - last_decay_ms_) / kDecayMilliseconds, kMaxDecayShift);
+  last_decay_ms_ = now_ms;
+  for (size_t position = 0; position < kDepth * kWidth; ++position) {
+    counters_[position] = static_cast<uint32_t>(
+        static_cast<uint64_t>(counters_[position]) >> shift);
+  }
+  for (auto& candidate : candidates_) {
+    candidate.hits >>= shift;
+  }
+  candidates_.erase(
+      std::remove_if(candidates_.begin(), candidates_.end(),
+                     [](const Candidate& c) { return c.hits == 0; }),
+      candidates_.end());
+  if (candidates_.size() < kCapacity) {
+    min_hits_ = 0;
+  } else {
+    UpdateMinimum();
+  }
+}
+
+std::vector<HotKey> HotKeySketch::Top(size_t count) const {
+  std::vector<const Candidate*> ranked;
+  ranked.reserve(candidates_.size());
+  for (const auto& candidate : candidates_) {
+    ranked.push_back(&candidate);
+  }
+  count = std::min(count, ranked.size());
+  std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                    [](const Candidate* a, const Candidate* b) {
+                      return a->hits > b->hits ||
+                             (a->hits == b->hits && a->key < b->key);
+                    });
+  std::vector<HotKey> top;
+  top.reserve(count);
+  for (size_t index = 0; index < count; ++index) {
+    top.push_back(HotKey{ranked[index]->key, ranked[index]->hits});
+  }
+  return top;
+}
+
+uint64_t HotKeySketch::Estimate(std::string_view key) const {
+  std::array<size_t, kDepth> positions{};
+  Positions(in_memory::HashString(key), positions.data());
+  uint64_t estimate = std::numeric_limits<uint64_t>::max();
+  for (const size_t position : positions) {
+    estimate = std::min<uint64_t>(estimate, counters_[position]);
+  }
+  return estimate;
+}
+
+void HotKeySketch::Clear() {
+  std::fill(counters_.get(), counters_.get() + kDepth * kWidth, 0);
+  candidates_.clear();
+  min_hits_ = 0;
+  min_index_ = 0;
+}
+}  // namespace redis_simple::db
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "memory/hash_function.h"
+
+namespace redis_simple::db {
+struct HotKey {
+  std::string key;
+  // Estimated accesses, halved every kDecayMilliseconds.
+  uint64_t hits{};
+};
+
+/*
+ * Bounded heavy-hitters tracker for key accesses. A count-min sketch of
+ * kDepth rows of kWidth counters estimates the accesses of any key, never
+ * below the true count, and the kCapacity keys with the highest estimates are
+ * kept by name. An access costs kDepth counter increments, with the hash
+ * supplied by the caller; the candidate list is searched only when the
+ * estimate beats its smallest entry, and that minimum is recomputed only when
+ * the entry holding it changes. All counts are halved every kDecayMilliseconds
+ * so keys that cool down drop out.
+ */
+class HotKeySketch {
+ public:
+  static constexpr size_t kDepth = 4;
+  static constexpr size_t kWidth = 1024;
+  static constexpr size_t kCapacity = 32;
+  static constexpr int64_t kDecayMilliseconds = 60 * 1000;
+  HotKeySketch();
+  // Count weight accesses to key. hash must be in_memory::HashString(key);
+  // callers that record one access in n pass n as weight.
+  void Record(std::string_view key, uint64_t hash, int64_t now_ms,
+              uint32_t weight);
+  void Record(std::string_view key, int64_t now_ms) {
+    Record(key, in_memory::HashString(key), now_ms, 1);
+  }
+  // Up to count tracked keys, most accessed first. Keys may no longer exist.
+  std::vector<HotKey> Top(size_t count) const;
+  // The estimated accesses of key.
+  uint64_t Estimate(std::string_view key) const;
+  void Clear();
+
+ private:
+  struct Candidate {
+    uint64_t hash;
+    uint64_t hits;
+    std::string key;
+  };
+  // Counter indexes of key in each row, from one 64-bit hash.
+  static void Positions(uint64_t hash, size_t* positions);
+  void Decay(int64_t now_ms);
+  void Offer(std::string_view key, uint64_t hash, uint64_t hits);
+  // Find the smallest candidate of a full list.
+  void UpdateMinimum();
+  std::unique_ptr<uint32_t[]> counters_;
+  std::vector<Candidate> candidates_;
+  // Smallest hits among candidates_ once it is full, else 0, and the index of
+  // the candidate holding it.
+  uint64_t min_hits_{};
+  size_t min_index_{};
+  int64_t last_decay_ms_{};
+};
+}  // namespace redis_simple::db
@@ -0,0 +1,76 @@
+#include "server/db/hot_keys.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace redis_simple::db {
+TEST(HotKeySketchTest, RanksHeavyHittersAmongManyKeys) {
+  HotKeySketch sketch;
+  constexpr int64_t kNow = 1000;
+  for (int round = 0; round < 100; ++round) {
+    for (int index = 0; index < 1000; ++index) {
+      sketch.Record("cold:" + std::to_string(index), kNow);
+    }
+    for (int hit = 0; hit < 50; ++hit) {
+      sketch.Record("hot:a", kNow);
+    }
+    for (int hit = 0; hit < 20; ++hit) {
+      sketch.Record("hot:b", kNow);
+    }
+  }
+  const auto top = sketch.Top(2);
+  ASSERT_EQ(top.size(), 2);
+  EXPECT_EQ(top[0].key, "hot:a");
+  EXPECT_GE(top[0].hits, 5000);
+  EXPECT_EQ(top[1].key, "hot:b");
+  EXPECT_GE(top[1].hits, 2000);
+  EXPECT_LE(sketch.Top(HotKeySketch::kCapacity * 2).size(),
+            HotKeySketch::kCapacity);
+  EXPECT_GE(sketch.Estimate("cold:1"), 100);
+}
+
+TEST(HotKeySketchTest, WeightedRecordsReplaceTheSmallestCandidate) {
+  HotKeySketch sketch;
+  constexpr int64_t kNow = 1000;
+  for (size_t index = 0; index < HotKeySketch::kCapacity; ++index) {
+    const std::string key = "key:" + std::to_string(index);
+    sketch.Record(key, in_memory::HashString(key), kNow,
+                  static_cast<uint32_t>(10 + index));
+  }
+  sketch.Record("key:0", in_memory::HashString("key:0"), kNow, 100);
+  // key:1 now holds the smallest count and is the one pushed out.
+  sketch.Record("new", in_memory::HashString("new"), kNow, 20);
+  const auto all = sketch.Top(HotKeySketch::kCapacity);
+  ASSERT_EQ(all.size(), HotKeySketch::kCapacity);
+  EXPECT_EQ(all[0].key, "key:0");
+  EXPECT_EQ(all[0].hits, 110);
+  EXPECT_EQ(sketch.Estimate("new"), 20);
+  for (const auto& hot_key : all) {
+    EXPECT_NE(hot_key.key, "key:1");
+  }
+  EXPECT_NE(std::find_if(all.begin(), all.end(),
+                         [](const HotKey& k) { return k.key == "new"; }),
+            all.end());
+}
+
+TEST(HotKeySketchTest, DecaysIdleCounts) {
+  HotKeySketch sketch;
+  constexpr int64_t kNow = 1000;
+  for (int hit = 0; hit < 64; ++hit) {
+    sketch.Record("key", kNow);
+  }
+  EXPECT_EQ(sketch.Estimate("key"), 64);
+  sketch.Record("other", kNow + 2 * HotKeySketch::kDecayMilliseconds);
+  EXPECT_EQ(sketch.Estimate("key"), 16);
+  ASSERT_FALSE(sketch.Top(1).empty());
+  EXPECT_EQ(sketch.Top(1)[0].hits, 16);
+
+  sketch.Clear();
+  EXPECT_EQ(sketch.Estimate("key"), 0);
+  EXPECT_TRUE(sketch.Top(1).empty());
+}
+}  // namespace redis_simple::db
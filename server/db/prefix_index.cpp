@@ -0,0 +1,46 @@
+#include "server/db/prefix_index.h"
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <utility>
+
+namespace redis_simple::db {
+namespace {
+// Generations start at a random value so cursors from an earlier run are
+// unlikely to match.
+size_t NextGeneration() {
+  static std::atomic<size_t> next{std::random_device{}()};
+  return next.fetch_add(1) & ((size_t{1} << PrefixIndex::kGenerationBits) - 1);
+}
+}  // namespace
+
+PrefixIndex::PrefixIndex() : generation_(NextGeneration()) {}
+
+size_t PrefixIndex::SaveCursor(std::string_view prefix,
+                               std::string&& last_key) {
+  constexpr size_t kIdMask = (size_t{1} << kIdBits) - 1;
+  const size_t id = next_cursor_id_++ & kIdMask;
+  const size_t cursor = kCursorTag | (generation_ << kIdBits) | id;
+  cursors_.emplace(cursor, Resume{std::string(prefix), std::move(last_key)});
+  cursor_order_.push_back(cursor);
+  while (cursor_order_.size() > kMaxCursors) {
+    cursors_.erase(cursor_order_.front());
+    cursor_order_.pop_front();
+  }
+  return cursor;
+}
+
+/*
+ * The tree's own footprint plus the saved cursors, whose strings are counted
+ * by capacity.
+ */
+size_t PrefixIndex::MemoryUsage() const {
+  size_t bytes = tree_.MemoryUsage();
+  for (const auto& [cursor, resume] : cursors_) {
+    bytes += sizeof(cursor) + sizeof(resume) + resume.prefix.capacity() +
+             resume.last_key.capacity();
+  }
+  return bytes + cursor_order_.size() * sizeof(size_t);
+}
+}  // namespace redis_simple::db
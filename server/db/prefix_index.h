@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "memory/radix_tree.h"
+
+namespace redis_simple::db {
+/*
+ * Key names kept in a radix tree so a SCAN whose pattern has a literal prefix
+ * walks only the keys under that prefix instead of the whole keyspace. The
+ * index must be told about every key added to or removed from the keyspace.
+ *
+ * A scan resumes after the last key it returned, which does not fit a numeric
+ * cursor, so the index remembers it and hands out a cursor naming it. Cursors
+ * have kCursorTag set, which keyspace cursors never reach, and stay valid,
+ * however often they are reused, until kMaxCursors newer ones have been
+ * handed out. Below the tag each cursor carries the generation of the index
+ * that issued it, so a cursor from a flushed index or an earlier run is
+ * reported unknown rather than resuming from an unrelated key.
+ */
+class PrefixIndex {
+ public:
+  static constexpr size_t kCursorTag = size_t{1} << 62;
+  static constexpr size_t kGenerationBits = 16;
+  static constexpr size_t kIdBits = 62 - kGenerationBits;
+  static constexpr size_t kMaxCursors = 1024;
+  static bool IsCursor(size_t cursor) { return (cursor & kCursorTag) != 0; }
+  PrefixIndex();
+  void Add(std::string_view key) { tree_.Insert(key); }
+  void Remove(std::string_view key) { tree_.Remove(key); }
+  // Call visitor(key) for up to count keys starting with prefix, resuming
+  // from cursor, or from the first key if cursor is 0. Return the cursor to
+  // continue from, 0 once every key has been visited, or std::nullopt if the
+  // cursor is unknown or was issued for another prefix. The key view is valid
+  // only during the callback.
+  template <typename Visitor>
+  std::optional<size_t> Scan(size_t cursor, std::string_view prefix,
+                             size_t count, Visitor&& visitor);
+  size_t Size() const { return tree_.Size(); }
+  size_t NodeCount() const { return tree_.NodeCount(); }
+  size_t MemoryUsage() const;
+  // Saved cursors are kept and resume over whatever keys are added later.
+  void Clear() { tree_.Clear(); }
+
+ private:
+  struct Resume {
+    std::string prefix;
+    std::string last_key;
+  };
+  size_t SaveCursor(std::string_view prefix, std::string&& last_key);
+  in_memory::RadixTree tree_;
+  std::unordered_map<size_t, Resume> cursors_;
+  // Issued cursors, oldest first.
+  std::deque<size_t> cursor_order_;
+  size_t generation_;
+  size_t next_cursor_id_{1};
+};
+
+template <typename Visitor>
+std::optional<size_t> PrefixIndex::Scan(size_t cursor, std::string_view prefix,
+                                        size_t count, Visitor&& visitor) {
+  std::string after;
+  if (cursor != 0) {
+    const auto it = cursors_.find(cursor);
+    if (it == cursors_.end() || it->second.prefix != prefix) {
+      return std::nullopt;
+    }
+    after = it->second.last_key;
+  }
+
+  std::string last_key;
+  const bool more = tree_.ScanPrefix(
+      prefix,
+      cursor == 0 ? std::nullopt : std::optional<std::string_view>(after),
+      count, [&visitor, &last_key](std::string_view key) {
+        last_key.assign(key);
+        visitor(key);
+      });
+  if (!more) {
+    return 0;
+  }
+  return SaveCursor(prefix, std::move(last_key));
+}
+}  // namespace redis_simple::db
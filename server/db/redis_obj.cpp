@@ -1,87 +1,391 @@
 #include "redis_obj.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
 #include <stdexcept>
 #include <string>
-#include <variant>
+#include <string_view>
+
+#include "memory/slab_allocator.h"
+#include "memory/used_memory.h"
+#include "utils/string_utils.h"
 
 namespace redis_simple::db {
-const std::string& RedisObject::String() const {
-  const auto* value = std::get_if<std::string>(&value_);
-  if (value == nullptr) {
+void RedisObjectDeleter::operator()(RedisObject* const object) const {
+  object->Release();
+}
+
+RedisObject::RedisObject(ObjectType type, Encoding encoding, void* pointer)
+    : type_(static_cast<uint32_t>(type)),
+      encoding_(static_cast<uint32_t>(encoding)),
+      lru_(0),
+      pointer_(pointer) {}
+
+size_t RedisObject::EmbeddedAllocationSize(size_t size) {
+  static_assert(offsetof(RedisObject, embedded_size_) == kPayloadOffset);
+  static_assert(sizeof(RedisObject) == 32);
+  return std::max(sizeof(RedisObject), kEmbeddedOffset + size);
+}
+
+size_t RedisObject::AllocationSize() const {
+  switch (GetEncoding()) {
+    case Encoding::kRaw:
+      return kRawAllocationSize;
+    case Encoding::kEmbStr:
+      return EmbeddedAllocationSize(embedded_size_);
+    case Encoding::kCollection:
+    case Encoding::kInt:
+      break;
+  }
+  return sizeof(RedisObject);
+}
+
+size_t RedisObject::FreeEffort() const {
+  switch (Type()) {
+    case ObjectType::kString:
+      break;
+    case ObjectType::kSet:
+      if (Set()->Encoding() == set::Set::Encoding::kDict) {
+        return Set()->Size();
+      }
+      break;
+    case ObjectType::kList:
+      if (List()->Encoding() != list::List::Encoding::kListPack) {
+        return List()->NodeCount();
+      }
+      break;
+    case ObjectType::kZSet:
+      if (ZSet()->Encoding() != zset::ZSet::Encoding::kListPack) {
+        return ZSet()->Size();
+      }
+      break;
+    case ObjectType::kHash:
+      if (Hash()->Encoding() != hash::Hash::Encoding::kListPack) {
+        return Hash()->Size();
+      }
+      break;
+  }
+  return 1;
+}
+
+size_t RedisObject::Bytes(size_t samples) const {
+  if (IsShared()) {
+    return 0;
+  }
+  size_t bytes = in_memory::SlabAllocationBytes(this, AllocationSize());
+  switch (Type()) {
+    case ObjectType::kString:
+      if (GetEncoding() == Encoding::kRaw) {
+        bytes += in_memory::StringBytes(*RawString());
+      }
+      break;
+    case ObjectType::kSet:
+      bytes += in_memory::AllocationBytes(pointer_) + Set()->Bytes(samples);
+      break;
+    case ObjectType::kList:
+      bytes += in_memory::AllocationBytes(pointer_) + List()->Bytes(samples);
+      break;
+    case ObjectType::kZSet:
+      bytes += in_memory::AllocationBytes(pointer_) + ZSet()->Bytes(samples);
+      break;
+    case ObjectType::kHash:
+      bytes += in_memory::AllocationBytes(pointer_) + Hash()->Bytes(samples);
+      break;
+  }
+  return bytes;
+}
+
+size_t RedisObject::Length() const {
+  switch (Type()) {
+    case ObjectType::kString:
+      break;
+    case ObjectType::kSet:
+      return Set()->Size();
+    case ObjectType::kList:
+      return List()->Size();
+    case ObjectType::kZSet:
+      return ZSet()->Size();
+    case ObjectType::kHash:
+      return Hash()->Size();
+  }
+  IntegerBuffer buffer;
+  return StringView(&buffer).size();
+}
+
+std::string_view RedisObject::EncodingName() const {
+  switch (Type()) {
+    case ObjectType::kString:
+      switch (GetEncoding()) {
+        case Encoding::kRaw:
+          return "raw";
+        case Encoding::kEmbStr:
+          return "embstr";
+        case Encoding::kInt:
+        case Encoding::kCollection:
+          return "int";
+      }
+      break;
+    case ObjectType::kSet:
+      switch (Set()->Encoding()) {
+        case set::Set::Encoding::kIntSet:
+          return "intset";
+        case set::Set::Encoding::kListPack:
+          return "listpack";
+        case set::Set::Encoding::kDict:
+          return "hashtable";
+      }
+      break;
+    case ObjectType::kList:
+      return List()->Encoding() == list::List::Encoding::kListPack
+                 ? "listpack"
+                 : "quicklist";
+    case ObjectType::kZSet:
+      return ZSet()->Encoding() == zset::ZSet::Encoding::kListPack
+                 ? "listpack"
+                 : "skiplist";
+    case ObjectType::kHash:
+      return Hash()->Encoding() == hash::Hash::Encoding::kListPack
+                 ? "listpack"
+                 : "hashtable";
+  }
+  return "unknown";
+}
+
+bool RedisObject::Defrag(in_memory::DefragStats* const stats) {
+  switch (Type()) {
+    case ObjectType::kString:
+      return GetEncoding() == Encoding::kRaw &&
+             in_memory::DefragString(RawString(), stats);
+    case ObjectType::kSet:
+      return Set()->Defrag(stats);
+    case ObjectType::kList:
+      return List()->Defrag(stats);
+    case ObjectType::kZSet:
+      return ZSet()->Defrag(stats);
+    case ObjectType::kHash:
+      return Hash()->Defrag(stats);
+  }
+  return false;
+}
+
+RedisObjectPtr RedisObject::CreateWithString(std::string_view value) {
+  int64_t integer = 0;
+  if (utils::ToCanonicalInt64(value, &integer)) {
+    return CreateWithInteger(integer);
+  }
+  if (value.size() > kMaxEmbeddedStringSize) {
+    void* const memory = in_memory::SlabAllocate(
+        kRawAllocationSize, in_memory::SlabTag::kRedisObject);
+    auto* const object = new (memory)
+        RedisObject(ObjectType::kString, Encoding::kRaw, nullptr);
+    new (object->RawString()) std::string(value);
+    return RedisObjectPtr(object);
+  }
+  void* const memory = in_memory::SlabAllocate(
+      EmbeddedAllocationSize(value.size()), in_memory::SlabTag::kRedisObject);
+  auto* const object = new (memory)
+      RedisObject(ObjectType::kString, Encoding::kEmbStr, nullptr);
+  object->embedded_size_ = static_cast<uint8_t>(value.size());
+  if (!value.empty()) {
+    std::memcpy(object->EmbeddedData(), value.data(), value.size());
+  }
+  return RedisObjectPtr(object);
+}
+
+RedisObjectPtr RedisObject::CreateWithInteger(int64_t value) {
+  if (value >= 0 && value < kSharedIntegers) {
+    return RedisObjectPtr(SharedInteger(value));
+  }
+  void* const memory = in_memory::SlabAllocate(
+      sizeof(RedisObject), in_memory::SlabTag::kRedisObject);
+  auto* const object =
+      new (memory) RedisObject(ObjectType::kString, Encoding::kInt, nullptr);
+  object->integer_ = value;
+  return RedisObjectPtr(object);
+}
+
+/*
+ * The pool is built on first use and never freed, so keys on any thread and
+ * the async reclaimer can release shared objects without touching it.
+ */
+RedisObject* RedisObject::SharedInteger(int64_t value) {
+  static RedisObject* const pool = [] {
+    auto* const objects = static_cast<RedisObject*>(
+        ::operator new(sizeof(RedisObject) * kSharedIntegers));
+    for (int64_t integer = 0; integer < kSharedIntegers; ++integer) {
+      auto* const object = new (&objects[integer])
+          RedisObject(ObjectType::kString, Encoding::kInt, nullptr);
+      object->integer_ = integer;
+      object->refcount_ = kSharedRefCount;
+    }
+    return objects;
+  }();
+  return &pool[value];
+}
+
+RedisObjectPtr RedisObject::Create(ObjectType type, void* pointer) {
+  void* const memory = in_memory::SlabAllocate(
+      sizeof(RedisObject), in_memory::SlabTag::kRedisObject);
+  return RedisObjectPtr(new (memory)
+                            RedisObject(type, Encoding::kCollection, pointer));
+}
+
+RedisObjectPtr RedisObject::CreateWithSet(std::unique_ptr<set::Set> set) {
+  return set == nullptr ? nullptr : Create(ObjectType::kSet, set.release());
+}
+
+RedisObjectPtr RedisObject::CreateWithList(std::unique_ptr<list::List> list) {
+  return list == nullptr ? nullptr : Create(ObjectType::kList, list.release());
+}
+
+RedisObjectPtr RedisObject::CreateWithZSet(std::unique_ptr<zset::ZSet> zset) {
+  return zset == nullptr ? nullptr : Create(ObjectType::kZSet, zset.release());
+}
+
+RedisObjectPtr RedisObject::CreateWithHash(std::unique_ptr<hash::Hash> hash) {
+  return hash == nullptr ? nullptr : Create(ObjectType::kHash, hash.release());
+}
+
+RedisObjectPtr RedisObject::Unshare(RedisObjectPtr object) {
+  if (object->refcount_ == 1) {
+    return object;
+  }
+  if (object->Type() != ObjectType::kString) {
+    throw std::logic_error("shared collections cannot be copied");
+  }
+  RedisObjectPtr copy;
+  if (object->GetEncoding() == Encoding::kInt) {
+    void* const memory = in_memory::SlabAllocate(
+        sizeof(RedisObject), in_memory::SlabTag::kRedisObject);
+    copy = RedisObjectPtr(
+        new (memory) RedisObject(ObjectType::kString, Encoding::kInt, nullptr));
+    copy->integer_ = object->integer_;
+  } else {
+    copy = CreateWithString(object->String());
+  }
+  copy->expire_ = object->expire_;
+  copy->lru_ = object->lru_;
+  return copy;
+}
+
+std::string_view RedisObject::StringView(IntegerBuffer* const buffer) const {
+  if (Type() != ObjectType::kString) {
     throw std::invalid_argument("value type is not string");
   }
-  return *value;
+  switch (GetEncoding()) {
+    case Encoding::kEmbStr:
+      return {EmbeddedData(), embedded_size_};
+    case Encoding::kInt:
+      return {buffer->data(), static_cast<size_t>(utils::Int64ToString(
+                                  buffer->data(), buffer->size(), integer_))};
+    default:
+      return *RawString();
+  }
+}
+
+std::string RedisObject::String() const {
+  IntegerBuffer buffer;
+  return std::string(StringView(&buffer));
 }
 
 std::string* RedisObject::MutableString() {
-  auto* value = std::get_if<std::string>(&value_);
-  if (value == nullptr) {
+  if (Type() != ObjectType::kString) {
     throw std::invalid_argument("value type is not string");
   }
-  return value;
+  return GetEncoding() == Encoding::kRaw ? RawString() : nullptr;
 }
 
-set::Set* RedisObject::Set() {
-  auto* value = std::get_if<SetPtr>(&value_);
-  if (value == nullptr) {
-    throw std::invalid_argument("value type is not set");
+int64_t RedisObject::Integer() const {
+  if (GetEncoding() != Encoding::kInt) {
+    throw std::invalid_argument("value is not integer-encoded");
   }
-  return value->get();
+  return integer_;
 }
 
-const set::Set* RedisObject::Set() const {
-  const auto* value = std::get_if<SetPtr>(&value_);
-  if (value == nullptr) {
-    throw std::invalid_argument("value type is not set");
+bool RedisObject::SetIntegerInPlace(int64_t value) {
+  if (GetEncoding() != Encoding::kInt) {
+    throw std::invalid_argument("value is not integer-encoded");
   }
-  return value->get();
+  if (refcount_ != 1 || (value >= 0 && value < kSharedIntegers)) {
+    return false;
+  }
+  integer_ = value;
+  return true;
 }
 
-list::List* RedisObject::List() {
-  auto* value = std::get_if<ListPtr>(&value_);
-  if (value == nullptr) {
-    throw std::invalid_argument("value type is not list");
+void RedisObject::IncrRefCount() {
+  if (!IsShared()) {
+    ++refcount_;
   }
-  return value->get();
 }
 
-const list::List* RedisObject::List() const {
-  const auto* value = std::get_if<ListPtr>(&value_);
-  if (value == nullptr) {
-    throw std::invalid_argument("value type is not list");
+void* RedisObject::Pointer(ObjectType type, std::string_view name) const {
+  if (Type() != type) {
+    throw std::invalid_argument("value type is not " + std::string(name));
   }
-  return value->get();
+  return pointer_;
+}
+
+set::Set* RedisObject::Set() {
+  return static_cast<set::Set*>(Pointer(ObjectType::kSet, "set"));
+}
+
+const set::Set* RedisObject::Set() const {
+  return static_cast<const set::Set*>(Pointer(ObjectType::kSet, "set"));
+}
+
+list::List* RedisObject::List() {
+  return static_cast<list::List*>(Pointer(ObjectType::kList, "list"));
+}
+
+const list::List* RedisObject::List() const {
+  return static_cast<const list::List*>(Pointer(ObjectType::kList, "list"));
 }
 
 zset::ZSet* RedisObject::ZSet() {
-  auto* value = std::get_if<ZSetPtr>(&value_);
-  if (value == nullptr) {
-    throw std::invalid_argument("value type is not zset");
-  }
-  return value->get();
+  return static_cast<zset::ZSet*>(Pointer(ObjectType::kZSet, "zset"));
 }
 
 const zset::ZSet* RedisObject::ZSet() const {
-  const auto* value = std::get_if<ZSetPtr>(&value_);
-  if (value == nullptr) {
-    throw std::invalid_argument("value type is not zset");
-  }
-  return value->get();
+  return static_cast<const zset::ZSet*>(Pointer(ObjectType::kZSet, "zset"));
 }
 
 hash::Hash* RedisObject::Hash() {
-  auto* value = std::get_if<HashPtr>(&value_);
-  if (value == nullptr) {
-    throw std::invalid_argument("value type is not hash");
-  }
-  return value->get();
+  return static_cast<hash::Hash*>(Pointer(ObjectType::kHash, "hash"));
 }
 
 const hash::Hash* RedisObject::Hash() const {
-  const auto* value = std::get_if<HashPtr>(&value_);
-  if (value == nullptr) {
-    throw std::invalid_argument("value type is not hash");
+  return static_cast<const hash::Hash*>(Pointer(ObjectType::kHash, "hash"));
+}
+
+void RedisObject::Release() {
+  if (IsShared() || --refcount_ > 0) {
+    return;
+  }
+  switch (Type()) {
+    case ObjectType::kString:
+      if (GetEncoding() == Encoding::kRaw) {
+        RawString()->~basic_string();
+      }
+      break;
+    case ObjectType::kSet:
+      delete static_cast<set::Set*>(pointer_);
+      break;
+    case ObjectType::kList:
+      delete static_cast<list::List*>(pointer_);
+      break;
+    case ObjectType::kZSet:
+      delete static_cast<zset::ZSet*>(pointer_);
+      break;
+    case ObjectType::kHash:
+      delete static_cast<hash::Hash*>(pointer_);
+      break;
   }
-  return value->get();
+  const size_t size = AllocationSize();
+  this->~RedisObject();
+  in_memory::SlabDeallocate(this, size, in_memory::SlabTag::kRedisObject);
 }
 }  // namespace redis_simple::db
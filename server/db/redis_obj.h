@@ -1,55 +1,91 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <stdexcept>
+#include <new>
 #include <string>
-#include <utility>
-#include <variant>
+#include <string_view>
 
 #include "data_types/hash/hash.h"
 #include "data_types/list/list.h"
 #include "data_types/set/set.h"
 #include "data_types/zset/zset.h"
+#include "memory/defrag.h"
 
 namespace redis_simple::db {
-class RedisObject {
- private:
-  using SetPtr = std::unique_ptr<set::Set>;
-  using ListPtr = std::unique_ptr<list::List>;
-  using ZSetPtr = std::unique_ptr<zset::ZSet>;
-  using HashPtr = std::unique_ptr<hash::Hash>;
-  using Value = std::variant<std::string, SetPtr, ListPtr, ZSetPtr, HashPtr>;
+class RedisObject;
+
+// Drops one reference to the object, freeing it with the last one.
+struct RedisObjectDeleter {
+  void operator()(RedisObject* object) const;
+};
+
+using RedisObjectPtr = std::unique_ptr<RedisObject, RedisObjectDeleter>;
 
+/*
+ * A keyspace value. The header packs the type, the encoding, LRU bits and a
+ * reference count next to the expiration time, and is followed by either a
+ * pointer to the value or, for strings of up to kMaxEmbeddedStringSize bytes,
+ * the string itself in the same slab allocation. Strings holding a canonical
+ * int64 store the integer instead, and those below kSharedIntegers point at
+ * one preallocated object shared by every key.
+ */
+class RedisObject {
  public:
-  enum class ObjectType {
+  enum class ObjectType : uint8_t {
     kString = 1,
     kSet = 2,
     kList = 3,
     kZSet = 4,
     kHash = 5,
   };
+  enum class Encoding : uint8_t {
+    // A string in its own heap allocation.
+    kRaw,
+    // A string stored right after the header.
+    kEmbStr,
+    // A set, list, sorted set or hash owned through a pointer.
+    kCollection,
+    // A string holding a canonical int64, stored as the integer.
+    kInt,
+  };
+  // The longest string that keeps the object within a 64-byte slab class.
+  static constexpr size_t kMaxEmbeddedStringSize = 47;
+  static constexpr uint32_t kLruBits = 24;
+  static constexpr uint32_t kMaxLru = (1U << kLruBits) - 1;
+  // Integers in [0, kSharedIntegers) use preallocated shared objects.
+  static constexpr int64_t kSharedIntegers = 10000;
+  // Fits any int64 in decimal, with a terminating NUL.
+  using IntegerBuffer = std::array<char, 21>;
 
-  static std::unique_ptr<RedisObject> CreateWithString(std::string value) {
-    return Create(Value(std::move(value)));
-  }
-  static std::unique_ptr<RedisObject> CreateWithSet(
-      std::unique_ptr<set::Set> set) {
-    return set == nullptr ? nullptr : Create(Value(std::move(set)));
-  }
-  static std::unique_ptr<RedisObject> CreateWithList(
-      std::unique_ptr<list::List> list) {
-    return list == nullptr ? nullptr : Create(Value(std::move(list)));
-  }
-  static std::unique_ptr<RedisObject> CreateWithZSet(
-      std::unique_ptr<zset::ZSet> zset) {
-    return zset == nullptr ? nullptr : Create(Value(std::move(zset)));
-  }
-  static std::unique_ptr<RedisObject> CreateWithHash(
-      std::unique_ptr<hash::Hash> hash) {
-    return hash == nullptr ? nullptr : Create(Value(std::move(hash)));
-  }
-  const std::string& String() const;
+  // Integer-encodes value if it is a canonical int64.
+  static RedisObjectPtr CreateWithString(std::string_view value);
+  static RedisObjectPtr CreateWithInteger(int64_t value);
+  static RedisObjectPtr CreateWithSet(std::unique_ptr<set::Set> set);
+  static RedisObjectPtr CreateWithList(std::unique_ptr<list::List> list);
+  static RedisObjectPtr CreateWithZSet(std::unique_ptr<zset::ZSet> zset);
+  static RedisObjectPtr CreateWithHash(std::unique_ptr<hash::Hash> hash);
+  // object itself, or a private copy of it if it is shared, so the caller can
+  // change its expiration.
+  static RedisObjectPtr Unshare(RedisObjectPtr object);
+  RedisObject(const RedisObject&) = delete;
+  RedisObject& operator=(const RedisObject&) = delete;
+
+  // Integer-encoded values are formatted into buffer, which must outlive the
+  // returned view.
+  std::string_view StringView(IntegerBuffer* buffer) const;
+  std::string String() const;
+  // The string to modify in place, or nullptr if it is embedded or
+  // integer-encoded. Callers then replace the object instead.
   std::string* MutableString();
+  // Requires the kInt encoding.
+  int64_t Integer() const;
+  // Updates an integer-encoded value in place. Returns false, leaving the
+  // object unchanged, if the object is shared or value belongs in a shared
+  // object; the caller then replaces it with CreateWithInteger(value).
+  bool SetIntegerInPlace(int64_t value);
   set::Set* Set();
   const set::Set* Set() const;
   list::List* List();
@@ -58,30 +94,82 @@ class RedisObject {
   const zset::ZSet* ZSet() const;
   hash::Hash* Hash();
   const hash::Hash* Hash() const;
-  ObjectType Type() const {
-    switch (value_.index()) {
-      case 0:
-        return ObjectType::kString;
-      case 1:
-        return ObjectType::kSet;
-      case 2:
-        return ObjectType::kList;
-      case 3:
-        return ObjectType::kZSet;
-      case 4:
-        return ObjectType::kHash;
-      default:
-        throw std::logic_error("Redis object has no value");
-    }
-  }
+  // Absolute expiration in unix milliseconds, or 0 if the key is persistent.
+  // Kept with the value so looking up a volatile key takes a single probe.
+  int64_t Expire() const { return expire_; }
+  void SetExpire(int64_t expire) { expire_ = expire; }
+  ObjectType Type() const { return static_cast<ObjectType>(type_); }
+  Encoding GetEncoding() const { return static_cast<Encoding>(encoding_); }
+  uint32_t Lru() const { return lru_; }
+  void SetLru(uint32_t lru) { lru_ = lru & kMaxLru; }
+  uint32_t RefCount() const { return refcount_; }
+  void IncrRefCount();
+  // Whether the object is one of the preallocated shared integers, which are
+  // never freed.
+  bool IsShared() const { return refcount_ == kSharedRefCount; }
+  // Bytes of the object's own allocation, excluding what it points to.
+  size_t AllocationSize() const;
+  // Roughly how many allocations freeing the value releases: the elements of
+  // a hash table or skiplist, the nodes of a quicklist, or 1 for a string,
+  // listpack or intset.
+  size_t FreeEffort() const;
+  // Heap bytes held by the object and its value, or 0 for a shared object.
+  // With samples, large collections measure only that many elements and
+  // extrapolate the rest.
+  size_t Bytes(size_t samples = 0) const;
+  // Bytes of a string, or elements of a collection.
+  size_t Length() const;
+  // The encoding of the value as OBJECT ENCODING names it, looking through
+  // collections to their current representation.
+  std::string_view EncodingName() const;
+  // Move the heap blocks of the value to fresh memory where that packs the
+  // heap better. The object itself is a slab object and stays put. Returns
+  // true if anything moved.
+  bool Defrag(in_memory::DefragStats* stats);
 
  private:
-  static std::unique_ptr<RedisObject> Create(Value value) {
-    return std::unique_ptr<RedisObject>(new RedisObject(std::move(value)));
+  friend struct RedisObjectDeleter;
+  // The payload follows the 16-byte header: a pointer for collections, a
+  // std::string for kRaw, or a length byte and the bytes themselves for
+  // kEmbStr. The last two may run past the end of the object into the rest of
+  // its allocation.
+  static constexpr size_t kPayloadOffset = 16;
+  static constexpr size_t kEmbeddedOffset = kPayloadOffset + 1;
+  static constexpr size_t kRawAllocationSize =
+      kPayloadOffset + sizeof(std::string);
+  static constexpr uint32_t kSharedRefCount = UINT32_MAX;
+
+  RedisObject(ObjectType type, Encoding encoding, void* pointer);
+  ~RedisObject() = default;
+  static RedisObjectPtr Create(ObjectType type, void* pointer);
+  static RedisObject* SharedInteger(int64_t value);
+  static size_t EmbeddedAllocationSize(size_t size);
+  std::string* RawString() {
+    return std::launder(reinterpret_cast<std::string*>(
+        reinterpret_cast<char*>(this) + kPayloadOffset));
   }
-  explicit RedisObject(Value value) : value_(std::move(value)) {}
-  Value value_;
-};
+  const std::string* RawString() const {
+    return std::launder(reinterpret_cast<const std::string*>(
+        reinterpret_cast<const char*>(this) + kPayloadOffset));
+  }
+  char* EmbeddedData() {
+    return reinterpret_cast<char*>(this) + kEmbeddedOffset;
+  }
+  const char* EmbeddedData() const {
+    return reinterpret_cast<const char*>(this) + kEmbeddedOffset;
+  }
+  void* Pointer(ObjectType type, std::string_view name) const;
+  void Release();
 
-using RedisObjectPtr = std::unique_ptr<RedisObject>;
+  uint32_t type_ : 4;
+  uint32_t encoding_ : 4;
+  uint32_t lru_ : kLruBits;
+  uint32_t refcount_{1};
+  int64_t expire_{};
+  uint8_t embedded_size_{};
+  union {
+    void* pointer_{};
+    int64_t integer_;
+  };
+};
 }  // namespace redis_simple::db
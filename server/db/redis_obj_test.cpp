@@ -2,7 +2,14 @@
 
 #include <gtest/gtest.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "memory/used_memory.h"
 
 namespace redis_simple::db {
 TEST(RedisObjectTest, StringObjectExposesStringValue) {
@@ -16,9 +23,92 @@ TEST(RedisObjectTest, StringObjectExposesStringValue) {
   EXPECT_THROW(object->Hash(), std::invalid_argument);
 }
 
+TEST(RedisObjectTest, ShortStringsAreEmbeddedInTheObject) {
+  const std::string longest(RedisObject::kMaxEmbeddedStringSize, 'x');
+  const auto embedded = RedisObject::CreateWithString(longest);
+  EXPECT_EQ(embedded->GetEncoding(), RedisObject::Encoding::kEmbStr);
+  EXPECT_EQ(embedded->String(), longest);
+  EXPECT_EQ(embedded->AllocationSize(), 64);
+
+  const auto empty = RedisObject::CreateWithString("");
+  EXPECT_EQ(empty->GetEncoding(), RedisObject::Encoding::kEmbStr);
+  EXPECT_EQ(empty->String(), "");
+  EXPECT_EQ(empty->AllocationSize(), sizeof(RedisObject));
+
+  const std::string too_long = longest + "y";
+  const auto raw = RedisObject::CreateWithString(too_long);
+  EXPECT_EQ(raw->GetEncoding(), RedisObject::Encoding::kRaw);
+  EXPECT_EQ(raw->String(), too_long);
+}
+
+TEST(RedisObjectTest, OnlyRawStringsAreMutableInPlace) {
+  const auto embedded = RedisObject::CreateWithString("short");
+  EXPECT_EQ(embedded->MutableString(), nullptr);
+
+  const std::string long_value(RedisObject::kMaxEmbeddedStringSize + 1, 'x');
+  const auto raw = RedisObject::CreateWithString(long_value);
+  std::string* const value = raw->MutableString();
+  ASSERT_NE(value, nullptr);
+  value->append("!");
+  EXPECT_EQ(raw->String(), long_value + "!");
+  EXPECT_EQ(raw->AllocationSize(), 16 + sizeof(std::string));
+}
+
+TEST(RedisObjectTest, CanonicalIntegersAreIntegerEncoded) {
+  const auto large = RedisObject::CreateWithString("-9223372036854775808");
+  EXPECT_EQ(large->GetEncoding(), RedisObject::Encoding::kInt);
+  EXPECT_EQ(large->Integer(), INT64_MIN);
+  EXPECT_FALSE(large->IsShared());
+  EXPECT_EQ(large->String(), "-9223372036854775808");
+  RedisObject::IntegerBuffer buffer;
+  EXPECT_EQ(large->StringView(&buffer), "-9223372036854775808");
+  EXPECT_EQ(large->MutableString(), nullptr);
+
+  for (const char* text : {"007", "+1", "-0", "1 "}) {
+    const auto object = RedisObject::CreateWithString(text);
+    EXPECT_NE(object->GetEncoding(), RedisObject::Encoding::kInt) << text;
+    EXPECT_EQ(object->String(), text);
+  }
+}
+
+TEST(RedisObjectTest, SmallIntegersShareOneObject) {
+  const auto first = RedisObject::CreateWithString("42");
+  const auto second = RedisObject::CreateWithInteger(42);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_TRUE(first->IsShared());
+  EXPECT_FALSE(first->SetIntegerInPlace(100000));
+  EXPECT_NE(RedisObject::CreateWithInteger(RedisObject::kSharedIntegers).get(),
+            RedisObject::CreateWithInteger(RedisObject::kSharedIntegers).get());
+  EXPECT_FALSE(RedisObject::CreateWithInteger(-1)->IsShared());
+
+  auto copy = RedisObject::Unshare(RedisObject::CreateWithInteger(42));
+  EXPECT_FALSE(copy->IsShared());
+  EXPECT_EQ(copy->Integer(), 42);
+  copy->SetExpire(7);
+  EXPECT_EQ(first->Expire(), 0);
+  EXPECT_TRUE(copy->SetIntegerInPlace(100000));
+  EXPECT_FALSE(copy->SetIntegerInPlace(3));
+  EXPECT_EQ(copy->Integer(), 100000);
+}
+
+TEST(RedisObjectTest, HeaderPacksLruAndRefCount) {
+  auto object = RedisObject::CreateWithString("value");
+  EXPECT_EQ(object->RefCount(), 1);
+  object->SetLru(RedisObject::kMaxLru + 5);
+  EXPECT_EQ(object->Lru(), 4);
+  EXPECT_EQ(object->Type(), RedisObject::ObjectType::kString);
+
+  object->IncrRefCount();
+  RedisObjectPtr shared(object.get());
+  object.reset();
+  EXPECT_EQ(shared->RefCount(), 1);
+  EXPECT_EQ(shared->String(), "value");
+}
+
 TEST(RedisObjectTest, CollectionObjectsExposeTypedStorage) {
   const auto set_object = RedisObject::CreateWithSet(set::Set::Create());
   EXPECT_EQ(set_object->Type(), RedisObject::ObjectType::kSet);
+  EXPECT_EQ(set_object->GetEncoding(), RedisObject::Encoding::kCollection);
   ASSERT_NE(set_object->Set(), nullptr);
   EXPECT_THROW(set_object->String(), std::invalid_argument);
 
@@ -44,4 +134,117 @@ TEST(RedisObjectTest, RejectsNullCollectionStorage) {
   EXPECT_EQ(RedisObject::CreateWithZSet(nullptr), nullptr);
   EXPECT_EQ(RedisObject::CreateWithHash(nullptr), nullptr);
 }
+namespace {
+// Build an object and check that Bytes() matches what the allocation counter
+// saw it take, within tolerance_percent.
+void ExpectBytesMatchUsedMemory(const std::function<RedisObjectPtr()>& build,
+                                double tolerance_percent) {
+  const size_t before = in_memory::UsedMemory();
+  const auto object = build();
+  const size_t used = in_memory::UsedMemory() - before;
+  const size_t estimate = object->Bytes();
+  EXPECT_NEAR(static_cast<double>(estimate), static_cast<double>(used),
+              static_cast<double>(used) * tolerance_percent / 100)
+      << object->EncodingName();
+}
+}  // namespace
+
+TEST(RedisObjectTest, BytesMatchUsedMemory) {
+  constexpr double kTolerancePercent = 5;
+  ExpectBytesMatchUsedMemory(
+      [] { return RedisObject::CreateWithString(std::string(1000, 'x')); },
+      kTolerancePercent);
+  ExpectBytesMatchUsedMemory(
+      [] {
+        auto set = set::Set::Create();
+        for (int i = 0; i < 5000; ++i) {
+          set->Add("member:" + std::to_string(i));
+        }
+        return RedisObject::CreateWithSet(std::move(set));
+      },
+      kTolerancePercent);
+  ExpectBytesMatchUsedMemory(
+      [] {
+        auto hash = hash::Hash::Create();
+        for (int i = 0; i < 5000; ++i) {
+          hash->Set("field:" + std::to_string(i),
+                    "a value long enough to need the heap " +
+                        std::to_string(i));
+        }
+        return RedisObject::CreateWithHash(std::move(hash));
+      },
+      kTolerancePercent);
+  ExpectBytesMatchUsedMemory(
+      [] {
+        auto zset = zset::ZSet::Create();
+        for (int i = 0; i < 5000; ++i) {
+          zset->InsertOrUpdate("member:" + std::to_string(i), i);
+        }
+        return RedisObject::CreateWithZSet(std::move(zset));
+      },
+      kTolerancePercent);
+  ExpectBytesMatchUsedMemory(
+      [] {
+        auto list = list::List::Create();
+        for (int i = 0; i < 20000; ++i) {
+          list->RPush("element:" + std::to_string(i));
+        }
+        return RedisObject::CreateWithList(std::move(list));
+      },
+      kTolerancePercent);
+  ExpectBytesMatchUsedMemory(
+      [] {
+        auto set = set::Set::Create();
+        for (int i = 0; i < 100; ++i) {
+          set->Add(std::to_string(i * 1000));
+        }
+        return RedisObject::CreateWithSet(std::move(set));
+      },
+      kTolerancePercent);
+}
+
+TEST(RedisObjectTest, SampledBytesApproximateFullMeasurement) {
+  auto set = set::Set::Create();
+  for (int i = 0; i < 10000; ++i) {
+    set->Add("member:" + std::to_string(i));
+  }
+  const auto object = RedisObject::CreateWithSet(std::move(set));
+  const size_t full = object->Bytes();
+  EXPECT_NEAR(static_cast<double>(object->Bytes(100)),
+              static_cast<double>(full), static_cast<double>(full) * 0.1);
+}
+
+TEST(RedisObjectTest, EncodingNameFollowsTheValue) {
+  EXPECT_EQ(RedisObject::CreateWithString("12345")->EncodingName(), "int");
+  EXPECT_EQ(RedisObject::CreateWithString("short")->EncodingName(), "embstr");
+  EXPECT_EQ(RedisObject::CreateWithString(std::string(100, 'x'))
+                ->EncodingName(),
+            "raw");
+  auto set = set::Set::Create();
+  set->Add("1");
+  EXPECT_EQ(RedisObject::CreateWithSet(std::move(set))->EncodingName(),
+            "intset");
+  EXPECT_EQ(RedisObject::CreateWithList(list::List::Create())->EncodingName(),
+            "listpack");
+  EXPECT_EQ(RedisObject::CreateWithInteger(7)->Bytes(), 0);
+}
+
+TEST(RedisObjectTest, FreeEffortCountsSeparateAllocations) {
+  EXPECT_EQ(RedisObject::CreateWithString(std::string(100, 'x'))->FreeEffort(),
+            1);
+  auto small = hash::Hash::Create();
+  small->Set("field", "value");
+  const auto compact = RedisObject::CreateWithHash(std::move(small));
+  EXPECT_EQ(compact->FreeEffort(), 1);
+  EXPECT_EQ(compact->Length(), 1);
+
+  auto large = hash::Hash::Create();
+  for (int i = 0; i < 1000; ++i) {
+    large->Set("field:" + std::to_string(i), "value");
+  }
+  const auto table = RedisObject::CreateWithHash(std::move(large));
+  EXPECT_EQ(table->EncodingName(), "hashtable");
+  EXPECT_EQ(table->FreeEffort(), 1000);
+  EXPECT_EQ(table->Length(), 1000);
+}
 }  // namespace redis_simple::db
@@ -0,0 +1,57 @@
+#include "server/defrag.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "logging/logger.h"
+#include "memory/defrag.h"
+#include "utils/time_utils.h"
+
+namespace redis_simple {
+void ActiveDefragger::RunCycle(db::RedisDb* const db, int hz) {
+  if (!options_.enabled || db == nullptr) {
+    return;
+  }
+  // A pass in progress keeps going at its current pace even if fragmentation
+  // has dropped, so every key gets a turn.
+  if (cursor_ == 0) {
+    cycle_percent_ = TargetCyclePercent();
+    if (cycle_percent_ == 0) {
+      return;
+    }
+    pass_start_hits_ = db->DefragStats().hits;
+  }
+  cursor_ = db->ActiveDefrag(cursor_,
+                             utils::CronSliceMicroseconds(cycle_percent_, hz));
+  if (cursor_ == 0) {
+    in_memory::ReleaseFreeHeap();
+    cycle_percent_ = 0;
+    // A pass that moved nothing will not do better on the same heap, so the
+    // next waits for more free memory to appear.
+    stalled_free_bytes_ = db->DefragStats().hits == pass_start_hits_
+                              ? in_memory::HeapMemoryStats().free_bytes
+                              : 0;
+    RS_LOG_DEBUG("active defrag pass complete\n");
+  }
+}
+
+int ActiveDefragger::TargetCyclePercent() const {
+  const auto heap = in_memory::HeapMemoryStats();
+  if (heap.heap_bytes == 0 || heap.free_bytes < options_.ignore_bytes ||
+      (stalled_free_bytes_ != 0 && heap.free_bytes <= stalled_free_bytes_)) {
+    return 0;
+  }
+  const int64_t free_percent = static_cast<int64_t>(
+      heap.free_bytes * 100 / heap.heap_bytes);
+  if (free_percent < options_.threshold_lower) {
+    return 0;
+  }
+  const int64_t lower = options_.threshold_lower;
+  const int64_t upper = std::max<int64_t>(kThresholdUpper, lower + 1);
+  const int64_t span = std::max(options_.cycle_max - kCycleMin, 0);
+  const int64_t percent =
+      kCycleMin + span * (std::min(free_percent, upper) - lower) /
+                      (upper - lower);
+  return static_cast<int>(percent);
+}
+}  // namespace redis_simple
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "server/db/db.h"
+
+namespace redis_simple {
+struct ActiveDefragOptions {
+  bool enabled{};
+  // Free heap bytes below which fragmentation is not worth fixing.
+  size_t ignore_bytes{size_t{100} * 1024 * 1024};
+  // Free share of the heap, in percent, at which defragmentation starts.
+  int threshold_lower{10};
+  // Share of each cron period, in percent, a cycle may spend once
+  // fragmentation reaches kThresholdUpper.
+  int cycle_max{25};
+};
+
+/*
+ * Schedules active defragmentation from the cron. While the free share of the
+ * malloc heap is at least threshold_lower percent and above ignore_bytes, each
+ * cron run moves fragmented values for a slice of the cron period that grows
+ * from kCycleMin percent at the lower threshold to cycle_max at
+ * kThresholdUpper.
+ * A pass resumes from its SCAN cursor across runs, and once it covers the
+ * keyspace the freed heap pages are handed back to the system. After a pass
+ * that moves nothing, no new one starts until the free heap grows.
+ */
+class ActiveDefragger {
+ public:
+  static constexpr int kCycleMin = 1;
+  static constexpr int kThresholdUpper = 100;
+  explicit ActiveDefragger(ActiveDefragOptions options = {})
+      : options_(options) {}
+  void RunCycle(db::RedisDb* db, int hz);
+  // Share of the cron period the current pass spends, or 0 when idle.
+  int CyclePercent() const { return cycle_percent_; }
+  const ActiveDefragOptions& Options() const { return options_; }
+
+ private:
+  // Cycle share for the current fragmentation, or 0 if below the thresholds.
+  int TargetCyclePercent() const;
+  ActiveDefragOptions options_;
+  size_t cursor_{};
+  int cycle_percent_{};
+  uint64_t pass_start_hits_{};
+  // Free heap bytes after the last pass if it moved nothing, else 0.
+  size_t stalled_free_bytes_{};
+};
+}  // namespace redis_simple
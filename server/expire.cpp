@@ -1,30 +1,52 @@
 #include "expire.h"
 
+#include <algorithm>
 #include <cstdint>
 
 #include "logging/logger.h"
-#include "server.h"
 #include "utils/time_utils.h"
 
 namespace redis_simple {
-void ActiveExpireCycle() {
-  auto* db = Server::Get()->Db();
+namespace {
+constexpr size_t kBaseBatchKeys = 20;
+// Share of each cron period the slow cycle may spend, before effort.
+constexpr int64_t kBaseSlowCyclePercent = 25;
+constexpr int64_t kBaseFastCycleMicroseconds = 1000;
+}  // namespace
+
+ActiveExpirer::ActiveExpirer(int effort)
+    : extra_effort_(std::clamp(effort, kMinEffort, kMaxEffort) - kMinEffort) {}
+
+void ActiveExpirer::RunSlowCycle(db::RedisDb* const db, int hz) const {
   if (db == nullptr) {
     RS_LOG_DEBUG("db unavailable\n");
     return;
   }
+  const int64_t percent = kBaseSlowCyclePercent + 2 * extra_effort_;
+  db->ActiveExpire(db::ExpireCycle::kSlow, BatchKeys(),
+                   utils::CronSliceMicroseconds(percent, hz));
+}
 
-  constexpr size_t kSampleCount = 20;
-  constexpr int64_t kTimeBudgetMilliseconds = 25;
-  constexpr size_t kContinueExpirePercent = 25;
-  const int64_t start = utils::NowInMilliseconds();
-  while (utils::NowInMilliseconds() - start < kTimeBudgetMilliseconds) {
-    const auto sample =
-        db->ExpireSome(kSampleCount, utils::NowInMilliseconds());
-    if (sample.sampled == 0 ||
-        sample.expired * 100 <= sample.sampled * kContinueExpirePercent) {
-      break;
-    }
+void ActiveExpirer::RunFastCycle(db::RedisDb* const db) {
+  if (db == nullptr) {
+    return;
   }
+  const int64_t now = utils::NowInMicroseconds();
+  const int64_t duration = FastCycleMicroseconds();
+  if (now - last_fast_cycle_start_ < 2 * duration ||
+      !db->HasDueKeys(utils::NowInMilliseconds())) {
+    return;
+  }
+  last_fast_cycle_start_ = now;
+  db->ActiveExpire(db::ExpireCycle::kFast, BatchKeys(), duration);
+}
+
+size_t ActiveExpirer::BatchKeys() const {
+  return kBaseBatchKeys + kBaseBatchKeys / 4 * extra_effort_;
+}
+
+int64_t ActiveExpirer::FastCycleMicroseconds() const {
+  return kBaseFastCycleMicroseconds +
+         kBaseFastCycleMicroseconds / 4 * extra_effort_;
 }
 }  // namespace redis_simple
@@ -1,5 +1,32 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
+#include "server/db/db.h"
+
 namespace redis_simple {
-void ActiveExpireCycle();
+/*
+ * Schedules active expiration. The slow cycle runs from the cron and may spend
+ * a share of each cron period; the fast cycle runs before the event loop polls
+ * while keys are due, at most once per two of its own durations. Effort from 1
+ * to 10 raises the budgets and batch size of both, trading CPU for memory
+ * reclaimed sooner.
+ */
+class ActiveExpirer {
+ public:
+  static constexpr int kMinEffort = 1;
+  static constexpr int kMaxEffort = 10;
+  static constexpr int kDefaultEffort = 1;
+  explicit ActiveExpirer(int effort = kDefaultEffort);
+  void RunSlowCycle(db::RedisDb* db, int hz) const;
+  void RunFastCycle(db::RedisDb* db);
+
+ private:
+  size_t BatchKeys() const;
+  int64_t FastCycleMicroseconds() const;
+  // Effort above the minimum, from 0 to kMaxEffort - kMinEffort.
+  int extra_effort_;
+  int64_t last_fast_cycle_start_{};
+};
 }  // namespace redis_simple
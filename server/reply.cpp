@@ -136,6 +136,10 @@ std::string WrongTypeError() {
       "value");
 }
 
+std::string OutOfMemoryError() {
+  return FromError("OOM command not allowed when used memory > 'maxmemory'.");
+}
+
 std::string Null(ProtocolVersion protocol) {
   if (protocol == ProtocolVersion::kResp2) {
     return "$-1\r\n";
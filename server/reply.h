@@ -26,6 +26,7 @@ std::string WrongNumberOfArguments();
 std::string UnknownCommand(std::string_view command);
 std::string SyntaxError();
 std::string WrongTypeError();
+std::string OutOfMemoryError();
 std::string Null(ProtocolVersion protocol);
 std::string FromMapHeader(size_t size, ProtocolVersion protocol);
 std::string FromSetHeader(size_t size, ProtocolVersion protocol);
@@ -5,8 +5,11 @@
 
 #include <algorithm>
 #include <any>
+#include <cstddef>
 #include <cstdint>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include "client_connection/client_connection.h"
 #include "db/db.h"
@@ -14,9 +17,25 @@
 #include "event_loop/time_event.h"
 #include "expire.h"
 #include "logging/logger.h"
+#include "memory/used_memory.h"
 #include "server/shutdown.h"
+#include "utils/time_utils.h"
 
 namespace redis_simple {
+namespace {
+// Time slice the cron spends migrating buckets, so resizes finish even when no
+// command touches the dicts without stalling the event loop.
+constexpr int64_t kActiveRehashBudgetMicroseconds = 1000;
+// Dynamic hz doubles the cron frequency while each run would otherwise have
+// more clients than this to look after.
+constexpr size_t kMaxClientsPerCronRun = 200;
+// Time slice one call to PerformEvictions() may spend, checked every
+// kEvictionsPerClockRead evictions.
+constexpr int64_t kEvictionBudgetMicroseconds = 500;
+constexpr size_t kEvictionsPerClockRead = 16;
+constexpr int kMillisecondsPerSecond = 1000;
+}  // namespace
+
 Server::Server()
     : loop_(event_loop::Loop::Create()), db_(db::RedisDb::Create()) {}
 
@@ -31,10 +50,21 @@ bool Server::Run(const ServerOptions& options) {
     return false;
   }
   aof_.reset();
-  db_ = db::RedisDb::Create();
+  hz_ = options.hz;
+  dynamic_hz_ = options.dynamic_hz;
+  maxmemory_ = options.maxmemory;
+  maxmemory_policy_ = options.maxmemory_policy;
+  expirer_ = ActiveExpirer(options.active_expire_effort);
+  defragger_ = ActiveDefragger(options.active_defrag);
+  db_ = db::RedisDb::Create(options.keyspace_shards,
+                            options.keyspace_prefix_index);
   if (db_ == nullptr) {
     return false;
   }
+  db_->SetEvictionPolicy(maxmemory_policy_);
+  db_->SetLazyFreeOptions(options.lazyfree);
+  db_->SetHotKeySampleRate(static_cast<uint32_t>(options.hotkeys_sample_rate));
+  startup_memory_ = in_memory::UsedMemory();
   if (options.append_only) {
     aof_ = aof::Aof::Open(options.aof_options, db_.get());
     if (aof_ == nullptr) {
@@ -58,7 +88,9 @@ bool Server::Run(const ServerOptions& options) {
   }
   loop_->CreateTimeEvent(event_loop::TimeEvent::Create(
       [](int64_t) { return ServerCron(); }, nullptr));
+  loop_->SetBeforeSleep([this] { expirer_.RunFastCycle(db_.get()); });
   loop_->Run();
+  loop_->SetBeforeSleep(nullptr);
   loop_->DeleteFileEvent(fd_, event_loop::EventFlag::kReadable);
   fd_ = -1;
   clients_.clear();
@@ -66,6 +98,35 @@ bool Server::Run(const ServerOptions& options) {
   return true;
 }
 
+ClientBufferMemory Server::ClientBuffers() const {
+  ClientBufferMemory memory;
+  for (const auto& client : clients_) {
+    memory.query_bytes += client->QueryBufferBytes();
+    memory.output_bytes += client->OutputBufferBytes();
+  }
+  return memory;
+}
+
+MemoryOverview Server::MemoryBreakdown() {
+  MemoryOverview memory;
+  memory.used_bytes = in_memory::UsedMemory();
+  memory.startup_bytes = startup_memory_;
+  memory.clients = ClientBuffers();
+  if (aof_ != nullptr) {
+    memory.aof_buffer_bytes = aof_->State().pending_bytes;
+  }
+  memory.keyspace = db_->MemoryBreakdown();
+  memory.overhead_bytes =
+      memory.startup_bytes + memory.clients.query_bytes +
+      memory.clients.output_bytes + memory.aof_buffer_bytes +
+      memory.keyspace.keyspace_bytes + memory.keyspace.expires_bytes +
+      memory.keyspace.prefix_index_bytes;
+  memory.dataset_bytes = memory.used_bytes > memory.overhead_bytes
+                             ? memory.used_bytes - memory.overhead_bytes
+                             : 0;
+  return memory;
+}
+
 void Server::Stop() {
   if (loop_ != nullptr) {
     loop_->Stop();
@@ -88,6 +149,52 @@ bool Server::RemoveClient(Client* c) {
   return true;
 }
 
+/*
+ * Values handed to the async reclaimer free their memory only later, so their
+ * estimated bytes count as already freed. Eviction still goes on while the
+ * reclaimer has work; otherwise a stream of large deletions would let writes
+ * through with nothing evicted.
+ */
+EvictionResult Server::PerformEvictions() {
+  if (maxmemory_ == 0 || db_ == nullptr ||
+      UnreclaimedMemory() <= maxmemory_) {
+    return EvictionResult::kOk;
+  }
+  const int64_t start = utils::NowInMicroseconds();
+  size_t evicted = 0;
+  while (UnreclaimedMemory() > maxmemory_) {
+    const auto key = db_->EvictKey();
+    if (!key.has_value()) {
+      return EvictionResult::kFail;
+    }
+    const std::vector<std::string_view> args = {*key};
+    if (aof_ != nullptr && !aof_->Append("DEL", args, db_.get())) {
+      RS_LOG_WARN("failed to append eviction to AOF\n");
+      Stop();
+      return EvictionResult::kRunning;
+    }
+    if (++evicted % kEvictionsPerClockRead == 0 &&
+        utils::NowInMicroseconds() - start >= kEvictionBudgetMicroseconds) {
+      return EvictionResult::kRunning;
+    }
+  }
+  return EvictionResult::kOk;
+}
+
+size_t Server::UnreclaimedMemory() const {
+  const size_t used = in_memory::UsedMemory();
+  const size_t pending = db_->PendingReclaimBytes();
+  return used > pending ? used - pending : 0;
+}
+
+void Server::SetMaxMemory(size_t bytes, db::EvictionPolicy policy) {
+  maxmemory_ = bytes;
+  maxmemory_policy_ = policy;
+  if (db_ != nullptr) {
+    db_->SetEvictionPolicy(policy);
+  }
+}
+
 bool Server::InstallAcceptCallback() {
   auto file_event = event_loop::FileEvent::Create(
       client_connection::AcceptConnectionCallback, nullptr, this,
@@ -113,7 +220,23 @@ int Server::ServerCron() {
           aof::RewriteResult::kError) {
     RS_LOG_WARN("automatic AOF rewrite failed to start\n");
   }
-  ActiveExpireCycle();
-  return 1;
+  const int hz = server->CronHz();
+  server->expirer_.RunSlowCycle(server->Db(), hz);
+  if (auto* const db = server->Db(); db != nullptr) {
+    db->ActiveRehash(kActiveRehashBudgetMicroseconds);
+  }
+  server->PerformEvictions();
+  server->defragger_.RunCycle(server->Db(), hz);
+  server->big_keys_.RunCycle(server->Db(), hz);
+  return kMillisecondsPerSecond / hz;
+}
+
+int Server::CronHz() const {
+  int hz = hz_;
+  while (dynamic_hz_ && hz < kMaxHz &&
+         clients_.size() / static_cast<size_t>(hz) > kMaxClientsPerCronRun) {
+    hz *= 2;
+  }
+  return std::min(hz, kMaxHz);
 }
 }  // namespace redis_simple
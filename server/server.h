@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -7,10 +8,44 @@
 #include "connection/connection.h"
 #include "event_loop/loop.h"
 #include "server/aof.h"
+#include "server/big_keys.h"
 #include "server/client.h"
+#include "server/db/db.h"
+#include "server/defrag.h"
+#include "server/expire.h"
 #include "server/server_options.h"
 
 namespace redis_simple {
+enum class EvictionResult {
+  // Used memory is within maxmemory.
+  kOk,
+  // Still over maxmemory, but keys were evicted until the time slice ran
+  // out.
+  kRunning,
+  // Over maxmemory with nothing left to evict.
+  kFail,
+};
+
+struct ClientBufferMemory {
+  size_t query_bytes{};
+  size_t output_bytes{};
+};
+
+/*
+ * Used memory split into fixed overhead and the dataset: startup memory,
+ * client buffers, the AOF buffer and the keyspace's own structures are
+ * overhead, and whatever else is in use is taken to be values.
+ */
+struct MemoryOverview {
+  size_t used_bytes{};
+  size_t startup_bytes{};
+  ClientBufferMemory clients;
+  size_t aof_buffer_bytes{};
+  db::KeyspaceMemory keyspace;
+  size_t overhead_bytes{};
+  size_t dataset_bytes{};
+};
+
 class Server {
  public:
   static Server* Get();
@@ -23,13 +58,40 @@ class Server {
     clients_.push_back(std::move(client));
   }
   bool RemoveClient(Client* c);
+  // Evict keys until used memory, less what the async reclaimer has yet to
+  // free, is back under maxmemory or the time slice runs out, logging each
+  // eviction to the AOF as a DEL.
+  EvictionResult PerformEvictions();
+  // Change the limit and policy Run() took from the options.
+  void SetMaxMemory(size_t bytes, db::EvictionPolicy policy);
+  size_t MaxMemory() const { return maxmemory_; }
+  db::EvictionPolicy MaxMemoryPolicy() const { return maxmemory_policy_; }
+  // Used memory once the server was set up, before loading any data.
+  size_t StartupMemory() const { return startup_memory_; }
+  // Buffer bytes summed over connected clients.
+  ClientBufferMemory ClientBuffers() const;
+  MemoryOverview MemoryBreakdown();
+  const ActiveDefragger& Defragger() const { return defragger_; }
+  BigKeysAnalysis& BigKeys() { return big_keys_; }
   ~Server() = default;
 
  private:
   Server();
   bool InstallAcceptCallback();
+  // Used memory minus the estimated bytes pending in the async reclaimer.
+  size_t UnreclaimedMemory() const;
   static int ServerCron();
+  // Cron frequency for the current load.
+  int CronHz() const;
   int fd_{-1};
+  int hz_{kDefaultHz};
+  bool dynamic_hz_{true};
+  size_t maxmemory_{};
+  size_t startup_memory_{};
+  db::EvictionPolicy maxmemory_policy_{db::EvictionPolicy::kNoEviction};
+  ActiveExpirer expirer_;
+  ActiveDefragger defragger_;
+  BigKeysAnalysis big_keys_;
   std::unique_ptr<event_loop::Loop> loop_;
   std::vector<std::unique_ptr<Client>> clients_;
   std::unique_ptr<db::RedisDb> db_;
@@ -2,6 +2,7 @@
 
 #include <charconv>
 #include <cstddef>
+#include <cstdint>
 #include <string_view>
 #include <system_error>
 
@@ -10,22 +11,23 @@ namespace {
 constexpr int kMinPort = 1;
 constexpr int kMaxPort = 65535;
 
-bool ParsePort(std::string_view value, int* const port) {
+bool ParseIntInRange(std::string_view value, int min, int max,
+                     int* const result) {
   if (value.empty()) {
     return false;
   }
   int parsed = 0;
-  const auto result =
+  const auto status =
       std::from_chars(value.data(), value.data() + value.size(), parsed);
-  if (result.ec != std::errc() || result.ptr != value.data() + value.size() ||
-      parsed < kMinPort || parsed > kMaxPort) {
+  if (status.ec != std::errc() || status.ptr != value.data() + value.size() ||
+      parsed < min || parsed > max) {
     return false;
   }
-  *port = parsed;
+  *result = parsed;
   return true;
 }
 
-bool ParseAppendOnly(std::string_view value, bool* const enabled) {
+bool ParseYesNo(std::string_view value, bool* const enabled) {
   if (value == "yes") {
     *enabled = true;
     return true;
@@ -61,6 +63,17 @@ bool ParseSize(std::string_view value, size_t* const result) {
       std::from_chars(value.data(), value.data() + value.size(), *result);
   return parsed.ec == std::errc() && parsed.ptr == value.data() + value.size();
 }
+
+bool ParseKeyspaceShards(std::string_view value, size_t* const shards) {
+  size_t parsed = 0;
+  if (!ParseSize(value, &parsed) || parsed == 0 ||
+      parsed > in_memory::ShardedDict<int64_t>::kMaxShards ||
+      (parsed & (parsed - 1)) != 0) {
+    return false;
+  }
+  *shards = parsed;
+  return true;
+}
 }  // namespace
 
 OptionsResult ParseServerOptions(int argc, const char* const* argv) {
@@ -74,7 +87,20 @@ OptionsResult ParseServerOptions(int argc, const char* const* argv) {
     if (option != "--bind" && option != "--port" && option != "--appendonly" &&
         option != "--appendfilename" && option != "--appendfsync" &&
         option != "--auto-aof-rewrite-min-size" &&
-        option != "--auto-aof-rewrite-percentage") {
+        option != "--auto-aof-rewrite-percentage" &&
+        option != "--keyspace-shards" &&
+        option != "--keyspace-prefix-index" && option != "--hz" &&
+        option != "--dynamic-hz" && option != "--active-expire-effort" &&
+        option != "--maxmemory" && option != "--maxmemory-policy" &&
+        option != "--activedefrag" &&
+        option != "--active-defrag-ignore-bytes" &&
+        option != "--active-defrag-threshold-lower" &&
+        option != "--active-defrag-cycle-max" &&
+        option != "--lazyfree-lazy-user-flush" &&
+        option != "--lazyfree-lazy-user-del" &&
+        option != "--lazyfree-lazy-expire" &&
+        option != "--lazyfree-lazy-server-del" &&
+        option != "--hotkeys-sample-rate") {
       result.status = OptionsStatus::kError;
       result.error = "unknown option";
       return result;
@@ -96,7 +122,7 @@ OptionsResult ParseServerOptions(int argc, const char* const* argv) {
       continue;
     }
     if (option == "--port") {
-      if (ParsePort(value, &result.options.port)) {
+      if (ParseIntInRange(value, kMinPort, kMaxPort, &result.options.port)) {
         continue;
       }
       result.status = OptionsStatus::kError;
@@ -104,7 +130,7 @@ OptionsResult ParseServerOptions(int argc, const char* const* argv) {
       return result;
     }
     if (option == "--appendonly") {
-      if (ParseAppendOnly(value, &result.options.append_only)) {
+      if (ParseYesNo(value, &result.options.append_only)) {
         continue;
       }
       result.status = OptionsStatus::kError;
@@ -138,6 +164,143 @@ OptionsResult ParseServerOptions(int argc, const char* const* argv) {
       result.error = "auto AOF rewrite percentage must be an integer";
       return result;
     }
+    if (option == "--keyspace-shards") {
+      if (ParseKeyspaceShards(value, &result.options.keyspace_shards)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "keyspace shards must be a power of two up to 1024";
+      return result;
+    }
+    if (option == "--keyspace-prefix-index") {
+      if (ParseYesNo(value, &result.options.keyspace_prefix_index)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "keyspace-prefix-index must be yes or no";
+      return result;
+    }
+    if (option == "--hz") {
+      if (ParseIntInRange(value, kMinHz, kMaxHz, &result.options.hz)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "hz must be between 1 and 500";
+      return result;
+    }
+    if (option == "--dynamic-hz") {
+      if (ParseYesNo(value, &result.options.dynamic_hz)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "dynamic-hz must be yes or no";
+      return result;
+    }
+    if (option == "--active-expire-effort") {
+      if (ParseIntInRange(value, ActiveExpirer::kMinEffort,
+                          ActiveExpirer::kMaxEffort,
+                          &result.options.active_expire_effort)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "active-expire-effort must be between 1 and 10";
+      return result;
+    }
+    if (option == "--maxmemory") {
+      if (ParseSize(value, &result.options.maxmemory)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "maxmemory must be a byte count";
+      return result;
+    }
+    if (option == "--maxmemory-policy") {
+      if (const auto policy = db::ParseEvictionPolicy(value)) {
+        result.options.maxmemory_policy = *policy;
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error =
+          "maxmemory-policy must be noeviction, allkeys-lru, allkeys-lfu, "
+          "allkeys-random, volatile-lru, or volatile-ttl";
+      return result;
+    }
+    if (option == "--activedefrag") {
+      if (ParseYesNo(value, &result.options.active_defrag.enabled)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "activedefrag must be yes or no";
+      return result;
+    }
+    if (option == "--active-defrag-ignore-bytes") {
+      if (ParseSize(value, &result.options.active_defrag.ignore_bytes)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "active-defrag-ignore-bytes must be a byte count";
+      return result;
+    }
+    if (option == "--active-defrag-threshold-lower") {
+      if (ParseIntInRange(value, 1, ActiveDefragger::kThresholdUpper,
+                          &result.options.active_defrag.threshold_lower)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "active-defrag-threshold-lower must be between 1 and 100";
+      return result;
+    }
+    if (option == "--active-defrag-cycle-max") {
+      if (ParseIntInRange(value, ActiveDefragger::kCycleMin, 99,
+                          &result.options.active_defrag.cycle_max)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "active-defrag-cycle-max must be between 1 and 99";
+      return result;
+    }
+    if (option == "--lazyfree-lazy-user-flush") {
+      if (ParseYesNo(value, &result.options.lazyfree.user_flush)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "lazyfree-lazy-user-flush must be yes or no";
+      return result;
+    }
+    if (option == "--lazyfree-lazy-user-del") {
+      if (ParseYesNo(value, &result.options.lazyfree.user_del)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "lazyfree-lazy-user-del must be yes or no";
+      return result;
+    }
+    if (option == "--lazyfree-lazy-expire") {
+      if (ParseYesNo(value, &result.options.lazyfree.expire)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "lazyfree-lazy-expire must be yes or no";
+      return result;
+    }
+    if (option == "--lazyfree-lazy-server-del") {
+      if (ParseYesNo(value, &result.options.lazyfree.server_del)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "lazyfree-lazy-server-del must be yes or no";
+      return result;
+    }
+    if (option == "--hotkeys-sample-rate") {
+      if (ParseIntInRange(
+              value, 0, static_cast<int>(db::RedisDb::kMaxHotKeySampleRate),
+              &result.options.hotkeys_sample_rate)) {
+        continue;
+      }
+      result.status = OptionsStatus::kError;
+      result.error = "hotkeys-sample-rate must be between 0 and 1000000";
+      return result;
+    }
     if (!ParseFsyncPolicy(value, &result.options.aof_options.fsync)) {
       result.status = OptionsStatus::kError;
       result.error = "appendfsync must be always, everysec, or no";
@@ -152,6 +315,18 @@ std::string_view ServerUsage() {
          "[--appendonly <yes|no>] [--appendfilename <path>] "
          "[--appendfsync <always|everysec|no>] "
          "[--auto-aof-rewrite-min-size <bytes>] "
-         "[--auto-aof-rewrite-percentage <percent>]\n";
+         "[--auto-aof-rewrite-percentage <percent>] "
+         "[--keyspace-shards <count>] [--keyspace-prefix-index <yes|no>] "
+         "[--hz <1-500>] [--dynamic-hz <yes|no>] "
+         "[--active-expire-effort <1-10>] [--maxmemory <bytes>] "
+         "[--maxmemory-policy <policy>] [--activedefrag <yes|no>] "
+         "[--active-defrag-ignore-bytes <bytes>] "
+         "[--active-defrag-threshold-lower <1-100>] "
+         "[--active-defrag-cycle-max <1-99>] "
+         "[--lazyfree-lazy-user-flush <yes|no>] "
+         "[--lazyfree-lazy-user-del <yes|no>] "
+         "[--lazyfree-lazy-expire <yes|no>] "
+         "[--lazyfree-lazy-server-del <yes|no>] "
+         "[--hotkeys-sample-rate <0-1000000>]\n";
 }
 }  // namespace redis_simple
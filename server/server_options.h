@@ -1,16 +1,41 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 
 #include "server/aof.h"
+#include "server/db/db.h"
+#include "server/defrag.h"
+#include "server/expire.h"
 
 namespace redis_simple {
+inline constexpr int kMinHz = 1;
+inline constexpr int kMaxHz = 500;
+inline constexpr int kDefaultHz = 10;
+
 struct ServerOptions {
   std::string bind_address{"127.0.0.1"};
   int port{8080};
   bool append_only{};
   aof::Options aof_options;
+  // Power of two between 1 and in_memory::ShardedDict<>::kMaxShards.
+  size_t keyspace_shards{db::RedisDb::kDefaultKeyspaceShards};
+  // Index key names by prefix to speed up SCAN MATCH, at the cost of a second
+  // copy of every key name.
+  bool keyspace_prefix_index{};
+  // Cron runs per second. With dynamic_hz the cron speeds up, up to kMaxHz,
+  // as the number of clients grows.
+  int hz{kDefaultHz};
+  bool dynamic_hz{true};
+  int active_expire_effort{ActiveExpirer::kDefaultEffort};
+  // Used memory the server evicts keys to stay under, or 0 for no limit.
+  size_t maxmemory{};
+  db::EvictionPolicy maxmemory_policy{db::EvictionPolicy::kNoEviction};
+  ActiveDefragOptions active_defrag;
+  db::LazyFreeOptions lazyfree;
+  // Feed one in this many key accesses to the HOTKEYS sketch, or none if 0.
+  int hotkeys_sample_rate{};
 };
 
 enum class OptionsStatus {
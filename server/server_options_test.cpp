@@ -19,6 +19,14 @@ TEST(ServerOptionsTest, UsesDefaults) {
   EXPECT_EQ(result.options.aof_options.auto_rewrite_min_bytes,
             size_t{64} * 1024 * 1024);
   EXPECT_EQ(result.options.aof_options.auto_rewrite_percentage, 100);
+  EXPECT_EQ(result.options.keyspace_shards,
+            db::RedisDb::kDefaultKeyspaceShards);
+  EXPECT_FALSE(result.options.keyspace_prefix_index);
+  EXPECT_EQ(result.options.hz, kDefaultHz);
+  EXPECT_TRUE(result.options.dynamic_hz);
+  EXPECT_EQ(result.options.active_expire_effort, ActiveExpirer::kDefaultEffort);
+  EXPECT_EQ(result.options.maxmemory, 0);
+  EXPECT_EQ(result.options.maxmemory_policy, db::EvictionPolicy::kNoEviction);
 }
 
 TEST(ServerOptionsTest, ParsesBindAddressAndPort) {
@@ -55,6 +63,155 @@ TEST(ServerOptionsTest, ParsesAofOptions) {
   EXPECT_EQ(result.options.aof_options.auto_rewrite_percentage, 50);
 }
 
+TEST(ServerOptionsTest, ParsesCronAndExpireOptions) {
+  constexpr std::array kArgv = {"redis_simple",
+                                "--hz",
+                                "100",
+                                "--dynamic-hz",
+                                "no",
+                                "--active-expire-effort",
+                                "7"};
+  const auto result = ParseServerOptions(kArgv.size(), kArgv.data());
+  EXPECT_EQ(result.status, OptionsStatus::kOk);
+  EXPECT_EQ(result.options.hz, 100);
+  EXPECT_FALSE(result.options.dynamic_hz);
+  EXPECT_EQ(result.options.active_expire_effort, 7);
+
+  constexpr std::array kInvalidHz = {"redis_simple", "--hz", "501"};
+  EXPECT_EQ(ParseServerOptions(kInvalidHz.size(), kInvalidHz.data()).status,
+            OptionsStatus::kError);
+  constexpr std::array kInvalidEffort = {"redis_simple",
+                                         "--active-expire-effort", "0"};
+  EXPECT_EQ(
+      ParseServerOptions(kInvalidEffort.size(), kInvalidEffort.data()).status,
+      OptionsStatus::kError);
+}
+
+TEST(ServerOptionsTest, ParsesMaxmemory) {
+  constexpr std::array kArgv = {"redis_simple", "--maxmemory", "1048576",
+                                "--maxmemory-policy", "allkeys-lfu"};
+  const auto result = ParseServerOptions(kArgv.size(), kArgv.data());
+  EXPECT_EQ(result.status, OptionsStatus::kOk);
+  EXPECT_EQ(result.options.maxmemory, 1048576);
+  EXPECT_EQ(result.options.maxmemory_policy, db::EvictionPolicy::kAllKeysLfu);
+
+  constexpr std::array kInvalidLimit = {"redis_simple", "--maxmemory", "1gb"};
+  EXPECT_EQ(
+      ParseServerOptions(kInvalidLimit.size(), kInvalidLimit.data()).status,
+      OptionsStatus::kError);
+  constexpr std::array kInvalidPolicy = {"redis_simple", "--maxmemory-policy",
+                                         "volatile-lfu"};
+  EXPECT_EQ(
+      ParseServerOptions(kInvalidPolicy.size(), kInvalidPolicy.data()).status,
+      OptionsStatus::kError);
+}
+
+TEST(ServerOptionsTest, ParsesActiveDefrag) {
+  constexpr std::array kDefaults = {"redis_simple"};
+  const auto defaults = ParseServerOptions(kDefaults.size(), kDefaults.data());
+  EXPECT_FALSE(defaults.options.active_defrag.enabled);
+  EXPECT_EQ(defaults.options.active_defrag.threshold_lower, 10);
+
+  constexpr std::array kArgv = {"redis_simple",
+                                "--activedefrag",
+                                "yes",
+                                "--active-defrag-ignore-bytes",
+                                "1048576",
+                                "--active-defrag-threshold-lower",
+                                "20",
+                                "--active-defrag-cycle-max",
+                                "50"};
+  const auto result = ParseServerOptions(kArgv.size(), kArgv.data());
+  EXPECT_EQ(result.status, OptionsStatus::kOk);
+  EXPECT_TRUE(result.options.active_defrag.enabled);
+  EXPECT_EQ(result.options.active_defrag.ignore_bytes, 1048576);
+  EXPECT_EQ(result.options.active_defrag.threshold_lower, 20);
+  EXPECT_EQ(result.options.active_defrag.cycle_max, 50);
+
+  constexpr std::array kInvalidCycle = {"redis_simple",
+                                        "--active-defrag-cycle-max", "100"};
+  EXPECT_EQ(
+      ParseServerOptions(kInvalidCycle.size(), kInvalidCycle.data()).status,
+      OptionsStatus::kError);
+}
+
+TEST(ServerOptionsTest, ParsesLazyFree) {
+  constexpr std::array kDefaults = {"redis_simple"};
+  const auto defaults = ParseServerOptions(kDefaults.size(), kDefaults.data());
+  EXPECT_FALSE(defaults.options.lazyfree.user_flush);
+  EXPECT_FALSE(defaults.options.lazyfree.user_del);
+  EXPECT_FALSE(defaults.options.lazyfree.expire);
+  EXPECT_FALSE(defaults.options.lazyfree.server_del);
+
+  constexpr std::array kArgv = {"redis_simple",
+                                "--lazyfree-lazy-user-flush",
+                                "yes",
+                                "--lazyfree-lazy-user-del",
+                                "yes",
+                                "--lazyfree-lazy-expire",
+                                "yes",
+                                "--lazyfree-lazy-server-del",
+                                "no"};
+  const auto result = ParseServerOptions(kArgv.size(), kArgv.data());
+  EXPECT_EQ(result.status, OptionsStatus::kOk);
+  EXPECT_TRUE(result.options.lazyfree.user_flush);
+  EXPECT_TRUE(result.options.lazyfree.user_del);
+  EXPECT_TRUE(result.options.lazyfree.expire);
+  EXPECT_FALSE(result.options.lazyfree.server_del);
+
+  constexpr std::array kInvalid = {"redis_simple",
+                                   "--lazyfree-lazy-user-flush", "maybe"};
+  EXPECT_EQ(ParseServerOptions(kInvalid.size(), kInvalid.data()).status,
+            OptionsStatus::kError);
+}
+
+TEST(ServerOptionsTest, ParsesHotKeysSampleRate) {
+  constexpr std::array kDefaults = {"redis_simple"};
+  EXPECT_EQ(ParseServerOptions(kDefaults.size(), kDefaults.data())
+                .options.hotkeys_sample_rate,
+            0);
+
+  constexpr std::array kArgv = {"redis_simple", "--hotkeys-sample-rate", "8"};
+  const auto result = ParseServerOptions(kArgv.size(), kArgv.data());
+  EXPECT_EQ(result.status, OptionsStatus::kOk);
+  EXPECT_EQ(result.options.hotkeys_sample_rate, 8);
+
+  for (const char* const rate : {"-1", "1000001", "often"}) {
+    const std::array kInvalid = {"redis_simple", "--hotkeys-sample-rate",
+                                 rate};
+    EXPECT_EQ(ParseServerOptions(kInvalid.size(), kInvalid.data()).status,
+              OptionsStatus::kError)
+        << rate;
+  }
+}
+
+TEST(ServerOptionsTest, ParsesKeyspaceShards) {
+  constexpr std::array kArgv = {"redis_simple", "--keyspace-shards", "64"};
+  const auto result = ParseServerOptions(kArgv.size(), kArgv.data());
+  EXPECT_EQ(result.status, OptionsStatus::kOk);
+  EXPECT_EQ(result.options.keyspace_shards, 64);
+
+  for (const char* const shards : {"0", "12", "2048", "many"}) {
+    const std::array kInvalid = {"redis_simple", "--keyspace-shards", shards};
+    EXPECT_EQ(ParseServerOptions(kInvalid.size(), kInvalid.data()).status,
+              OptionsStatus::kError)
+        << shards;
+  }
+}
+
+TEST(ServerOptionsTest, ParsesKeyspacePrefixIndex) {
+  constexpr std::array kArgv = {"redis_simple", "--keyspace-prefix-index",
+                                "yes"};
+  const auto result = ParseServerOptions(kArgv.size(), kArgv.data());
+  EXPECT_EQ(result.status, OptionsStatus::kOk);
+  EXPECT_TRUE(result.options.keyspace_prefix_index);
+
+  constexpr std::array kInvalid = {"redis_simple", "--keyspace-prefix-index",
+                                   "on"};
+  EXPECT_EQ(ParseServerOptions(kInvalid.size(), kInvalid.data()).status,
+            OptionsStatus::kError);
+}
+
 TEST(ServerOptionsTest, HandlesHelpAndInvalidArguments) {
   constexpr std::array kHelp = {"redis_simple", "--help"};
   EXPECT_EQ(ParseServerOptions(kHelp.size(), kHelp.data()).status,
@@ -0,0 +1,69 @@
+#include "server/server.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "data_types/hash/hash.h"
+#include "memory/used_memory.h"
+#include "server/db/db.h"
+
+namespace redis_simple {
+TEST(ServerTest, EvictsWhileReclaimsArePending) {
+  auto* const server = Server::Get();
+  auto* const db = server->Db();
+  ASSERT_NE(db, nullptr);
+  db->Flush();
+  const size_t baseline = in_memory::UsedMemory();
+  for (int index = 0; index < 2000; ++index) {
+    ASSERT_EQ(db->SetKey("key:" + std::to_string(index),
+                         db::RedisObject::CreateWithString(
+                             std::string(1024, 'x')),
+                         0),
+              db::DbStatus::kOk);
+  }
+  const size_t filled = in_memory::UsedMemory();
+  ASSERT_GT(filled, baseline);
+  for (int index = 0; index < 20; ++index) {
+    auto hash = hash::Hash::Create();
+    for (int field = 0; field < 5000; ++field) {
+      hash->Set("field:" + std::to_string(field), "value");
+    }
+    const std::string key = "hash:" + std::to_string(index);
+    ASSERT_EQ(db->SetKey(key, db::RedisObject::CreateWithHash(std::move(hash)),
+                         0),
+              db::DbStatus::kOk);
+  }
+  for (int index = 0; index < 20; ++index) {
+    ASSERT_EQ(db->UnlinkKey("hash:" + std::to_string(index)),
+              db::DbStatus::kOk);
+  }
+
+  const size_t limit = baseline + (filled - baseline) / 2;
+  server->SetMaxMemory(limit, db::EvictionPolicy::kAllKeysRandom);
+  // The reclaimer is still freeing the hashes, which must not stop the first
+  // call from evicting.
+  EvictionResult result = server->PerformEvictions();
+  EXPECT_GT(db->EvictStats().evicted_keys, 0);
+  while (result == EvictionResult::kRunning) {
+    result = server->PerformEvictions();
+  }
+  EXPECT_EQ(result, EvictionResult::kOk);
+  EXPECT_LT(db->KeyCount(), 2000);
+  // The reclaimer may free memory before it retires the estimate, so clamp
+  // as the server does.
+  const size_t pending = db->PendingReclaimBytes();
+  const size_t used = in_memory::UsedMemory();
+  EXPECT_LE(used - std::min(used, pending), limit);
+
+  while (db->PendingReclaims() > 0) {
+    std::this_thread::yield();
+  }
+  server->SetMaxMemory(0, db::EvictionPolicy::kNoEviction);
+  db->Flush();
+}
+}  // namespace redis_simple
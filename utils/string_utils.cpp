@@ -200,6 +200,23 @@ bool MatchesGlob(std::string_view value, std::string_view pattern) {
   return pattern_offset == pattern.size();
 }
 
+std::string GlobLiteralPrefix(std::string_view pattern) {
+  std::string prefix;
+  for (size_t offset = 0; offset < pattern.size(); ++offset) {
+    const char token = pattern[offset];
+    if (token == '*' || token == '?' || token == '[') {
+      break;
+    }
+    if (token == '\\' && ++offset == pattern.size()) {
+      // A trailing backslash matches itself.
+      prefix.push_back(token);
+      break;
+    }
+    prefix.push_back(pattern[offset]);
+  }
+  return prefix;
+}
+
 bool ToInt64(std::string_view s, int64_t* const v) {
   if (s.empty() || s.size() > 20) {
     return false;
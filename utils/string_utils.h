@@ -19,6 +19,8 @@ void ToUppercase(std::string& s);
 bool EqualsIgnoreCase(std::string_view left, std::string_view right);
 // Match Redis-style glob patterns without allocating temporary strings.
 bool MatchesGlob(std::string_view value, std::string_view pattern);
+// The literal text every value matching pattern starts with, unescaped.
+std::string GlobLiteralPrefix(std::string_view pattern);
 // Return true if the string strictly represents a signed int64: no leading or
 // trailing spaces, no extra characters, and no leading zeroes except "0".
 bool ToInt64(std::string_view s, int64_t* v);
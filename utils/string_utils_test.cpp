@@ -122,6 +122,16 @@ TEST(StringUtilsTest, MatchesRedisStyleGlobs) {
   EXPECT_FALSE(MatchesGlob("", "?"));
 }
 
+TEST(StringUtilsTest, GlobLiteralPrefix) {
+  EXPECT_EQ(GlobLiteralPrefix("user:1234:*"), "user:1234:");
+  EXPECT_EQ(GlobLiteralPrefix("key?"), "key");
+  EXPECT_EQ(GlobLiteralPrefix("file[0-9]"), "file");
+  EXPECT_EQ(GlobLiteralPrefix(R"(literal\*x*)"), "literal*x");
+  EXPECT_EQ(GlobLiteralPrefix(R"(tail\)"), R"(tail\)");
+  EXPECT_EQ(GlobLiteralPrefix("exact"), "exact");
+  EXPECT_EQ(GlobLiteralPrefix("*:suffix"), "");
+}
+
 TEST(StringUtilsTest, ToInt64) {
   std::string s1("100234567");
   int64_t v1 = 0;
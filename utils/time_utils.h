@@ -1,12 +1,68 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 
 namespace redis_simple::utils {
+inline constexpr int64_t kMicrosecondsPerSecond = 1000000;
+// SCAN steps a time-budgeted cron job takes between clock reads.
+inline constexpr size_t kStepsPerClockRead = 16;
+
+// Microseconds a cron job may spend per run to use percent of each second
+// when the cron runs hz times a second.
+inline int64_t CronSliceMicroseconds(int64_t percent, int hz) {
+  return kMicrosecondsPerSecond * percent / 100 / std::max(hz, 1);
+}
+
 inline int64_t NowInMilliseconds() {
   return std::chrono::duration_cast<std::chrono::milliseconds>(
              std::chrono::system_clock::now().time_since_epoch())
       .count();
 }
+
+// Monotonic time for measuring elapsed intervals. steady_clock reads
+// CLOCK_MONOTONIC through the vDSO, without a system call.
+inline int64_t NowInMicroseconds() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Monotonic time for scheduling timers, unaffected by wall-clock changes.
+inline int64_t MonotonicNowInMilliseconds() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+namespace time_internal {
+// Wall-clock milliseconds cached by the innermost CachedClockScope, or 0.
+inline thread_local int64_t cached_now_ms = 0;
+}  // namespace time_internal
+
+/*
+ * Wall-clock milliseconds for expiration decisions. While a CachedClockScope
+ * is open this is the time the scope opened, so every command run by one
+ * event loop iteration sees the same time and lookups of volatile keys do not
+ * read the clock. Outside a scope it reads the clock.
+ */
+inline int64_t CachedNowInMilliseconds() {
+  const int64_t cached = time_internal::cached_now_ms;
+  return cached != 0 ? cached : NowInMilliseconds();
+}
+
+class CachedClockScope {
+ public:
+  CachedClockScope() : previous_(time_internal::cached_now_ms) {
+    time_internal::cached_now_ms = NowInMilliseconds();
+  }
+  CachedClockScope(const CachedClockScope&) = delete;
+  CachedClockScope& operator=(const CachedClockScope&) = delete;
+  ~CachedClockScope() { time_internal::cached_now_ms = previous_; }
+
+ private:
+  int64_t previous_;
+};
 }  // namespace redis_simple::utils
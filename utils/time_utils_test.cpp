@@ -0,0 +1,42 @@
+#include "utils/time_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace redis_simple::utils {
+TEST(TimeUtilsTest, CachedClockHoldsTimeWithinScope) {
+  const int64_t before = NowInMilliseconds();
+  {
+    const CachedClockScope outer;
+    const int64_t cached = CachedNowInMilliseconds();
+    EXPECT_GE(cached, before);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(CachedNowInMilliseconds(), cached);
+    {
+      const CachedClockScope inner;
+      EXPECT_GT(CachedNowInMilliseconds(), cached);
+    }
+    EXPECT_EQ(CachedNowInMilliseconds(), cached);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  EXPECT_GE(CachedNowInMilliseconds(), before + 2);
+}
+
+TEST(TimeUtilsTest, MonotonicClocksAdvance) {
+  const int64_t micros = NowInMicroseconds();
+  const int64_t millis = MonotonicNowInMilliseconds();
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  EXPECT_GE(NowInMicroseconds() - micros, 2000);
+  EXPECT_GE(MonotonicNowInMilliseconds() - millis, 2);
+}
+
+TEST(TimeUtilsTest, CronSliceSplitsThePercentAcrossRuns) {
+  EXPECT_EQ(CronSliceMicroseconds(25, 10), 25000);
+  EXPECT_EQ(CronSliceMicroseconds(1, 500), 20);
+  // A zero rate is treated as one run a second.
+  EXPECT_EQ(CronSliceMicroseconds(10, 0), 100000);
+}
+}  // namespace redis_simple::utils